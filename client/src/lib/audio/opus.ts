@@ -0,0 +1,142 @@
+/**
+ * Opus codec mode (WebCodecs).
+ *
+ * Negotiated at bind: the client asks for `codec: 'opus'` and switches over
+ * once the server's `bound` reply confirms it. Capture frames (128 samples)
+ * go into an AudioEncoder configured for 2.5ms low-delay frames; the encoder
+ * re-frames them itself. Received Opus packets are decoded and written to
+ * the playback ring buffer like PCM.
+ *
+ * Opus datagrams carry the usual 8-byte header (sequence, timestamp in
+ * samples) followed by the Opus packet; they are always shorter than a PCM
+ * datagram, so the length tells them apart.
+ */
+
+import { SAMPLE_RATE, AUDIO_HEADER_SIZE, AUDIO_PACKET_SIZE } from './types.js';
+
+/** Opus frame: 2.5ms (120 samples at 48kHz) */
+export const OPUS_FRAME_SAMPLES = 120;
+const OPUS_BITRATE = 96_000;
+
+const ENCODER_CONFIG = {
+	codec: 'opus',
+	sampleRate: SAMPLE_RATE,
+	numberOfChannels: 1,
+	bitrate: OPUS_BITRATE,
+	opus: { frameDuration: 2500, application: 'lowdelay', signal: 'music' }
+} as AudioEncoderConfig;
+
+const DECODER_CONFIG: AudioDecoderConfig = {
+	codec: 'opus',
+	sampleRate: SAMPLE_RATE,
+	numberOfChannels: 1
+};
+
+/** True if a received datagram carries an Opus packet */
+export function isOpusDatagram(byteLength: number): boolean {
+	return byteLength > AUDIO_HEADER_SIZE && byteLength < AUDIO_PACKET_SIZE;
+}
+
+/** True if this browser can encode and decode 2.5ms Opus */
+export async function opusSupported(): Promise<boolean> {
+	if (typeof AudioEncoder === 'undefined' || typeof AudioDecoder === 'undefined') return false;
+	try {
+		const [enc, dec] = await Promise.all([
+			AudioEncoder.isConfigSupported(ENCODER_CONFIG),
+			AudioDecoder.isConfigSupported(DECODER_CONFIG)
+		]);
+		return !!enc.supported && !!dec.supported;
+	} catch {
+		return false;
+	}
+}
+
+/** Encodes capture frames and hands each Opus datagram to `send` */
+export class OpusSender {
+	private encoder: AudioEncoder;
+	private sequence = 0;
+	private inputSamples = 0;
+
+	constructor(private send: (datagram: Uint8Array) => void) {
+		this.encoder = new AudioEncoder({
+			output: (chunk) => this.handleChunk(chunk),
+			error: (err) => console.warn('[Opus] Encoder error:', err)
+		});
+		this.encoder.configure(ENCODER_CONFIG);
+	}
+
+	/** Queue one capture frame (copied; the caller may reuse `samples`) */
+	encode(samples: Int16Array): void {
+		if (this.encoder.state !== 'configured') return;
+		const data = new AudioData({
+			format: 's16',
+			sampleRate: SAMPLE_RATE,
+			numberOfFrames: samples.length,
+			numberOfChannels: 1,
+			timestamp: Math.round((this.inputSamples * 1e6) / SAMPLE_RATE),
+			data: samples.slice()
+		});
+		this.inputSamples += samples.length;
+		this.encoder.encode(data);
+		data.close();
+	}
+
+	close(): void {
+		if (this.encoder.state !== 'closed') this.encoder.close();
+	}
+
+	private handleChunk(chunk: EncodedAudioChunk): void {
+		const datagram = new Uint8Array(AUDIO_HEADER_SIZE + chunk.byteLength);
+		const view = new DataView(datagram.buffer);
+		view.setUint32(0, this.sequence++, true);
+		view.setUint32(4, Math.round((chunk.timestamp * SAMPLE_RATE) / 1e6) >>> 0, true);
+		chunk.copyTo(datagram.subarray(AUDIO_HEADER_SIZE));
+		this.send(datagram);
+	}
+}
+
+/** Decodes received Opus datagrams and hands the int16 samples to `write` */
+export class OpusReceiver {
+	private decoder: AudioDecoder;
+	private floatBuffer = new Float32Array(OPUS_FRAME_SAMPLES * 4);
+
+	constructor(private write: (samples: Int16Array) => void) {
+		this.decoder = new AudioDecoder({
+			output: (data) => this.handleData(data),
+			error: (err) => console.warn('[Opus] Decoder error:', err)
+		});
+		this.decoder.configure(DECODER_CONFIG);
+	}
+
+	decode(datagram: Uint8Array): void {
+		if (this.decoder.state !== 'configured') return;
+		const view = new DataView(datagram.buffer, datagram.byteOffset, datagram.byteLength);
+		const timestamp = view.getUint32(4, true);
+		this.decoder.decode(
+			new EncodedAudioChunk({
+				type: 'key',
+				timestamp: Math.round((timestamp * 1e6) / SAMPLE_RATE),
+				data: datagram.subarray(AUDIO_HEADER_SIZE)
+			})
+		);
+	}
+
+	close(): void {
+		if (this.decoder.state !== 'closed') this.decoder.close();
+	}
+
+	private handleData(data: AudioData): void {
+		const n = data.numberOfFrames;
+		if (this.floatBuffer.length < n) this.floatBuffer = new Float32Array(n);
+		const floats = this.floatBuffer.subarray(0, n);
+		data.copyTo(floats, { planeIndex: 0, format: 'f32-planar' });
+		data.close();
+
+		const samples = new Int16Array(n);
+		for (let i = 0; i < n; i++) {
+			const s = Math.max(-1, Math.min(1, floats[i]));
+			samples[i] = s < 0 ? s * 0x8000 : s * 0x7fff;
+		}
+		this.write(samples);
+	}
+}
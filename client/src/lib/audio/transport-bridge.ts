@@ -10,6 +10,9 @@
  *
  * The playback path stays on the main thread (adding a Worker hop would
  * increase playback latency).
+ *
+ * In Opus mode (see opus.ts) captured frames are encoded on the main thread
+ * before sending, and received Opus datagrams are decoded before playback.
  */
 
 import { RingBufferReader, RingBufferWriter } from './ring-buffer.js';
@@ -22,6 +25,7 @@ import {
 	deserializePacket,
 	type AudioPacket
 } from './types.js';
+import { OpusSender, OpusReceiver, isOpusDatagram } from './opus.js';
 import type { Transport } from '../transport/transport.js';
 
 export interface TransportBridgeOptions {
@@ -49,6 +53,8 @@ export class TransportBridge {
 	private incomingCount = 0;
 	private loopbackEnabled = false;
 	private micMuted = false;
+	private opusSender: OpusSender | null = null;
+	private opusReceiver: OpusReceiver | null = null;
 
 	// Pre-allocated buffers for zero-allocation on hot path (fallback only)
 	private readBuffer = new Int16Array(SAMPLES_PER_FRAME);
@@ -81,7 +87,11 @@ export class TransportBridge {
 			this.worker.onmessage = (event: MessageEvent) => {
 				const msg = event.data;
 				if (msg.type === 'packet') {
-					this.transport.sendDatagram(new Uint8Array(msg.data));
+					if (this.opusSender) {
+						this.opusSender.encode(new Int16Array(msg.data, AUDIO_HEADER_SIZE, SAMPLES_PER_FRAME));
+					} else {
+						this.transport.sendDatagram(new Uint8Array(msg.data));
+					}
 					this.sendSequence++;
 				} else if (msg.type === 'loopback') {
 					this.playbackWriter.write(new Int16Array(msg.samples));
@@ -130,6 +140,27 @@ export class TransportBridge {
 			clearInterval(this.pollTimer);
 			this.pollTimer = null;
 		}
+
+		this.setCodec('pcm');
+	}
+
+	/** Switch the send/receive codec (after the server's `bound` reply) */
+	setCodec(codec: 'pcm' | 'opus'): void {
+		this.opusSender?.close();
+		this.opusReceiver?.close();
+		this.opusSender = null;
+		this.opusReceiver = null;
+		if (codec !== 'opus') return;
+		try {
+			this.opusSender = new OpusSender((datagram) => this.transport.sendDatagram(datagram));
+			this.opusReceiver = new OpusReceiver((samples) => this.playbackWriter.write(samples));
+			console.log('[TransportBridge] Using Opus');
+		} catch (err) {
+			console.warn('[TransportBridge] Opus unavailable, staying on PCM:', err);
+			this.opusSender?.close();
+			this.opusSender = null;
+			this.opusReceiver = null;
+		}
 	}
 
 	/** Mute/unmute mic (still drains buffer, but skips sending) */
@@ -163,7 +194,11 @@ export class TransportBridge {
 			if (read < SAMPLES_PER_FRAME) break;
 
 			// When muted, still drain the buffer but don't send over network
-			if (!this.micMuted) {
+			if (!this.micMuted && this.opusSender) {
+				this.opusSender.encode(this.readBuffer);
+				this.sendSequence++;
+				this.sendTimestamp += SAMPLES_PER_FRAME;
+			} else if (!this.micMuted) {
 				const packet: AudioPacket = {
 					sequence: this.sendSequence++,
 					timestamp: this.sendTimestamp,
@@ -184,6 +219,12 @@ export class TransportBridge {
 
 	/** Handle incoming datagram: deserialize and write to playback ring buffer */
 	private handleIncoming(data: Uint8Array): void {
+		if (this.opusReceiver && isOpusDatagram(data.byteLength)) {
+			this.opusReceiver.decode(data);
+			this.incomingCount++;
+			return;
+		}
+
 		const packet = deserializePacket(data);
 		if (!packet) return;
 
@@ -28,14 +28,20 @@ export function serializePacket(packet: AudioPacket): Uint8Array {
 	return bytes;
 }
 
-/** Deserialize a Uint8Array into an AudioPacket */
+/** Samples of a header-only silence marker (shared, never written) */
+const SILENT_SAMPLES = new Int16Array(SAMPLES_PER_FRAME);
+
+/** Deserialize a Uint8Array into an AudioPacket. A header-only datagram is a silence marker. */
 export function deserializePacket(data: Uint8Array): AudioPacket | null {
-	if (data.byteLength < AUDIO_PACKET_SIZE) return null;
+	const silent = data.byteLength === AUDIO_HEADER_SIZE;
+	if (data.byteLength < AUDIO_PACKET_SIZE && !silent) return null;
 	const view = new DataView(data.buffer, data.byteOffset, data.byteLength);
 	return {
 		sequence: view.getUint32(0, true),
 		timestamp: view.getUint32(4, true),
-		samples: new Int16Array(data.buffer, data.byteOffset + AUDIO_HEADER_SIZE, SAMPLES_PER_FRAME)
+		samples: silent
+			? SILENT_SAMPLES
+			: new Int16Array(data.buffer, data.byteOffset + AUDIO_HEADER_SIZE, SAMPLES_PER_FRAME)
 	};
 }
 
@@ -0,0 +1,64 @@
+/**
+ * Node probe — measures RTT from this browser to each server node.
+ *
+ * On a multi-node deployment the directory lists its nodes at /api/nodes;
+ * the join request carries these RTTs so the room is placed on the node
+ * nearest the whole group. Single-node servers have no /api/nodes and the
+ * probe returns nothing.
+ */
+
+interface NodeEntry {
+	id: string;
+	probe_url: string;
+	draining: boolean;
+}
+
+/** Fetches per node; the minimum filters out connection setup */
+const PROBES_PER_NODE = 3;
+const PROBE_TIMEOUT_MS = 1500;
+
+async function timeFetch(url: string): Promise<number | null> {
+	const controller = new AbortController();
+	const timer = setTimeout(() => controller.abort(), PROBE_TIMEOUT_MS);
+	const start = performance.now();
+	try {
+		await fetch(url, { cache: 'no-store', signal: controller.signal });
+		return performance.now() - start;
+	} catch {
+		return null;
+	} finally {
+		clearTimeout(timer);
+	}
+}
+
+async function probeNode(node: NodeEntry): Promise<number | null> {
+	let best: number | null = null;
+	for (let i = 0; i < PROBES_PER_NODE; i++) {
+		const rtt = await timeFetch(node.probe_url);
+		if (rtt !== null && (best === null || rtt < best)) best = rtt;
+	}
+	return best;
+}
+
+/** RTT in ms to each reachable, non-draining node, keyed by node ID */
+export async function probeNodes(): Promise<Record<string, number>> {
+	let nodes: NodeEntry[];
+	try {
+		const res = await fetch('/api/nodes');
+		if (!res.ok) return {};
+		nodes = (await res.json()).nodes ?? [];
+	} catch {
+		return {};
+	}
+
+	const rtts: Record<string, number> = {};
+	const results = await Promise.all(
+		nodes
+			.filter((n) => !n.draining && n.probe_url)
+			.map(async (n) => [n.id, await probeNode(n)] as const)
+	);
+	for (const [id, rtt] of results) {
+		if (rtt !== null) rtts[id] = Math.round(rtt * 10) / 10;
+	}
+	return rtts;
+}
@@ -4,6 +4,16 @@
 
 import { writable, derived } from 'svelte/store';
 import type { Participant, RoomInfo } from '../audio/types.js';
+import { probeNodes } from '../latency/node-probe.js';
+
+/** Where the room's audio lives, from the join response */
+export interface RoomTransport {
+	wtUrl?: string;
+	wsUrl?: string;
+	certHash?: string;
+	/** Room is hosted by another node than the one serving this page */
+	remote: boolean;
+}
 
 export interface RoomState {
 	/** Current room name (null if in lobby) */
@@ -16,6 +26,8 @@ export interface RoomState {
 	participants: Participant[];
 	/** Is a vacate request active */
 	vacateNotice: boolean;
+	/** Transport endpoints for the room (null until joined) */
+	transport: RoomTransport | null;
 }
 
 const initialRoomState: RoomState = {
@@ -23,7 +35,8 @@ const initialRoomState: RoomState = {
 	participantId: null,
 	alias: null,
 	participants: [],
-	vacateNotice: false
+	vacateNotice: false,
+	transport: null
 };
 
 export const roomState = writable<RoomState>(initialRoomState);
@@ -47,6 +60,59 @@ export async function fetchRooms(): Promise<void> {
 	}
 }
 
+/** Poll interval when the lobby event stream isn't available */
+const ROOM_POLL_MS = 5000;
+
+/**
+ * Keep `rooms` current from the server's lobby event stream
+ * (GET /api/rooms/events): a snapshot on connect, then an update with
+ * just the rooms that changed. Falls back to polling /api/rooms if the
+ * stream can't be opened. Returns a function that stops watching.
+ */
+export function watchRooms(): () => void {
+	let pollTimer: ReturnType<typeof setInterval> | null = null;
+	const startPolling = () => {
+		if (pollTimer) return;
+		fetchRooms();
+		pollTimer = setInterval(fetchRooms, ROOM_POLL_MS);
+	};
+	const stopPolling = () => {
+		if (pollTimer) clearInterval(pollTimer);
+		pollTimer = null;
+	};
+
+	if (typeof EventSource === 'undefined') {
+		startPolling();
+		return stopPolling;
+	}
+
+	const source = new EventSource('/api/rooms/events');
+	source.addEventListener('snapshot', (e) => {
+		stopPolling();
+		rooms.set(JSON.parse((e as MessageEvent).data).rooms);
+	});
+	source.addEventListener('update', (e) => {
+		const changed: RoomInfo[] = JSON.parse((e as MessageEvent).data).rooms;
+		rooms.update((list) => {
+			const next = list.map((room) => changed.find((c) => c.name === room.name) ?? room);
+			for (const room of changed) {
+				if (!next.some((r) => r.name === room.name)) next.push(room);
+			}
+			return next;
+		});
+	});
+	source.onerror = () => {
+		// EventSource reconnects by itself; CLOSED means it gave up
+		// (e.g. a server without the stream), so poll instead
+		if (source.readyState === EventSource.CLOSED) startPolling();
+	};
+
+	return () => {
+		source.close();
+		stopPolling();
+	};
+}
+
 /** Join a room */
 export async function joinRoom(
 	roomName: string,
@@ -57,7 +123,7 @@ export async function joinRoom(
 		const res = await fetch(`/api/rooms/${encodeURIComponent(roomName)}/join`, {
 			method: 'POST',
 			headers: { 'Content-Type': 'application/json' },
-			body: JSON.stringify({ alias, password: password ?? '' })
+			body: JSON.stringify({ alias, password: password ?? '', rtts: await probeNodes() })
 		});
 
 		if (res.ok) {
@@ -66,7 +132,13 @@ export async function joinRoom(
 				...s,
 				currentRoom: roomName,
 				participantId: data.participant_id,
-				alias
+				alias,
+				transport: {
+					wtUrl: data.wt_url,
+					wsUrl: data.ws_url,
+					certHash: data.cert_hash,
+					remote: data.remote === true
+				}
 			}));
 			return { success: true };
 		}
@@ -13,13 +13,16 @@ export interface Settings {
 	alias: string;
 	/** Playback prebuffer frames (0 = no prebuffer, higher = more latency but fewer underruns) */
 	prebufferFrames: number;
+	/** Audio codec requested at bind ('opus' falls back to 'pcm' if unsupported) */
+	codec: 'pcm' | 'opus';
 }
 
 const defaultSettings: Settings = {
 	nerdMode: false,
 	fudgeFactorMs: 0,
 	alias: '',
-	prebufferFrames: 0
+	prebufferFrames: 0,
+	codec: 'pcm'
 };
 
 function createSettingsStore() {
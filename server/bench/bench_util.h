@@ -0,0 +1,110 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "audio/room.h"
+#include "transport/transport_interface.h"
+
+namespace tutti::bench {
+
+/// One render quantum (128 samples at 48kHz) in nanoseconds
+constexpr double kQuantumNs = 1e9 * kSamplesPerFrame / kSampleRate;
+
+/// Collects per-iteration wall time and reports tail percentiles as counters.
+///
+///   LatencySampler sampler(state);
+///   for (auto _ : state) {
+///       auto t = sampler.begin();
+///       ...work...
+///       sampler.end(t);
+///   }
+///   sampler.report();
+///
+/// Counters: p50_ns, p99_ns, p999_ns, and p999_budget_pct (p99.9 as a
+/// percentage of the 2.67ms mix quantum).
+class LatencySampler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit LatencySampler(benchmark::State& state) : state_(state) {
+        samples_.reserve(static_cast<size_t>(std::min<benchmark::IterationCount>(
+            state.max_iterations, 1 << 22)));
+    }
+
+    Clock::time_point begin() const { return Clock::now(); }
+
+    void end(Clock::time_point start) {
+        samples_.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                               Clock::now() - start).count());
+    }
+
+    void report() {
+        if (samples_.empty()) return;
+        std::sort(samples_.begin(), samples_.end());
+        double p999 = percentile(0.999);
+        state_.counters["p50_ns"] = percentile(0.50);
+        state_.counters["p99_ns"] = percentile(0.99);
+        state_.counters["p999_ns"] = p999;
+        state_.counters["p999_budget_pct"] = 100.0 * p999 / kQuantumNs;
+    }
+
+private:
+    double percentile(double p) const {
+        size_t idx = static_cast<size_t>(p * static_cast<double>(samples_.size() - 1));
+        return static_cast<double>(samples_[idx]);
+    }
+
+    benchmark::State& state_;
+    std::vector<int64_t> samples_;
+};
+
+/// Transport session that accepts and discards everything
+class NullSession : public TransportSession {
+public:
+    explicit NullSession(std::string id) : id_(std::move(id)) {}
+    bool send_datagram(const uint8_t*, size_t) override {
+        sent.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    bool send_reliable(const std::string&) override { return true; }
+    void close() override {}
+    std::string id() const override { return id_; }
+    std::string remote_address() const override { return "bench"; }
+    bool is_connected() const override { return true; }
+
+    std::atomic<uint64_t> sent{0};
+
+private:
+    std::string id_;
+};
+
+/// A serialized PCM packet with every sample set to `value`
+inline std::vector<uint8_t> make_packet(int16_t value, uint32_t seq = 0) {
+    AudioPacket pkt{};
+    pkt.sequence = seq;
+    pkt.timestamp = seq * kSamplesPerFrame;
+    for (auto& s : pkt.samples) s = value;
+    std::vector<uint8_t> buf(kAudioPacketSize);
+    pkt.serialize(buf.data());
+    return buf;
+}
+
+/// Rewrite a packet's sequence and timestamp in place, so repeated sends
+/// look like a live stream to the jitter buffer rather than duplicates
+inline void set_packet_sequence(std::vector<uint8_t>& pkt, uint32_t seq) {
+    const uint32_t ts = seq * kSamplesPerFrame;
+    for (int b = 0; b < 4; ++b) {
+        pkt[b] = static_cast<uint8_t>(seq >> (8 * b));
+        pkt[4 + b] = static_cast<uint8_t>(ts >> (8 * b));
+    }
+}
+
+} // namespace tutti::bench
@@ -0,0 +1,51 @@
+#include "bench_util.h"
+
+#include "audio/jitter_buffer.h"
+
+namespace tutti::bench {
+namespace {
+
+/// One participant's jitter buffer for a cycle: a frame in, the cycle's
+/// frame out. Arg = the sender's clock skew in ppm (-81250 is an iOS
+/// client at 44.1kHz); skewed senders are run for 10 simulated seconds
+/// first, so compensation is under way when timing starts.
+void BM_JitterBufferPlayout(benchmark::State& state) {
+    const double ratio = 1.0 + static_cast<double>(state.range(0)) * 1e-6;
+    const double period_ns = kQuantumNs / ratio;
+
+    JitterBuffer jb;
+    AudioFrame frame;
+    for (size_t i = 0; i < kSamplesPerFrame; ++i) frame.samples[i] = static_cast<int16_t>(i * 64);
+    uint32_t seq = 0;
+    uint64_t cycle = 0;
+    auto run_cycle = [&] {
+        const double now = static_cast<double>(cycle++) * kQuantumNs;
+        while (seq * period_ns - kQuantumNs / 2 <= now) {
+            frame.sequence = seq;
+            frame.timestamp = seq * kSamplesPerFrame;
+            jb.push(frame, static_cast<int64_t>(seq * period_ns - kQuantumNs / 2));
+            ++seq;
+        }
+        const AudioFrame* out;
+        jb.front(out);
+        benchmark::DoNotOptimize(out);
+        jb.pop();
+    };
+    const auto warmup = static_cast<uint64_t>(10 * kSampleRate / kSamplesPerFrame);
+    while (cycle < warmup) run_cycle();
+
+    LatencySampler sampler(state);
+    for (auto _ : state) {
+        auto t = sampler.begin();
+        run_cycle();
+        sampler.end(t);
+    }
+    sampler.report();
+    JitterStats stats = jb.stats();
+    state.counters["drift_ppm"] = stats.drift_ppm;
+    state.counters["concealed"] = static_cast<double>(stats.concealed);
+}
+BENCHMARK(BM_JitterBufferPlayout)->ArgName("skew_ppm")->Arg(0)->Arg(300)->Arg(-300)->Arg(-81250);
+
+} // namespace
+} // namespace tutti::bench
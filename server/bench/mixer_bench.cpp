@@ -0,0 +1,121 @@
+#include "bench_util.h"
+
+#include "audio/mixer.h"
+
+namespace tutti::bench {
+namespace {
+
+AudioFrame make_frame(int16_t value) {
+    AudioFrame frame;
+    frame.sequence = 0;
+    frame.timestamp = 0;
+    frame.samples.fill(value);
+    return frame;
+}
+
+/// One full cycle: every participant submits a frame, the mixer runs,
+/// every listener's output is popped. Arg 0 = participants, arg 1 = 1 to
+/// give each listener a non-unity gain for every source (worst case),
+/// arg 2 = 1 for stereo: stereo sources and listeners, every source panned
+/// when gained.
+void BM_MixCycle(benchmark::State& state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    const bool gained = state.range(1) != 0;
+    const bool stereo = state.range(2) != 0;
+
+    Mixer mixer(n);
+    std::vector<ParticipantSlot> slots;
+    std::vector<std::string> ids;
+    for (size_t i = 0; i < n; ++i) {
+        ids.push_back("p" + std::to_string(i));
+        slots.push_back(mixer.add_participant(ids.back()));
+    }
+    if (gained) {
+        for (const auto& listener : ids) {
+            for (const auto& source : ids) {
+                if (listener != source) mixer.set_gain(listener, source, 0.7f);
+                if (listener != source && stereo) mixer.set_pan(listener, source, -0.3f);
+            }
+        }
+    }
+    if (stereo) {
+        for (const auto& id : ids) mixer.set_output_channels(id, 2);
+    }
+
+    std::vector<AudioFrame> frames;
+    for (size_t i = 0; i < n; ++i) {
+        frames.push_back(make_frame(static_cast<int16_t>(1000 + i)));
+        if (stereo) frames.back().channels = 2;
+    }
+
+    LatencySampler sampler(state);
+    AudioFrame out;
+    uint32_t seq = 0;
+    for (auto _ : state) {
+        for (size_t i = 0; i < n; ++i) {
+            frames[i].sequence = seq;
+            frames[i].timestamp = seq * kSamplesPerFrame;
+            mixer.push_input(slots[i], frames[i]);
+        }
+        ++seq;
+        auto t = sampler.begin();
+        mixer.mix_cycle();
+        sampler.end(t);
+        for (size_t i = 0; i < n; ++i) mixer.pop_output(slots[i], out);
+        benchmark::DoNotOptimize(out);
+    }
+    sampler.report();
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(n));
+}
+BENCHMARK(BM_MixCycle)
+    ->ArgNames({"participants", "gained", "stereo"})
+    ->ArgsProduct({{2, 3, 4, 8, 12, 16}, {0, 1}, {0, 1}});
+
+/// A mix cycle with listen-only participants: arg 0 = performers, arg 1 =
+/// listeners, who send nothing and all hear the same mix (built once,
+/// copied to each), arg 2 = 1 to have every listener give every performer
+/// the same non-unity gain
+void BM_MixCycleAudience(benchmark::State& state) {
+    const auto performers = static_cast<size_t>(state.range(0));
+    const auto n = performers + static_cast<size_t>(state.range(1));
+    const bool gained = state.range(2) != 0;
+
+    Mixer mixer(n);
+    std::vector<ParticipantSlot> slots;
+    for (size_t i = 0; i < n; ++i) slots.push_back(mixer.add_participant("p" + std::to_string(i)));
+    if (gained) {
+        for (size_t listener = performers; listener < n; ++listener) {
+            for (size_t source = 0; source < performers; ++source) {
+                mixer.set_gain("p" + std::to_string(listener), "p" + std::to_string(source), 0.7f);
+            }
+        }
+    }
+
+    std::vector<AudioFrame> frames;
+    for (size_t i = 0; i < performers; ++i) frames.push_back(make_frame(static_cast<int16_t>(1000 + i)));
+
+    LatencySampler sampler(state);
+    AudioFrame out;
+    uint32_t seq = 0;
+    for (auto _ : state) {
+        for (size_t i = 0; i < performers; ++i) {
+            frames[i].sequence = seq;
+            frames[i].timestamp = seq * kSamplesPerFrame;
+            mixer.push_input(slots[i], frames[i]);
+        }
+        ++seq;
+        auto t = sampler.begin();
+        mixer.mix_cycle();
+        sampler.end(t);
+        for (size_t i = 0; i < n; ++i) mixer.pop_output(slots[i], out);
+        benchmark::DoNotOptimize(out);
+    }
+    sampler.report();
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(n));
+}
+BENCHMARK(BM_MixCycleAudience)
+    ->ArgNames({"performers", "listeners", "gained"})
+    ->ArgsProduct({{4, 8}, {0, 8, 16, 24}, {0, 1}});
+
+} // namespace
+} // namespace tutti::bench
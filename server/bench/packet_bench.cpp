@@ -0,0 +1,40 @@
+#include "bench_util.h"
+
+namespace tutti::bench {
+namespace {
+
+void BM_PacketSerialize(benchmark::State& state) {
+    AudioPacket pkt{};
+    pkt.sequence = 42;
+    pkt.timestamp = 42 * kSamplesPerFrame;
+    for (size_t i = 0; i < kSamplesPerFrame; ++i) pkt.samples[i] = static_cast<int16_t>(i * 100);
+
+    uint8_t buf[kAudioPacketSize];
+    LatencySampler sampler(state);
+    for (auto _ : state) {
+        auto t = sampler.begin();
+        pkt.serialize(buf);
+        benchmark::DoNotOptimize(buf);
+        sampler.end(t);
+    }
+    sampler.report();
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(kAudioPacketSize));
+}
+BENCHMARK(BM_PacketSerialize);
+
+void BM_PacketDeserialize(benchmark::State& state) {
+    auto buf = make_packet(1234, 42);
+    LatencySampler sampler(state);
+    for (auto _ : state) {
+        auto t = sampler.begin();
+        auto pkt = AudioPacket::deserialize(buf.data(), buf.size());
+        benchmark::DoNotOptimize(pkt);
+        sampler.end(t);
+    }
+    sampler.report();
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(kAudioPacketSize));
+}
+BENCHMARK(BM_PacketDeserialize);
+
+} // namespace
+} // namespace tutti::bench
@@ -0,0 +1,202 @@
+#include "bench_util.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+
+#include "audio/capture_replay.h"
+#include "rooms/room_manager.h"
+#include "rooms/room_names.h"
+#include "transport/session_binder.h"
+
+namespace tutti::bench {
+namespace {
+
+struct BenchRoom {
+    explicit BenchRoom(size_t n) : room("Bench", n) {
+        for (size_t i = 0; i < n; ++i) {
+            std::string id = "p" + std::to_string(i);
+            auto session = std::make_shared<NullSession>(id);
+            room.add_participant(id, id, session);
+            slots.push_back(room.slot_of(id));
+            sessions.push_back(std::move(session));
+        }
+    }
+
+    Room room;
+    std::vector<ParticipantSlot> slots;
+    std::vector<std::shared_ptr<NullSession>> sessions;
+};
+
+/// 2 participants: on_audio_received forwards straight to the peer.
+/// Arg 1 = the peer has turned the sender down (gain applied per packet).
+void BM_RoomFastPath(benchmark::State& state) {
+    BenchRoom r(2);
+    if (state.range(0) != 0) r.room.set_gain("p1", "p0", 0.7f);
+    auto pkt = make_packet(1000);
+
+    LatencySampler sampler(state);
+    for (auto _ : state) {
+        auto t = sampler.begin();
+        r.room.on_audio_received(r.slots[0], pkt.data(), pkt.size());
+        sampler.end(t);
+    }
+    sampler.report();
+}
+BENCHMARK(BM_RoomFastPath)->ArgName("gained")->Arg(0)->Arg(1);
+
+/// 3+ participants: one quantum = every participant's packet received,
+/// then the mix cycle and output sends (as a MixerScheduler worker runs it)
+void BM_RoomMixedPath(benchmark::State& state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    BenchRoom r(n);
+    auto pkt = make_packet(1000);
+
+    LatencySampler sampler(state);
+    uint32_t seq = 0;
+    for (auto _ : state) {
+        set_packet_sequence(pkt, seq++);
+        auto t = sampler.begin();
+        for (const auto& slot : r.slots) {
+            r.room.on_audio_received(slot, pkt.data(), pkt.size());
+        }
+        r.room.process_cycle();
+        sampler.end(t);
+    }
+    sampler.report();
+}
+BENCHMARK(BM_RoomMixedPath)->ArgName("participants")->Arg(3)->Arg(4)->Arg(8);
+
+/// BM_RoomMixedPath while the room records every input and mix: the
+/// mixer's share of recording is one queued copy per frame
+void BM_RoomRecording(benchmark::State& state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    BenchRoom r(n);
+    const std::string dir = "/tmp/tutti-bench-recording";
+    if (!r.room.start_recording(dir, true)) {
+        state.SkipWithError("cannot record to /tmp");
+        return;
+    }
+    auto pkt = make_packet(1000);
+
+    LatencySampler sampler(state);
+    uint32_t seq = 0;
+    for (auto _ : state) {
+        set_packet_sequence(pkt, seq++);
+        auto t = sampler.begin();
+        for (const auto& slot : r.slots) {
+            r.room.on_audio_received(slot, pkt.data(), pkt.size());
+        }
+        r.room.process_cycle();
+        sampler.end(t);
+    }
+    sampler.report();
+    r.room.stop_recording();
+    for (size_t i = 0; i < n; ++i) {
+        const std::string id = "p" + std::to_string(i);
+        std::remove((dir + "/" + id + ".wav").c_str());
+        std::remove((dir + "/mix-" + id + ".wav").c_str());
+    }
+    ::rmdir(dir.c_str());
+}
+BENCHMARK(BM_RoomRecording)->ArgName("participants")->Arg(4)->Arg(8);
+
+/// SessionBinder::on_datagram routing (session → binding → room), as wired
+/// through make_callbacks() for either transport
+void BM_BinderOnDatagram(benchmark::State& state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    auto manager = std::make_shared<RoomManager>(n);
+    manager->initialize_default_rooms();
+    SessionBinder binder(manager);
+    auto callbacks = binder.make_callbacks();
+
+    const std::string room_name = kDefaultRooms[0].name;
+    std::vector<std::shared_ptr<NullSession>> sessions;
+    for (size_t i = 0; i < n; ++i) {
+        std::string participant_id;
+        manager->join_room(room_name, "p" + std::to_string(i), "", nullptr, participant_id);
+        auto session = std::make_shared<NullSession>("session-" + std::to_string(i));
+        callbacks.on_session_open(session);
+        callbacks.on_message(session.get(),
+                             R"({"type":"bind","participant_id":")" + participant_id +
+                                 R"(","room":")" + room_name + R"("})");
+        sessions.push_back(std::move(session));
+    }
+    auto pkt = make_packet(1000);
+
+    LatencySampler sampler(state);
+    uint32_t seq = 0;
+    for (auto _ : state) {
+        set_packet_sequence(pkt, seq++);
+        auto t = sampler.begin();
+        callbacks.on_datagram(sessions[0].get(), pkt.data(), pkt.size());
+        sampler.end(t);
+    }
+    sampler.report();
+
+    for (auto& session : sessions) callbacks.on_session_close(session.get());
+    manager->stop_mixers();
+}
+BENCHMARK(BM_BinderOnDatagram)->ArgName("participants")->Arg(2)->Arg(4);
+
+/// One second of a room: `n` participants streaming, every fourth packet
+/// of the first a quantum late, and a mix cycle per quantum
+CaptureFile synthetic_capture(size_t n) {
+    CaptureFile capture;
+    capture.room = "Bench";
+    capture.max_participants = n;
+    for (size_t i = 0; i < n; ++i) {
+        const std::string join = std::string(1, '\0') + "p" + std::to_string(i);
+        const uint8_t bind[2] = {static_cast<uint8_t>(AudioCodec::Pcm), 1};
+        capture.add(0, CaptureEvent::Join, static_cast<uint32_t>(i),
+                    reinterpret_cast<const uint8_t*>(join.data()), join.size());
+        capture.add(0, CaptureEvent::Bind, static_cast<uint32_t>(i), bind, sizeof(bind));
+    }
+    auto pkt = make_packet(1000);
+    const auto quantum = static_cast<int64_t>(kQuantumNs);
+    for (uint32_t seq = 0; seq < 375; ++seq) {
+        const int64_t t = seq * quantum;
+        set_packet_sequence(pkt, seq);
+        for (size_t i = 0; i < n; ++i) {
+            const int64_t late = (i == 0 && seq % 4 == 0) ? quantum : 0;
+            capture.add(t + late + 1, CaptureEvent::Datagram, static_cast<uint32_t>(i),
+                        pkt.data(), pkt.size());
+        }
+        capture.add(t + quantum, CaptureEvent::MixCycle, 0);
+    }
+    std::stable_sort(capture.events.begin(), capture.events.end(),
+                     [](const auto& a, const auto& b) { return a.t_ns < b.t_ns; });
+    return capture;
+}
+
+/// A capture replayed flat out into a fresh room: the whole audio path
+/// (receive, jitter buffers, mix, send) under a recorded arrival pattern.
+/// Arg = participants in a synthetic capture; TUTTI_REPLAY_FILE replays a
+/// real one (tutti-server --capture) instead.
+void BM_RoomReplay(benchmark::State& state) {
+    CaptureFile capture;
+    const char* file = std::getenv("TUTTI_REPLAY_FILE");
+    if (file && !capture.load(file)) {
+        state.SkipWithError("TUTTI_REPLAY_FILE is not a capture");
+        return;
+    }
+    if (!file) capture = synthetic_capture(static_cast<size_t>(state.range(0)));
+
+    uint64_t cycles = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto room = std::make_unique<Room>(capture.room, capture.max_participants);
+        CaptureReplay replay(capture, *room, 0.0);
+        state.ResumeTiming();
+        cycles += replay.run().cycles;
+        state.PauseTiming();
+        room.reset();
+        state.ResumeTiming();
+    }
+    state.counters["cycles"] = benchmark::Counter(static_cast<double>(cycles),
+                                                  benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_RoomReplay)->ArgName("participants")->Arg(4)->Arg(8)->Unit(benchmark::kMillisecond);
+
+} // namespace
+} // namespace tutti::bench
@@ -0,0 +1,53 @@
+#include "bench_util.h"
+
+#include "telemetry/trace.h"
+
+namespace tutti::bench {
+namespace {
+
+// Events cost less than LatencySampler's own clock reads would add, so
+// these report the plain mean. Nearly all of an event is its timestamp
+// reads (~17ns each as rdtsc on a VM): BM_TraceTimestamp is one,
+// BM_TraceRecord the ring write alone (~2.5ns).
+
+/// One raw timestamp (rdtsc on x86)
+void BM_TraceTimestamp(benchmark::State& state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(trace::now());
+    }
+}
+BENCHMARK(BM_TraceTimestamp);
+
+/// One ring write with the timestamps already taken
+void BM_TraceRecord(benchmark::State& state) {
+    trace::ThreadRing& ring = trace::thread_ring();
+    uint64_t i = 0;
+    for (auto _ : state) {
+        ring.record("bench.record", i, i + 1, i);
+        ++i;
+    }
+}
+BENCHMARK(BM_TraceRecord);
+
+/// One traced scope: two timestamps and a ring write
+void BM_TraceScope(benchmark::State& state) {
+    trace::thread_ring();  // registered up front, as after a thread's first event
+    uint64_t i = 0;
+    for (auto _ : state) {
+        trace::Scope scope("bench.scope", i++);
+    }
+}
+BENCHMARK(BM_TraceScope);
+
+/// One instant: a timestamp and a ring write
+void BM_TraceInstant(benchmark::State& state) {
+    trace::thread_ring();
+    uint64_t i = 0;
+    for (auto _ : state) {
+        trace::instant("bench.instant", i++);
+    }
+}
+BENCHMARK(BM_TraceInstant);
+
+} // namespace
+} // namespace tutti::bench
@@ -18,13 +18,20 @@ if(TUTTI_ENABLE_WEBTRANSPORT)
     FetchContent_MakeAvailable(libwtf)
 endif()
 
-# ── rigtorp/SPSCQueue (lock-free SPSC queue) ────────────────────────────────
-FetchContent_Declare(
-    SPSCQueue
-    GIT_REPOSITORY https://github.com/rigtorp/SPSCQueue.git
-    GIT_TAG        v1.1
-    GIT_SHALLOW    TRUE
-)
+# ── libopus (optional low-latency codec mode) ───────────────────────────────
+if(TUTTI_ENABLE_OPUS)
+    FetchContent_Declare(
+        opus
+        GIT_REPOSITORY https://github.com/xiph/opus.git
+        GIT_TAG        v1.5.2
+        GIT_SHALLOW    TRUE
+    )
+    set(OPUS_BUILD_TESTING OFF CACHE BOOL "" FORCE)
+    set(OPUS_BUILD_PROGRAMS OFF CACHE BOOL "" FORCE)
+    set(OPUS_INSTALL_PKG_CONFIG_MODULE OFF CACHE BOOL "" FORCE)
+    set(OPUS_INSTALL_CMAKE_CONFIG_MODULE OFF CACHE BOOL "" FORCE)
+    FetchContent_MakeAvailable(opus)
+endif()
 
 # ── libdatachannel (WebRTC DataChannel - Safari/iOS fallback) ────────────────
 # libdatachannel bundles its own nlohmann/json, so we use that rather than
@@ -46,6 +53,20 @@ FetchContent_Declare(
     GIT_SHALLOW    TRUE
 )
 
+# ── Google Benchmark (microbenchmarks, optional) ─────────────────────────────
+if(TUTTI_BUILD_BENCH)
+    FetchContent_Declare(
+        benchmark
+        GIT_REPOSITORY https://github.com/google/benchmark.git
+        GIT_TAG        v1.8.3
+        GIT_SHALLOW    TRUE
+    )
+    set(BENCHMARK_ENABLE_TESTING OFF CACHE BOOL "" FORCE)
+    set(BENCHMARK_ENABLE_GTEST_TESTS OFF CACHE BOOL "" FORCE)
+    set(BENCHMARK_ENABLE_INSTALL OFF CACHE BOOL "" FORCE)
+    FetchContent_MakeAvailable(benchmark)
+endif()
+
 # Make dependencies available
 # libdatachannel must come first since it provides nlohmann_json
-FetchContent_MakeAvailable(libdatachannel SPSCQueue googletest)
+FetchContent_MakeAvailable(libdatachannel googletest)
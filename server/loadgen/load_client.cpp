@@ -0,0 +1,217 @@
+#include "load_client.h"
+
+#include <cstring>
+#include <iostream>
+
+#include <nlohmann/json.hpp>
+#include <rtc/rtc.hpp>
+
+#include "signaling/http_client.h"
+#include "transport/transport_interface.h"
+
+namespace tutti::loadgen {
+
+namespace {
+
+// Clicks closer together than this are one click heard twice (concealment
+// can repeat a frame); further apart than a click interval, a stale one
+constexpr int64_t kClickGuardNs = 100'000'000;
+constexpr int64_t kClickStaleNs = kFramePeriodNs * ToneSignal::kClickEvery;
+
+} // namespace
+
+LoadClient::LoadClient(Config config, std::shared_ptr<RoomProbe> probe)
+    : config_(std::move(config)), probe_(std::move(probe)) {}
+
+LoadClient::~LoadClient() { close(); }
+
+template <typename Pred>
+bool LoadClient::wait_for(Pred done, int timeout_ms) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return cv_.wait_for(lock, std::chrono::milliseconds(timeout_ms),
+                        [&] { return failed_ || done(); }) && !failed_;
+}
+
+bool LoadClient::connect(int timeout_ms) {
+    const std::string tag = "[" + config_.room + "/" + config_.alias + "] ";
+
+    // 1. Join through the HTTP API, as the lobby does
+    HttpClientResponse resp;
+    nlohmann::json join = {{"alias", config_.alias}};
+    if (!http_request("POST", config_.api_url + "/api/rooms/" + config_.room + "/join",
+                      join.dump(), resp) || resp.status != 200) {
+        std::cerr << tag << "Join failed (HTTP " << resp.status << "): " << resp.body << "\n";
+        return false;
+    }
+    nlohmann::json joined = nlohmann::json::parse(resp.body, nullptr, false);
+    if (joined.is_discarded()) {
+        std::cerr << tag << "Join response is not JSON\n";
+        return false;
+    }
+    participant_id_ = joined.value("participant_id", "");
+    std::string ws_url = config_.ws_url.empty() ? joined.value("ws_url", "") : config_.ws_url;
+
+    try {
+        // 2. Signaling socket. Dev and load-test servers use self-signed certs.
+        rtc::WebSocket::Configuration ws_config;
+        ws_config.disableTlsVerification = true;
+        ws_ = std::make_shared<rtc::WebSocket>(ws_config);
+        ws_->onOpen([this] {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ws_open_ = true;
+            cv_.notify_all();
+        });
+        ws_->onError([this, tag](std::string error) {
+            std::cerr << tag << "Signaling error: " << error << "\n";
+            std::lock_guard<std::mutex> lock(mutex_);
+            failed_ = true;
+            cv_.notify_all();
+        });
+        ws_->onMessage([this](auto data) {
+            if (auto* text = std::get_if<std::string>(&data)) on_signaling(*text);
+        });
+        ws_->open(ws_url);
+        if (!wait_for([this] { return ws_open_; }, timeout_ms)) {
+            std::cerr << tag << "Signaling socket did not open: " << ws_url << "\n";
+            return false;
+        }
+
+        // 3. Peer connection with the browser client's channels. No STUN:
+        // load runs where host candidates reach the server.
+        pc_ = std::make_shared<rtc::PeerConnection>(rtc::Configuration{});
+        pc_->onLocalDescription([this](rtc::Description desc) {
+            ws_->send(nlohmann::json{{"type", "offer"}, {"sdp", std::string(desc)}}.dump());
+        });
+        pc_->onLocalCandidate([this](rtc::Candidate candidate) {
+            ws_->send(nlohmann::json{{"type", "ice_candidate"},
+                                     {"candidate", std::string(candidate)},
+                                     {"mid", candidate.mid()}}.dump());
+        });
+
+        auto channel_open = [this] {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++channels_open_;
+            cv_.notify_all();
+        };
+        rtc::DataChannelInit audio_init;
+        audio_init.reliability.unordered = true;
+        audio_init.reliability.maxRetransmits = 0;
+        audio_dc_ = pc_->createDataChannel("audio", audio_init);
+        audio_dc_->onOpen(channel_open);
+        audio_dc_->onMessage([this](auto data) {
+            if (auto* binary = std::get_if<rtc::binary>(&data)) {
+                on_audio(reinterpret_cast<const uint8_t*>(binary->data()), binary->size());
+            }
+        });
+        control_dc_ = pc_->createDataChannel("control");
+        control_dc_->onOpen(channel_open);
+        control_dc_->onMessage([this](auto data) {
+            if (auto* text = std::get_if<std::string>(&data)) on_control(*text);
+        });
+        if (!wait_for([this] { return channels_open_ == 2; }, timeout_ms)) {
+            std::cerr << tag << "DataChannels did not open\n";
+            return false;
+        }
+
+        // 4. Bind the session to the participant
+        control_dc_->send(nlohmann::json{{"type", "bind"},
+                                         {"participant_id", participant_id_},
+                                         {"room", config_.room}}.dump());
+        if (!wait_for([this] { return bound_; }, timeout_ms)) {
+            std::cerr << tag << "Bind was not accepted\n";
+            return false;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << tag << "Connect error: " << e.what() << "\n";
+        return false;
+    }
+    return true;
+}
+
+void LoadClient::on_signaling(const std::string& message) {
+    nlohmann::json msg = nlohmann::json::parse(message, nullptr, false);
+    if (msg.is_discarded()) return;
+    std::string type = msg.value("type", "");
+    try {
+        if (type == "answer") {
+            pc_->setRemoteDescription(
+                rtc::Description(msg.value("sdp", ""), rtc::Description::Type::Answer));
+        } else if (type == "ice_candidate") {
+            pc_->addRemoteCandidate(
+                rtc::Candidate(msg.value("candidate", ""), msg.value("mid", "")));
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "[" << config_.room << "/" << config_.alias << "] Bad " << type
+                  << ": " << e.what() << "\n";
+    }
+}
+
+void LoadClient::on_control(const std::string& message) {
+    nlohmann::json msg = nlohmann::json::parse(message, nullptr, false);
+    if (msg.is_discarded() || msg.value("type", "") != "bound") return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    bound_ = true;
+    cv_.notify_all();
+}
+
+void LoadClient::send_frame(uint32_t sequence) {
+    if (!audio_dc_ || !audio_dc_->isOpen()) return;
+
+    AudioPacket pkt{};
+    pkt.sequence = sequence;
+    pkt.timestamp = sequence * kSamplesPerFrame;
+    pkt.channels = 1;
+    const bool click = config_.prober && sequence % ToneSignal::kClickEvery == 0;
+    ToneSignal::fill(pkt.samples, click);
+
+    uint8_t buf[kAudioPacketSize];
+    pkt.serialize(buf);
+    if (click) probe_->last_click_ns.store(steady_ns(), std::memory_order_release);
+    try {
+        audio_dc_->send(reinterpret_cast<const std::byte*>(buf), sizeof(buf));
+        stats_.on_sent();
+    } catch (const std::exception&) {
+        // Closed under us; the report shows the shortfall
+    }
+}
+
+void LoadClient::on_audio(const uint8_t* data, size_t len) {
+    if (len < kAudioHeaderSize) return;
+    const int64_t now = steady_ns();
+    uint32_t sequence;
+    std::memcpy(&sequence, data, sizeof(sequence));
+    const bool marker = len == kAudioHeaderSize;
+    stats_.on_packet(sequence, now, marker);
+    if (marker || len < kAudioPacketSize) return;
+
+    AudioPacket pkt = AudioPacket::deserialize(data, len);
+    if (!ToneSignal::has_click(pkt.samples, kSamplesPerFrame)) return;
+    if (now - last_click_heard_ns_ < kClickGuardNs) return;
+    last_click_heard_ns_ = now;
+
+    const int64_t sent = probe_->last_click_ns.load(std::memory_order_acquire);
+    if (sent != 0 && now - sent < kClickStaleNs) stats_.on_transit(now - sent);
+}
+
+void LoadClient::close() {
+    try {
+        if (audio_dc_) audio_dc_->close();
+        if (control_dc_) control_dc_->close();
+        if (pc_) pc_->close();
+        if (ws_) ws_->close();
+    } catch (const std::exception&) {
+    }
+    audio_dc_.reset();
+    control_dc_.reset();
+    pc_.reset();
+    ws_.reset();
+
+    if (!participant_id_.empty()) {
+        HttpClientResponse resp;
+        http_request("POST", config_.api_url + "/api/rooms/" + config_.room + "/leave",
+                     nlohmann::json{{"participant_id", participant_id_}}.dump(), resp);
+        participant_id_.clear();
+    }
+}
+
+} // namespace tutti::loadgen
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "load_stats.h"
+
+// Forward declarations for libdatachannel
+namespace rtc {
+class PeerConnection;
+class DataChannel;
+class WebSocket;
+} // namespace rtc
+
+namespace tutti::loadgen {
+
+/// Click bookkeeping shared by the clients in one room: the prober stamps
+/// each click it sends, the others time how long until they hear it
+struct RoomProbe {
+    std::atomic<int64_t> last_click_ns{0};
+};
+
+/// One synthetic participant over WebRTC: joins through the HTTP API,
+/// negotiates a peer connection with the WebSocket signaling server like
+/// the browser client does, binds, then streams the test tone.
+class LoadClient {
+public:
+    struct Config {
+        std::string api_url;   // e.g. http://127.0.0.1:8080
+        std::string ws_url;    // signaling; empty = the join response's ws_url
+        std::string room;
+        std::string alias;
+        bool prober = false;   // sends the room's clicks
+    };
+
+    LoadClient(Config config, std::shared_ptr<RoomProbe> probe);
+    ~LoadClient();
+
+    LoadClient(const LoadClient&) = delete;
+    LoadClient& operator=(const LoadClient&) = delete;
+
+    /// Join, connect and bind. Blocks up to `timeout_ms`; false (with the
+    /// reason logged) if any step fails.
+    bool connect(int timeout_ms);
+
+    /// Send frame `sequence` of the test signal. Called from the pacing thread.
+    void send_frame(uint32_t sequence);
+
+    /// Close the transport and leave the room
+    void close();
+
+    const std::string& room() const { return config_.room; }
+    StreamReport report() const { return stats_.report(); }
+
+private:
+    void on_signaling(const std::string& message);
+    void on_control(const std::string& message);
+    void on_audio(const uint8_t* data, size_t len);
+
+    /// Wait until `done` or the deadline; false on timeout
+    template <typename Pred>
+    bool wait_for(Pred done, int timeout_ms);
+
+    Config config_;
+    std::shared_ptr<RoomProbe> probe_;
+    std::string participant_id_;
+
+    std::shared_ptr<rtc::WebSocket> ws_;
+    std::shared_ptr<rtc::PeerConnection> pc_;
+    std::shared_ptr<rtc::DataChannel> audio_dc_;   // unreliable, unordered
+    std::shared_ptr<rtc::DataChannel> control_dc_; // reliable, ordered
+
+    // Connection progress, signalled from libdatachannel's threads
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool ws_open_ = false;
+    int channels_open_ = 0;
+    bool bound_ = false;
+    bool failed_ = false;
+
+    StreamStats stats_;
+    int64_t last_click_heard_ns_ = 0;  // audio thread only
+};
+
+} // namespace tutti::loadgen
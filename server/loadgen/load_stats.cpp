@@ -0,0 +1,83 @@
+#include "load_stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include "transport/transport_interface.h"
+
+namespace tutti::loadgen {
+
+void Distribution::add(int64_t ns) {
+    samples_us.push_back(static_cast<uint32_t>(std::max<int64_t>(ns, 0) / 1000));
+}
+
+void Distribution::merge(const Distribution& other) {
+    samples_us.insert(samples_us.end(), other.samples_us.begin(), other.samples_us.end());
+}
+
+uint32_t Distribution::quantile_us(double q) {
+    if (samples_us.empty()) return 0;
+    size_t rank = static_cast<size_t>(q * static_cast<double>(samples_us.size() - 1));
+    std::nth_element(samples_us.begin(), samples_us.begin() + rank, samples_us.end());
+    return samples_us[rank];
+}
+
+uint32_t Distribution::max_us() const {
+    return samples_us.empty() ? 0 : *std::max_element(samples_us.begin(), samples_us.end());
+}
+
+void StreamStats::on_packet(uint32_t sequence, int64_t now_ns, bool marker) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++report_.received;
+    if (marker) ++report_.markers;
+    if (!started_) {
+        started_ = true;
+        highest_ = sequence;
+        last_arrival_ns_ = now_ns;
+        return;
+    }
+
+    // Signed distance copes with wrap-around
+    int32_t ahead = static_cast<int32_t>(sequence - highest_);
+    if (ahead <= 0) {
+        // Late: it was counted as lost when the gap opened
+        ++report_.reordered;
+        if (report_.lost > 0) --report_.lost;
+        return;
+    }
+    report_.lost += static_cast<uint64_t>(ahead - 1);
+    highest_ = sequence;
+    report_.jitter.add(std::llabs(now_ns - last_arrival_ns_ - kFramePeriodNs));
+    last_arrival_ns_ = now_ns;
+}
+
+void StreamStats::on_transit(int64_t ns) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    report_.transit.add(ns);
+}
+
+StreamReport StreamStats::report() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return report_;
+}
+
+void ToneSignal::fill(int16_t* samples, bool click) {
+    // 375Hz: exactly one cycle per frame, so every client's tone is in
+    // phase and a sum of them stays predictable
+    constexpr double kTwoPi = 6.283185307179586;
+    for (size_t i = 0; i < kSamplesPerFrame; ++i) {
+        samples[i] = static_cast<int16_t>(
+            kToneLevel * std::sin(kTwoPi * static_cast<double>(i) / kSamplesPerFrame));
+    }
+    if (click) samples[0] = kClickLevel;
+}
+
+bool ToneSignal::has_click(const int16_t* samples, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        if (samples[i] >= kClickThreshold) return true;
+    }
+    return false;
+}
+
+} // namespace tutti::loadgen
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace tutti::loadgen {
+
+/// Nanoseconds between frames at 48kHz / 128 samples (375 pps)
+constexpr int64_t kFramePeriodNs = 2'666'667;
+
+/// Steady-clock nanoseconds, shared by every client in the process
+inline int64_t steady_ns() {
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+}
+
+/// Exact percentiles over recorded samples (microseconds)
+struct Distribution {
+    std::vector<uint32_t> samples_us;
+
+    void add(int64_t ns);
+    void merge(const Distribution& other);
+
+    /// Value at quantile `q` (0..1), 0 if empty. Sorts in place.
+    uint32_t quantile_us(double q);
+    uint32_t max_us() const;
+};
+
+/// What one load client saw of the mixes sent back to it
+struct StreamReport {
+    uint64_t sent = 0;
+    uint64_t received = 0;
+    uint64_t lost = 0;        // sequence gaps not later filled
+    uint64_t reordered = 0;   // arrived below the highest sequence seen
+    uint64_t markers = 0;     // header-only silence markers among `received`
+    Distribution transit;     // click sent by the room's prober until heard
+    Distribution jitter;      // |inter-arrival - kFramePeriodNs|
+};
+
+/// Receive-side accounting for one client. Packets arrive on the
+/// transport's threads; report() may be called from any thread.
+class StreamStats {
+public:
+    /// An incoming datagram: output sequence and receive time
+    void on_packet(uint32_t sequence, int64_t now_ns, bool marker);
+
+    /// A transit measurement (prober's click heard `ns` after it was sent)
+    void on_transit(int64_t ns);
+
+    void on_sent() { std::lock_guard<std::mutex> lock(mutex_); ++report_.sent; }
+
+    StreamReport report() const;
+
+private:
+    mutable std::mutex mutex_;
+    StreamReport report_;
+    bool started_ = false;
+    uint32_t highest_ = 0;
+    int64_t last_arrival_ns_ = 0;
+};
+
+/// Test signal: a low sine every client sends, with a loud one-sample
+/// click from the room's prober once a second. The tone holds the silence
+/// gate open; the click survives any mix of up to 16 tones.
+struct ToneSignal {
+    static constexpr int16_t kToneLevel = 500;
+    static constexpr int16_t kClickLevel = 20000;
+    static constexpr int16_t kClickThreshold = 10000;
+    static constexpr uint32_t kClickEvery = 375;  // frames
+
+    /// Fill one mono frame; `click` puts the click at sample 0
+    static void fill(int16_t* samples, bool click);
+
+    /// True if a received frame holds a click
+    static bool has_click(const int16_t* samples, size_t count);
+};
+
+} // namespace tutti::loadgen
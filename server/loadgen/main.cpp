@@ -0,0 +1,187 @@
+#include <atomic>
+#include <csignal>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "load_client.h"
+#include "signaling/http_client.h"
+
+namespace {
+std::atomic<bool> g_stop{false};
+
+void signal_handler(int) { g_stop = true; }
+
+void usage() {
+    std::cout << "Usage: tutti-loadgen [options]\n"
+              << "  --api URL              HTTP API (default http://127.0.0.1:8080)\n"
+              << "  --ws URL               signaling WebSocket (default: the join response's ws_url)\n"
+              << "  --rooms N              rooms to fill (default 16)\n"
+              << "  --per-room N           clients per room (default 4)\n"
+              << "  --duration SECONDS     streaming time (default 30)\n"
+              << "  --connect-timeout MS   per-client connect timeout (default 5000)\n";
+}
+
+double ms(uint32_t us) { return us / 1000.0; }
+
+/// One report row: loss, reordering, click transit and inter-arrival jitter
+void print_row(const std::string& label, size_t clients, tutti::loadgen::StreamReport& r) {
+    const uint64_t expected = r.received + r.lost;
+    const double loss = expected ? 100.0 * static_cast<double>(r.lost) / expected : 0.0;
+    std::cout << std::left << std::setw(14) << label << std::right
+              << std::setw(4) << clients
+              << std::setw(10) << r.sent
+              << std::setw(10) << r.received
+              << std::setw(8) << std::fixed << std::setprecision(2) << loss
+              << std::setw(7) << r.reordered
+              << std::setw(9) << ms(r.transit.quantile_us(0.5))
+              << std::setw(9) << ms(r.transit.quantile_us(0.99))
+              << std::setw(9) << ms(r.jitter.quantile_us(0.5))
+              << std::setw(9) << ms(r.jitter.quantile_us(0.99))
+              << std::setw(9) << ms(r.jitter.quantile_us(0.999))
+              << std::setw(9) << ms(r.jitter.max_us()) << "\n";
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string api_url = "http://127.0.0.1:8080";
+    std::string ws_url;
+    size_t room_count = 16;
+    size_t per_room = 4;
+    int duration_s = 30;
+    int connect_timeout_ms = 5000;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--api" && i + 1 < argc) {
+            api_url = argv[++i];
+        } else if (arg == "--ws" && i + 1 < argc) {
+            ws_url = argv[++i];
+        } else if (arg == "--rooms" && i + 1 < argc) {
+            room_count = static_cast<size_t>(std::stoi(argv[++i]));
+        } else if (arg == "--per-room" && i + 1 < argc) {
+            per_room = static_cast<size_t>(std::stoi(argv[++i]));
+        } else if (arg == "--duration" && i + 1 < argc) {
+            duration_s = std::stoi(argv[++i]);
+        } else if (arg == "--connect-timeout" && i + 1 < argc) {
+            connect_timeout_ms = std::stoi(argv[++i]);
+        } else if (arg == "--help" || arg == "-h") {
+            usage();
+            return 0;
+        } else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            usage();
+            return 1;
+        }
+    }
+
+    std::signal(SIGINT, signal_handler);
+    std::signal(SIGTERM, signal_handler);
+
+    // Rooms with room for a full set of clients, in lobby order
+    tutti::HttpClientResponse resp;
+    if (!tutti::http_request("GET", api_url + "/api/rooms", "", resp) || resp.status != 200) {
+        std::cerr << "[Loadgen] Cannot list rooms at " << api_url << "\n";
+        return 1;
+    }
+    nlohmann::json listing = nlohmann::json::parse(resp.body, nullptr, false);
+    if (listing.is_discarded()) {
+        std::cerr << "[Loadgen] Room list is not JSON\n";
+        return 1;
+    }
+    std::vector<std::string> rooms;
+    const nlohmann::json listed = listing.value("rooms", nlohmann::json::array());
+    for (const auto& r : listed) {
+        size_t max = r.value("max_participants", size_t{0});
+        size_t count = r.value("participant_count", size_t{0});
+        size_t free = max > count ? max - count : 0;
+        if (rooms.size() < room_count && free >= per_room) rooms.push_back(r.value("name", ""));
+    }
+    if (rooms.size() < room_count) {
+        std::cerr << "[Loadgen] Only " << rooms.size() << " rooms have " << per_room
+                  << " free places\n";
+    }
+
+    // Connect every client; the first in each room sends its clicks
+    std::vector<std::unique_ptr<tutti::loadgen::LoadClient>> clients;
+    for (const auto& room : rooms) {
+        auto probe = std::make_shared<tutti::loadgen::RoomProbe>();
+        for (size_t i = 0; i < per_room && !g_stop; ++i) {
+            tutti::loadgen::LoadClient::Config config{
+                api_url, ws_url, room, "load-" + std::to_string(i), i == 0};
+            auto client = std::make_unique<tutti::loadgen::LoadClient>(std::move(config), probe);
+            if (client->connect(connect_timeout_ms)) {
+                clients.push_back(std::move(client));
+            }
+        }
+    }
+    std::cout << "[Loadgen] " << clients.size() << " of " << rooms.size() * per_room
+              << " clients connected across " << rooms.size() << " rooms\n";
+    if (clients.empty()) return 1;
+
+    // Pace every client's frames off one absolute clock, 375 per second
+    const auto period = std::chrono::nanoseconds(tutti::loadgen::kFramePeriodNs);
+    const auto start = std::chrono::steady_clock::now();
+    const auto end = start + std::chrono::seconds(duration_s);
+    auto next = start;
+    auto next_progress = start + std::chrono::seconds(5);
+    uint64_t late = 0;
+    for (uint32_t seq = 0; !g_stop && next < end; ++seq) {
+        for (auto& client : clients) client->send_frame(seq);
+        next += period;
+        auto now = std::chrono::steady_clock::now();
+        if (now > next) ++late;  // a send round overran its frame
+        std::this_thread::sleep_until(next);
+
+        if (now >= next_progress) {
+            uint64_t received = 0, lost = 0;
+            for (auto& client : clients) {
+                auto r = client->report();
+                received += r.received;
+                lost += r.lost;
+            }
+            std::cout << "[Loadgen] "
+                      << std::chrono::duration_cast<std::chrono::seconds>(now - start).count()
+                      << "s: " << received << " mixes received, " << lost << " lost\n";
+            next_progress += std::chrono::seconds(5);
+        }
+    }
+
+    // Collect before closing: leaving tears the rooms down
+    std::map<std::string, std::pair<size_t, tutti::loadgen::StreamReport>> by_room;
+    std::pair<size_t, tutti::loadgen::StreamReport> total{};
+    for (auto& client : clients) {
+        auto r = client->report();
+        auto& room = by_room[client->room()];
+        for (auto* agg : {&room, &total}) {
+            ++agg->first;
+            agg->second.sent += r.sent;
+            agg->second.received += r.received;
+            agg->second.lost += r.lost;
+            agg->second.reordered += r.reordered;
+            agg->second.markers += r.markers;
+            agg->second.transit.merge(r.transit);
+            agg->second.jitter.merge(r.jitter);
+        }
+    }
+    for (auto& client : clients) client->close();
+
+    std::cout << "\n" << std::left << std::setw(14) << "room" << std::right
+              << std::setw(4) << "n" << std::setw(10) << "sent" << std::setw(10) << "recv"
+              << std::setw(8) << "loss%" << std::setw(7) << "reord"
+              << std::setw(9) << "tr p50" << std::setw(9) << "tr p99"
+              << std::setw(9) << "jit p50" << std::setw(9) << "jit p99"
+              << std::setw(9) << "p99.9" << std::setw(9) << "max" << "\n";
+    for (auto& [name, room] : by_room) print_row(name, room.first, room.second);
+    print_row("total", total.first, total.second);
+    std::cout << "(times in ms; transit: prober's click until heard by the others; "
+              << "jitter: |inter-arrival - 2.667ms| of the returned mixes)\n";
+    if (late) std::cout << "[Loadgen] " << late << " send rounds overran their frame\n";
+    return 0;
+}
@@ -0,0 +1,73 @@
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "audio/capture_replay.h"
+#include "audio/room.h"
+
+namespace {
+void usage() {
+    std::cout << "Usage: tutti-replay [options] CAPTURE\n"
+              << "  --speed X              1 real time, 2 twice as fast, 0 flat out (default 0)\n"
+              << "  --repeat N             replay N times into fresh rooms (default 1)\n"
+              << "  --no-silence-markers   send silent listeners full zero frames\n";
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string path;
+    double speed = 0.0;
+    int repeat = 1;
+    bool silence_markers = true;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--speed" && i + 1 < argc) {
+            speed = std::stod(argv[++i]);
+        } else if (arg == "--repeat" && i + 1 < argc) {
+            repeat = std::stoi(argv[++i]);
+        } else if (arg == "--no-silence-markers") {
+            silence_markers = false;
+        } else if (arg == "--help" || arg == "-h") {
+            usage();
+            return 0;
+        } else if (path.empty() && arg[0] != '-') {
+            path = arg;
+        } else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            usage();
+            return 1;
+        }
+    }
+    if (path.empty()) {
+        usage();
+        return 1;
+    }
+
+    tutti::CaptureFile capture;
+    if (!capture.load(path)) {
+        std::cerr << "[Replay] Not a capture file: " << path << "\n";
+        return 1;
+    }
+    std::cout << "[Replay] Room " << capture.room << ": " << capture.events.size()
+              << " events over "
+              << (capture.events.empty() ? 0.0 : capture.events.back().t_ns / 1e9) << "s\n";
+
+    for (int run = 0; run < repeat; ++run) {
+        tutti::Room room(capture.room, capture.max_participants);
+        room.set_silence_markers(silence_markers);
+        tutti::CaptureReplay replay(capture, room, speed);
+        tutti::CaptureReplay::Result r = replay.run();
+
+        uint64_t sent = 0;
+        for (uint32_t slot = 0; slot < tutti::Mixer::kMaxSlots; ++slot) {
+            if (auto session = replay.session(slot)) sent += session->sent();
+        }
+        const double per_cycle_us = r.cycles ? r.elapsed_ns / 1e3 / r.cycles : 0.0;
+        std::cout << "[Replay] run " << run + 1 << ": " << r.datagrams << " datagrams in, "
+                  << sent << " out, " << r.cycles << " cycles, " << r.control << " control, "
+                  << r.skipped << " skipped; " << std::fixed << std::setprecision(1)
+                  << r.elapsed_ns / 1e6 << " ms (" << per_cycle_us << " us/cycle)\n";
+    }
+    return 0;
+}
@@ -0,0 +1,180 @@
+#include "capture_replay.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <thread>
+
+namespace tutti {
+
+namespace {
+
+template <typename T>
+T read_at(const uint8_t* p) {
+    T v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+} // namespace
+
+bool CaptureFile::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    constexpr size_t kHeaderSize = 20;
+    if (bytes.size() < kHeaderSize ||
+        std::memcmp(bytes.data(), kCaptureMagic, sizeof(kCaptureMagic)) != 0 ||
+        read_at<uint32_t>(bytes.data() + 8) != kCaptureVersion) {
+        return false;
+    }
+    max_participants = read_at<uint32_t>(bytes.data() + 12);
+    uint32_t name_len = read_at<uint32_t>(bytes.data() + 16);
+    if (bytes.size() < kHeaderSize + name_len) return false;
+    room.assign(reinterpret_cast<const char*>(bytes.data() + kHeaderSize), name_len);
+
+    events.clear();
+    payload.clear();
+    size_t pos = kHeaderSize + name_len;
+    while (pos + kCaptureRecordHeaderSize <= bytes.size()) {
+        const uint8_t* rec = bytes.data() + pos;
+        uint16_t len = read_at<uint16_t>(rec + 12);
+        if (pos + kCaptureRecordHeaderSize + len > bytes.size()) break;
+        add(read_at<int64_t>(rec), static_cast<CaptureEvent>(rec[8]), read_at<uint16_t>(rec + 10),
+            rec + kCaptureRecordHeaderSize, len);
+        pos += kCaptureRecordHeaderSize + len;
+    }
+
+    // Records are written in queue order; threads stamp them just before
+    // queueing, so neighbours can be slightly out of time order
+    std::stable_sort(events.begin(), events.end(),
+                     [](const Event& a, const Event& b) { return a.t_ns < b.t_ns; });
+    return true;
+}
+
+void CaptureFile::add(int64_t t_ns, CaptureEvent kind, uint32_t slot,
+                      const uint8_t* data, size_t len) {
+    len = std::min(len, CaptureRecord::kMaxPayload);
+    events.push_back({t_ns, kind, static_cast<uint16_t>(slot),
+                      static_cast<uint32_t>(payload.size()), static_cast<uint16_t>(len)});
+    if (len) payload.insert(payload.end(), data, data + len);
+}
+
+bool ReplaySession::send_datagram(const uint8_t* data, size_t len) {
+    sent_.fetch_add(1, std::memory_order_relaxed);
+    if (keep_) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        datagrams_.emplace_back(data, data + len);
+    }
+    return true;
+}
+
+std::vector<std::vector<uint8_t>> ReplaySession::datagrams() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return datagrams_;
+}
+
+CaptureReplay::CaptureReplay(const CaptureFile& capture, Room& room, double speed,
+                             bool keep_output)
+    : capture_(capture), room_(room), speed_(speed), keep_output_(keep_output),
+      slots_(Mixer::kMaxSlots) {}
+
+const std::string& CaptureReplay::id_of(uint32_t slot) const {
+    static const std::string kNone;
+    return slot < slots_.size() ? slots_[slot].id : kNone;
+}
+
+std::shared_ptr<ReplaySession> CaptureReplay::session(uint32_t slot) const {
+    return slot < slots_.size() ? slots_[slot].session : nullptr;
+}
+
+CaptureReplay::Result CaptureReplay::run() {
+    Result result;
+    const auto start = std::chrono::steady_clock::now();
+
+    for (const auto& e : capture_.events) {
+        if (speed_ > 0.0) {
+            std::this_thread::sleep_until(
+                start + std::chrono::nanoseconds(static_cast<int64_t>(e.t_ns / speed_)));
+        }
+        const uint8_t* data = capture_.data(e);
+        if (e.kind == CaptureEvent::MixCycle) {
+            room_.process_cycle();
+            ++result.cycles;
+            continue;
+        }
+        if (e.slot >= slots_.size()) {
+            ++result.skipped;
+            continue;
+        }
+        Replayed& r = slots_[e.slot];
+
+        switch (e.kind) {
+            case CaptureEvent::Datagram: {
+                // Copied like a receive buffer: aligned, as the transports deliver it
+                alignas(8) uint8_t buf[CaptureRecord::kMaxPayload];
+                std::memcpy(buf, data, e.len);
+                if (!r.slot.valid()) {
+                    ++result.skipped;
+                    break;
+                }
+                room_.on_audio_received(r.slot, buf, e.len);
+                ++result.datagrams;
+                break;
+            }
+            case CaptureEvent::Join: {
+                if (e.len < 1) break;
+                r.id.assign(reinterpret_cast<const char*>(data + 1), e.len - 1);
+                room_.add_participant(r.id, r.id, nullptr, data[0] != 0);
+                r.slot = room_.slot_of(r.id);
+                r.session.reset();
+                ++result.control;
+                break;
+            }
+            case CaptureEvent::Bind: {
+                if (e.len < 2 || r.id.empty()) break;
+                r.session = std::make_shared<ReplaySession>(r.id, keep_output_);
+                room_.attach_session(r.id, r.session, &r.slot,
+                                     static_cast<AudioCodec>(data[0]), data[1]);
+                ++result.control;
+                break;
+            }
+            case CaptureEvent::Leave:
+                if (r.id.empty()) break;
+                room_.remove_participant(r.id);
+                r.slot = {};
+                ++result.control;
+                break;
+            case CaptureEvent::Gain:
+            case CaptureEvent::Pan:
+            case CaptureEvent::Mute: {
+                if (e.len < 3 || r.id.empty()) break;
+                const std::string& source = id_of(read_at<uint16_t>(data));
+                if (source.empty()) break;
+                if (e.kind == CaptureEvent::Mute) {
+                    room_.set_mute(r.id, source, data[2] != 0);
+                } else if (e.len >= 6) {
+                    float value = read_at<float>(data + 2);
+                    if (e.kind == CaptureEvent::Gain) {
+                        room_.set_gain(r.id, source, value);
+                    } else {
+                        room_.set_pan(r.id, source, value);
+                    }
+                }
+                ++result.control;
+                break;
+            }
+            case CaptureEvent::MixCycle:
+                break;
+        }
+    }
+
+    result.elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+} // namespace tutti
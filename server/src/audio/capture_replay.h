@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "room.h"
+#include "telemetry/packet_capture.h"
+
+namespace tutti {
+
+/// A capture file (see PacketCapture) read back into memory
+struct CaptureFile {
+    struct Event {
+        int64_t t_ns = 0;
+        CaptureEvent kind = CaptureEvent::Datagram;
+        uint16_t slot = 0;
+        uint32_t offset = 0;  // into payload
+        uint16_t len = 0;
+    };
+
+    std::string room;
+    size_t max_participants = 4;
+    std::vector<Event> events;     // in time order
+    std::vector<uint8_t> payload;
+
+    /// Read `path`. False if it isn't a capture file; a record cut short
+    /// (capture still running, or the server died) ends the read.
+    bool load(const std::string& path);
+
+    /// Append an event, for building captures in code (tests, benchmarks)
+    void add(int64_t t_ns, CaptureEvent kind, uint32_t slot,
+             const uint8_t* data = nullptr, size_t len = 0);
+
+    const uint8_t* data(const Event& e) const { return payload.data() + e.offset; }
+};
+
+/// Stand-in transport session for replayed participants: counts what the
+/// room sends and keeps the datagrams if asked to
+class ReplaySession : public TransportSession {
+public:
+    ReplaySession(std::string id, bool keep) : id_(std::move(id)), keep_(keep) {}
+
+    bool send_datagram(const uint8_t* data, size_t len) override;
+    bool send_reliable(const std::string&) override { return true; }
+    void close() override {}
+    std::string id() const override { return id_; }
+    std::string remote_address() const override { return "replay"; }
+    bool is_connected() const override { return true; }
+    const char* transport_name() const override { return "replay"; }
+
+    uint64_t sent() const { return sent_.load(std::memory_order_relaxed); }
+    std::vector<std::vector<uint8_t>> datagrams() const;
+
+private:
+    std::string id_;
+    bool keep_;
+    std::atomic<uint64_t> sent_{0};
+    mutable std::mutex mutex_;
+    std::vector<std::vector<uint8_t>> datagrams_;
+};
+
+/// Feeds a capture back through a room: joins, binds, gain changes and
+/// leaves through the room's control API, datagrams into
+/// on_audio_received() and mix cycles into process_cycle(), in recorded
+/// order and from the calling thread, so a replay is deterministic.
+class CaptureReplay {
+public:
+    /// `speed` 1 replays in real time, 2 twice as fast, 0 as fast as possible.
+    /// `keep_output` keeps every datagram the room sends, per participant.
+    CaptureReplay(const CaptureFile& capture, Room& room, double speed = 1.0,
+                  bool keep_output = false);
+
+    struct Result {
+        uint64_t datagrams = 0;  // fed to on_audio_received
+        uint64_t cycles = 0;     // mix cycles run
+        uint64_t control = 0;    // joins, binds, leaves, gain changes
+        uint64_t skipped = 0;    // events for slots nobody holds
+        int64_t elapsed_ns = 0;
+    };
+    Result run();
+
+    /// Session standing in for the participant recorded in `slot` (null if none)
+    std::shared_ptr<ReplaySession> session(uint32_t slot) const;
+
+private:
+    /// Participant id recorded in `slot`, empty if none
+    const std::string& id_of(uint32_t slot) const;
+
+    const CaptureFile& capture_;
+    Room& room_;
+    double speed_;
+    bool keep_output_;
+
+    struct Replayed {
+        std::string id;
+        ParticipantSlot slot;
+        std::shared_ptr<ReplaySession> session;
+    };
+    std::vector<Replayed> slots_;  // by recorded slot index
+};
+
+} // namespace tutti
@@ -0,0 +1,506 @@
+#include "jitter_buffer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace tutti {
+
+namespace {
+// A sequence this far from playout is a restart (new stream, client
+// reload), not jitter: re-anchor instead of dropping it as late/overflow.
+constexpr uint32_t kDiscontinuity = JitterBuffer::kCapacity * 4;
+
+// Target depth covers this many multiples of the jitter estimate.
+// Keeps the target at 0 while jitter stays under half a frame (~1.3ms).
+constexpr double kJitterMargin = 2.0;
+
+// Trim one frame per cycle once depth exceeds target by more than this
+constexpr uint32_t kTrimSlack = 2;
+
+// Skew is the slope of the minimum transit time from window to window:
+// the minimum is the packets that queued least, so jitter mostly drops out
+constexpr int64_t kSkewWindowNs = 2000000000LL;
+// A gap in arrivals this long (sender paused) starts the windows afresh
+constexpr int64_t kSkewGapNs = 250000000LL;
+// Once seeded, each window moves the estimate 1/8 of the way, and by at
+// most this much (a route change shifts transit; it isn't drift)
+constexpr double kSkewSmoothing = 8.0;
+constexpr double kSkewStepPpm = 500.0;
+
+// Past the skew: slip (or insert) this much more per frame that depth,
+// smoothed over ~0.7s, sits above target + 2 (or below target + 1)
+constexpr double kFillGainPpm = 200.0;
+constexpr double kFillSmoothing = 256.0;
+// Smoothed depth past target that counts as a frame ahead
+constexpr double kAheadFill = 1.75;
+
+int64_t steady_now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/// Resample `need` sample frames of `in` onto one frame of `out`, linearly,
+/// in 16.16 fixed point. `in` holds `have` (>= need): any sample past
+/// `need` is interpolated toward at the end, for continuity.
+template <size_t Channels>
+void stretch(const int16_t* in, uint32_t need, uint32_t have, int16_t* out) {
+    const uint32_t step = (need << 16) / kSamplesPerFrame;
+    const uint32_t last = have - 1;
+    uint32_t x = 0;
+    for (size_t s = 0; s < kSamplesPerFrame; ++s, x += step) {
+        const uint32_t i0 = x >> 16;
+        const uint32_t i1 = std::min(i0 + 1, last);
+        const int32_t frac = static_cast<int32_t>((x & 0xffff) >> 1);  // 15 bits: no overflow
+        for (size_t c = 0; c < Channels; ++c) {
+            const int32_t a = in[i0 * Channels + c];
+            const int32_t b = in[i1 * Channels + c];
+            out[s * Channels + c] = static_cast<int16_t>(a + (((b - a) * frac + 0x4000) >> 15));
+        }
+    }
+}
+} // namespace
+
+JitterBuffer::JitterBuffer() : last_frame_(&frames_[kCapacity]) {
+    for (uint32_t i = 0; i < kCapacity; ++i) cells_[i].frame = &frames_[i];
+}
+
+// ── Producer (network thread) ───────────────────────────────────────────────
+
+bool JitterBuffer::push(const AudioFrame& frame) {
+    return push(frame, steady_now_ns());
+}
+
+bool JitterBuffer::push(const AudioFrame& frame, int64_t arrival_ns) {
+    AudioFrame* dst = claim(frame.sequence, frame.timestamp, arrival_ns);
+    if (!dst) return false;
+    *dst = frame;
+    commit(frame.sequence);
+    return true;
+}
+
+bool JitterBuffer::push_datagram(const uint8_t* data, uint8_t channels, bool silent) {
+    uint32_t seq, timestamp;
+    std::memcpy(&seq, data, sizeof(seq));
+    std::memcpy(&timestamp, data + 4, sizeof(timestamp));
+    AudioFrame* dst = claim(seq, timestamp, steady_now_ns());
+    if (!dst) return false;
+
+    dst->sequence = seq;
+    dst->timestamp = timestamp;
+    dst->channels = channels;
+    dst->silent = silent;
+    dst->room_total = false;
+    if (silent) {
+        std::fill_n(dst->samples.begin(), dst->sample_count(), int16_t{0});
+    } else {
+        std::memcpy(dst->samples.data(), data + kAudioHeaderSize, kAudioPayloadSize * channels);
+    }
+    commit(seq);
+    return true;
+}
+
+AudioFrame* JitterBuffer::claim(uint32_t seq, uint32_t timestamp, int64_t arrival_ns) {
+    uint32_t epoch = reset_epoch_.load(std::memory_order_acquire);
+    if (epoch != seen_epoch_) {
+        // Consumer reset (slot handover or park): start estimation afresh
+        seen_epoch_ = epoch;
+        have_last_ = false;
+        jitter_samples_ = 0.0;
+        target_depth_.store(0, std::memory_order_relaxed);
+        slopes_ = 0;
+        skew_ready_.store(false, std::memory_order_relaxed);
+        skew_ppm_.store(0.0f, std::memory_order_relaxed);
+    }
+
+    update_jitter(timestamp, arrival_ns);
+
+    const bool anchored = anchored_.load(std::memory_order_acquire);
+    uint32_t play = 0;
+    if (anchored) {
+        play = play_seq_.load(std::memory_order_acquire);
+        if (seq_before(seq, play)) {
+            if (play - seq > kDiscontinuity) {
+                resync_.store(true, std::memory_order_release);
+            } else {
+                late_.fetch_add(1, std::memory_order_relaxed);
+            }
+            return nullptr;
+        }
+        if (seq - play >= kCapacity) {
+            if (seq - play > kDiscontinuity) {
+                resync_.store(true, std::memory_order_release);
+            } else {
+                overflow_.fetch_add(1, std::memory_order_relaxed);
+            }
+            return nullptr;
+        }
+    }
+
+    Cell& cell = cells_[seq % kCapacity];
+    uint32_t tag = cell.tag.load(std::memory_order_acquire);
+    if (tag != 0) {
+        uint32_t held = tag - 1;
+        if (held == seq) return nullptr;  // duplicate
+        // Only a cell the consumer has already played past may be reused
+        if (!anchored || !seq_before(held, play)) {
+            overflow_.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+    }
+
+    return cell.frame;
+}
+
+void JitterBuffer::commit(uint32_t seq) {
+    cells_[seq % kCapacity].tag.store(seq + 1, std::memory_order_release);
+
+    if (have_last_ && seq_before(seq, newest_seq_)) {
+        reordered_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        newest_seq_ = seq;
+    }
+}
+
+void JitterBuffer::update_jitter(uint32_t timestamp, int64_t arrival_ns) {
+    if (have_last_) {
+        // RFC 3550 §6.4.1: J += (|D| - J) / 16, in timestamp units (samples)
+        double arrival_delta = static_cast<double>(arrival_ns - last_arrival_ns_) *
+                               kSampleRate / 1e9;
+        double ts_delta = static_cast<int32_t>(timestamp - last_timestamp_);
+        double d = std::fabs(arrival_delta - ts_delta);
+        jitter_samples_ += (d - jitter_samples_) / 16.0;
+
+        auto target = static_cast<uint32_t>(kJitterMargin * jitter_samples_ / kSamplesPerFrame);
+        target_depth_.store(std::min(target, kMaxTargetDepth), std::memory_order_relaxed);
+        jitter_us_.store(static_cast<uint32_t>(jitter_samples_ * 1e6 / kSampleRate),
+                         std::memory_order_relaxed);
+
+        ts_elapsed_ += static_cast<int32_t>(timestamp - last_timestamp_);
+        update_skew(arrival_ns, arrival_ns - last_arrival_ns_ > kSkewGapNs);
+    } else {
+        ts_elapsed_ = 0;
+        skew_origin_ns_ = arrival_ns;
+        have_baseline_ = false;
+        window_start_ns_ = arrival_ns;
+        window_min_ = 0.0;
+    }
+    have_last_ = true;
+    last_arrival_ns_ = arrival_ns;
+    last_timestamp_ = timestamp;
+}
+
+void JitterBuffer::update_skew(int64_t arrival_ns, bool gap) {
+    // Transit in samples, from an arbitrary origin: grows while the
+    // sender's clock runs slow, shrinks while it runs fast
+    const double transit = static_cast<double>(arrival_ns - skew_origin_ns_) * kSampleRate / 1e9 -
+                           static_cast<double>(ts_elapsed_);
+    if (gap) {
+        // The sender paused: its timestamps did too, so start over from here
+        have_baseline_ = false;
+    } else if (arrival_ns - window_start_ns_ < kSkewWindowNs) {
+        window_min_ = std::min(window_min_, transit);
+        return;
+    } else if (have_baseline_) {
+        const double seconds = static_cast<double>(window_start_ns_ - last_window_start_ns_) / 1e9;
+        const double ppm = -(window_min_ - last_window_min_) / seconds / kSampleRate * 1e6;
+        if (slopes_++ == 0) {
+            skew_estimate_ppm_ = ppm;
+        } else {
+            skew_estimate_ppm_ += std::clamp(ppm - skew_estimate_ppm_, -kSkewStepPpm, kSkewStepPpm) /
+                                  kSkewSmoothing;
+        }
+        skew_estimate_ppm_ = std::clamp(skew_estimate_ppm_, -static_cast<double>(kMaxSkewPpm),
+                                        static_cast<double>(kMaxSkewPpm));
+        skew_ppm_.store(static_cast<float>(skew_estimate_ppm_), std::memory_order_relaxed);
+        skew_ready_.store(true, std::memory_order_release);
+    }
+    if (!gap) {
+        last_window_start_ns_ = window_start_ns_;
+        last_window_min_ = window_min_;
+        have_baseline_ = true;
+    }
+    window_start_ns_ = arrival_ns;
+    window_min_ = transit;
+}
+
+// ── Consumer (mixer thread) ─────────────────────────────────────────────────
+
+void JitterBuffer::publish_play_seq() {
+    play_seq_.store(next_seq_, std::memory_order_release);
+}
+
+JitterBuffer::PopResult JitterBuffer::front(const AudioFrame*& out) {
+    out = nullptr;
+    if (resync_.load(std::memory_order_acquire)) reset();
+
+    const uint32_t target = target_depth_.load(std::memory_order_relaxed);
+
+    if (!anchored_.load(std::memory_order_relaxed)) {
+        // Prime: start at the oldest buffered frame once `target` more are queued
+        uint32_t present = 0;
+        uint32_t oldest = 0;
+        for (auto& cell : cells_) {
+            uint32_t tag = cell.tag.load(std::memory_order_acquire);
+            if (tag == 0) continue;
+            if (present == 0 || seq_before(tag - 1, oldest)) oldest = tag - 1;
+            ++present;
+        }
+        depth_.store(present, std::memory_order_relaxed);
+        if (present == 0 || present < target + 1) return PopResult::None;
+
+        next_seq_ = oldest;
+        publish_play_seq();
+        anchored_.store(true, std::memory_order_release);
+        carry_len_ = 0;
+        slip_owed_ = 0.0;
+        fill_avg_ = target + 1.0;
+    }
+
+    // Depth: frames buffered at or after the playout point
+    uint32_t depth = 0;
+    for (auto& cell : cells_) {
+        uint32_t tag = cell.tag.load(std::memory_order_acquire);
+        if (tag != 0 && !seq_before(tag - 1, next_seq_)) ++depth;
+    }
+    depth_.store(depth, std::memory_order_relaxed);
+
+    if (depth > target + kTrimSlack) {
+        // Latency built up (burst after a stall): drop the oldest frame
+        Cell& cell = cells_[next_seq_ % kCapacity];
+        if (cell.tag.load(std::memory_order_acquire) == next_seq_ + 1) {
+            cell.tag.store(0, std::memory_order_release);
+            --depth;
+        }
+        ++next_seq_;
+        publish_play_seq();
+        trimmed_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Off the mix clock: through the carry. A miss there drops the carry
+    // and conceals like any other.
+    const int32_t adjust = drift_adjustment(depth, target);
+    if (adjust != 0 || carry_len_ > 0) {
+        PopResult result = play_adjusted(adjust, out);
+        if (result != PopResult::None) return result;
+        carry_len_ = 0;
+    }
+
+    Cell& cell = cells_[next_seq_ % kCapacity];
+    if (cell.tag.load(std::memory_order_acquire) == next_seq_ + 1) {
+        // Held until pop(): play_seq_ stays on it, so the producer can't
+        // reuse the cell in the meantime
+        out = cell.frame;
+        holding_ = 1;
+        played_.fetch_add(1, std::memory_order_relaxed);
+        return PopResult::Frame;
+    }
+
+    // Missing frame
+    if (depth == 0 && (!have_last_frame_ || conceal_run_ >= kMaxConcealed)) {
+        // Nothing buffered for a while: the stream stopped. Go quiet and
+        // re-prime when audio resumes.
+        for (auto& c : cells_) c.tag.store(0, std::memory_order_release);
+        anchored_.store(false, std::memory_order_release);
+        have_last_frame_ = false;
+        return PopResult::None;
+    }
+
+    // More frames queued behind the gap than the target cushion: it's lost.
+    // Otherwise hold the playout point so a late frame still plays next cycle.
+    if (depth > target || conceal_run_ >= kMaxConcealed) {
+        ++next_seq_;
+        publish_play_seq();
+    }
+    if (!have_last_frame_) return PopResult::None;
+    conceal();
+    out = &concealed_frame_;
+    return PopResult::Concealed;
+}
+
+void JitterBuffer::pop() {
+    if (holding_ == 0) return;
+
+    // The played buffer becomes the concealment source; the cell takes the
+    // previous one. The tag's release publishes the swap to the producer.
+    for (; holding_ > 0; --holding_) {
+        Cell& cell = cells_[next_seq_ % kCapacity];
+        std::swap(cell.frame, last_frame_);
+        cell.tag.store(0, std::memory_order_release);
+        ++next_seq_;
+    }
+    publish_play_seq();
+    have_last_frame_ = true;
+    conceal_run_ = 0;
+}
+
+int32_t JitterBuffer::drift_adjustment(uint32_t depth, uint32_t target) {
+    const double fill = depth + static_cast<double>(carry_len_) / kSamplesPerFrame;
+    fill_avg_ += (fill - fill_avg_) / kFillSmoothing;
+    if (!skew_ready_.load(std::memory_order_acquire)) return 0;
+
+    // The sender's skew, and a nudge back into [target + 1, target + 2]
+    // for what the estimate misses
+    const double off_target = fill_avg_ - std::clamp(fill_avg_, target + 1.0, target + 2.0);
+    const double ppm = std::clamp(skew_ppm_.load(std::memory_order_relaxed) + kFillGainPpm * off_target,
+                                  -static_cast<double>(kMaxSkewPpm),
+                                  static_cast<double>(kMaxSkewPpm));
+    const double per_frame = ppm * 1e-6 * kSamplesPerFrame;
+    // What's owed is paid off at most a sample a cycle faster than it accrues
+    const double bound = std::min(static_cast<double>(kMaxSlip), std::fabs(per_frame) + 1.0);
+    slip_owed_ = std::clamp(slip_owed_ + per_frame, -bound, bound);
+
+    auto adjust = static_cast<int32_t>(slip_owed_);  // whole samples, the rest stays owed
+    // Slipping past the carry takes a sample of the next frame, and from then
+    // on every frame a cycle early: wait until the sender is reliably that
+    // far ahead, not just a frame early by jitter
+    if (adjust > static_cast<int32_t>(carry_len_) && fill_avg_ < target + kAheadFill) {
+        adjust = static_cast<int32_t>(carry_len_);
+    }
+    return adjust;
+}
+
+JitterBuffer::PopResult JitterBuffer::play_adjusted(int32_t adjust, const AudioFrame*& out) {
+    const AudioFrame* head = nullptr;
+    {
+        Cell& cell = cells_[next_seq_ % kCapacity];
+        if (cell.tag.load(std::memory_order_acquire) == next_seq_ + 1) head = cell.frame;
+    }
+    if (head && carry_len_ > 0 && head->channels != carry_channels_) carry_len_ = 0;  // renegotiated
+
+    const uint8_t channels = head ? head->channels : carry_channels_;
+    AudioFrame& frame = adjusted_frame_;
+    frame.sequence = next_seq_;
+    frame.timestamp = head ? head->timestamp : last_frame_->timestamp;
+    frame.channels = channels;
+    frame.room_total = false;
+
+    if (adjust == 0 && head) {
+        // Most cycles: the carry, the head up to a frame, and the rest of
+        // the head carried
+        const size_t carried = carry_len_ * channels;
+        const size_t from_head = kSamplesPerFrame * channels - carried;
+        std::copy_n(carry_.begin(), carried, frame.samples.begin());
+        std::copy_n(head->samples.begin(), from_head, frame.samples.begin() + carried);
+        std::copy_n(head->samples.begin() + from_head, carried, carry_.begin());
+        frame.silent = (carry_len_ == 0 || carry_silent_) && head->silent;
+        carry_silent_ = head->silent;
+        played_.fetch_add(1, std::memory_order_relaxed);
+        holding_ = 1;
+        out = &frame;
+        return PopResult::Frame;
+    }
+
+    // Gather what this cycle plays behind the carry: the head cell, and the
+    // one after it when slipping past the end of the head
+    uint32_t need = kSamplesPerFrame + adjust;
+    uint32_t have = carry_len_;
+    uint32_t cells = 0;
+    bool silent = carry_len_ == 0 || carry_silent_;
+    while (have < need) {
+        Cell& cell = cells_[(next_seq_ + cells) % kCapacity];
+        if (cell.tag.load(std::memory_order_acquire) != next_seq_ + cells + 1) break;
+        const AudioFrame& f = *cell.frame;
+        if (f.channels != channels) break;
+        std::copy_n(f.samples.begin(), f.sample_count(), carry_.begin() + have * channels);
+        have += kSamplesPerFrame;
+        silent &= f.silent;
+        carry_silent_ = f.silent;
+        ++cells;
+    }
+    if (have < need) {
+        // The head is late with most of a frame carried: stretch that
+        // instead of concealing (the sender's phase is at the wrap)
+        if (cells == 0 && have < kSamplesPerFrame - kMaxSlip) return PopResult::None;
+        need = have;
+    }
+
+    frame.silent = silent;
+    if (need == kSamplesPerFrame) {
+        std::copy_n(carry_.begin(), kSamplesPerFrame * channels, frame.samples.begin());
+    } else if (channels == 2) {
+        stretch<2>(carry_.data(), need, have, frame.samples.data());
+    } else {
+        stretch<1>(carry_.data(), need, have, frame.samples.data());
+    }
+    // What's left over plays first next cycle
+    std::copy(carry_.begin() + need * channels, carry_.begin() + have * channels, carry_.begin());
+    carry_len_ = have - need;
+    carry_channels_ = channels;
+
+    const auto applied = static_cast<int32_t>(need) - static_cast<int32_t>(kSamplesPerFrame);
+    slip_owed_ -= applied;
+    if (applied > 0) slipped_.fetch_add(static_cast<uint64_t>(applied), std::memory_order_relaxed);
+    if (applied < 0) inserted_.fetch_add(static_cast<uint64_t>(-applied), std::memory_order_relaxed);
+    if (cells > 0) played_.fetch_add(cells, std::memory_order_relaxed);
+    holding_ = cells;
+    out = &frame;
+    return PopResult::Frame;
+}
+
+JitterBuffer::PopResult JitterBuffer::pop(AudioFrame& out) {
+    const AudioFrame* frame;
+    PopResult result = front(frame);
+    if (frame) out = *frame;
+    pop();
+    return result;
+}
+
+void JitterBuffer::conceal() {
+    // Repeat the last good frame, fading linearly to silence over kMaxConcealed frames
+    ++conceal_run_;
+    float start = std::max(0.0f, 1.0f - static_cast<float>(conceal_run_ - 1) / kMaxConcealed);
+    float end = std::max(0.0f, 1.0f - static_cast<float>(conceal_run_) / kMaxConcealed);
+    float step = (end - start) / kSamplesPerFrame;
+
+    const AudioFrame& last = *last_frame_;
+    AudioFrame& out = concealed_frame_;
+    out.sequence = next_seq_;
+    out.timestamp = last.timestamp + conceal_run_ * static_cast<uint32_t>(kSamplesPerFrame);
+    out.silent = last.silent;
+    out.channels = last.channels;
+    const size_t channels = out.channels;
+    float gain = start;
+    for (size_t s = 0; s < kSamplesPerFrame; ++s, gain += step) {
+        for (size_t c = 0; c < channels; ++c) {
+            size_t i = s * channels + c;
+            out.samples[i] = static_cast<int16_t>(std::lrintf(last.samples[i] * gain));
+        }
+    }
+    concealed_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void JitterBuffer::reset() {
+    for (auto& cell : cells_) cell.tag.store(0, std::memory_order_release);
+    resync_.store(false, std::memory_order_relaxed);
+    anchored_.store(false, std::memory_order_release);
+    reset_epoch_.fetch_add(1, std::memory_order_release);
+    conceal_run_ = 0;
+    have_last_frame_ = false;
+    holding_ = 0;
+    carry_len_ = 0;
+    slip_owed_ = 0.0;
+    depth_.store(0, std::memory_order_relaxed);
+}
+
+JitterStats JitterBuffer::stats() const {
+    JitterStats s;
+    s.depth = depth_.load(std::memory_order_relaxed);
+    s.target_depth = target_depth_.load(std::memory_order_relaxed);
+    s.jitter_us = jitter_us_.load(std::memory_order_relaxed);
+    s.played = played_.load(std::memory_order_relaxed);
+    s.concealed = concealed_.load(std::memory_order_relaxed);
+    s.late = late_.load(std::memory_order_relaxed);
+    s.reordered = reordered_.load(std::memory_order_relaxed);
+    s.overflow = overflow_.load(std::memory_order_relaxed);
+    s.trimmed = trimmed_.load(std::memory_order_relaxed);
+    if (skew_ready_.load(std::memory_order_relaxed)) {
+        s.drift_ppm = static_cast<int32_t>(std::lrint(skew_ppm_.load(std::memory_order_relaxed)));
+    }
+    s.slipped = slipped_.load(std::memory_order_relaxed);
+    s.inserted = inserted_.load(std::memory_order_relaxed);
+    return s;
+}
+
+} // namespace tutti
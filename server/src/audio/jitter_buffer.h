@@ -0,0 +1,192 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "ring_buffer.h"
+
+namespace tutti {
+
+/// Jitter buffer counters for one participant. Written with relaxed
+/// atomics by the network and mixer threads, readable from any thread.
+struct JitterStats {
+    uint32_t depth = 0;          // frames buffered at the last mix cycle
+    uint32_t target_depth = 0;   // adaptive target (0 on a clean link)
+    uint32_t jitter_us = 0;      // RFC 3550 interarrival jitter estimate
+    uint64_t played = 0;         // frames delivered in order
+    uint64_t concealed = 0;      // frames synthesized by PLC
+    uint64_t late = 0;           // arrived after their playout slot
+    uint64_t reordered = 0;      // arrived out of order, still in time
+    uint64_t overflow = 0;       // dropped: too far ahead of playout
+    uint64_t trimmed = 0;        // dropped to pull latency back to target
+    int32_t drift_ppm = 0;       // sender clock against ours (+ fast), once estimated
+    uint64_t slipped = 0;        // samples dropped to keep up with a fast sender
+    uint64_t inserted = 0;       // samples added to keep a slow sender fed
+};
+
+/// Sequence-aware, adaptive jitter buffer for one participant's input.
+///
+/// Single producer (network receive thread) and single consumer (mixer
+/// RT thread), lock-free. Frames are stored in a ring indexed by sequence
+/// number, so reordered packets land in place. Each cell is tagged with seq+1
+/// once written, and cleared once played.
+///
+/// The producer tracks RFC 3550 interarrival jitter and derives a target
+/// depth. On a clean link that target is 0, keeping the zero-prebuffer
+/// path. The consumer primes to the target, plays in sequence order,
+/// conceals a missing frame by repeating the last one with a fade, and
+/// trims back toward the target when latency builds up. A stream that
+/// stops is concealed for a few frames and then goes quiet.
+///
+/// Frames are read where they were written: front() hands out the cell
+/// itself, and pop() swaps the played buffer out to become the
+/// concealment source, so nothing is copied out of the ring.
+///
+/// Senders' clocks are not ours: a browser runs a few tens of ppm fast or
+/// slow, and an iOS client at 44.1kHz sends ~8% fewer frames than the mix
+/// plays. The producer estimates each sender's skew from how the lower
+/// envelope of (arrival - timestamp) moves, over a few seconds. Once it
+/// has one, the consumer slips or inserts samples at that rate, plus a
+/// little more while depth sits off target, so the input stays in step
+/// with the mix clock rather than drifting into trims and concealment. A
+/// cycle that moves the stream stretches one frame's worth of input
+/// (128 ± n samples) onto 128 by linear interpolation; the samples left
+/// over carry into the next cycle. Until a cycle first adjusts, and
+/// whenever the carry is empty, frames are still read in place.
+class JitterBuffer {
+public:
+    /// Ring size: ~43ms at 48kHz/128 samples
+    static constexpr uint32_t kCapacity = 16;
+    /// Upper bound on the adaptive target (~21ms)
+    static constexpr uint32_t kMaxTargetDepth = 8;
+    /// Consecutive concealed frames before the stream is treated as stopped
+    static constexpr uint32_t kMaxConcealed = 4;
+    /// Largest skew compensated (10%: a 44.1kHz sender, and its drift)
+    static constexpr int32_t kMaxSkewPpm = 100000;
+    /// Most samples a cycle slips or inserts (kMaxSkewPpm of a frame, rounded up)
+    static constexpr int32_t kMaxSlip = 16;
+
+    enum class PopResult {
+        None,       // nothing to play for this participant this cycle
+        Frame,      // a received frame, in order
+        Concealed   // a PLC frame (loss or late arrival)
+    };
+
+    JitterBuffer();
+
+    JitterBuffer(const JitterBuffer&) = delete;
+    JitterBuffer& operator=(const JitterBuffer&) = delete;
+
+    /// Producer: insert a received frame. Returns false if it was dropped
+    /// (late, duplicate or too far ahead).
+    bool push(const AudioFrame& frame);
+    bool push(const AudioFrame& frame, int64_t arrival_ns);
+
+    /// Producer: insert a PCM datagram (header, then kSamplesPerFrame
+    /// samples per channel), written straight into its cell. A silent
+    /// frame's samples are not read; it is stored as zeros.
+    bool push_datagram(const uint8_t* data, uint8_t channels, bool silent);
+
+    /// Consumer: the frame to mix this cycle, read in place (nullptr with
+    /// None). It stays valid, and its cell held, until pop().
+    PopResult front(const AudioFrame*& out);
+
+    /// Consumer: done with the frame from front(). Call once per front().
+    void pop();
+
+    /// Consumer: the frame to mix this cycle, copied out (front() + pop())
+    PopResult pop(AudioFrame& out);
+
+    /// Consumer: discard everything and re-prime (slot handover, park)
+    void reset();
+
+    JitterStats stats() const;
+
+private:
+    struct Cell {
+        std::atomic<uint32_t> tag{0};  // seq + 1 when holding a frame, 0 = empty
+        AudioFrame* frame = nullptr;   // into frames_; swapped by pop(), published by tag
+    };
+
+    static bool seq_before(uint32_t a, uint32_t b) {
+        return static_cast<int32_t>(a - b) < 0;
+    }
+
+    /// Producer: the cell buffer to write `seq` into, or nullptr if the
+    /// frame is dropped. commit() publishes it.
+    AudioFrame* claim(uint32_t seq, uint32_t timestamp, int64_t arrival_ns);
+    void commit(uint32_t seq);
+
+    void update_jitter(uint32_t timestamp, int64_t arrival_ns);
+    void update_skew(int64_t arrival_ns, bool gap);
+    /// Samples to slip (+) or insert (-) this cycle; 0 until the skew is known
+    int32_t drift_adjustment(uint32_t depth, uint32_t target);
+    /// Play `adjust` samples more or fewer than a frame's worth, through the carry.
+    /// None if the head frame is needed and missing.
+    PopResult play_adjusted(int32_t adjust, const AudioFrame*& out);
+    void conceal();
+    void publish_play_seq();
+
+    std::array<Cell, kCapacity> cells_;
+    // One buffer per cell plus the last played frame (last_frame_)
+    std::array<AudioFrame, kCapacity + 1> frames_;
+
+    // Shared state
+    std::atomic<uint32_t> play_seq_{0};       // consumer's next sequence
+    std::atomic<bool> anchored_{false};       // consumer has a valid play_seq_
+    std::atomic<bool> resync_{false};         // producer saw a sequence discontinuity
+    std::atomic<uint32_t> reset_epoch_{0};    // bumped by reset(); restarts the estimator
+    std::atomic<uint32_t> target_depth_{0};
+
+    // Producer state
+    uint32_t seen_epoch_ = 0;
+    bool have_last_ = false;
+    int64_t last_arrival_ns_ = 0;
+    uint32_t last_timestamp_ = 0;
+    uint32_t newest_seq_ = 0;
+    double jitter_samples_ = 0.0;
+    // Skew: the sender's clock (unwrapped timestamps) against arrival time,
+    // in samples, through the minimum transit of each window
+    int64_t ts_elapsed_ = 0;
+    int64_t skew_origin_ns_ = 0;
+    int64_t window_start_ns_ = 0;
+    double window_min_ = 0.0;
+    int64_t last_window_start_ns_ = 0;
+    double last_window_min_ = 0.0;
+    bool have_baseline_ = false;  // last_window_* hold the previous window
+    uint32_t slopes_ = 0;         // windows compared so far
+    double skew_estimate_ppm_ = 0.0;
+    std::atomic<float> skew_ppm_{0.0f};
+    std::atomic<bool> skew_ready_{false};
+
+    // Consumer state
+    uint32_t next_seq_ = 0;
+    uint32_t conceal_run_ = 0;
+    bool have_last_frame_ = false;
+    uint32_t holding_ = 0;        // cells from next_seq_ on that front() read; pop() frees them
+    AudioFrame* last_frame_;      // the buffer pop() last swapped out of a cell
+    AudioFrame concealed_frame_;
+    // Drift compensation: input not yet played, ahead of the head cell
+    std::array<int16_t, 3 * kSamplesPerFrame * kMaxChannels> carry_{};
+    uint32_t carry_len_ = 0;      // sample frames in carry_
+    uint8_t carry_channels_ = 1;
+    bool carry_silent_ = true;
+    AudioFrame adjusted_frame_;   // what front() hands out off the carry
+    double slip_owed_ = 0.0;      // samples to slip (+) or insert (-), accrued
+    double fill_avg_ = 0.0;       // smoothed frames buffered, carry included
+
+    // Stats
+    std::atomic<uint32_t> depth_{0};
+    std::atomic<uint32_t> jitter_us_{0};
+    std::atomic<uint64_t> played_{0};
+    std::atomic<uint64_t> concealed_{0};
+    std::atomic<uint64_t> late_{0};
+    std::atomic<uint64_t> reordered_{0};
+    std::atomic<uint64_t> overflow_{0};
+    std::atomic<uint64_t> trimmed_{0};
+    std::atomic<uint64_t> slipped_{0};
+    std::atomic<uint64_t> inserted_{0};
+};
+
+} // namespace tutti
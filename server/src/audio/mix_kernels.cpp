@@ -0,0 +1,472 @@
+#include "mix_kernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define TUTTI_MIX_AVX2 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define TUTTI_MIX_NEON 1
+#endif
+
+namespace tutti {
+
+// ── Scalar ──────────────────────────────────────────────────────────────────
+
+namespace {
+
+// Soft clip above the knee: over / (1 + over / headroom) approaches the
+// headroom without reaching it, with unit slope at the knee
+constexpr float kSoftClipHeadroom = kSoftClipCeiling - kSoftClipKnee;
+constexpr float kInvSoftClipHeadroom = 1.0f / kSoftClipHeadroom;
+
+// std::fmaf keeps the scalar path bit-identical to the vector FMA paths.
+// lrintf rounds half-to-even under the default FP environment, like the SIMD
+// float-to-int conversions.
+
+void scalar_accumulate(float* acc, const int16_t* src, size_t n) {
+    for (size_t i = 0; i < n; ++i) acc[i] += static_cast<float>(src[i]);
+}
+
+void scalar_subtract(float* acc, const int16_t* src, size_t n) {
+    for (size_t i = 0; i < n; ++i) acc[i] -= static_cast<float>(src[i]);
+}
+
+void scalar_accumulate_scaled(float* acc, const int16_t* src, float gain, size_t n) {
+    for (size_t i = 0; i < n; ++i) acc[i] = std::fmaf(static_cast<float>(src[i]), gain, acc[i]);
+}
+
+float scalar_peak(const float* acc, size_t n) {
+    float peak = 0.0f;
+    for (size_t i = 0; i < n; ++i) peak = std::max(peak, std::fabs(acc[i]));
+    return peak;
+}
+
+float scalar_store(int16_t* dst, const float* acc, size_t n) {
+    constexpr long lo = std::numeric_limits<int16_t>::min();
+    constexpr long hi = std::numeric_limits<int16_t>::max();
+    for (size_t i = 0; i < n; ++i) {
+        dst[i] = static_cast<int16_t>(std::clamp(std::lrintf(acc[i]), lo, hi));
+    }
+    return scalar_peak(acc, n);
+}
+
+/// limit() from sample `first` of the ramp (vector paths finish their tail here)
+void scalar_limit_from(int16_t* dst, const float* acc, float from, float step,
+                       size_t first, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        float g = std::fmaf(step, static_cast<float>(first + i + 1), from);
+        float y = acc[i] * g;
+        float a = std::fabs(y);
+        float over = std::max(a - kSoftClipKnee, 0.0f);
+        float mag = std::min(a, kSoftClipKnee) + over / std::fmaf(over, kInvSoftClipHeadroom, 1.0f);
+        dst[i] = static_cast<int16_t>(std::lrintf(std::copysign(mag, y)));
+    }
+}
+
+void scalar_limit(int16_t* dst, const float* acc, float from, float step, size_t n) {
+    scalar_limit_from(dst, acc, from, step, 0, n);
+}
+
+void scalar_accumulate_panned(float* acc, const int16_t* src,
+                              float left, float right, size_t frames) {
+    for (size_t i = 0; i < frames; ++i) {
+        float s = static_cast<float>(src[i]);
+        acc[2 * i] = std::fmaf(s, left, acc[2 * i]);
+        acc[2 * i + 1] = std::fmaf(s, right, acc[2 * i + 1]);
+    }
+}
+
+void scalar_accumulate_balanced(float* acc, const int16_t* src,
+                                float left, float right, size_t frames) {
+    for (size_t i = 0; i < frames; ++i) {
+        acc[2 * i] = std::fmaf(static_cast<float>(src[2 * i]), left, acc[2 * i]);
+        acc[2 * i + 1] = std::fmaf(static_cast<float>(src[2 * i + 1]), right, acc[2 * i + 1]);
+    }
+}
+
+void scalar_downmix(int16_t* dst, const int16_t* src, size_t frames) {
+    for (size_t i = 0; i < frames; ++i) {
+        dst[i] = static_cast<int16_t>((static_cast<int32_t>(src[2 * i]) + src[2 * i + 1]) >> 1);
+    }
+}
+
+uint64_t scalar_energy(const int16_t* src, size_t n) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < n; ++i) {
+        sum += static_cast<uint64_t>(static_cast<int32_t>(src[i]) * src[i]);
+    }
+    return sum;
+}
+
+const MixKernels kScalarKernels = {
+    "scalar",
+    scalar_accumulate,
+    scalar_subtract,
+    scalar_accumulate_scaled,
+    scalar_store,
+    scalar_peak,
+    scalar_limit,
+    scalar_accumulate_panned,
+    scalar_accumulate_balanced,
+    scalar_downmix,
+    scalar_energy,
+};
+
+// ── AVX2 ────────────────────────────────────────────────────────────────────
+
+#ifdef TUTTI_MIX_AVX2
+
+__attribute__((target("avx2,fma")))
+inline __m256 avx2_load_samples(const int16_t* src) {
+    return _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src))));
+}
+
+/// Round 16 floats half-to-even and pack them to int16 with saturation
+__attribute__((target("avx2,fma")))
+inline void avx2_pack_store(int16_t* dst, __m256 a, __m256 b) {
+    // packs works per 128-bit lane; restore sample order with a 64-bit permute
+    __m256i packed = _mm256_permute4x64_epi64(
+        _mm256_packs_epi32(_mm256_cvtps_epi32(a), _mm256_cvtps_epi32(b)), 0xD8);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), packed);
+}
+
+__attribute__((target("avx2,fma")))
+void avx2_accumulate(float* acc, const int16_t* src, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(acc + i, _mm256_add_ps(_mm256_loadu_ps(acc + i), avx2_load_samples(src + i)));
+    }
+    scalar_accumulate(acc + i, src + i, n - i);
+}
+
+__attribute__((target("avx2,fma")))
+void avx2_subtract(float* acc, const int16_t* src, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(acc + i, _mm256_sub_ps(_mm256_loadu_ps(acc + i), avx2_load_samples(src + i)));
+    }
+    scalar_subtract(acc + i, src + i, n - i);
+}
+
+__attribute__((target("avx2,fma")))
+void avx2_accumulate_scaled(float* acc, const int16_t* src, float gain, size_t n) {
+    const __m256 g = _mm256_set1_ps(gain);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(acc + i, _mm256_fmadd_ps(avx2_load_samples(src + i), g, _mm256_loadu_ps(acc + i)));
+    }
+    scalar_accumulate_scaled(acc + i, src + i, gain, n - i);
+}
+
+__attribute__((target("avx2,fma")))
+inline float avx2_hmax(__m256 v) {
+    __m128 m = _mm_max_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    m = _mm_max_ps(m, _mm_movehl_ps(m, m));
+    m = _mm_max_ss(m, _mm_shuffle_ps(m, m, 1));
+    return _mm_cvtss_f32(m);
+}
+
+__attribute__((target("avx2,fma")))
+float avx2_peak(const float* acc, size_t n) {
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    __m256 peak = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        peak = _mm256_max_ps(peak, _mm256_andnot_ps(sign, _mm256_loadu_ps(acc + i)));
+    }
+    return std::max(avx2_hmax(peak), scalar_peak(acc + i, n - i));
+}
+
+__attribute__((target("avx2,fma")))
+float avx2_store(int16_t* dst, const float* acc, size_t n) {
+    // The bus stays far below 2^31, so the int32 conversion never overflows
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    __m256 peak = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256 a = _mm256_loadu_ps(acc + i);
+        __m256 b = _mm256_loadu_ps(acc + i + 8);
+        peak = _mm256_max_ps(peak, _mm256_max_ps(_mm256_andnot_ps(sign, a), _mm256_andnot_ps(sign, b)));
+        avx2_pack_store(dst + i, a, b);
+    }
+    return std::max(avx2_hmax(peak), scalar_store(dst + i, acc + i, n - i));
+}
+
+__attribute__((target("avx2,fma")))
+inline __m256 avx2_soft_clip(__m256 acc, __m256 g) {
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    const __m256 knee = _mm256_set1_ps(kSoftClipKnee);
+    const __m256 inv_headroom = _mm256_set1_ps(kInvSoftClipHeadroom);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    __m256 y = _mm256_mul_ps(acc, g);
+    __m256 a = _mm256_andnot_ps(sign, y);
+    __m256 over = _mm256_max_ps(_mm256_sub_ps(a, knee), _mm256_setzero_ps());
+    __m256 mag = _mm256_add_ps(_mm256_min_ps(a, knee),
+                               _mm256_div_ps(over, _mm256_fmadd_ps(over, inv_headroom, one)));
+    return _mm256_or_ps(mag, _mm256_and_ps(y, sign));
+}
+
+__attribute__((target("avx2,fma")))
+void avx2_limit(int16_t* dst, const float* acc, float from, float step, size_t n) {
+    const __m256 ramp = _mm256_setr_ps(1, 2, 3, 4, 5, 6, 7, 8);
+    const __m256 s = _mm256_set1_ps(step);
+    const __m256 f = _mm256_set1_ps(from);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256 base = _mm256_set1_ps(static_cast<float>(i));
+        __m256 g0 = _mm256_fmadd_ps(s, _mm256_add_ps(base, ramp), f);
+        __m256 g1 = _mm256_fmadd_ps(s, _mm256_add_ps(_mm256_add_ps(base, _mm256_set1_ps(8)), ramp), f);
+        avx2_pack_store(dst + i, avx2_soft_clip(_mm256_loadu_ps(acc + i), g0),
+                        avx2_soft_clip(_mm256_loadu_ps(acc + i + 8), g1));
+    }
+    scalar_limit_from(dst + i, acc + i, from, step, i, n - i);
+}
+
+__attribute__((target("avx2,fma")))
+void avx2_accumulate_panned(float* acc, const int16_t* src,
+                            float left, float right, size_t frames) {
+    const __m256 g = _mm256_setr_ps(left, right, left, right, left, right, left, right);
+    const __m256i lo = _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3);
+    const __m256i hi = _mm256_setr_epi32(4, 4, 5, 5, 6, 6, 7, 7);
+    size_t i = 0;
+    for (; i + 8 <= frames; i += 8) {
+        __m256 s = avx2_load_samples(src + i);
+        // Duplicate each sample into an L/R pair, then scale per channel
+        float* dst = acc + 2 * i;
+        _mm256_storeu_ps(dst, _mm256_fmadd_ps(_mm256_permutevar8x32_ps(s, lo), g, _mm256_loadu_ps(dst)));
+        _mm256_storeu_ps(dst + 8, _mm256_fmadd_ps(_mm256_permutevar8x32_ps(s, hi), g, _mm256_loadu_ps(dst + 8)));
+    }
+    scalar_accumulate_panned(acc + 2 * i, src + i, left, right, frames - i);
+}
+
+__attribute__((target("avx2,fma")))
+void avx2_accumulate_balanced(float* acc, const int16_t* src,
+                              float left, float right, size_t frames) {
+    const __m256 g = _mm256_setr_ps(left, right, left, right, left, right, left, right);
+    const size_t n = 2 * frames;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(acc + i, _mm256_fmadd_ps(avx2_load_samples(src + i), g, _mm256_loadu_ps(acc + i)));
+    }
+    scalar_accumulate_balanced(acc + i, src + i, left, right, (n - i) / 2);
+}
+
+__attribute__((target("avx2,fma")))
+void avx2_downmix(int16_t* dst, const int16_t* src, size_t frames) {
+    const __m256i ones = _mm256_set1_epi16(1);
+    size_t i = 0;
+    for (; i + 16 <= frames; i += 16) {
+        // madd with ones sums each L/R pair into an int32
+        __m256i a = _mm256_srai_epi32(_mm256_madd_epi16(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 2 * i)), ones), 1);
+        __m256i b = _mm256_srai_epi32(_mm256_madd_epi16(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 2 * i + 16)), ones), 1);
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), packed);
+    }
+    scalar_downmix(dst + i, src + 2 * i, frames - i);
+}
+
+__attribute__((target("avx2,fma")))
+uint64_t avx2_energy(const int16_t* src, size_t n) {
+    __m256i sum = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        // Pair sums reach 2^31 for two full-scale negatives: read them as unsigned
+        __m256i pairs = _mm256_madd_epi16(s, s);
+        sum = _mm256_add_epi64(sum, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(pairs)));
+        sum = _mm256_add_epi64(sum, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(pairs, 1)));
+    }
+    alignas(32) uint64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), sum);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + scalar_energy(src + i, n - i);
+}
+
+const MixKernels kAvx2Kernels = {
+    "avx2",
+    avx2_accumulate,
+    avx2_subtract,
+    avx2_accumulate_scaled,
+    avx2_store,
+    avx2_peak,
+    avx2_limit,
+    avx2_accumulate_panned,
+    avx2_accumulate_balanced,
+    avx2_downmix,
+    avx2_energy,
+};
+
+#endif // TUTTI_MIX_AVX2
+
+// ── NEON ────────────────────────────────────────────────────────────────────
+
+#ifdef TUTTI_MIX_NEON
+
+inline float32x4_t neon_load_samples(const int16_t* src) {
+    return vcvtq_f32_s32(vmovl_s16(vld1_s16(src)));
+}
+
+void neon_accumulate(float* acc, const int16_t* src, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        vst1q_f32(acc + i, vaddq_f32(vld1q_f32(acc + i), neon_load_samples(src + i)));
+    }
+    scalar_accumulate(acc + i, src + i, n - i);
+}
+
+void neon_subtract(float* acc, const int16_t* src, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        vst1q_f32(acc + i, vsubq_f32(vld1q_f32(acc + i), neon_load_samples(src + i)));
+    }
+    scalar_subtract(acc + i, src + i, n - i);
+}
+
+void neon_accumulate_scaled(float* acc, const int16_t* src, float gain, size_t n) {
+    const float32x4_t g = vdupq_n_f32(gain);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        vst1q_f32(acc + i, vfmaq_f32(vld1q_f32(acc + i), neon_load_samples(src + i), g));
+    }
+    scalar_accumulate_scaled(acc + i, src + i, gain, n - i);
+}
+
+float neon_store(int16_t* dst, const float* acc, size_t n) {
+    float32x4_t peak = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        float32x4_t a = vld1q_f32(acc + i);
+        float32x4_t b = vld1q_f32(acc + i + 4);
+        peak = vmaxq_f32(peak, vmaxq_f32(vabsq_f32(a), vabsq_f32(b)));
+        vst1q_s16(dst + i, vcombine_s16(vqmovn_s32(vcvtnq_s32_f32(a)),
+                                        vqmovn_s32(vcvtnq_s32_f32(b))));
+    }
+    return std::max(vmaxvq_f32(peak), scalar_store(dst + i, acc + i, n - i));
+}
+
+float neon_peak(const float* acc, size_t n) {
+    float32x4_t peak = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) peak = vmaxq_f32(peak, vabsq_f32(vld1q_f32(acc + i)));
+    return std::max(vmaxvq_f32(peak), scalar_peak(acc + i, n - i));
+}
+
+inline int32x4_t neon_soft_clip(float32x4_t acc, float32x4_t g) {
+    const float32x4_t knee = vdupq_n_f32(kSoftClipKnee);
+    const uint32x4_t sign = vdupq_n_u32(0x80000000u);
+    float32x4_t y = vmulq_f32(acc, g);
+    float32x4_t a = vabsq_f32(y);
+    float32x4_t over = vmaxq_f32(vsubq_f32(a, knee), vdupq_n_f32(0.0f));
+    float32x4_t den = vfmaq_f32(vdupq_n_f32(1.0f), over, vdupq_n_f32(kInvSoftClipHeadroom));
+    float32x4_t mag = vaddq_f32(vminq_f32(a, knee), vdivq_f32(over, den));
+    return vcvtnq_s32_f32(vbslq_f32(sign, y, mag));  // copysign
+}
+
+void neon_limit(int16_t* dst, const float* acc, float from, float step, size_t n) {
+    const float32x4_t ramp = {1, 2, 3, 4};
+    const float32x4_t s = vdupq_n_f32(step);
+    const float32x4_t f = vdupq_n_f32(from);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        float32x4_t base = vdupq_n_f32(static_cast<float>(i));
+        float32x4_t g0 = vfmaq_f32(f, s, vaddq_f32(base, ramp));
+        float32x4_t g1 = vfmaq_f32(f, s, vaddq_f32(vaddq_f32(base, vdupq_n_f32(4)), ramp));
+        vst1q_s16(dst + i, vcombine_s16(vqmovn_s32(neon_soft_clip(vld1q_f32(acc + i), g0)),
+                                        vqmovn_s32(neon_soft_clip(vld1q_f32(acc + i + 4), g1))));
+    }
+    scalar_limit_from(dst + i, acc + i, from, step, i, n - i);
+}
+
+void neon_accumulate_panned(float* acc, const int16_t* src,
+                            float left, float right, size_t frames) {
+    const float32x4_t g = {left, right, left, right};
+    size_t i = 0;
+    for (; i + 4 <= frames; i += 4) {
+        float32x4_t s = neon_load_samples(src + i);
+        float32x4x2_t pairs = vzipq_f32(s, s);  // each sample as an L/R pair
+        float* dst = acc + 2 * i;
+        vst1q_f32(dst, vfmaq_f32(vld1q_f32(dst), pairs.val[0], g));
+        vst1q_f32(dst + 4, vfmaq_f32(vld1q_f32(dst + 4), pairs.val[1], g));
+    }
+    scalar_accumulate_panned(acc + 2 * i, src + i, left, right, frames - i);
+}
+
+void neon_accumulate_balanced(float* acc, const int16_t* src,
+                              float left, float right, size_t frames) {
+    const float32x4_t g = {left, right, left, right};
+    const size_t n = 2 * frames;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        vst1q_f32(acc + i, vfmaq_f32(vld1q_f32(acc + i), neon_load_samples(src + i), g));
+    }
+    scalar_accumulate_balanced(acc + i, src + i, left, right, (n - i) / 2);
+}
+
+void neon_downmix(int16_t* dst, const int16_t* src, size_t frames) {
+    size_t i = 0;
+    for (; i + 4 <= frames; i += 4) {
+        int16x4x2_t lr = vld2_s16(src + 2 * i);  // deinterleave
+        vst1_s16(dst + i, vshrn_n_s32(vaddl_s16(lr.val[0], lr.val[1]), 1));
+    }
+    scalar_downmix(dst + i, src + 2 * i, frames - i);
+}
+
+uint64_t neon_energy(const int16_t* src, size_t n) {
+    uint64x2_t sum = vdupq_n_u64(0);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        int16x4_t s = vld1_s16(src + i);
+        // Each square is at most 2^30, so the widening multiply can't overflow
+        sum = vpadalq_u32(sum, vreinterpretq_u32_s32(vmull_s16(s, s)));
+    }
+    return vgetq_lane_u64(sum, 0) + vgetq_lane_u64(sum, 1) + scalar_energy(src + i, n - i);
+}
+
+const MixKernels kNeonKernels = {
+    "neon",
+    neon_accumulate,
+    neon_subtract,
+    neon_accumulate_scaled,
+    neon_store,
+    neon_peak,
+    neon_limit,
+    neon_accumulate_panned,
+    neon_accumulate_balanced,
+    neon_downmix,
+    neon_energy,
+};
+
+#endif // TUTTI_MIX_NEON
+
+const MixKernels& select_kernels() {
+    const char* forced = std::getenv("TUTTI_MIX_KERNEL");
+    if (forced && std::strcmp(forced, "scalar") == 0) return kScalarKernels;
+
+#if defined(TUTTI_MIX_AVX2)
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return kAvx2Kernels;
+#elif defined(TUTTI_MIX_NEON)
+    return kNeonKernels;
+#endif
+    return kScalarKernels;
+}
+
+} // namespace
+
+const MixKernels& mix_kernels() {
+    static const MixKernels& selected = select_kernels();
+    return selected;
+}
+
+const MixKernels& scalar_mix_kernels() {
+    return kScalarKernels;
+}
+
+} // namespace tutti
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace tutti {
+
+/// Soft-clip curve applied by MixKernels::limit: linear up to the knee
+/// (-1 dBFS), then bending smoothly towards full scale without reaching it
+static constexpr float kSoftClipKnee = 29204.0f;
+static constexpr float kSoftClipCeiling = 32767.0f;
+
+/// Vectorized sample kernels used by the Mixer.
+///
+/// The mix bus is float32 in int16 units: sources are converted as they
+/// are summed (a fused multiply-add when scaled) and the bus is converted
+/// back to int16 once per output, by store() or through limit().
+///
+/// One implementation is selected at startup: AVX2+FMA on x86-64 CPUs that
+/// support it, NEON on AArch64, scalar otherwise. Set TUTTI_MIX_KERNEL=scalar
+/// in the environment to force the scalar path (for A/B testing).
+///
+/// Every implementation performs the same IEEE operations per sample,
+/// fusing the same multiply-adds, and rounds half-to-even, so all kernels
+/// produce bit-identical results.
+struct MixKernels {
+    const char* name;
+
+    /// acc[i] += src[i]
+    void (*accumulate)(float* acc, const int16_t* src, size_t n);
+
+    /// acc[i] -= src[i]
+    void (*subtract)(float* acc, const int16_t* src, size_t n);
+
+    /// acc[i] = fma(src[i], gain, acc[i]). `gain` may be negative.
+    void (*accumulate_scaled)(float* acc, const int16_t* src, float gain, size_t n);
+
+    /// dst[i] = round(acc[i]) saturated to the int16 range.
+    /// Returns max |acc[i]|, as peak() would, from the same pass.
+    float (*store)(int16_t* dst, const float* acc, size_t n);
+
+    /// max |acc[i]| (0 for n == 0)
+    float (*peak)(const float* acc, size_t n);
+
+    /// dst[i] = round(soft_clip(acc[i] * g)), with g = fma(step, i + 1, from):
+    /// a gain ramp applied ahead of the soft clip (see kSoftClipKnee).
+    /// Branch-free; never saturates.
+    void (*limit)(int16_t* dst, const float* acc, float from, float step, size_t n);
+
+    // Stereo: `acc` is `frames` interleaved L/R pairs
+
+    /// Mono source into a stereo bus:
+    /// acc[2i] = fma(src[i], left, acc[2i]), acc[2i+1] = fma(src[i], right, acc[2i+1])
+    void (*accumulate_panned)(float* acc, const int16_t* src,
+                              float left, float right, size_t frames);
+
+    /// Stereo source (interleaved) into a stereo bus:
+    /// acc[2i] = fma(src[2i], left, acc[2i]), acc[2i+1] = fma(src[2i+1], right, acc[2i+1])
+    void (*accumulate_balanced)(float* acc, const int16_t* src,
+                                float left, float right, size_t frames);
+
+    /// dst[i] = floor((src[2i] + src[2i+1]) / 2): interleaved stereo to mono
+    void (*downmix)(int16_t* dst, const int16_t* src, size_t frames);
+
+    /// Sum of src[i]^2, exact (silence detection)
+    uint64_t (*energy)(const int16_t* src, size_t n);
+};
+
+/// Kernels selected for this CPU (resolved once, on first call)
+const MixKernels& mix_kernels();
+
+/// Portable reference implementation
+const MixKernels& scalar_mix_kernels();
+
+} // namespace tutti
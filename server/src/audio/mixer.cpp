@@ -1,176 +1,560 @@
 #include "mixer.h"
+#include "mix_kernels.h"
+#include "session_recorder.h"
+#include "telemetry/trace.h"
 
 #include <algorithm>
-#include <cmath>
+#include <bitset>
 #include <cstring>
-#include <limits>
 
 namespace tutti {
 
+namespace {
+
+// Balance law: centre leaves both sides at unity, so a centred source
+// sounds as it does in a mono mix; panning attenuates the far side only
+void pan_gains(float pan, float gain, float& left, float& right) {
+    left = gain * std::min(1.0f, 1.0f - pan);
+    right = gain * std::min(1.0f, 1.0f + pan);
+}
+
+uint32_t float_bits(float f) {
+    uint32_t u;
+    std::memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+// One multiply-xorshift round of a mix signature. Groups compare in full on
+// a match, so a collision only costs a comparison.
+uint64_t signature_step(uint64_t h, uint64_t v) {
+    h = (h ^ v) * 0x9e3779b97f4a7c15ull;
+    return h ^ (h >> 29);
+}
+
+} // namespace
+
 Mixer::Mixer(size_t max_participants)
-    : max_participants_(max_participants) {
-    // Pre-allocate temp buffers
-    input_frames_.resize(max_participants);
-    active_ids_.reserve(max_participants);
-    has_input_.resize(max_participants, false);
-    active_states_.reserve(max_participants);
+    : max_participants_(std::min(max_participants, kMaxSlots)),
+      slots_(new std::atomic<ParticipantMixState*>[max_participants_]),
+      gain_matrix_(new GainCell[max_participants_ * max_participants_]) {
+    // Slot state waits for the first occupant; temp buffers are allocated now
+    for (size_t i = 0; i < max_participants_; ++i) {
+        slots_[i].store(nullptr, std::memory_order_relaxed);
+    }
+    inputs_.resize(max_participants_, nullptr);
+    input_channels_.resize(max_participants_, 1);
+    mono_frames_.resize(max_participants_);
+    listener_channels_.resize(max_participants_, 1);
+    limiters_.resize(max_participants_);
+    has_input_.resize(max_participants_, false);
+    quiet_input_.resize(max_participants_, false);
+    active_slots_.reserve(max_participants_);
+    corrections_.reserve(max_participants_ * max_participants_);
+    groups_.reserve(max_participants_);
+    seen_occupancy_.resize(max_participants_, 0);
+    seen_occupied_.resize(max_participants_, false);
+}
+
+Mixer::~Mixer() {
+    for (size_t i = 0; i < max_participants_; ++i) {
+        delete slots_[i].load(std::memory_order_relaxed);
+    }
 }
 
-void Mixer::add_participant(const std::string& id) {
+ParticipantSlot Mixer::add_participant(const std::string& id) {
     std::lock_guard<std::mutex> lock(participants_mutex_);
-    if (participants_.size() >= max_participants_) return;
-    participants_[id] = std::make_shared<ParticipantMixState>(id);
+    if (ids_.size() >= max_participants_) return {};
+    if (ids_.count(id)) return {};
+
+    uint64_t table = slot_table_.load(std::memory_order_relaxed);
+    uint32_t mask = table_mask(table);
+
+    // Round-robin from the last allocation so a just-freed slot is reused last
+    uint32_t index = ParticipantSlot::kInvalid;
+    for (size_t i = 0; i < max_participants_; ++i) {
+        uint32_t candidate = static_cast<uint32_t>((next_slot_ + i) % max_participants_);
+        if (!(mask & (1u << candidate))) {
+            index = candidate;
+            break;
+        }
+    }
+    if (index == ParticipantSlot::kInvalid) return {};
+    next_slot_ = static_cast<uint32_t>((index + 1) % max_participants_);
+
+    // First occupant of the slot: its queues are allocated here, on the
+    // control path, and published before the slot bit below
+    ParticipantMixState* existing = slots_[index].load(std::memory_order_relaxed);
+    if (!existing) {
+        existing = new ParticipantMixState();
+        slots_[index].store(existing, std::memory_order_release);
+    }
+
+    uint32_t epoch = table_epoch(table) + 1;
+    auto& state = *existing;
+    state.id = id;
+    state.generation.store(epoch, std::memory_order_relaxed);
+    state.output_drops.store(0, std::memory_order_relaxed);
+    state.output_channels.store(1, std::memory_order_relaxed);
+    state.occupancy.fetch_add(1, std::memory_order_relaxed);
+    reset_gains(index);
+    ids_[id] = index;
+
+    // Publish: state and gains are visible before the slot bit
+    mask |= (1u << index);
+    slot_table_.store((static_cast<uint64_t>(epoch) << 32) | mask,
+                      std::memory_order_release);
+    return {index, epoch};
 }
 
 void Mixer::remove_participant(const std::string& id) {
     std::lock_guard<std::mutex> lock(participants_mutex_);
-    participants_.erase(id);
+    auto it = ids_.find(id);
+    if (it == ids_.end()) return;
+
+    uint32_t index = it->second;
+    ids_.erase(it);
+
+    uint64_t table = slot_table_.load(std::memory_order_relaxed);
+    uint32_t epoch = table_epoch(table) + 1;
+    uint32_t mask = table_mask(table) & ~(1u << index);
+
+    // Invalidate outstanding handles, then publish the new table.
+    // Queued frames are drained by the mixer thread when it observes the change.
+    state(index)->generation.store(0, std::memory_order_relaxed);
+    state(index)->id.clear();
+    reset_gains(index);
+    slot_table_.store((static_cast<uint64_t>(epoch) << 32) | mask,
+                      std::memory_order_release);
+}
+
+ParticipantSlot Mixer::slot_of(const std::string& id) const {
+    std::lock_guard<std::mutex> lock(participants_mutex_);
+    auto it = ids_.find(id);
+    if (it == ids_.end()) return {};
+    return {it->second, state(it->second)->generation.load(std::memory_order_relaxed)};
+}
+
+ParticipantSlot Mixer::slot_at(uint32_t index) const {
+    const ParticipantMixState* s = index < max_participants_ ? state(index) : nullptr;
+    const uint32_t generation = s ? s->generation.load(std::memory_order_acquire) : 0;
+    if (generation == 0) return {};
+    return {index, generation};
+}
 
-    std::lock_guard<std::mutex> glock(gains_mutex_);
-    gains_.erase(id);
-    for (auto& [listener, source_map] : gains_) {
-        source_map.erase(id);
+bool Mixer::is_current(ParticipantSlot slot) const {
+    if (slot.index >= max_participants_) return false;
+    const ParticipantMixState* s = state(slot.index);
+    return s && s->generation.load(std::memory_order_acquire) == slot.generation;
+}
+
+void Mixer::reset_gains(size_t slot) {
+    for (size_t other = 0; other < max_participants_; ++other) {
+        gain_cell(slot, other).reset();
+        gain_cell(other, slot).reset();
     }
 }
 
-void Mixer::set_gain(const std::string& listener_id,
+bool Mixer::set_gain(const std::string& listener_id,
                      const std::string& source_id,
-                     float gain) {
-    std::lock_guard<std::mutex> lock(gains_mutex_);
-    gains_[listener_id][source_id].gain = std::clamp(gain, 0.0f, 1.0f);
+                     float gain,
+                     float* previous) {
+    std::lock_guard<std::mutex> lock(participants_mutex_);
+    auto lit = ids_.find(listener_id);
+    auto sit = ids_.find(source_id);
+    if (lit == ids_.end() || sit == ids_.end()) return false;
+    float old = gain_cell(lit->second, sit->second)
+        .gain.exchange(std::clamp(gain, 0.0f, 1.0f), std::memory_order_relaxed);
+    if (previous) *previous = old;
+    return true;
 }
 
-void Mixer::set_mute(const std::string& listener_id,
+bool Mixer::set_mute(const std::string& listener_id,
                      const std::string& source_id,
-                     bool muted) {
-    std::lock_guard<std::mutex> lock(gains_mutex_);
-    gains_[listener_id][source_id].muted = muted;
+                     bool muted,
+                     bool* previous) {
+    std::lock_guard<std::mutex> lock(participants_mutex_);
+    auto lit = ids_.find(listener_id);
+    auto sit = ids_.find(source_id);
+    if (lit == ids_.end() || sit == ids_.end()) return false;
+    bool old = gain_cell(lit->second, sit->second).muted.exchange(muted, std::memory_order_relaxed);
+    if (previous) *previous = old;
+    return true;
+}
+
+bool Mixer::set_pan(const std::string& listener_id,
+                    const std::string& source_id,
+                    float pan,
+                    float* previous) {
+    std::lock_guard<std::mutex> lock(participants_mutex_);
+    auto lit = ids_.find(listener_id);
+    auto sit = ids_.find(source_id);
+    if (lit == ids_.end() || sit == ids_.end()) return false;
+    float old = gain_cell(lit->second, sit->second)
+        .pan.exchange(std::clamp(pan, -1.0f, 1.0f), std::memory_order_relaxed);
+    if (previous) *previous = old;
+    return true;
+}
+
+void Mixer::set_output_channels(const std::string& id, uint8_t channels) {
+    std::lock_guard<std::mutex> lock(participants_mutex_);
+    auto it = ids_.find(id);
+    if (it == ids_.end()) return;
+    state(it->second)->output_channels.store(channels == 2 ? 2 : 1, std::memory_order_relaxed);
 }
 
 GainEntry Mixer::get_gain_entry(const std::string& listener_id,
                                  const std::string& source_id) {
-    std::lock_guard<std::mutex> lock(gains_mutex_);
-    auto lit = gains_.find(listener_id);
-    if (lit == gains_.end()) return {};
-    auto sit = lit->second.find(source_id);
-    if (sit == lit->second.end()) return {};
-    return sit->second;
+    uint32_t listener_slot, source_slot;
+    {
+        std::lock_guard<std::mutex> lock(participants_mutex_);
+        auto lit = ids_.find(listener_id);
+        auto sit = ids_.find(source_id);
+        if (lit == ids_.end() || sit == ids_.end()) return {};
+        listener_slot = lit->second;
+        source_slot = sit->second;
+    }
+    return get_gain_entry(listener_slot, source_slot);
 }
 
-bool Mixer::push_input(const std::string& participant_id,
-                       const AudioFrame& frame) {
-    std::lock_guard<std::mutex> lock(participants_mutex_);
-    auto it = participants_.find(participant_id);
-    if (it == participants_.end()) return false;
-    return it->second->input_queue.try_push(frame);
+GainEntry Mixer::get_gain_entry(uint32_t listener_slot, uint32_t source_slot) const {
+    if (listener_slot >= max_participants_ || source_slot >= max_participants_) return {};
+    const auto& cell = gain_cell(listener_slot, source_slot);
+    return {cell.gain.load(std::memory_order_relaxed),
+            cell.muted.load(std::memory_order_relaxed),
+            cell.pan.load(std::memory_order_relaxed)};
 }
 
-bool Mixer::pop_output(const std::string& participant_id,
-                       AudioFrame& frame) {
-    std::lock_guard<std::mutex> lock(participants_mutex_);
-    auto it = participants_.find(participant_id);
-    if (it == participants_.end()) return false;
-    return it->second->output_queue.try_pop(frame);
+bool Mixer::push_input(ParticipantSlot slot, const AudioFrame& frame) {
+    TUTTI_TRACE_ARG("mixer.push_input", slot.index);
+    if (!is_current(slot)) return false;
+    return state(slot.index)->input_queue.push(frame);
+}
+
+bool Mixer::push_input(ParticipantSlot slot, const uint8_t* datagram,
+                       uint8_t channels, bool silent) {
+    TUTTI_TRACE_ARG("mixer.push_input", slot.index);
+    if (!is_current(slot)) return false;
+    return state(slot.index)->input_queue.push_datagram(datagram, channels, silent);
+}
+
+bool Mixer::pop_output(ParticipantSlot slot, AudioFrame& frame) {
+    if (!is_current(slot)) return false;
+    return state(slot.index)->output_queue.try_pop(frame);
+}
+
+const AudioFrame* Mixer::front_output(ParticipantSlot slot) {
+    if (!is_current(slot)) return nullptr;
+    return state(slot.index)->output_queue.front();
+}
+
+void Mixer::pop_front_output(ParticipantSlot slot) {
+    if (slot.index < max_participants_) state(slot.index)->output_queue.pop();
+}
+
+bool Mixer::push_input(const std::string& participant_id, const AudioFrame& frame) {
+    return push_input(slot_of(participant_id), frame);
+}
+
+bool Mixer::pop_output(const std::string& participant_id, AudioFrame& frame) {
+    return pop_output(slot_of(participant_id), frame);
+}
+
+void Mixer::drain(uint32_t slot) {
+    ParticipantMixState* s = state(slot);
+    if (!s) return;  // never occupied
+    s->input_queue.reset();
+    while (s->output_queue.front()) s->output_queue.pop();
+    limiters_[slot].reset();
 }
 
 void Mixer::mix_cycle() {
-    // Snapshot participant IDs and shared_ptrs — single lock acquisition
-    active_ids_.clear();
-    active_states_.clear();
-    {
-        std::lock_guard<std::mutex> lock(participants_mutex_);
-        for (auto& [id, state] : participants_) {
-            active_ids_.push_back(id);
-            active_states_.push_back(state);
+    TUTTI_TRACE("mixer.mix_cycle");
+    // Snapshot the slot table — one atomic load, no lock
+    uint32_t mask = table_mask(slot_table_.load(std::memory_order_acquire));
+    recorder_cycle_ = recorder_.load(std::memory_order_acquire);
+    if (recorder_cycle_) recorder_cycle_->begin_cycle();
+
+    active_slots_.clear();
+    for (uint32_t i = 0; i < max_participants_; ++i) {
+        if (!(mask & (1u << i))) {
+            // Occupant left: drop whatever they still had queued
+            if (seen_occupied_[i]) {
+                drain(i);
+                seen_occupied_[i] = false;
+            }
+            continue;
+        }
+
+        // Slot changed hands since the last cycle. Drain if an earlier
+        // occupant may have left frames behind (seen here, or never seen).
+        uint32_t occ = state(i)->occupancy.load(std::memory_order_acquire);
+        if (occ != seen_occupancy_[i]) {
+            if (seen_occupied_[i] || occ - seen_occupancy_[i] > 1) drain(i);
+            seen_occupancy_[i] = occ;
+            seen_occupied_[i] = true;
         }
+        active_slots_.push_back(i);
     }
 
-    const size_t n = active_ids_.size();
+    const size_t n = active_slots_.size();
     if (n == 0) return;
 
-    // Pop one frame per participant per cycle (SPSC queues are lock-free)
+    // One frame per participant per cycle, in sequence order: a received
+    // frame, or a concealment frame for a loss (jitter buffers are lock-free)
+    size_t quiet = 0;
+    bool stereo_sources = false;
     for (size_t i = 0; i < n; ++i) {
-        has_input_[i] = false;
-        AudioFrame frame;
-        if (active_states_[i]->input_queue.try_pop(frame)) {
-            input_frames_[i] = frame.samples;
-            has_input_[i] = true;
+        const AudioFrame* frame;
+        bool popped = state(active_slots_[i])->input_queue.front(frame) !=
+                      JitterBuffer::PopResult::None;
+        inputs_[i] = frame;
+        quiet_input_[i] = popped && frame->silent;
+        has_input_[i] = popped && !frame->silent;
+        if (has_input_[i]) {
+            input_channels_[i] = frame->channels;
+            stereo_sources |= frame->channels == 2;
+        }
+        if (quiet_input_[i]) ++quiet;
+        if (recorder_cycle_ && popped) {
+            const uint32_t slot = active_slots_[i];
+            recorder_cycle_->record_input(
+                slot, state(slot)->generation.load(std::memory_order_relaxed), *frame);
         }
     }
 
-    // Snapshot gains
-    std::unordered_map<std::string,
-                       std::unordered_map<std::string, GainEntry>> gains_snapshot;
-    {
-        std::lock_guard<std::mutex> lock(gains_mutex_);
-        gains_snapshot = gains_;
+    mix_outputs(n, quiet, stereo_sources);
+
+    // Done reading the inputs: hand their cells back to the jitter buffers
+    for (size_t i = 0; i < n; ++i) state(active_slots_[i])->input_queue.pop();
+}
+
+void Mixer::mix_outputs(size_t n, size_t quiet, bool stereo_sources) {
+    // Which mixes this cycle builds: mono, stereo, or both
+    const uint32_t direct = direct_listeners_.load(std::memory_order_relaxed);
+    bool mono_listeners = false;
+    bool stereo_listeners = false;
+    for (size_t i = 0; i < n; ++i) {
+        if (direct & (1u << active_slots_[i])) continue;
+        listener_channels_[i] = state(active_slots_[i])->output_channels.load(std::memory_order_relaxed);
+        (listener_channels_[i] == 2 ? stereo_listeners : mono_listeners) = true;
     }
 
-    // For each listener, produce a mix of all other participants
-    for (size_t listener_idx = 0; listener_idx < n; ++listener_idx) {
-        const auto& listener_id = active_ids_[listener_idx];
+    const MixKernels& k = mix_kernels();
 
-        AudioFrame output;
-        output.sequence = 0; // Will be set by transport
-        output.timestamp = 0;
+    // Sum every source once. Each listener's mix is then the total minus
+    // their own input, plus corrections only for sources at non-unity gain
+    // (or, in stereo, panned off centre).
+    total_.fill(0.0f);
+    size_t senders = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (!has_input_[i]) continue;
+        ++senders;
+        if (input_channels_[i] == 1) k.accumulate(total_.data(), input_view(i), kSamplesPerFrame);
+    }
+    if (senders == 0 && quiet == 0) return;
 
-        // Accumulate in int32 to avoid overflow
-        std::array<int32_t, kSamplesPerFrame> accum{};
+    if (stereo_listeners) {
+        // Mono sources sit centred: the same sum on both sides
+        for (size_t s = 0; s < kSamplesPerFrame; ++s) {
+            stereo_total_[2 * s] = stereo_total_[2 * s + 1] = total_[s];
+        }
+        for (size_t i = 0; i < n; ++i) {
+            if (has_input_[i] && input_channels_[i] == 2) {
+                k.accumulate(stereo_total_.data(), input_view(i), 2 * kSamplesPerFrame);
+            }
+        }
+    }
+    if (mono_listeners && stereo_sources) {
+        for (size_t i = 0; i < n; ++i) {
+            if (!has_input_[i] || input_channels_[i] != 2) continue;
+            k.downmix(mono_frames_[i].data(), input_view(i), kSamplesPerFrame);
+            k.accumulate(total_.data(), mono_frames_[i].data(), kSamplesPerFrame);
+        }
+    }
 
-        bool any_input = false;
-        auto gains_it = gains_snapshot.find(listener_id);
+    corrections_.clear();
+    groups_.clear();
+    for (size_t listener_idx = 0; listener_idx < n; ++listener_idx) {
+        const uint32_t listener_slot = active_slots_[listener_idx];
+        if (direct & (1u << listener_slot)) continue;  // forwarded by the room
+        const bool stereo = listener_channels_[listener_idx] == 2;
 
+        // Sources audible to this listener, and which of them need a
+        // correction — their own input included — in source order. The
+        // signature hashes what decides the mix, to find an identical one.
+        size_t contributing = senders;
+        bool hears_quiet = false;
+        const size_t first = corrections_.size();
+        uint64_t signature = stereo;
+        auto correct = [&](size_t source_idx, float left, float right) {
+            corrections_.push_back({source_idx, left, right});
+            signature = signature_step(
+                signature, (uint64_t{float_bits(left)} << 32 | float_bits(right)) + source_idx);
+        };
         for (size_t source_idx = 0; source_idx < n; ++source_idx) {
-            if (source_idx == listener_idx) continue; // Skip own audio
-            if (!has_input_[source_idx]) continue;
-
-            const auto& source_id = active_ids_[source_idx];
-
-            // Get gain for this source in this listener's mix
-            float gain = 1.0f;
-            bool muted = false;
-            if (gains_it != gains_snapshot.end()) {
-                auto src_it = gains_it->second.find(source_id);
-                if (src_it != gains_it->second.end()) {
-                    gain = src_it->second.gain;
-                    muted = src_it->second.muted;
+            if (!has_input_[source_idx] && !quiet_input_[source_idx]) continue;
+            if (source_idx == listener_idx) {
+                if (has_input_[source_idx]) {
+                    --contributing;
+                    correct(source_idx, kRemoveSource, kRemoveSource);
                 }
+                continue;
             }
 
-            if (muted || gain <= 0.0f) continue;
+            const auto& cell = gain_cell(listener_slot, active_slots_[source_idx]);
+            float gain = cell.gain.load(std::memory_order_relaxed);
+            bool muted = cell.muted.load(std::memory_order_relaxed);
+            float pan = stereo ? cell.pan.load(std::memory_order_relaxed) : 0.0f;
 
-            any_input = true;
-            for (size_t s = 0; s < kSamplesPerFrame; ++s) {
-                accum[s] += static_cast<int32_t>(
-                    std::lround(input_frames_[source_idx][s] * gain));
+            if (quiet_input_[source_idx]) {
+                hears_quiet |= !muted && gain > 0.0f;
+                continue;
+            }
+            if (muted || gain <= 0.0f) {
+                --contributing;
+                correct(source_idx, kRemoveSource, kRemoveSource);
+            } else if (gain != 1.0f || pan != 0.0f) {
+                float left, right;
+                pan_gains(pan, gain, left, right);
+                correct(source_idx, left - 1.0f, right - 1.0f);
             }
         }
+        const size_t count = corrections_.size() - first;
 
-        if (!any_input) continue;
+        if (contributing == 0 && !hears_quiet) {
+            corrections_.resize(first);
+            continue;
+        }
 
-        // Clamp to int16 range
-        for (size_t s = 0; s < kSamplesPerFrame; ++s) {
-            output.samples[s] = static_cast<int16_t>(
-                std::clamp(accum[s],
-                           static_cast<int32_t>(std::numeric_limits<int16_t>::min()),
-                           static_cast<int32_t>(std::numeric_limits<int16_t>::max())));
+        // Mix straight into the listener's output queue — no lock needed,
+        // SPSC is thread-safe. A full queue drops this cycle's mix.
+        AudioRingBuffer& queue = state(listener_slot)->output_queue;
+        AudioFrame* output = queue.back();
+        if (!output) {
+            corrections_.resize(first);
+            state(listener_slot)->output_drops.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        output->sequence = 0; // Will be set by transport
+        output->timestamp = 0;
+        output->channels = stereo ? 2 : 1;
+        output->room_total = false;
+
+        if (contributing == 0) {
+            // Everyone audible is resting: tell the listener it's silence, not loss
+            corrections_.resize(first);
+            output->silent = true;
+            std::fill_n(output->samples.begin(), output->sample_count(), int16_t{0});
+            publish_output(listener_slot, *output);
+            continue;
+        }
+        output->silent = false;
+
+        // Same corrections and limiter state as a mix already built this
+        // cycle: the result is identical, so copy it
+        const float limiter_gain = limiters_[listener_slot].gain();
+        signature = signature_step(signature, float_bits(limiter_gain));
+        const MixGroup* group = nullptr;
+        for (const auto& g : groups_) {
+            if (g.signature == signature && g.stereo == stereo &&
+                g.limiter_gain == limiter_gain && g.count == count &&
+                std::equal(corrections_.begin() + g.first, corrections_.begin() + g.first + count,
+                           corrections_.begin() + first)) {
+                group = &g;
+                break;
+            }
+        }
+        if (group) {
+            corrections_.resize(first);
+            *output = *group->output;
+            limiters_[listener_slot] = limiters_[group->leader_slot];
+            publish_output(listener_slot, *output);
+            shared_mixes_.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        if (!stereo) {
+            std::copy(total_.begin(), total_.end(), accum_.begin());
+            for (size_t c = first; c < first + count; ++c) {
+                const GainCorrection& term = corrections_[c];
+                const int16_t* src = mono_view(term.source_idx);
+                if (term.left == kRemoveSource) {
+                    k.subtract(accum_.data(), src, kSamplesPerFrame);
+                } else {
+                    k.accumulate_scaled(accum_.data(), src, term.left, kSamplesPerFrame);
+                }
+            }
+        } else {
+            std::copy(stereo_total_.begin(), stereo_total_.end(), accum_.begin());
+            for (size_t c = first; c < first + count; ++c) {
+                const GainCorrection& term = corrections_[c];
+                const int16_t* src = input_view(term.source_idx);
+                if (input_channels_[term.source_idx] == 1) {
+                    k.accumulate_panned(accum_.data(), src, term.left, term.right, kSamplesPerFrame);
+                } else if (term.left == kRemoveSource && term.right == kRemoveSource) {
+                    k.subtract(accum_.data(), src, 2 * kSamplesPerFrame);
+                } else {
+                    k.accumulate_balanced(accum_.data(), src, term.left, term.right, kSamplesPerFrame);
+                }
+            }
         }
 
-        // Push to listener's output queue — no lock needed, SPSC is thread-safe
-        active_states_[listener_idx]->output_queue.try_push(std::move(output));
+        // Back to int16, with this listener's limiter taming any overs
+        limiters_[listener_slot].process(k, output->samples.data(), accum_.data(),
+                                         output->sample_count());
+        output->room_total = !stereo && count == 0;
+        groups_.push_back({signature, first, count, stereo, limiter_gain, listener_slot, output});
+        publish_output(listener_slot, *output);
+    }
+}
+
+void Mixer::publish_output(uint32_t slot, const AudioFrame& mix) {
+    if (recorder_cycle_) {
+        recorder_cycle_->record_mix(slot, state(slot)->generation.load(std::memory_order_relaxed), mix);
     }
+    state(slot)->output_queue.push();
+}
+
+void Mixer::clear_queues() {
+    for (uint32_t i = 0; i < max_participants_; ++i) drain(i);
+}
+
+JitterStats Mixer::jitter_stats(uint32_t slot) const {
+    const ParticipantMixState* s = slot < max_participants_ ? state(slot) : nullptr;
+    return s ? s->input_queue.stats() : JitterStats{};
+}
+
+size_t Mixer::output_depth(uint32_t slot) const {
+    const ParticipantMixState* s = slot < max_participants_ ? state(slot) : nullptr;
+    return s ? s->output_queue.size_approx() : 0;
+}
+
+uint64_t Mixer::shared_mixes() const {
+    return shared_mixes_.load(std::memory_order_relaxed);
+}
+
+uint64_t Mixer::output_drops(uint32_t slot) const {
+    const ParticipantMixState* s = slot < max_participants_ ? state(slot) : nullptr;
+    return s ? s->output_drops.load(std::memory_order_relaxed) : 0;
+}
+
+size_t Mixer::allocated_slots() const {
+    size_t n = 0;
+    for (size_t i = 0; i < max_participants_; ++i) {
+        n += state(i) != nullptr;
+    }
+    return n;
 }
 
 size_t Mixer::participant_count() const {
-    std::lock_guard<std::mutex> lock(participants_mutex_);
-    return participants_.size();
+    return std::bitset<32>(table_mask(slot_table_.load(std::memory_order_acquire))).count();
 }
 
 std::vector<std::string> Mixer::participant_ids() const {
     std::lock_guard<std::mutex> lock(participants_mutex_);
     std::vector<std::string> ids;
-    ids.reserve(participants_.size());
-    for (const auto& [id, _] : participants_) {
+    ids.reserve(ids_.size());
+    for (const auto& [id, _] : ids_) {
         ids.push_back(id);
     }
     return ids;
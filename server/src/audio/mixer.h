@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <mutex>
@@ -8,102 +9,329 @@
 #include <unordered_map>
 #include <vector>
 
+#include "jitter_buffer.h"
 #include "ring_buffer.h"
+#include "soft_limiter.h"
 #include "transport/transport_interface.h"
 
 namespace tutti {
 
+class SessionRecorder;
+
 /// Per-participant mix state.
-/// Not copyable/movable because AudioRingBuffer wraps rigtorp::SPSCQueue.
-/// Stored via shared_ptr so the mixer thread can snapshot pointers without
-/// holding the participants mutex during queue operations.
+/// Not copyable/movable: JitterBuffer and AudioRingBuffer hold atomics.
+/// Allocated when its slot is first occupied and owned by the Mixer from
+/// then on, so the network and mixer threads can hold raw pointers to it
+/// without a lock.
 struct ParticipantMixState {
-    std::string id;
-    float gain = 1.0f;           // 0.0 - 1.0
-    bool muted = false;
-    AudioRingBuffer input_queue;  // Network → Mixer
+    std::string id;                        // guarded by Mixer::participants_mutex_
+    std::atomic<uint32_t> generation{0};   // slot-table epoch when added, 0 = free
+    std::atomic<uint32_t> occupancy{0};    // times this slot has been assigned
+    JitterBuffer input_queue;     // Network → Mixer (reorders, conceals)
     AudioRingBuffer output_queue; // Mixer → Network
+    std::atomic<uint64_t> output_drops{0};  // mixes lost to a full output_queue
+    std::atomic<uint8_t> output_channels{1};  // 1 = mono mix, 2 = interleaved stereo
 
-    explicit ParticipantMixState(const std::string& participant_id)
-        : id(participant_id) {}
+    ParticipantMixState() = default;
 
     ParticipantMixState(const ParticipantMixState&) = delete;
     ParticipantMixState& operator=(const ParticipantMixState&) = delete;
 };
 
-/// Per-user gain setting: how loud participant B is in participant A's mix
+/// Per-user gain setting: how loud participant B is in participant A's mix,
+/// and where they sit in it (-1 = left, 0 = centre, +1 = right; stereo
+/// listeners only)
 struct GainEntry {
     float gain = 1.0f;
     bool muted = false;
+    float pan = 0.0f;
+};
+
+/// One cell of the gain matrix. Written by control threads, read by the
+/// mixer with relaxed loads — no lock, no allocation on the RT path.
+struct GainCell {
+    std::atomic<float> gain{1.0f};
+    std::atomic<bool> muted{false};
+    std::atomic<float> pan{0.0f};
+
+    void reset() {
+        gain.store(1.0f, std::memory_order_relaxed);
+        muted.store(false, std::memory_order_relaxed);
+        pan.store(0.0f, std::memory_order_relaxed);
+    }
 };
 
 /// Audio mixer for a single room.
 /// Produces a custom mix for each participant (sum of all others * their gain).
+/// Computed as sum-minus-self: the room total is accumulated once, and each
+/// listener only pays extra for sources they've turned down or muted.
+/// Frames flagged silent are never summed; a listener who can only hear
+/// silent sources gets a silent output frame without any mixing. Outputs
+/// that are exactly the room total (a listener not sending, at unity
+/// gains) are flagged so the room can encode them once for all of them.
 /// Designed to run on a dedicated RT-priority thread.
 ///
-/// All methods called from the mixer thread must be lock-free / wait-free.
-/// Participant add/remove uses a separate mutex (not on the audio path).
+/// Sources may be mono or stereo (AudioFrame::channels), and each listener
+/// gets a mono or stereo mix. Stereo listeners have their own total:
+/// mono sources sit centred on both sides, stereo sources as sent, and a
+/// pan is just another per-listener correction. Mono listeners hear
+/// stereo sources downmixed. Pan follows a balance law, so a centred
+/// source is as loud as in a mono mix.
+///
+/// The mix bus is float32: sources are summed (gains as fused
+/// multiply-adds) without rounding, and each listener's mix passes through
+/// their own SoftLimiter once, on the way back to int16, so several loud
+/// players compress smoothly instead of hard clipping.
+///
+/// Listeners whose mixes come out the same — same channel count, same
+/// corrections to the total (their own input counts as one), same limiter
+/// state — share one: it is built for the first of them and copied to the
+/// rest. Listen-only participants at default gains all hear the room
+/// total, so an audience costs a copy per head, not a mix.
+///
+/// Nothing is copied between the queues: inputs are summed where the jitter
+/// buffers hold them, and each limiter writes straight into a slot of the
+/// listener's output queue, whose frames are already laid out as datagrams.
+///
+/// Participants occupy fixed slots. Add/remove (under a mutex, not on the
+/// audio path) publish a new slot table — an occupancy mask plus epoch in a
+/// single atomic word — so push_input, pop_output and mix_cycle never lock.
 class Mixer {
 public:
+    /// Slot occupancy is a 32-bit mask
+    static constexpr size_t kMaxSlots = 32;
+
     explicit Mixer(size_t max_participants = 8);
+    ~Mixer();
+
+    Mixer(const Mixer&) = delete;
+    Mixer& operator=(const Mixer&) = delete;
 
     /// Add a participant. NOT called from RT thread.
-    void add_participant(const std::string& id);
+    /// Returns an invalid slot if the mixer is full or the ID is present.
+    ParticipantSlot add_participant(const std::string& id);
 
     /// Remove a participant. NOT called from RT thread.
     void remove_participant(const std::string& id);
 
-    /// Set gain for how loud `source_id` sounds in `listener_id`'s mix.
-    /// Can be called from any thread (atomic float write).
-    void set_gain(const std::string& listener_id,
+    /// Current slot for a participant (invalid if absent). Takes the mutex.
+    ParticipantSlot slot_of(const std::string& id) const;
+
+    /// True if `slot` still refers to the participant it was issued for
+    bool is_current(ParticipantSlot slot) const;
+
+    /// Handle for whoever occupies slot `index` now (invalid if free). Lock-free.
+    ParticipantSlot slot_at(uint32_t index) const;
+
+    /// Set gain for how loud `source_id` sounds in `listener_id`'s mix,
+    /// clamped to [0, 1]. Can be called from any thread (atomic exchange in
+    /// the matrix); `previous` receives the value it replaced.
+    /// Ignored (false) unless both participants are present.
+    bool set_gain(const std::string& listener_id,
                   const std::string& source_id,
-                  float gain);
+                  float gain,
+                  float* previous = nullptr);
 
-    /// Set mute state for `source_id` in `listener_id`'s mix.
-    void set_mute(const std::string& listener_id,
+    /// Set mute state for `source_id` in `listener_id`'s mix (atomic exchange).
+    bool set_mute(const std::string& listener_id,
                   const std::string& source_id,
-                  bool muted);
+                  bool muted,
+                  bool* previous = nullptr);
+
+    /// Set where `source_id` sits in `listener_id`'s stereo mix, clamped to
+    /// [-1, 1] (atomic exchange). Has no effect on a mono mix.
+    bool set_pan(const std::string& listener_id,
+                 const std::string& source_id,
+                 float pan,
+                 float* previous = nullptr);
+
+    /// Mix for a participant in mono (1) or interleaved stereo (2).
+    /// Resets to mono when the slot is reassigned. Ignored unless present.
+    void set_output_channels(const std::string& id, uint8_t channels);
 
     /// Get gain entry for a source in a listener's mix. Thread-safe.
     GainEntry get_gain_entry(const std::string& listener_id,
                               const std::string& source_id);
 
-    /// Push an incoming audio frame from a participant.
-    /// Called from the network receive thread.
-    bool push_input(const std::string& participant_id, const AudioFrame& frame);
+    /// Get gain entry by slot index. Lock-free.
+    GainEntry get_gain_entry(uint32_t listener_slot, uint32_t source_slot) const;
+
+    /// Push an incoming audio frame from a participant into their jitter
+    /// buffer. Called from the network receive thread. Lock-free.
+    /// Returns false if the frame was rejected (stale slot, late, duplicate).
+    bool push_input(ParticipantSlot slot, const AudioFrame& frame);
 
-    /// Pop an outgoing mixed frame for a participant.
-    /// Called from the network send thread.
+    /// Push a PCM datagram straight into the participant's jitter buffer,
+    /// without building a frame first. Lock-free.
+    bool push_input(ParticipantSlot slot, const uint8_t* datagram, uint8_t channels, bool silent);
+
+    /// Pop an outgoing mixed frame for a participant (a copy).
+    /// Called from the network send thread. Lock-free.
+    bool pop_output(ParticipantSlot slot, AudioFrame& frame);
+
+    /// The next outgoing mixed frame for a participant, read in place
+    /// (nullptr if none). Release it with pop_front_output(). Lock-free.
+    const AudioFrame* front_output(ParticipantSlot slot);
+    void pop_front_output(ParticipantSlot slot);
+
+    /// ID-keyed convenience overloads: resolve the slot under the mutex.
+    /// Not for the per-packet path.
+    bool push_input(const std::string& participant_id, const AudioFrame& frame);
     bool pop_output(const std::string& participant_id, AudioFrame& frame);
 
     /// Process one mix cycle: read all inputs, produce all outputs.
     /// Called from the RT mixer thread. Must be lock-free.
     void mix_cycle();
 
-    /// Get current participant count
+    /// Discard all queued input and output frames.
+    /// Called from the RT mixer thread (the consumer of both queues).
+    void clear_queues();
+
+    /// Jitter buffer counters for a slot. Lock-free.
+    JitterStats jitter_stats(uint32_t slot) const;
+
+    /// Mixed frames waiting in a slot's output queue. Lock-free.
+    size_t output_depth(uint32_t slot) const;
+
+    /// Mixed frames dropped because a slot's output queue was full. Lock-free.
+    uint64_t output_drops(uint32_t slot) const;
+
+    /// Outputs copied from an identical mix built the same cycle. Lock-free.
+    uint64_t shared_mixes() const;
+
+    /// Slots that have had an occupant, and so hold queues. Lock-free.
+    size_t allocated_slots() const;
+
+    /// Get current participant count. Lock-free.
     size_t participant_count() const;
 
+    /// Listeners (bit per slot) whose audio the room forwards directly from
+    /// their single audible source; mix_cycle produces no output for them.
+    /// Set from the control path, read by the mixer. Lock-free.
+    void set_direct_listeners(uint32_t mask) {
+        direct_listeners_.store(mask, std::memory_order_relaxed);
+    }
+
+    /// Bit i set when slot i is occupied. Lock-free.
+    uint32_t occupied_mask() const {
+        return table_mask(slot_table_.load(std::memory_order_acquire));
+    }
+
     /// Get list of participant IDs
     std::vector<std::string> participant_ids() const;
 
+    /// Hand every cycle's inputs, and mixes, to `recorder` (nullptr stops).
+    /// Control path; takes effect from the next cycle.
+    void set_recorder(SessionRecorder* recorder) {
+        recorder_.store(recorder, std::memory_order_release);
+    }
+
 private:
+    static uint32_t table_mask(uint64_t table) { return static_cast<uint32_t>(table); }
+    static uint32_t table_epoch(uint64_t table) { return static_cast<uint32_t>(table >> 32); }
+
+    /// Gain matrix cell for `source` in `listener`'s mix
+    GainCell& gain_cell(size_t listener_slot, size_t source_slot) {
+        return gain_matrix_[listener_slot * max_participants_ + source_slot];
+    }
+    const GainCell& gain_cell(size_t listener_slot, size_t source_slot) const {
+        return gain_matrix_[listener_slot * max_participants_ + source_slot];
+    }
+
+    /// Reset a slot's row and column to unity gain, unmuted
+    void reset_gains(size_t slot);
+
+    /// Drain a slot's queues and reset its limiter (RT thread only)
+    void drain(uint32_t slot);
+
+    /// Build every listener's output from this cycle's inputs
+    void mix_outputs(size_t n, size_t quiet, bool stereo_sources);
+
+    /// Push a listener's filled output slot, recording the mix if asked to
+    void publish_output(uint32_t slot, const AudioFrame& mix);
+
     size_t max_participants_;
 
-    // Participant state indexed by ID
-    // Protected by mutex for add/remove; mixer thread snapshots shared_ptrs
-    std::unordered_map<std::string, std::shared_ptr<ParticipantMixState>> participants_;
+    // Fixed slot array, sized once. A slot's state is allocated by its
+    // first occupant (under participants_mutex_) and kept until the Mixer
+    // goes, so rooms nobody has joined hold no queues.
+    std::unique_ptr<std::atomic<ParticipantMixState*>[]> slots_;
+
+    /// A slot's state, nullptr until first occupied
+    ParticipantMixState* state(size_t slot) const {
+        return slots_[slot].load(std::memory_order_acquire);
+    }
+
+    // Published slot table: high 32 bits = epoch, low 32 bits = occupancy
+    std::atomic<uint64_t> slot_table_{0};
+
+    std::atomic<uint32_t> direct_listeners_{0};
+
+    // ID → slot index, for the control path only
+    std::unordered_map<std::string, uint32_t> ids_;
+    uint32_t next_slot_ = 0;  // round-robin allocation delays slot reuse
     mutable std::mutex participants_mutex_;
 
-    // Per-listener gain map: gains_[listener_id][source_id]
-    std::unordered_map<std::string,
-                       std::unordered_map<std::string, GainEntry>> gains_;
-    std::mutex gains_mutex_;
+    // Dense max_participants × max_participants gain matrix, indexed
+    // [listener_slot][source_slot]. Fixed at construction, never reallocated.
+    std::unique_ptr<GainCell[]> gain_matrix_;
+
+    /// Source samples as sent
+    const int16_t* input_view(size_t idx) const { return inputs_[idx]->samples.data(); }
+
+    /// Source samples for a mono mix: a stereo source's downmix
+    const int16_t* mono_view(size_t idx) const {
+        return input_channels_[idx] == 2 ? mono_frames_[idx].data() : input_view(idx);
+    }
 
     // Temporary buffers for mix cycle (pre-allocated, no allocations on RT path)
-    std::vector<std::array<int16_t, kSamplesPerFrame>> input_frames_;
-    std::vector<std::string> active_ids_;
-    std::vector<bool> has_input_;
-    std::vector<std::shared_ptr<ParticipantMixState>> active_states_;
+    std::vector<const AudioFrame*> inputs_;  // this cycle's frames, in their jitter buffer cells
+    std::vector<uint8_t> input_channels_;
+    std::vector<std::array<int16_t, kSamplesPerFrame>> mono_frames_;  // downmixed stereo inputs
+    std::vector<uint8_t> listener_channels_;
+    std::vector<bool> has_input_;     // a frame to mix this cycle
+    std::vector<bool> quiet_input_;   // a silent frame: present, but not mixed
+    std::vector<uint32_t> active_slots_;
+    std::array<float, kSamplesPerFrame> total_{};   // sum of every source this cycle
+    std::array<float, kSamplesPerFrame * 2> stereo_total_{};  // the same, interleaved L/R
+    std::array<float, kSamplesPerFrame * kMaxChannels> accum_{};  // one listener's mix
+    std::vector<SoftLimiter> limiters_;  // per listener slot
+
+    /// Per-listener adjustment to the total: add source * delta per side,
+    /// or remove the source entirely (their own input, muted, zero gain).
+    /// Mono mixes use `left` only.
+    struct GainCorrection {
+        size_t source_idx;
+        float left;
+        float right;
+
+        bool operator==(const GainCorrection& o) const {
+            return source_idx == o.source_idx && left == o.left && right == o.right;
+        }
+    };
+    static constexpr float kRemoveSource = -1.0f;
+    // This cycle's corrections, every mixed listener's in turn
+    std::vector<GainCorrection> corrections_;
+
+    /// A mix built this cycle, for listeners whose mix would be identical
+    struct MixGroup {
+        uint64_t signature;
+        size_t first;    // its corrections_ range
+        size_t count;
+        bool stereo;
+        float limiter_gain;  // before this cycle's block
+        uint32_t leader_slot;
+        const AudioFrame* output;  // in the leader's output queue
+    };
+    std::vector<MixGroup> groups_;
+
+    std::atomic<uint64_t> shared_mixes_{0};
+    std::atomic<SessionRecorder*> recorder_{nullptr};
+    SessionRecorder* recorder_cycle_ = nullptr;  // this cycle's, mixer thread only
+    // Mixer thread only: slot state as of the last cycle, used to drop a
+    // previous occupant's leftover frames when a slot changes hands
+    std::vector<uint32_t> seen_occupancy_;
+    std::vector<bool> seen_occupied_;
 };
 
 } // namespace tutti
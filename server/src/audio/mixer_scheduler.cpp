@@ -0,0 +1,432 @@
+#include "mixer_scheduler.h"
+#include "mix_kernels.h"
+#include "room.h"
+#include "telemetry/trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#ifdef __linux__
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace tutti {
+
+namespace {
+// One render quantum: 128 samples at 48kHz ≈ 2.67ms
+constexpr auto kMixQuantum = std::chrono::nanoseconds(
+    1000000000LL * static_cast<int64_t>(kSamplesPerFrame) / kSampleRate);
+
+std::vector<int> isolated_cpus() {
+#ifdef __linux__
+    std::ifstream f("/sys/devices/system/cpu/isolated");
+    std::string list;
+    if (f && std::getline(f, list)) {
+        return MixerScheduler::parse_cpu_list(list);
+    }
+#endif
+    return {};
+}
+} // namespace
+
+MixerScheduler::MixerScheduler(MixerSchedulerConfig config)
+    : config_(std::move(config)) {
+    size_t count = std::max<size_t>(1, config_.worker_count);
+
+    std::vector<int> cpus = config_.cpus;
+    if (cpus.empty()) cpus = isolated_cpus();
+    unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+
+    for (size_t i = 0; i < count; ++i) {
+        auto worker = std::make_unique<Worker>();
+        worker->index = i;
+        if (!cpus.empty()) {
+            worker->cpu = cpus[i % cpus.size()];
+        } else {
+            // Historical default: keep core 0 for the kernel and network threads
+            worker->cpu = static_cast<int>((1 + i) % hw);
+        }
+#ifdef __linux__
+        worker->wake_fd = eventfd(0, EFD_NONBLOCK);
+        if (worker->wake_fd < 0) {
+            std::cerr << "[Mixer:" << i << "] Warning: Could not create eventfd\n";
+        }
+        worker->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+        if (worker->timer_fd < 0) {
+            std::cerr << "[Mixer:" << i << "] Warning: Could not create timerfd, "
+                      << "falling back to poll timeouts\n";
+        }
+#endif
+        workers_.push_back(std::move(worker));
+    }
+}
+
+MixerScheduler::~MixerScheduler() {
+    stop();
+#ifdef __linux__
+    for (auto& w : workers_) {
+        if (w->wake_fd >= 0) ::close(w->wake_fd);
+        if (w->timer_fd >= 0) ::close(w->timer_fd);
+    }
+#endif
+}
+
+void MixerScheduler::start() {
+    if (running_) return;
+    running_ = true;
+    for (auto& w : workers_) {
+        w->thread = std::thread(&MixerScheduler::worker_func, this, std::ref(*w));
+    }
+    std::cout << "[Tutti] Mixer scheduler started (" << workers_.size()
+              << " worker" << (workers_.size() == 1 ? "" : "s") << ", "
+              << mix_kernels().name << " kernels)\n";
+}
+
+void MixerScheduler::stop() {
+    running_ = false;
+    for (auto& w : workers_) {
+        wake(*w);  // an idle worker is asleep on its eventfd
+        if (w->thread.joinable()) w->thread.join();
+    }
+}
+
+void MixerScheduler::wake(Worker& worker) {
+#ifdef __linux__
+    if (worker.wake_fd >= 0) {
+        uint64_t val = 1;
+        (void)::write(worker.wake_fd, &val, sizeof(val));
+    }
+#else
+    (void)worker;
+#endif
+}
+
+void MixerScheduler::add_room(std::shared_ptr<Room> room) {
+    if (!room) return;
+
+    // Least-loaded worker: fewest rooms needing mixing, then fewest rooms
+    Worker* target = nullptr;
+    std::pair<size_t, size_t> best{SIZE_MAX, SIZE_MAX};
+    for (auto& w : workers_) {
+        std::lock_guard<std::mutex> lock(w->rooms_mutex);
+        std::pair<size_t, size_t> load{0, w->rooms.size()};
+        for (const auto& r : w->rooms) load.first += r->needs_mixing();
+        if (load < best) {
+            best = load;
+            target = w.get();
+        }
+    }
+
+    room->set_wake_fd(target->wake_fd);
+    {
+        std::lock_guard<std::mutex> lock(target->rooms_mutex);
+        target->rooms.push_back(std::move(room));
+        target->rooms_version.fetch_add(1, std::memory_order_release);
+    }
+    wake(*target);  // the room may need mixing already
+}
+
+void MixerScheduler::remove_room(const Room* room) {
+    for (auto& w : workers_) {
+        std::lock_guard<std::mutex> lock(w->rooms_mutex);
+        auto it = std::find_if(w->rooms.begin(), w->rooms.end(),
+                               [room](const auto& r) { return r.get() == room; });
+        if (it != w->rooms.end()) {
+            (*it)->set_wake_fd(-1);
+            w->rooms.erase(it);
+            w->rooms_version.fetch_add(1, std::memory_order_release);
+            return;
+        }
+    }
+}
+
+size_t MixerScheduler::rebalance() {
+    size_t moves = 0;
+    for (size_t attempt = 0; attempt < 64 && workers_.size() > 1; ++attempt) {
+        // Busiest and idlest workers by rooms needing mixing
+        Worker* busiest = nullptr;
+        Worker* idlest = nullptr;
+        size_t most = 0;
+        size_t least = SIZE_MAX;
+        std::shared_ptr<Room> moving;
+        for (auto& w : workers_) {
+            std::lock_guard<std::mutex> lock(w->rooms_mutex);
+            size_t active = 0;
+            std::shared_ptr<Room> any;
+            for (const auto& r : w->rooms) {
+                if (r->needs_mixing()) {
+                    ++active;
+                    any = r;
+                }
+            }
+            if (!busiest || active > most) {
+                busiest = w.get();
+                most = active;
+                moving = std::move(any);
+            }
+            if (active < least) {
+                idlest = w.get();
+                least = active;
+            }
+        }
+        if (most < least + 2) break;
+
+        uint64_t version;
+        {
+            std::lock_guard<std::mutex> lock(busiest->rooms_mutex);
+            auto it = std::find(busiest->rooms.begin(), busiest->rooms.end(), moving);
+            if (it == busiest->rooms.end()) continue;  // removed meanwhile
+            busiest->rooms.erase(it);
+            version = busiest->rooms_version.fetch_add(1, std::memory_order_release) + 1;
+        }
+
+        // The old worker may be mid-pass on the room: wait for it to let go
+        wake(*busiest);
+        while (running_ && busiest->applied_version.load(std::memory_order_acquire) < version) {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+
+        moving->set_wake_fd(idlest->wake_fd);
+        {
+            std::lock_guard<std::mutex> lock(idlest->rooms_mutex);
+            idlest->rooms.push_back(std::move(moving));
+            idlest->rooms_version.fetch_add(1, std::memory_order_release);
+        }
+        wake(*idlest);
+        ++moves;
+    }
+    return moves;
+}
+
+size_t MixerScheduler::worker_of(const Room* room) const {
+    for (const auto& w : workers_) {
+        std::lock_guard<std::mutex> lock(w->rooms_mutex);
+        for (const auto& r : w->rooms) {
+            if (r.get() == room) return w->index;
+        }
+    }
+    return workers_.size();
+}
+
+MixClockStats MixerScheduler::clock_stats() const {
+    MixClockStats stats;
+    for (const auto& w : workers_) {
+        stats.early += w->early.load(std::memory_order_relaxed);
+        stats.on_time += w->on_time.load(std::memory_order_relaxed);
+        stats.late += w->late.load(std::memory_order_relaxed);
+        stats.wakeups += w->wakeups.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+std::vector<int> MixerScheduler::parse_cpu_list(const std::string& list) {
+    std::vector<int> cpus;
+    std::istringstream iss(list);
+    std::string part;
+    while (std::getline(iss, part, ',')) {
+        if (part.empty()) continue;
+        try {
+            auto dash = part.find('-');
+            if (dash == std::string::npos) {
+                cpus.push_back(std::stoi(part));
+            } else {
+                int lo = std::stoi(part.substr(0, dash));
+                int hi = std::stoi(part.substr(dash + 1));
+                for (int c = lo; c <= hi; ++c) cpus.push_back(c);
+            }
+        } catch (...) {
+            // Ignore malformed entries
+        }
+    }
+    return cpus;
+}
+
+void MixerScheduler::worker_func(Worker& worker) {
+    TUTTI_TRACE_THREAD("mixer-" + std::to_string(worker.index));
+#ifdef __linux__
+    // Set RT priority for mixer thread
+    struct sched_param param;
+    param.sched_priority = sched_get_priority_max(SCHED_FIFO);
+    if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) != 0) {
+        std::cerr << "[Mixer:" << worker.index << "] Warning: Could not set RT priority\n";
+    }
+
+    // Pin to this worker's core (improves cache locality, avoids sharing with other workers)
+    if (worker.cpu >= 0) {
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(worker.cpu, &cpuset);
+        pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+    }
+#endif
+
+    // Thread-local snapshot of assigned rooms (refreshed only on change)
+    std::vector<std::shared_ptr<Room>> rooms;
+    std::vector<uint8_t> mixed;   // mixed already in the current quantum
+    std::vector<uint8_t> active;  // needed mixing in the previous pass
+    uint64_t seen_version = UINT64_MAX;
+
+    // Every room's outputs for a pass, sent together after the last room mixes
+    DatagramBatch batch;
+
+    auto deadline = std::chrono::steady_clock::now() + kMixQuantum;
+    bool ticking = false;  // the quantum clock is running
+#ifdef __linux__
+    // Without an eventfd nothing could wake an idle worker: keep ticking
+    const bool can_idle = worker.wake_fd >= 0;
+
+    // Start the clock at `deadline`, or stop it. The timerfd is periodic
+    // from the first deadline; steady_clock is CLOCK_MONOTONIC, so
+    // `deadline` tracks the kernel's ticks exactly.
+    auto set_clock = [&worker, &deadline](bool run) {
+        if (worker.timer_fd < 0) return;
+        struct itimerspec spec {};
+        if (run) {
+            auto first = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                deadline.time_since_epoch()).count();
+            spec.it_value.tv_sec = static_cast<time_t>(first / 1000000000);
+            spec.it_value.tv_nsec = static_cast<long>(first % 1000000000);
+            spec.it_interval.tv_nsec = static_cast<long>(kMixQuantum.count());
+        }
+        if (timerfd_settime(worker.timer_fd, TFD_TIMER_ABSTIME, &spec, nullptr) != 0 && run) {
+            std::cerr << "[Mixer:" << worker.index << "] Warning: Could not arm timerfd\n";
+            ::close(worker.timer_fd);
+            worker.timer_fd = -1;
+        }
+    };
+#else
+    const bool can_idle = false;
+    auto set_clock = [](bool) {};
+#endif
+
+    while (running_) {
+        uint64_t version = worker.rooms_version.load(std::memory_order_acquire);
+        if (version != seen_version) {
+            std::lock_guard<std::mutex> lock(worker.rooms_mutex);
+            rooms = worker.rooms;
+            mixed.assign(rooms.size(), 0);
+            active.assign(rooms.size(), 0);
+            seen_version = version;
+            worker.applied_version.store(version, std::memory_order_release);
+        }
+
+        // A room started needing mixing (or the worker can't idle): run the
+        // clock from a quantum from now
+        if (!ticking) {
+            bool wanted = !can_idle;
+            for (const auto& room : rooms) wanted = wanted || room->needs_mixing();
+            if (wanted) {
+                deadline = std::chrono::steady_clock::now() + kMixQuantum;
+                std::fill(mixed.begin(), mixed.end(), 0);
+                set_clock(true);
+                ticking = true;
+            }
+        }
+
+        // Quantum ticks elapsed since the last pass (0 = woken early)
+        uint64_t ticks = 0;
+#ifdef __linux__
+        // Wait for a room to report a complete set of frames, or the
+        // deadline; idle, for a room to start needing mixing
+        struct pollfd pfds[2];
+        pfds[0] = {worker.wake_fd, POLLIN, 0};
+        pfds[1] = {worker.timer_fd, POLLIN, 0};
+        if (!ticking) {
+            (void)ppoll(pfds, 1, nullptr, nullptr);
+        } else if (worker.timer_fd >= 0) {
+            (void)ppoll(pfds, 2, nullptr, nullptr);
+        } else {
+            auto remaining = deadline - std::chrono::steady_clock::now();
+            if (remaining > std::chrono::nanoseconds::zero()) {
+                auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(remaining).count();
+                struct timespec ts;
+                ts.tv_sec = static_cast<time_t>(ns / 1000000000);
+                ts.tv_nsec = static_cast<long>(ns % 1000000000);
+                (void)ppoll(pfds, 1, &ts, nullptr);
+            }
+        }
+        if (pfds[0].revents & POLLIN) {
+            uint64_t val;
+            (void)::read(worker.wake_fd, &val, sizeof(val));
+        }
+        if (ticking && worker.timer_fd >= 0) {
+            if ((pfds[1].revents & POLLIN) &&
+                ::read(worker.timer_fd, &ticks, sizeof(ticks)) != sizeof(ticks)) {
+                ticks = 0;
+            }
+        }
+#else
+        std::this_thread::sleep_until(deadline);
+#endif
+        auto now = std::chrono::steady_clock::now();
+        worker.wakeups.fetch_add(1, std::memory_order_relaxed);
+#ifdef __linux__
+        if (ticking && worker.timer_fd < 0)
+#endif
+        {
+            if (now >= deadline) ticks = 1 + (now - deadline) / kMixQuantum;
+        }
+        TUTTI_TRACE_INSTANT("mixer.wake", ticks);
+
+        // Deadline cycles are late if the wake-up overshot the most recent
+        // tick, or whole quanta were missed (e.g. preempted)
+        bool deadline_passed = ticks > 0;
+        bool late = false;
+        if (deadline_passed) {
+            auto tick = deadline + kMixQuantum * static_cast<int64_t>(ticks - 1);
+            late = ticks > 1 || now - tick > kLateSlack;
+        }
+
+        bool busy = false;  // some room still needs mixing
+        for (size_t i = 0; i < rooms.size(); ++i) {
+            Room& room = *rooms[i];
+            if (!room.needs_mixing()) {
+                // Stopped needing mixing (routes went direct, or everyone
+                // rests): discard leftover audio so it doesn't surface as
+                // stale latency when the room re-activates
+                if (active[i]) {
+                    room.park();
+                    active[i] = 0;
+                }
+                continue;
+            }
+            active[i] = 1;
+            busy = true;
+            TUTTI_TRACE_ARG("mixer.room", i);
+
+            if (room.take_mix_ready()) {
+                room.process_cycle(batch);
+                mixed[i] = 1;
+                worker.early.fetch_add(1, std::memory_order_relaxed);
+            } else if (deadline_passed && !mixed[i]) {
+                room.process_cycle(batch);
+                (late ? worker.late : worker.on_time).fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        batch.flush();
+
+        if (deadline_passed) {
+            // Missed ticks are skipped, not replayed: stay on the quantum
+            // grid instead of bursting to catch up
+            std::fill(mixed.begin(), mixed.end(), 0);
+            deadline += kMixQuantum * static_cast<int64_t>(ticks);
+        }
+
+        // Every room parked: stop the clock until one needs mixing again
+        if (ticking && !busy && can_idle) {
+            set_clock(false);
+            ticking = false;
+        }
+    }
+}
+
+} // namespace tutti
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tutti {
+
+class Room;
+
+/// Mixer worker pool configuration (--mixer-threads / --mixer-cpus)
+struct MixerSchedulerConfig {
+    size_t worker_count = 1;
+    /// CPU to pin each worker to. Empty = use the kernel's isolated
+    /// CPU list if there is one, else cores 1, 2, ... in order.
+    std::vector<int> cpus;
+};
+
+/// How room mix cycles were triggered, summed over rooms and workers
+struct MixClockStats {
+    uint64_t early = 0;    // every participant delivered before the deadline
+    uint64_t on_time = 0;  // mixed at the deadline, woken within kLateSlack of it
+    uint64_t late = 0;     // mixed at the deadline but woken later, or a quantum was missed
+    uint64_t wakeups = 0;  // worker passes, mixing or not: idle workers make none
+};
+
+/// Shared pool of RT mixer workers.
+///
+/// Replaces the one-thread-per-room model: a small, fixed number of
+/// SCHED_FIFO workers (one per isolated core) each drive a subset of rooms
+/// off a quantum clock (~2.67ms at 48kHz/128 samples). On Linux the clock
+/// is a periodic timerfd armed at absolute CLOCK_MONOTONIC deadlines, so
+/// ticks stay phase-locked to the quantum rather than drifting with
+/// wake-up latency. A room is mixed early when every occupied slot has
+/// delivered a frame, or at the quantum deadline otherwise. Rooms whose
+/// Room::needs_mixing() is false (no bound listener needs a mix, or every
+/// source it hears is resting) are parked and skipped.
+///
+/// A worker with no room to mix disarms its clock and sleeps on its
+/// eventfd until one of its rooms starts needing mixing (Room signals it),
+/// so idle rooms cost no wake-ups at all; the clock restarts a quantum
+/// after the room activates.
+class MixerScheduler {
+public:
+    /// A deadline cycle woken later than this after its tick counts as late
+    static constexpr auto kLateSlack = std::chrono::microseconds(250);
+
+    explicit MixerScheduler(MixerSchedulerConfig config = {});
+    ~MixerScheduler();
+
+    MixerScheduler(const MixerScheduler&) = delete;
+    MixerScheduler& operator=(const MixerScheduler&) = delete;
+
+    /// Start the worker threads
+    void start();
+
+    /// Stop and join the worker threads
+    void stop();
+
+    /// Assign a room to the least-loaded worker: the fewest rooms needing
+    /// mixing, then the fewest rooms. NOT called from RT thread.
+    void add_room(std::shared_ptr<Room> room);
+
+    /// Move rooms needing mixing off the busiest worker until no two
+    /// workers' counts of them differ by more than one. Rooms are assigned
+    /// before anyone joins, so add_room() can't see which will be busy;
+    /// call this periodically. A room leaves its old worker's snapshot
+    /// before the new one mixes it. Returns the rooms moved.
+    /// NOT called from RT thread.
+    size_t rebalance();
+
+    /// Remove a room from whichever worker owns it. NOT called from RT thread.
+    void remove_room(const Room* room);
+
+    size_t worker_count() const { return workers_.size(); }
+
+    /// Index of the worker that owns `room`, or worker_count() if none does
+    size_t worker_of(const Room* room) const;
+
+    /// Early / on-time / late cycle counts. Lock-free, any thread.
+    MixClockStats clock_stats() const;
+
+    /// Parse a Linux CPU list ("2-5,7") into CPU indices
+    static std::vector<int> parse_cpu_list(const std::string& list);
+
+private:
+    struct Worker {
+        size_t index = 0;
+        int cpu = -1;
+        int wake_fd = -1;   // Linux eventfd, -1 on other platforms
+        int timer_fd = -1;  // Linux timerfd quantum clock, -1 = relative ppoll timeout
+        std::thread thread;
+
+        // Room assignment. The RT loop re-snapshots only when version changes.
+        std::mutex rooms_mutex;
+        std::vector<std::shared_ptr<Room>> rooms;
+        std::atomic<uint64_t> rooms_version{0};
+        std::atomic<uint64_t> applied_version{0};  // last version the RT loop snapshotted
+
+        std::atomic<uint64_t> early{0};
+        std::atomic<uint64_t> on_time{0};
+        std::atomic<uint64_t> late{0};
+        std::atomic<uint64_t> wakeups{0};
+    };
+
+    void worker_func(Worker& worker);
+
+    /// Signal a worker's eventfd: rooms changed, or it should stop
+    static void wake(Worker& worker);
+
+    MixerSchedulerConfig config_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::atomic<bool> running_{false};
+};
+
+} // namespace tutti
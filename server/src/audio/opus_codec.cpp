@@ -0,0 +1,181 @@
+#include "opus_codec.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#ifdef TUTTI_OPUS
+#include <opus.h>
+#endif
+
+namespace tutti {
+
+const char* codec_name(AudioCodec codec) {
+    switch (codec) {
+        case AudioCodec::Opus: return "opus";
+        case AudioCodec::Pcm: break;
+    }
+    return "pcm";
+}
+
+AudioCodec parse_codec(const std::string& name) {
+    return name == "opus" ? AudioCodec::Opus : AudioCodec::Pcm;
+}
+
+bool codec_supported(AudioCodec codec) {
+#ifdef TUTTI_OPUS
+    return true;
+#else
+    return codec == AudioCodec::Pcm;
+#endif
+}
+
+// ── Decoder ─────────────────────────────────────────────────────────────────
+
+OpusStreamDecoder::OpusStreamDecoder() {
+#ifdef TUTTI_OPUS
+    int err = OPUS_OK;
+    decoder_ = opus_decoder_create(static_cast<opus_int32>(kSampleRate), 1, &err);
+    if (err != OPUS_OK) {
+        std::cerr << "[Opus] Decoder init failed: " << opus_strerror(err) << "\n";
+        decoder_ = nullptr;
+    }
+#endif
+}
+
+OpusStreamDecoder::~OpusStreamDecoder() {
+#ifdef TUTTI_OPUS
+    if (decoder_) opus_decoder_destroy(decoder_);
+#endif
+}
+
+size_t OpusStreamDecoder::push_samples(const int16_t* pcm, size_t n,
+                                       AudioFrame* out, size_t produced) {
+    while (n > 0) {
+        size_t take = std::min(n, kSamplesPerFrame - fifo_len_);
+        std::memcpy(fifo_ + fifo_len_, pcm, take * sizeof(int16_t));
+        fifo_len_ += take;
+        pcm += take;
+        n -= take;
+        if (fifo_len_ < kSamplesPerFrame) break;
+
+        fifo_len_ = 0;
+        if (produced == kMaxFramesPerPacket) continue;  // unreachable by construction
+        AudioFrame& frame = out[produced++];
+        frame.sequence = frame_sequence_++;
+        frame.timestamp = frame_timestamp_;
+        frame_timestamp_ += static_cast<uint32_t>(kSamplesPerFrame);
+        std::copy(fifo_, fifo_ + kSamplesPerFrame, frame.samples.begin());
+    }
+    return produced;
+}
+
+size_t OpusStreamDecoder::decode(const uint8_t* data, size_t len, AudioFrame* out) {
+#ifdef TUTTI_OPUS
+    if (!decoder_ || len < kAudioHeaderSize || len >= kAudioPacketSize) return 0;
+    if (reset_requested_.exchange(false, std::memory_order_acq_rel)) {
+        opus_decoder_ctl(decoder_, OPUS_RESET_STATE);
+        have_sequence_ = false;
+        fifo_len_ = 0;
+    }
+
+    uint32_t sequence;
+    std::memcpy(&sequence, data, sizeof(sequence));
+
+    int16_t pcm[kOpusFrameSamples];
+    size_t produced = 0;
+    if (have_sequence_) {
+        auto gap = static_cast<int32_t>(sequence - next_sequence_);
+        if (gap < 0) return 0;  // late or duplicate: the decoder has moved past it
+        if (static_cast<uint32_t>(gap) > kMaxConcealedPackets) {
+            // Long outage or sender restart: don't synthesize it, start over
+            opus_decoder_ctl(decoder_, OPUS_RESET_STATE);
+        } else {
+            for (int32_t i = 0; i < gap; ++i) {
+                int n = opus_decode(decoder_, nullptr, 0, pcm, kOpusFrameSamples, 0);
+                if (n > 0) produced = push_samples(pcm, static_cast<size_t>(n), out, produced);
+            }
+        }
+    }
+    have_sequence_ = true;
+    next_sequence_ = sequence + 1;
+
+    if (len == kAudioHeaderSize) {
+        // Silence marker: one Opus frame of zeros
+        std::memset(pcm, 0, sizeof(pcm));
+        return push_samples(pcm, kOpusFrameSamples, out, produced);
+    }
+    int n = opus_decode(decoder_, data + kAudioHeaderSize,
+                        static_cast<opus_int32>(len - kAudioHeaderSize),
+                        pcm, kOpusFrameSamples, 0);
+    if (n > 0) produced = push_samples(pcm, static_cast<size_t>(n), out, produced);
+    return produced;
+#else
+    (void)data;
+    (void)len;
+    (void)out;
+    return 0;
+#endif
+}
+
+// ── Encoder ─────────────────────────────────────────────────────────────────
+
+OpusStreamEncoder::OpusStreamEncoder() {
+#ifdef TUTTI_OPUS
+    int err = OPUS_OK;
+    encoder_ = opus_encoder_create(static_cast<opus_int32>(kSampleRate), 1,
+                                   OPUS_APPLICATION_RESTRICTED_LOWDELAY, &err);
+    if (err != OPUS_OK) {
+        std::cerr << "[Opus] Encoder init failed: " << opus_strerror(err) << "\n";
+        encoder_ = nullptr;
+        return;
+    }
+    opus_encoder_ctl(encoder_, OPUS_SET_BITRATE(kBitrate));
+    opus_encoder_ctl(encoder_, OPUS_SET_SIGNAL(OPUS_SIGNAL_MUSIC));
+#endif
+}
+
+OpusStreamEncoder::~OpusStreamEncoder() {
+#ifdef TUTTI_OPUS
+    if (encoder_) opus_encoder_destroy(encoder_);
+#endif
+}
+
+size_t OpusStreamEncoder::encode(const AudioFrame& frame, OpusPacket* out) {
+#ifdef TUTTI_OPUS
+    if (!encoder_) return 0;
+    if (reset_requested_.exchange(false, std::memory_order_acq_rel)) {
+        opus_encoder_ctl(encoder_, OPUS_RESET_STATE);
+        timestamp_ = 0;
+        fifo_len_ = 0;
+    }
+
+    size_t produced = 0;
+    size_t consumed = 0;
+    while (consumed < kSamplesPerFrame) {
+        size_t take = std::min(kOpusFrameSamples - fifo_len_, kSamplesPerFrame - consumed);
+        std::memcpy(fifo_ + fifo_len_, frame.samples.data() + consumed, take * sizeof(int16_t));
+        fifo_len_ += take;
+        consumed += take;
+        if (fifo_len_ < kOpusFrameSamples) break;
+
+        fifo_len_ = 0;
+        OpusPacket& pkt = out[produced];
+        pkt.timestamp = timestamp_;
+        timestamp_ += static_cast<uint32_t>(kOpusFrameSamples);
+        opus_int32 n = opus_encode(encoder_, fifo_, kOpusFrameSamples,
+                                   pkt.payload, static_cast<opus_int32>(kMaxOpusPayload));
+        if (n > 0) {
+            pkt.payload_len = static_cast<size_t>(n);
+            ++produced;
+        }
+    }
+    return produced;
+#else
+    (void)frame;
+    (void)out;
+    return 0;
+#endif
+}
+
+} // namespace tutti
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "ring_buffer.h"
+#include "transport/transport_interface.h"
+
+// libopus handles (opus.h is only included by opus_codec.cpp)
+struct OpusDecoder;
+struct OpusEncoder;
+
+namespace tutti {
+
+/// Encoding of a session's audio datagrams, negotiated at bind
+enum class AudioCodec : uint8_t {
+    Pcm,   // 264-byte int16 frames (default)
+    Opus   // 2.5ms Opus packets, restricted-lowdelay
+};
+
+const char* codec_name(AudioCodec codec);
+
+/// Codec named by a bind message's "codec" field. Unknown names are PCM.
+AudioCodec parse_codec(const std::string& name);
+
+/// True if this build can encode and decode `codec`
+/// (Opus needs -DTUTTI_ENABLE_OPUS=ON)
+bool codec_supported(AudioCodec codec);
+
+/// Opus frame: 2.5ms at 48kHz, the shortest Opus allows
+static constexpr size_t kOpusFrameSamples = 120;
+/// Opus payloads stay below the PCM payload size, so a datagram's length
+/// alone says what it carries: header only (silence), Opus, or PCM.
+static constexpr size_t kMaxOpusPayload = kAudioPayloadSize - 1;
+
+inline bool is_opus_datagram(size_t len) {
+    return len > kAudioHeaderSize && len < kAudioPacketSize;
+}
+
+/// Decodes one participant's Opus datagrams into 128-sample AudioFrames.
+///
+/// Receive thread only. 120-sample Opus frames are re-framed through a
+/// small FIFO, so a packet completes zero or one AudioFrame (more after
+/// concealing a gap). Short sequence gaps are filled with Opus PLC;
+/// late packets are dropped. Output frames carry their own contiguous
+/// sequence numbers.
+class OpusStreamDecoder {
+public:
+    /// Most AudioFrames one decode() can produce
+    static constexpr size_t kMaxFramesPerPacket = 5;
+    /// Longest gap concealed with PLC; longer gaps restart the stream
+    static constexpr uint32_t kMaxConcealedPackets = 4;
+
+    OpusStreamDecoder();
+    ~OpusStreamDecoder();
+
+    OpusStreamDecoder(const OpusStreamDecoder&) = delete;
+    OpusStreamDecoder& operator=(const OpusStreamDecoder&) = delete;
+
+    /// Decode one Opus datagram (header + payload) into `out`.
+    /// Returns the number of completed frames.
+    size_t decode(const uint8_t* data, size_t len, AudioFrame* out);
+
+    /// Any thread: start afresh before the next decode (slot handover)
+    void request_reset() { reset_requested_.store(true, std::memory_order_release); }
+
+private:
+    size_t push_samples(const int16_t* pcm, size_t n, AudioFrame* out, size_t produced);
+
+    OpusDecoder* decoder_ = nullptr;
+    std::atomic<bool> reset_requested_{false};
+    bool have_sequence_ = false;
+    uint32_t next_sequence_ = 0;     // next expected packet
+    uint32_t frame_sequence_ = 0;    // next output frame
+    uint32_t frame_timestamp_ = 0;
+    size_t fifo_len_ = 0;
+    int16_t fifo_[kSamplesPerFrame];
+};
+
+/// One encoded Opus datagram
+struct OpusPacket {
+    uint32_t timestamp = 0;
+    size_t payload_len = 0;
+    uint8_t payload[kMaxOpusPayload];
+};
+
+/// Encodes one stream of 128-sample mixes into 2.5ms Opus packets.
+///
+/// Mixer worker thread only. Samples are re-framed through a FIFO: a frame
+/// completes one packet, and every 15th frame two.
+class OpusStreamEncoder {
+public:
+    static constexpr size_t kMaxPacketsPerFrame = 2;
+    static constexpr int kBitrate = 96000;
+
+    OpusStreamEncoder();
+    ~OpusStreamEncoder();
+
+    OpusStreamEncoder(const OpusStreamEncoder&) = delete;
+    OpusStreamEncoder& operator=(const OpusStreamEncoder&) = delete;
+
+    /// Append a mixed frame; fills `out` with the packets it completes.
+    /// Returns the number of packets.
+    size_t encode(const AudioFrame& frame, OpusPacket* out);
+
+    /// Any thread: start afresh before the next encode (slot handover)
+    void request_reset() { reset_requested_.store(true, std::memory_order_release); }
+
+private:
+    OpusEncoder* encoder_ = nullptr;
+    std::atomic<bool> reset_requested_{false};
+    uint32_t timestamp_ = 0;  // of the next packet
+    size_t fifo_len_ = 0;
+    int16_t fifo_[kOpusFrameSamples];
+};
+
+} // namespace tutti
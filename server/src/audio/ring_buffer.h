@@ -1,25 +1,60 @@
 #pragma once
 
-#include <rigtorp/SPSCQueue.h>
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
+#include <type_traits>
+#include <vector>
+
 #include "transport/transport_interface.h"
 
 namespace tutti {
 
-/// Audio frame: a fixed-size buffer of kSamplesPerFrame int16 samples.
-/// Used as the element type in SPSC queues between network and mixer threads.
+/// Audio frame: kSamplesPerFrame sample frames of 1 or 2 channels,
+/// interleaved L/R when stereo. Sized for kMaxChannels so every frame is
+/// the same type. Used as the element type in SPSC queues between network
+/// and mixer threads.
+///
+/// The header fields and samples are laid out as a PCM datagram, so a
+/// queued frame goes onto the wire with one memcpy from wire_data().
 struct AudioFrame {
     uint32_t sequence = 0;
     uint32_t timestamp = 0;
-    std::array<int16_t, kSamplesPerFrame> samples{};
+    std::array<int16_t, kSamplesPerFrame * kMaxChannels> samples{};
+    uint8_t channels = 1;
+    bool silent = false;      // gated as silence: samples are zero and needn't be mixed
+    bool room_total = false;  // mixer output equal to the room total (shareable encode)
+
+    /// Samples in use: kSamplesPerFrame per channel
+    size_t sample_count() const { return kSamplesPerFrame * channels; }
+
+    /// Datagram bytes: sequence and timestamp, then sample_count() samples
+    /// (pcm_packet_size(channels) in all; the header alone for a marker)
+    const uint8_t* wire_data() const { return reinterpret_cast<const uint8_t*>(this); }
+
+    AudioFrame() = default;
+    AudioFrame(const AudioFrame&) = default;
+
+    /// Copies only the samples in use: mono frames (the common case) don't
+    /// pay for the stereo half on every queue hop
+    AudioFrame& operator=(const AudioFrame& other) {
+        sequence = other.sequence;
+        timestamp = other.timestamp;
+        channels = other.channels;
+        silent = other.silent;
+        room_total = other.room_total;
+        std::copy_n(other.samples.begin(), other.sample_count(), samples.begin());
+        return *this;
+    }
 
     static AudioFrame from_packet(const AudioPacket& pkt) {
         AudioFrame frame;
         frame.sequence = pkt.sequence;
         frame.timestamp = pkt.timestamp;
-        std::copy(std::begin(pkt.samples), std::end(pkt.samples),
-                  frame.samples.begin());
+        frame.channels = pkt.channels;
+        std::copy(pkt.samples, pkt.samples + frame.sample_count(), frame.samples.begin());
         return frame;
     }
 
@@ -27,56 +62,103 @@ struct AudioFrame {
         AudioPacket pkt;
         pkt.sequence = sequence;
         pkt.timestamp = timestamp;
-        std::copy(samples.begin(), samples.end(), std::begin(pkt.samples));
+        pkt.channels = channels;
+        std::copy(samples.begin(), samples.begin() + sample_count(), std::begin(pkt.samples));
         return pkt;
     }
 };
 
+static_assert(std::is_standard_layout_v<AudioFrame> &&
+                  offsetof(AudioFrame, samples) == kAudioHeaderSize,
+              "AudioFrame must start with its wire-format datagram");
+
 /// SPSC ring buffer for audio frames.
-/// Wraps rigtorp::SPSCQueue with audio-specific convenience.
 /// Producer: network receive thread. Consumer: mixer RT thread (or vice versa).
+///
+/// Frames are written and read in place: the producer fills the slot from
+/// back() and publishes it with push(), the consumer reads front() and
+/// releases it with pop(). try_push/try_pop are copying conveniences.
 class AudioRingBuffer {
 public:
     /// Capacity in frames. Default ~21ms of buffer at 48kHz/128 samples.
     explicit AudioRingBuffer(size_t capacity = 8)
-        : queue_(capacity) {}
+        : slots_(capacity + 1) {}  // one slot stays empty to tell full from empty
 
-    /// Non-blocking push. Returns false if full (drop frame).
-    bool try_push(const AudioFrame& frame) {
-        return queue_.try_push(frame);
+    AudioRingBuffer(const AudioRingBuffer&) = delete;
+    AudioRingBuffer& operator=(const AudioRingBuffer&) = delete;
+
+    /// Producer: the next free slot, to fill before push().
+    /// Returns nullptr if full (drop frame).
+    AudioFrame* back() {
+        size_t write = write_.load(std::memory_order_relaxed);
+        size_t next = advance(write);
+        if (next == read_cache_) {
+            read_cache_ = read_.load(std::memory_order_acquire);
+            if (next == read_cache_) return nullptr;
+        }
+        return &slots_[write];
     }
 
-    /// Non-blocking push with move.
-    bool try_push(AudioFrame&& frame) {
-        return queue_.try_push(std::move(frame));
+    /// Producer: publish the slot back() returned
+    void push() {
+        write_.store(advance(write_.load(std::memory_order_relaxed)),
+                     std::memory_order_release);
     }
 
-    /// Non-blocking pop. Returns nullptr if empty.
+    /// Non-blocking push. Returns false if full (drop frame).
+    bool try_push(const AudioFrame& frame) {
+        AudioFrame* slot = back();
+        if (!slot) return false;
+        *slot = frame;
+        push();
+        return true;
+    }
+
+    /// Consumer: the oldest frame, read in place. Returns nullptr if empty.
     AudioFrame* front() {
-        return queue_.front();
+        size_t read = read_.load(std::memory_order_relaxed);
+        if (read == write_cache_) {
+            write_cache_ = write_.load(std::memory_order_acquire);
+            if (read == write_cache_) return nullptr;
+        }
+        return &slots_[read];
     }
 
-    /// Pop the front element (must call front() first to check).
+    /// Consumer: release the front element (must call front() first to check).
     void pop() {
-        queue_.pop();
+        read_.store(advance(read_.load(std::memory_order_relaxed)),
+                    std::memory_order_release);
     }
 
     /// Try to pop into destination. Returns false if empty.
     bool try_pop(AudioFrame& out) {
-        auto* f = queue_.front();
+        AudioFrame* f = front();
         if (!f) return false;
         out = *f;
-        queue_.pop();
+        pop();
         return true;
     }
 
     /// Approximate number of items in queue (not exact in concurrent use)
     size_t size_approx() const {
-        return queue_.size();
+        size_t write = write_.load(std::memory_order_acquire);
+        size_t read = read_.load(std::memory_order_acquire);
+        return write >= read ? write - read : slots_.size() - read + write;
     }
 
 private:
-    rigtorp::SPSCQueue<AudioFrame> queue_;
+    size_t advance(size_t index) const {
+        return index + 1 == slots_.size() ? 0 : index + 1;
+    }
+
+    std::vector<AudioFrame> slots_;
+
+    // Producer and consumer indices on separate cache lines, each with the
+    // owner's cached copy of the other so most calls touch only their own
+    alignas(64) std::atomic<size_t> write_{0};
+    size_t read_cache_ = 0;   // producer only
+    alignas(64) std::atomic<size_t> read_{0};
+    size_t write_cache_ = 0;  // consumer only
 };
 
 } // namespace tutti
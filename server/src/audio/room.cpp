@@ -1,18 +1,16 @@
 #include "room.h"
+#include "mix_kernels.h"
+#include "telemetry/trace.h"
 
+#include <algorithm>
+#include <array>
 #include <chrono>
-#include <cmath>
 #include <cstring>
 #include <iostream>
-#include <limits>
+#include <thread>
 #include <nlohmann/json.hpp>
 
 #ifdef __linux__
-#include <poll.h>
-#include <pthread.h>
-#include <sched.h>
-#include <sys/eventfd.h>
-#include <time.h>
 #include <unistd.h>
 #endif
 
@@ -20,217 +18,557 @@ namespace tutti {
 
 Room::Room(const std::string& name, size_t max_participants)
     : name_(name),
-      max_participants_(max_participants),
-      mixer_(max_participants) {
-#ifdef __linux__
-    notify_fd_ = eventfd(0, EFD_NONBLOCK);
-    if (notify_fd_ < 0) {
-        std::cerr << "[Room:" << name_ << "] Warning: Could not create eventfd\n";
+      max_participants_(std::min(max_participants, kMaxParticipants)),
+      slot_count_(max_participants_ + kListenOnlySeats),
+      mixer_(slot_count_),
+      slot_activity_(new SlotActivity[slot_count_]),
+      routes_(new SlotRoute[slot_count_]),
+      metrics_(slot_count_),
+      own_batch_(slot_count_) {
+    if (codec_supported(AudioCodec::Opus)) {
+        opus_decoders_.reset(new OpusStreamDecoder[slot_count_]);
+        opus_encoders_.reset(new OpusStreamEncoder[slot_count_]);
+        shared_encoder_ = std::make_unique<OpusStreamEncoder>();
     }
-#endif
+    if (max_participants > kMaxParticipants) {
+        std::cerr << "[Room:" << name_ << "] Warning: " << max_participants
+                  << " participants requested, the mixer seats " << kMaxParticipants << "\n";
+    }
+    publish_roster();
 }
 
-Room::~Room() {
-    stop();
-#ifdef __linux__
-    if (notify_fd_ >= 0) ::close(notify_fd_);
-#endif
+Room::~Room() = default;
+
+void Room::process_cycle(DatagramBatch& batch) {
+    auto start = std::chrono::steady_clock::now();
+    capture_event(CaptureEvent::MixCycle, 0);
+    delivered_mask_.store(0, std::memory_order_release);
+    mixer_.mix_cycle();
+    send_outputs(batch);
+    if (++cycles_since_stream_check_ >= 64) expire_streams();
+
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    metrics_.record_mix_cycle(static_cast<uint64_t>(ns));
+    latency_.record_mix_duration(static_cast<double>(ns) / 1000.0);
 }
 
-void Room::start() {
-    if (running_) return;
-    running_ = true;
-    mixer_thread_ = std::thread(&Room::mixer_thread_func, this);
+void Room::process_cycle() {
+    process_cycle(own_batch_);
+    own_batch_.flush();
 }
 
-void Room::stop() {
-    running_ = false;
-    if (mixer_thread_.joinable()) {
-        mixer_thread_.join();
-    }
+void Room::park() {
+    delivered_mask_.store(0, std::memory_order_release);
+    mix_ready_.store(false, std::memory_order_release);
+    mixer_.clear_queues();
 }
 
 bool Room::add_participant(const std::string& id,
                            const std::string& alias,
-                           std::shared_ptr<TransportSession> session) {
-    std::lock_guard<std::mutex> lock(participants_mutex_);
-    if (participants_.size() >= max_participants_) return false;
+                           std::shared_ptr<TransportSession> session,
+                           bool listen_only) {
+    std::unique_lock<std::mutex> lock(participants_mutex_);
+    if (listen_only ? listeners_full() : is_full()) return false;
     if (participants_.count(id)) return false;
 
-    participants_[id] = {alias, std::move(session), 0,
-                         std::chrono::steady_clock::now(), 0, 0};
-    mixer_.add_participant(id);
+    ParticipantSlot slot = mixer_.add_participant(id);
+    if (!slot.valid() || slot.index >= slot_count_) return false;
+
+    slot_activity_[slot.index].last_audio_received_ns.store(0, std::memory_order_relaxed);
+    slot_activity_[slot.index].last_audio_sent_ns.store(0, std::memory_order_relaxed);
+    slot_activity_[slot.index].last_sound_ns.store(0, std::memory_order_relaxed);
+    streaming_mask_.fetch_and(~(1u << slot.index), std::memory_order_relaxed);
+    metrics_.reset_slot(slot.index);
+    routes_[slot.index].output_sequence.store(0, std::memory_order_relaxed);
+    routes_[slot.index].gate.reset();
+    if (opus_decoders_) {
+        opus_decoders_[slot.index].request_reset();
+        opus_encoders_[slot.index].request_reset();
+    }
+    participants_[id] = {alias, std::move(session), slot,
+                         std::chrono::steady_clock::now()};
+    participants_[id].listen_only = listen_only;
+    capture_participant(id);
+    if (recording_.load(std::memory_order_relaxed)) recorder_->name_track(slot.index, slot.generation, id);
+    const uint32_t bit = 1u << slot.index;
+    if (listen_only) {
+        listen_only_mask_.fetch_or(bit, std::memory_order_relaxed);
+    } else {
+        listen_only_mask_.fetch_and(~bit, std::memory_order_relaxed);
+    }
+    publish_roster();
+    publish_routes();
 
-    // Notify existing participants
-    nlohmann::json msg = {
+    // Notify existing participants, and send room state to the new one
+    broadcast(std::make_shared<const std::string>(nlohmann::json{
         {"type", "participant_joined"},
         {"id", id},
-        {"name", alias}
-    };
-    std::string msg_str = msg.dump();
-    for (auto& [pid, p] : participants_) {
-        if (pid != id && p.session) {
-            p.session->send_reliable(msg_str);
-        }
-    }
-
-    // Send room state to new participant
-    auto& new_session = participants_[id].session;
-    if (new_session) {
-        nlohmann::json state_msg;
-        state_msg["type"] = "room_state";
-        state_msg["participants"] = nlohmann::json::array();
-        for (auto& [pid, p] : participants_) {
-            state_msg["participants"].push_back({
-                {"id", pid},
-                {"name", p.alias}
-            });
-        }
-        new_session->send_reliable(state_msg.dump());
-    }
+        {"name", alias},
+        {"listen_only", listen_only}
+    }.dump()), id);
+    post(participants_[id].session, room_state_);
 
+    lock.unlock();
+    flush_outbox();
     return true;
 }
 
 bool Room::attach_session(const std::string& id,
-                           std::shared_ptr<TransportSession> session) {
-    std::lock_guard<std::mutex> lock(participants_mutex_);
+                           std::shared_ptr<TransportSession> session,
+                           ParticipantSlot* slot_out,
+                           AudioCodec codec,
+                           uint8_t channels) {
+    std::unique_lock<std::mutex> lock(participants_mutex_);
     auto it = participants_.find(id);
     if (it == participants_.end()) return false;
+    if (!codec_supported(codec)) return false;
+    if (channels != 1 && (channels != 2 || codec != AudioCodec::Pcm)) return false;
 
+    std::shared_ptr<TransportSession> previous = std::move(it->second.session);
     it->second.session = std::move(session);
+    it->second.codec = codec;
+    it->second.channels = channels;
+    const uint8_t bind[2] = {static_cast<uint8_t>(codec), channels};
+    capture_event(CaptureEvent::Bind, it->second.slot.index, bind, sizeof(bind));
+    mixer_.set_output_channels(id, channels);
+    if (slot_out) *slot_out = it->second.slot;
+    if (opus_decoders_) {
+        // A new session starts new streams in both directions
+        opus_decoders_[it->second.slot.index].request_reset();
+        opus_encoders_[it->second.slot.index].request_reset();
+    }
+    publish_routes();
 
     // Send room state to the newly-bound participant
-    if (it->second.session) {
-        nlohmann::json state_msg;
-        state_msg["type"] = "room_state";
-        state_msg["participants"] = nlohmann::json::array();
-        for (auto& [pid, p] : participants_) {
-            state_msg["participants"].push_back({
-                {"id", pid},
-                {"name", p.alias}
-            });
-        }
-        it->second.session->send_reliable(state_msg.dump());
-    }
+    post(it->second.session, room_state_);
 
+    lock.unlock();
+    if (previous) synchronize_routes();  // no forward or batch may still hold it
+    flush_outbox();
     return true;
 }
 
 void Room::remove_participant(const std::string& id) {
-    std::lock_guard<std::mutex> lock(participants_mutex_);
-    participants_.erase(id);
+    std::unique_lock<std::mutex> lock(participants_mutex_);
+    std::shared_ptr<TransportSession> departing;
+    auto it = participants_.find(id);
+    if (it != participants_.end()) {
+        departing = std::move(it->second.session);
+        capture_event(CaptureEvent::Leave, it->second.slot.index);
+        participants_.erase(it);
+    }
     mixer_.remove_participant(id);
+    publish_roster();
+    publish_routes();
 
     // Notify remaining participants
-    nlohmann::json msg = {
+    broadcast(std::make_shared<const std::string>(nlohmann::json{
         {"type", "participant_left"},
         {"id", id}
-    };
-    std::string msg_str = msg.dump();
-    for (auto& [pid, p] : participants_) {
-        if (p.session) p.session->send_reliable(msg_str);
-    }
+    }.dump()));
 
     // Clear password if room is now empty
     if (participants_.empty()) {
         clear_password();
     }
+
+    lock.unlock();
+    if (departing) synchronize_routes();  // no forward or batch may still hold it
+    flush_outbox();
 }
 
-void Room::on_audio_received(const std::string& participant_id,
-                              const uint8_t* data, size_t len) {
-    if (len < kAudioPacketSize) return;
+void Room::post(const std::shared_ptr<TransportSession>& session,
+                std::shared_ptr<const std::string> message) {
+    if (!session) return;
+    std::lock_guard<std::mutex> lock(outbox_mutex_);
+    outbox_.push_back({session, std::move(message)});
+}
 
-    // Fast path: 2 participants → direct forwarding (bypass mixer)
-    std::shared_ptr<TransportSession> target_session;
-    std::string target_id;
-    uint32_t output_seq = 0;
-    bool use_fast_path = false;
-    size_t count = 0;
+void Room::broadcast(const std::shared_ptr<const std::string>& message, const std::string& except) {
+    for (const auto& [pid, p] : participants_) {
+        if (pid != except) post(p.session, message);
+    }
+}
 
-    {
-        std::lock_guard<std::mutex> lock(participants_mutex_);
-        count = participants_.size();
-        // Stamp activity for reaper
-        auto recv_it = participants_.find(participant_id);
-        if (recv_it != participants_.end())
-            recv_it->second.last_audio_received_ns = now_ns();
-        if (count == 2) {
-            for (auto& [pid, p] : participants_) {
-                if (pid != participant_id) {
-                    target_id = pid;
-                    target_session = p.session;
-                    output_seq = p.output_sequence++;
-                    p.last_audio_sent_ns = now_ns();
-                    use_fast_path = true;
-                    break;
-                }
-            }
+void Room::flush_outbox() {
+    // One sender at a time, draining in queue order: a participant sees
+    // changes in the order they were made, whoever sends them
+    std::lock_guard<std::mutex> sending(outbox_send_mutex_);
+    std::vector<OutboxEntry> batch;
+    for (;;) {
+        {
+            std::lock_guard<std::mutex> lock(outbox_mutex_);
+            if (outbox_.empty()) return;
+            batch.swap(outbox_);
+        }
+        for (const auto& entry : batch) entry.session->send_reliable(*entry.message);
+        batch.clear();
+    }
+}
+
+AudioCodec Room::codec_of(const std::string& id) const {
+    std::lock_guard<std::mutex> lock(participants_mutex_);
+    auto it = participants_.find(id);
+    return it != participants_.end() ? it->second.codec : AudioCodec::Pcm;
+}
+
+void Room::on_audio_received(ParticipantSlot slot,
+                              const uint8_t* data, size_t len) {
+    TUTTI_TRACE_ARG("room.receive", slot.index);
+    // A PCM frame, an Opus packet, or a header-only silence marker
+    const bool marker = len == kAudioHeaderSize;
+    const bool opus = is_opus_datagram(len);
+    if (len < kAudioHeaderSize) return;
+    if (!mixer_.is_current(slot)) return; // Left the room, or stale binding
+    if (PacketCapture* capture = capture_.load(std::memory_order_acquire)) {
+        capture->record(CaptureEvent::Datagram, slot.index, data, len, now_ns());
+    }
+    if (listen_only_mask_.load(std::memory_order_relaxed) & (1u << slot.index)) return;
+
+    // Opus only from sessions that negotiated it; PCM with every channel
+    SlotRoute& own = routes_[slot.index];
+    const bool opus_source = own.codec.load(std::memory_order_relaxed) == AudioCodec::Opus;
+    const uint8_t channels = own.channels.load(std::memory_order_relaxed);
+    if (opus && !opus_source) return;
+    if (!marker && !opus && len < pcm_packet_size(channels)) return;
+
+    // Stamp activity for reaper
+    int64_t now = now_ns();
+    slot_activity_[slot.index].last_audio_received_ns.store(now, std::memory_order_relaxed);
+
+    uint32_t sequence;
+    std::memcpy(&sequence, data, sizeof(sequence));
+    metrics_.record_received(slot.index, sequence);
+
+    size_t count = performer_count_.load(std::memory_order_relaxed) +
+                   listener_count_.load(std::memory_order_relaxed);
+
+    // Solo participant: nobody to hear it, and unless recording the room
+    // isn't being mixed
+    if (count < 2 && !recording_.load(std::memory_order_relaxed)) return;
+
+    // PCM is gated on arrival, Opus once decoded; the gate's threshold is
+    // per channel. The 8-byte header keeps the samples 2-byte aligned.
+    const auto* samples = reinterpret_cast<const int16_t*>(data + kAudioHeaderSize);
+    const bool silent = marker || (!opus && own.gate.update(
+        mix_kernels().energy(samples, kSamplesPerFrame * channels) / channels));
+    if (silent) metrics_.record_silent(slot.index);
+    else note_sound(slot.index, now);
+
+    // Direct forwarding (bypasses the mixer): every listener for whom this
+    // is the only audible source
+    uint32_t direct = own.direct_listeners.load(std::memory_order_acquire);
+    if (direct) {
+        metrics_.record_fast_path(slot.index);
+        forward_direct(slot.index, direct, data, len, channels, silent, now);
+    }
+    if (!needs_mixing()) {
+        // Parked while everyone rests: keep mixed listeners hearing (and
+        // counted as receiving) silence
+        const uint32_t resting = own.resting_listeners.load(std::memory_order_acquire);
+        if (silent && resting) forward_rest(slot.index, resting, data, now);
+        return;
+    }
+
+    // Push to the mixer (lock-free) for everyone else
+    metrics_.record_mixed_path(slot.index);
+    if (opus_source) {
+        AudioFrame frames[OpusStreamDecoder::kMaxFramesPerPacket];
+        size_t n = opus_decoders_[slot.index].decode(data, len, frames);
+        for (size_t i = 0; i < n; ++i) {
+            frames[i].silent = own.gate.update(
+                mix_kernels().energy(frames[i].samples.data(), kSamplesPerFrame));
+            if (frames[i].silent) metrics_.record_silent(slot.index);
+            push_to_mixer(slot, frames[i]);
         }
+        return;
     }
 
-    if (use_fast_path) {
-        GainEntry ge = mixer_.get_gain_entry(target_id, participant_id);
+    // A silent frame still holds its place in the sequence, without samples
+    push_to_mixer(slot, data, channels, silent);
+}
 
-        if (ge.muted || ge.gain <= 0.0f) return;
+void Room::push_to_mixer(ParticipantSlot slot, const AudioFrame& frame) {
+    note_delivery(slot, mixer_.push_input(slot, frame));
+}
+
+void Room::push_to_mixer(ParticipantSlot slot, const uint8_t* data,
+                         uint8_t channels, bool silent) {
+    note_delivery(slot, mixer_.push_input(slot, data, channels, silent));
+}
 
-        if (ge.gain == 1.0f) {
+void Room::note_delivery(ParticipantSlot slot, bool accepted) {
+    if (!accepted) {  // stale slot, late or duplicate
+        metrics_.record_input_drop(slot.index);
+        return;
+    }
+
+    // Wake the mixer worker early once every performer's slot has
+    // delivered this cycle. Only the frame that completes the set signals.
+    const uint32_t bit = 1u << slot.index;
+    const uint32_t expected =
+        mixer_.occupied_mask() & ~listen_only_mask_.load(std::memory_order_relaxed);
+    uint32_t prev = delivered_mask_.fetch_or(bit, std::memory_order_acq_rel);
+    if ((prev & expected) != expected && ((prev | bit) & expected) == expected) {
+        mix_ready_.store(true, std::memory_order_release);
+        wake_worker();
+    }
+}
+
+void Room::note_sound(uint32_t slot, int64_t now) {
+    slot_activity_[slot].last_sound_ns.store(now, std::memory_order_relaxed);
+    const uint32_t bit = 1u << slot;
+    if (streaming_mask_.load(std::memory_order_relaxed) & bit) return;
+    streaming_mask_.fetch_or(bit, std::memory_order_relaxed);
+    if (needs_mixing()) wake_worker();
+}
+
+void Room::expire_streams() {
+    cycles_since_stream_check_ = 0;
+    const int64_t cutoff = now_ns() -
+        std::chrono::duration_cast<std::chrono::nanoseconds>(kStreamingTimeout).count();
+    uint32_t expired = 0;
+    for (uint32_t streaming = streaming_mask_.load(std::memory_order_relaxed); streaming;
+         streaming &= streaming - 1) {
+        const uint32_t slot = static_cast<uint32_t>(__builtin_ctz(streaming));
+        if (slot_activity_[slot].last_sound_ns.load(std::memory_order_relaxed) < cutoff) {
+            expired |= 1u << slot;
+        }
+    }
+    if (expired) streaming_mask_.fetch_and(~expired, std::memory_order_relaxed);
+}
+
+void Room::wake_worker() {
+#ifdef __linux__
+    int fd = wake_fd_.load(std::memory_order_acquire);
+    if (fd >= 0) {
+        uint64_t val = 1;
+        (void)::write(fd, &val, sizeof(val));
+    }
+#endif
+}
+
+void Room::forward_direct(uint32_t source, uint32_t listeners, const uint8_t* data,
+                          size_t len, uint8_t channels, bool silent, int64_t now) {
+    TUTTI_TRACE_ARG("room.forward", source);
+    // Opus packets pass through untouched: routes only pair an Opus
+    // listener with an Opus source at unity gain. PCM routes pair sessions
+    // with the same channel count.
+    const size_t pcm_len = pcm_packet_size(channels);
+    const size_t out_len = silent ? wire_size(true, channels)
+                                  : (is_opus_datagram(len) ? len : pcm_len);
+    std::atomic<uint32_t>* readers = routes_[source].readers;
+    uint32_t phase = enter_routes(readers);
+    while (listeners) {
+        uint32_t listener = static_cast<uint32_t>(__builtin_ctz(listeners));
+        listeners &= listeners - 1;
+
+        SlotRoute& route = routes_[listener];
+        TransportSession* session = route.session.load(std::memory_order_acquire);
+        if (!session) continue;
+
+        slot_activity_[listener].last_audio_sent_ns.store(now, std::memory_order_relaxed);
+        GainEntry ge = mixer_.get_gain_entry(listener, source);
+        if (ge.muted || ge.gain <= 0.0f) continue;
+        uint32_t output_seq = route.output_sequence.fetch_add(1, std::memory_order_relaxed);
+
+        uint8_t buf[kMaxAudioPacketSize];
+        if (silent) {
+            // Marker, or (markers off) a zero frame: only the header carries over
+            std::memcpy(buf, &output_seq, sizeof(output_seq));
+            std::memcpy(buf + 4, data + 4, sizeof(uint32_t));
+            if (out_len > kAudioHeaderSize) std::memset(buf + kAudioHeaderSize, 0, out_len - kAudioHeaderSize);
+        } else if (out_len < kAudioPacketSize) {
+            std::memcpy(buf, data, out_len);
+            std::memcpy(buf, &output_seq, sizeof(output_seq));
+        } else if (ge.gain == 1.0f) {
             // Near-zero-copy: memcpy + overwrite sequence number
-            uint8_t buf[kAudioPacketSize];
-            std::memcpy(buf, data, kAudioPacketSize);
+            std::memcpy(buf, data, pcm_len);
             std::memcpy(buf, &output_seq, sizeof(output_seq));
-            if (target_session)
-                target_session->send_datagram(buf, kAudioPacketSize);
         } else {
-            // Apply gain, re-serialize
-            auto pkt = AudioPacket::deserialize(data, len);
-            for (size_t s = 0; s < kSamplesPerFrame; ++s) {
-                pkt.samples[s] = static_cast<int16_t>(
-                    std::clamp(
-                        static_cast<int32_t>(std::lround(pkt.samples[s] * ge.gain)),
-                        static_cast<int32_t>(std::numeric_limits<int16_t>::min()),
-                        static_cast<int32_t>(std::numeric_limits<int16_t>::max())));
-            }
+            // Apply gain, re-serialize. Gains never exceed unity, so the
+            // result can't clip and needs no limiter.
+            auto pkt = AudioPacket::deserialize(data, pcm_len);
+            const MixKernels& k = mix_kernels();
+            float scaled[kSamplesPerFrame * kMaxChannels] = {};
+            const size_t n = kSamplesPerFrame * pkt.channels;
+            k.accumulate_scaled(scaled, pkt.samples, ge.gain, n);
+            k.store(pkt.samples, scaled, n);
             pkt.sequence = output_seq;
-            uint8_t buf[kAudioPacketSize];
             pkt.serialize(buf);
-            if (target_session)
-                target_session->send_datagram(buf, kAudioPacketSize);
         }
-        return;
+        session->send_datagram(buf, out_len);
     }
+    readers[phase].fetch_sub(1, std::memory_order_release);
+}
 
-    // 3+ participant path: push to mixer
-    auto pkt = AudioPacket::deserialize(data, len);
-    auto frame = AudioFrame::from_packet(pkt);
-    mixer_.push_input(participant_id, frame);
+void Room::forward_rest(uint32_t source, uint32_t listeners, const uint8_t* data, int64_t now) {
+    std::atomic<uint32_t>* readers = routes_[source].readers;
+    uint32_t phase = enter_routes(readers);
+    while (listeners) {
+        uint32_t listener = static_cast<uint32_t>(__builtin_ctz(listeners));
+        listeners &= listeners - 1;
+
+        SlotRoute& route = routes_[listener];
+        TransportSession* session = route.session.load(std::memory_order_acquire);
+        if (!session) continue;
+
+        slot_activity_[listener].last_audio_sent_ns.store(now, std::memory_order_relaxed);
+        uint32_t output_seq = route.output_sequence.fetch_add(1, std::memory_order_relaxed);
+        const size_t len = wire_size(true, route.channels.load(std::memory_order_relaxed));
+        uint8_t buf[kMaxAudioPacketSize];
+        std::memcpy(buf, &output_seq, sizeof(output_seq));
+        std::memcpy(buf + 4, data + 4, sizeof(uint32_t));
+        if (len > kAudioHeaderSize) std::memset(buf + kAudioHeaderSize, 0, len - kAudioHeaderSize);
+        session->send_datagram(buf, len);
+    }
+    readers[phase].fetch_sub(1, std::memory_order_release);
+}
 
-    // Notify mixer thread if all frames have arrived this cycle
-    uint32_t received = frames_received_.fetch_add(1, std::memory_order_acq_rel) + 1;
-    if (received >= count) {
-#ifdef __linux__
-        uint64_t val = 1;
-        (void)::write(notify_fd_, &val, sizeof(val));
-#endif
+uint32_t Room::enter_routes(std::atomic<uint32_t>* readers) {
+    for (;;) {
+        uint32_t phase = route_phase_.load(std::memory_order_seq_cst) & 1;
+        readers[phase].fetch_add(1, std::memory_order_seq_cst);
+        if ((route_phase_.load(std::memory_order_seq_cst) & 1) == phase) return phase;
+        // A writer flipped in between: it may not wait for us, so retry
+        readers[phase].fetch_sub(1, std::memory_order_release);
+    }
+}
+
+void Room::synchronize_routes() {
+    std::lock_guard<std::mutex> lock(route_sync_mutex_);  // one grace period at a time
+    // Readers that entered before the flip see the old phase; anyone after
+    // it sees the routes already republished without the retired session
+    uint32_t old_phase = route_phase_.fetch_add(1, std::memory_order_seq_cst) & 1;
+    for (size_t i = 0; i < slot_count_; ++i) {
+        while (routes_[i].readers[old_phase].load(std::memory_order_acquire) != 0) {
+            std::this_thread::yield();
+        }
+    }
+    while (send_readers_[old_phase].load(std::memory_order_acquire) != 0) {
+        std::this_thread::yield();
     }
 }
 
+void Room::publish_routes() {
+    const uint32_t slots = static_cast<uint32_t>(slot_count_);
+    std::array<TransportSession*, Mixer::kMaxSlots> sessions{};
+    std::array<AudioCodec, Mixer::kMaxSlots> codecs{};
+    std::array<uint8_t, Mixer::kMaxSlots> channels{};
+    uint32_t bound = 0;
+    uint32_t performers = 0;  // listen-only participants are never sources
+    for (const auto& [id, p] : participants_) {
+        // Only bound participants are heard or sent to
+        if (p.session) bound |= 1u << p.slot.index;
+        if (p.session && !p.listen_only) performers |= 1u << p.slot.index;
+        sessions[p.slot.index] = p.session.get();
+        codecs[p.slot.index] = p.codec;
+        channels[p.slot.index] = p.channels;
+    }
+
+    // A listener with exactly one audible source needn't be mixed, if the
+    // packet can go out as it came in (same codec and channel count; Opus
+    // can't take a gain, nor a forwarded stereo frame a pan), and the room
+    // isn't recording mixes: a forwarded stream has none to record
+    std::array<uint32_t, Mixer::kMaxSlots> direct_from{};
+    std::array<uint32_t, Mixer::kMaxSlots> resting_from{};  // each mixed listener's lowest source
+    uint32_t direct = 0;
+    bool mixing = recording_.load(std::memory_order_relaxed);  // the recorder taps the mixer
+    uint32_t mixed_sources = 0;
+    for (uint32_t listener = 0; listener < slots; ++listener) {
+        if (!(bound & (1u << listener))) continue;
+        uint32_t audible = 0;
+        uint32_t heard = 0;
+        uint32_t only_source = 0;
+        float only_gain = 1.0f;
+        float only_pan = 0.0f;
+        for (uint32_t source = 0; source < slots; ++source) {
+            if (source == listener || !(performers & (1u << source))) continue;
+            GainEntry ge = mixer_.get_gain_entry(listener, source);
+            if (ge.muted || ge.gain <= 0.0f) continue;
+            ++audible;
+            heard |= 1u << source;
+            only_source = source;
+            only_gain = ge.gain;
+            only_pan = ge.pan;
+        }
+        bool forwardable = audible == 1 && !recording_mixes_ &&
+                           codecs[only_source] == codecs[listener] &&
+                           (codecs[listener] == AudioCodec::Pcm || only_gain == 1.0f) &&
+                           channels[only_source] == channels[listener] &&
+                           (channels[listener] == 1 || only_pan == 0.0f);
+        if (forwardable) {
+            direct_from[only_source] |= 1u << listener;
+            direct |= 1u << listener;
+        } else if (audible > 0) {
+            mixing = true;
+            mixed_sources |= heard;
+            resting_from[__builtin_ctz(heard)] |= 1u << listener;
+        }
+    }
+
+    // Start mixing before any direct route goes away. An idle worker is
+    // asleep with its clock stopped: wake it to start the clock.
+    mixed_sources_.store(mixed_sources, std::memory_order_relaxed);
+    if (mixing && !mixing_.exchange(true, std::memory_order_release) && needs_mixing()) {
+        wake_worker();
+    }
+    for (uint32_t i = 0; i < slots; ++i) {
+        routes_[i].session.store(sessions[i], std::memory_order_seq_cst);
+        routes_[i].codec.store(codecs[i], std::memory_order_relaxed);
+        routes_[i].channels.store(std::max<uint8_t>(channels[i], 1), std::memory_order_relaxed);
+        routes_[i].direct_listeners.store(direct_from[i], std::memory_order_release);
+        routes_[i].resting_listeners.store(resting_from[i], std::memory_order_release);
+    }
+    mixer_.set_direct_listeners(direct);
+    if (!mixing) mixing_.store(false, std::memory_order_relaxed);
+}
+
 void Room::set_gain(const std::string& listener_id,
                     const std::string& source_id,
                     float gain) {
-    mixer_.set_gain(listener_id, source_id, gain);
+    float previous = 1.0f;
+    bool applied = mixer_.set_gain(listener_id, source_id, gain, &previous);
+    capture_gain_change(CaptureEvent::Gain, listener_id, source_id, gain);
+    // Routes only care whether a source is audible and at unity: a fader
+    // moving between the two leaves them, and the lock, alone
+    gain = std::clamp(gain, 0.0f, 1.0f);
+    if (!applied || ((previous > 0.0f) == (gain > 0.0f) && (previous == 1.0f) == (gain == 1.0f))) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(participants_mutex_);
+    publish_routes();
 }
 
 void Room::set_mute(const std::string& listener_id,
                     const std::string& source_id,
                     bool muted) {
-    mixer_.set_mute(listener_id, source_id, muted);
+    bool previous = false;
+    bool applied = mixer_.set_mute(listener_id, source_id, muted, &previous);
+    capture_gain_change(CaptureEvent::Mute, listener_id, source_id, muted ? 1.0f : 0.0f);
+    if (!applied || previous == muted) return;
+    std::lock_guard<std::mutex> lock(participants_mutex_);
+    publish_routes();
+}
+
+void Room::set_pan(const std::string& listener_id,
+                   const std::string& source_id,
+                   float pan) {
+    float previous = 0.0f;
+    bool applied = mixer_.set_pan(listener_id, source_id, pan, &previous);
+    capture_gain_change(CaptureEvent::Pan, listener_id, source_id, pan);
+    // Only a centred pan can be forwarded: moving off-centre is what matters
+    pan = std::clamp(pan, -1.0f, 1.0f);
+    if (!applied || (previous == 0.0f) == (pan == 0.0f)) return;
+    std::lock_guard<std::mutex> lock(participants_mutex_);
+    publish_routes();
 }
 
 bool Room::claim(const std::string& password) {
     std::lock_guard<std::mutex> lock(password_mutex_);
     password_ = password;
+    if (lobby_signal_) lobby_signal_->notify();
     return true;
 }
 
@@ -243,11 +581,147 @@ bool Room::check_password(const std::string& password) const {
 void Room::clear_password() {
     std::lock_guard<std::mutex> lock(password_mutex_);
     password_.clear();
+    if (lobby_signal_) lobby_signal_->notify();
 }
 
-size_t Room::participant_count() const {
+RoomAudioMetrics Room::audio_metrics() const {
+    RoomAudioMetrics m;
+    m.mix_cycles = metrics_.mix_cycles();
+    auto participants = roster();
+    uint32_t mask = mixer_.occupied_mask();
+    for (uint32_t i = 0; i < slot_count_; ++i) {
+        if (!(mask & (1u << i))) continue;
+        ParticipantAudioMetrics p;
+        p.slot = i;
+        p.counters = metrics_.slot(i);
+        p.jitter = mixer_.jitter_stats(i);
+        p.output_depth = mixer_.output_depth(i);
+        p.output_drops = mixer_.output_drops(i);
+        for (const auto& info : *participants) {
+            if (info.slot != i) continue;
+            p.id = info.id;
+            p.alias = info.alias;
+        }
+        m.participants.push_back(p);
+    }
+    return m;
+}
+
+bool Room::start_capture(const std::string& path) {
+    std::lock_guard<std::mutex> capture_lock(capture_mutex_);
     std::lock_guard<std::mutex> lock(participants_mutex_);
-    return participants_.size();
+    if (!capture_owner_) capture_owner_ = std::make_unique<PacketCapture>();
+    if (!capture_owner_->start(path, name_, max_participants_)) return false;
+    capture_.store(capture_owner_.get(), std::memory_order_release);
+    capture_snapshot();
+    return true;
+}
+
+void Room::stop_capture() {
+    std::lock_guard<std::mutex> lock(capture_mutex_);
+    if (capture_owner_) capture_owner_->stop();
+}
+
+bool Room::capturing() const {
+    std::lock_guard<std::mutex> lock(capture_mutex_);
+    return capture_owner_ && capture_owner_->active();
+}
+
+void Room::capture_event(CaptureEvent kind, uint32_t slot, const uint8_t* data, size_t len) {
+    if (PacketCapture* capture = capture_.load(std::memory_order_acquire)) {
+        capture->record(kind, slot, data, len, now_ns());
+    }
+}
+
+void Room::capture_gain_change(CaptureEvent kind, const std::string& listener_id,
+                               const std::string& source_id, float value) {
+    if (!capture_.load(std::memory_order_acquire)) return;
+    ParticipantSlot listener = mixer_.slot_of(listener_id);
+    ParticipantSlot source = mixer_.slot_of(source_id);
+    if (!listener.valid() || !source.valid()) return;
+
+    // u16 source slot, then f32 (gain, pan) or u8 (muted)
+    uint8_t payload[6];
+    const uint16_t source_index = static_cast<uint16_t>(source.index);
+    std::memcpy(payload, &source_index, sizeof(source_index));
+    size_t len = sizeof(payload);
+    if (kind == CaptureEvent::Mute) {
+        payload[2] = value != 0.0f;
+        len = 3;
+    } else {
+        std::memcpy(payload + 2, &value, sizeof(value));
+    }
+    capture_event(kind, listener.index, payload, len);
+}
+
+void Room::capture_participant(const std::string& id) {
+    if (!capture_.load(std::memory_order_acquire)) return;
+    const Participant& p = participants_.at(id);
+    uint8_t join[1 + 255] = {static_cast<uint8_t>(p.listen_only)};
+    const size_t id_len = std::min<size_t>(id.size(), 255);
+    std::memcpy(join + 1, id.data(), id_len);
+    capture_event(CaptureEvent::Join, p.slot.index, join, 1 + id_len);
+    if (p.session) {
+        const uint8_t bind[2] = {static_cast<uint8_t>(p.codec), p.channels};
+        capture_event(CaptureEvent::Bind, p.slot.index, bind, sizeof(bind));
+    }
+}
+
+void Room::capture_snapshot() {
+    for (const auto& entry : participants_) capture_participant(entry.first);
+    for (const auto& [listener_id, listener] : participants_) {
+        for (const auto& [source_id, source] : participants_) {
+            if (listener_id == source_id) continue;
+            GainEntry ge = mixer_.get_gain_entry(listener.slot.index, source.slot.index);
+            if (ge.gain != 1.0f) capture_gain_change(CaptureEvent::Gain, listener_id, source_id, ge.gain);
+            if (ge.muted) capture_gain_change(CaptureEvent::Mute, listener_id, source_id, 1.0f);
+            if (ge.pan != 0.0f) capture_gain_change(CaptureEvent::Pan, listener_id, source_id, ge.pan);
+        }
+    }
+}
+
+bool Room::start_recording(const std::string& dir, bool mixes) {
+    std::lock_guard<std::mutex> recording_lock(recording_mutex_);
+    std::unique_lock<std::mutex> lock(participants_mutex_);
+    if (!recorder_) recorder_ = std::make_unique<SessionRecorder>();
+    if (!recorder_->start(dir, mixes)) return false;
+    for (const auto& [id, p] : participants_) {
+        recorder_->name_track(p.slot.index, p.slot.generation, id);
+    }
+    recording_.store(true, std::memory_order_relaxed);
+    recording_mixes_ = mixes;
+    publish_routes();
+    mixer_.set_recorder(recorder_.get());
+    announce_recording();
+    lock.unlock();
+    flush_outbox();
+    return true;
+}
+
+void Room::stop_recording() {
+    std::lock_guard<std::mutex> recording_lock(recording_mutex_);
+    if (!recorder_ || !recorder_->active()) return;
+    {
+        std::lock_guard<std::mutex> lock(participants_mutex_);
+        mixer_.set_recorder(nullptr);
+        recording_.store(false, std::memory_order_relaxed);
+        recording_mixes_ = false;
+        publish_routes();
+        announce_recording();
+    }
+    flush_outbox();
+    recorder_->stop();
+}
+
+void Room::announce_recording() {
+    broadcast(std::make_shared<const std::string>(nlohmann::json{
+        {"type", "recording"},
+        {"recording", recording_.load(std::memory_order_relaxed)}
+    }.dump()));
+}
+
+size_t Room::participant_count() const {
+    return performer_count_.load(std::memory_order_relaxed);
 }
 
 RoomStatus Room::status() const {
@@ -261,11 +735,35 @@ std::vector<Room::ParticipantInfo> Room::get_participants() const {
     std::vector<ParticipantInfo> result;
     result.reserve(participants_.size());
     for (const auto& [id, p] : participants_) {
-        result.push_back({id, p.alias});
+        result.push_back({id, p.alias, p.slot.index, p.listen_only});
     }
     return result;
 }
 
+void Room::publish_roster() {
+    auto roster = std::make_shared<std::vector<ParticipantInfo>>();
+    roster->reserve(participants_.size());
+    size_t listeners = 0;
+    for (const auto& [id, p] : participants_) {
+        roster->push_back({id, p.alias, p.slot.index, p.listen_only});
+        listeners += p.listen_only;
+    }
+    // Serialized once per change, for every participant who binds until the next
+    nlohmann::json state = {{"type", "room_state"}, {"participants", nlohmann::json::array()}};
+    for (const auto& info : *roster) {
+        state["participants"].push_back({
+            {"id", info.id},
+            {"name", info.alias},
+            {"listen_only", info.listen_only}
+        });
+    }
+    room_state_ = std::make_shared<const std::string>(state.dump());
+    performer_count_.store(participants_.size() - listeners, std::memory_order_relaxed);
+    listener_count_.store(listeners, std::memory_order_relaxed);
+    std::atomic_store(&roster_, std::shared_ptr<const std::vector<ParticipantInfo>>(std::move(roster)));
+    if (lobby_signal_) lobby_signal_->notify();
+}
+
 size_t Room::reap_stale_participants() {
     std::vector<std::string> to_reap;
     auto now = std::chrono::steady_clock::now();
@@ -292,8 +790,9 @@ size_t Room::reap_stale_participants() {
             if (count <= 1) continue;
 
             // Check audio inactivity (both directions)
-            int64_t last_recv = p.last_audio_received_ns;
-            int64_t last_sent = p.last_audio_sent_ns;
+            const auto& activity = slot_activity_[p.slot.index];
+            int64_t last_recv = activity.last_audio_received_ns.load(std::memory_order_relaxed);
+            int64_t last_sent = activity.last_audio_sent_ns.load(std::memory_order_relaxed);
             int64_t last_activity = std::max(last_recv, last_sent);
 
             if (last_activity == 0) {
@@ -316,73 +815,63 @@ size_t Room::reap_stale_participants() {
     return to_reap.size();
 }
 
-void Room::mixer_thread_func() {
-#ifdef __linux__
-    // Set RT priority for mixer thread
-    struct sched_param param;
-    param.sched_priority = sched_get_priority_max(SCHED_FIFO);
-    if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) != 0) {
-        std::cerr << "[Room:" << name_ << "] Warning: Could not set RT priority\n";
-    }
-
-    // Pin to a core (optional, improves cache locality)
-    cpu_set_t cpuset;
-    CPU_ZERO(&cpuset);
-    CPU_SET(1, &cpuset); // Pin to core 1
-    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
-#endif
-
-    // Mix cycle interval: match one render quantum (~2.67ms at 48kHz/128 samples)
-    constexpr auto mix_interval =
-        std::chrono::microseconds(1000000 * kSamplesPerFrame / kSampleRate);
-
-    while (running_) {
-#ifdef __linux__
-        // Event-driven: wait for all participants' frames or timeout
-        struct pollfd pfd;
-        pfd.fd = notify_fd_;
-        pfd.events = POLLIN;
-        // Timeout slightly above one frame period to catch stragglers
-        int ret = poll(&pfd, 1, 3);
-        if (ret > 0 && (pfd.revents & POLLIN)) {
-            uint64_t val;
-            (void)::read(notify_fd_, &val, sizeof(val));
-        }
-#else
-        std::this_thread::sleep_for(mix_interval);
-#endif
-
-        frames_received_.store(0, std::memory_order_release);
-        mixer_.mix_cycle();
-        send_outputs();
-    }
-}
-
-void Room::send_outputs() {
-    // Collect outputs under lock, then send outside to avoid holding
-    // the mutex during network I/O (which contends with receive thread)
-    pending_sends_.clear();
-    {
-        std::lock_guard<std::mutex> lock(participants_mutex_);
-        for (auto& [id, participant] : participants_) {
-            AudioFrame frame;
-            if (mixer_.pop_output(id, frame)) {
-                participant.last_audio_sent_ns = now_ns();
-                frame.sequence = participant.output_sequence++;
-                PendingSend ps;
-                ps.session = participant.session;
-                auto pkt = frame.to_packet();
-                pkt.serialize(ps.buf);
-                pending_sends_.push_back(std::move(ps));
+void Room::send_outputs(DatagramBatch& batch) {
+    TUTTI_TRACE("room.send_outputs");
+    // Serialize outputs into the batch from the published routes, so the
+    // worker never waits on participants_mutex_. The batch sends to raw
+    // session pointers at flush: pin them until then.
+    const uint32_t phase = enter_routes(send_readers_);
+
+    // Room-total mixes are identical: encode them once per cycle for every
+    // Opus listener that gets one
+    OpusPacket shared[OpusStreamEncoder::kMaxPacketsPerFrame];
+    size_t shared_count = 0;
+    bool shared_encoded = false;
+
+    for (uint32_t occupied = mixer_.occupied_mask(); occupied; occupied &= occupied - 1) {
+        const uint32_t index = static_cast<uint32_t>(__builtin_ctz(occupied));
+        const ParticipantSlot slot = mixer_.slot_at(index);
+        // Read in place from the output queue, released once serialized
+        const AudioFrame* frame = mixer_.front_output(slot);
+        if (!frame) continue;
+        slot_activity_[index].last_audio_sent_ns.store(now_ns(), std::memory_order_relaxed);
+        SlotRoute& route = routes_[index];
+        TransportSession* session = route.session.load(std::memory_order_acquire);
+        if (session) {
+            if (route.codec.load(std::memory_order_relaxed) == AudioCodec::Opus && !frame->silent) {
+                OpusPacket own[OpusStreamEncoder::kMaxPacketsPerFrame];
+                const OpusPacket* packets = own;
+                size_t count;
+                if (frame->room_total) {
+                    if (!shared_encoded) {
+                        shared_count = shared_encoder_->encode(*frame, shared);
+                        shared_encoded = true;
+                    }
+                    packets = shared;
+                    count = shared_count;
+                } else {
+                    count = opus_encoders_[index].encode(*frame, own);
+                }
+                for (size_t i = 0; i < count; ++i) {
+                    uint32_t seq = route.output_sequence.fetch_add(1, std::memory_order_relaxed);
+                    uint8_t* buf = batch.append(session, kAudioHeaderSize + packets[i].payload_len);
+                    std::memcpy(buf, &seq, sizeof(seq));
+                    std::memcpy(buf + 4, &packets[i].timestamp, sizeof(packets[i].timestamp));
+                    std::memcpy(buf + kAudioHeaderSize, packets[i].payload, packets[i].payload_len);
+                }
+            } else {
+                // The frame is its own datagram (a silent one's samples are
+                // zero): one copy out, then this listener's sequence number
+                uint32_t seq = route.output_sequence.fetch_add(1, std::memory_order_relaxed);
+                size_t len = wire_size(frame->silent, frame->channels);
+                uint8_t* buf = batch.append(session, len);
+                std::memcpy(buf, frame->wire_data(), len);
+                std::memcpy(buf, &seq, sizeof(seq));
             }
         }
+        mixer_.pop_front_output(slot);
     }
-
-    // Send outside the lock
-    for (auto& ps : pending_sends_) {
-        if (ps.session)
-            ps.session->send_datagram(ps.buf, kAudioPacketSize);
-    }
+    batch.hold(&send_readers_[phase]);
 }
 
 } // namespace tutti
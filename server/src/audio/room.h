@@ -2,13 +2,21 @@
 
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <memory>
 #include <mutex>
 #include <string>
-#include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include "mixer.h"
+#include "opus_codec.h"
+#include "silence_gate.h"
+#include "telemetry/latency.h"
+#include "session_recorder.h"
+#include "telemetry/packet_capture.h"
+#include "telemetry/room_metrics.h"
+#include "transport/datagram_batch.h"
 #include "transport/transport_interface.h"
 
 namespace tutti {
@@ -20,39 +28,131 @@ enum class RoomStatus {
     Full     // At max capacity
 };
 
+/// Counts changes to what the lobby shows (occupancy, claims) across a
+/// RoomManager's rooms and wakes whoever is waiting for the next one
+class LobbySignal {
+public:
+    void notify() {
+        version_.fetch_add(1, std::memory_order_release);
+        { std::lock_guard<std::mutex> lock(mutex_); }  // no lost wakeup
+        cv_.notify_all();
+    }
+
+    uint64_t version() const { return version_.load(std::memory_order_acquire); }
+
+    /// Block until version() differs from `seen` or `timeout` passes
+    uint64_t wait(uint64_t seen, std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait_for(lock, timeout, [&] { return version() != seen; });
+        return version();
+    }
+
+private:
+    std::atomic<uint64_t> version_{0};
+    std::mutex mutex_;
+    std::condition_variable cv_;
+};
+
 /// Helper: current time as nanoseconds since epoch (steady clock)
 inline int64_t now_ns() {
     return std::chrono::steady_clock::now().time_since_epoch().count();
 }
 
+/// Audio-path metrics for one occupied mixer slot
+struct ParticipantAudioMetrics {
+    uint32_t slot = 0;
+    std::string id;
+    std::string alias;
+    SlotMetrics counters;
+    JitterStats jitter;          // input buffer; jitter.depth is input occupancy
+    size_t output_depth = 0;     // mixed frames waiting to be sent
+    uint64_t output_drops = 0;   // mixed frames lost to a full output queue
+};
+
+/// Lock-free snapshot of a room's audio-path metrics
+struct RoomAudioMetrics {
+    LatencyHistogram::Snapshot mix_cycles;
+    std::vector<ParticipantAudioMetrics> participants;  // occupied slots, by index
+};
+
 // Reaper timeouts
 constexpr auto kUnboundTimeout = std::chrono::seconds(15);
 constexpr auto kInactivityTimeout = std::chrono::seconds(15);
 
-/// A single rehearsal room with its own mixer and RT thread.
-class Room {
+/// A source counts as streaming this long after its last non-silent frame,
+/// so a rest in the music doesn't park the room
+constexpr auto kStreamingTimeout = std::chrono::seconds(5);
+
+/// A single rehearsal room with its own mixer.
+/// Mix cycles are driven by a MixerScheduler worker, not a per-room thread.
+class Room : public DatagramSink {
 public:
+    /// Listen-only seats on top of max_participants: they hear the room
+    /// but send nothing into it. Listeners at default gains share one mix.
+    static constexpr size_t kListenOnlySeats = 16;
+
+    /// Most performer seats a room can have: with its listen-only seats
+    /// they fill the mixer's slots. Larger requests are clamped, with a warning.
+    static constexpr size_t kMaxParticipants = Mixer::kMaxSlots - kListenOnlySeats;
+
     explicit Room(const std::string& name, size_t max_participants = 4);
-    ~Room();
+    ~Room() override;
 
-    // Non-copyable, non-movable (owns a thread)
+    // Non-copyable, non-movable (referenced by mixer workers and sessions)
     Room(const Room&) = delete;
     Room& operator=(const Room&) = delete;
 
-    /// Start the mixer RT thread
-    void start();
+    /// Run one mix cycle and append the results to `batch`, which the
+    /// caller flushes. Called from the owning MixerScheduler worker (RT thread).
+    void process_cycle(DatagramBatch& batch);
+
+    /// Run one mix cycle and send the results immediately
+    void process_cycle();
+
+    /// Drop audio still queued for the mixer. Called from the owning worker
+    /// when the room stops needing mixing.
+    void park();
+
+    /// True when some bound listener can't be served by direct forwarding
+    /// (they hear 2+ bound sources, or a codec, channel or gain change
+    /// stands between them and their only one) and a source they hear is
+    /// streaming, or the room is recording. Turning true wakes the owning
+    /// worker, which sleeps while none of its rooms needs mixing.
+    bool needs_mixing() const {
+        if (!mixing_.load(std::memory_order_relaxed)) return false;
+        return recording_.load(std::memory_order_relaxed) ||
+               (streaming_mask_.load(std::memory_order_relaxed) &
+                mixed_sources_.load(std::memory_order_relaxed)) != 0;
+    }
+
+    /// True (once) if every participant has delivered a frame since the
+    /// last cycle, so the worker can mix before the quantum deadline.
+    /// Tracked per slot: a participant sending twice doesn't stand in for
+    /// one that hasn't sent.
+    bool take_mix_ready() {
+        return mix_ready_.exchange(false, std::memory_order_acq_rel);
+    }
 
-    /// Stop the mixer RT thread
-    void stop();
+    /// eventfd of the owning worker, signalled when the room starts needing
+    /// mixing and when it is ready to mix
+    void set_wake_fd(int fd) { wake_fd_.store(fd, std::memory_order_release); }
 
-    /// Add a participant to the room
+    /// Add a participant to the room. A `listen_only` one takes a
+    /// listen-only seat; their audio is ignored.
     bool add_participant(const std::string& id,
                         const std::string& alias,
-                        std::shared_ptr<TransportSession> session);
+                        std::shared_ptr<TransportSession> session,
+                        bool listen_only = false);
 
-    /// Attach a transport session to an existing participant (called after bind)
+    /// Attach a transport session to an existing participant (called after bind).
+    /// On success, `slot_out` (if given) receives the participant's mixer slot.
+    /// `codec` is what the session receives; it must be codec_supported().
+    /// `channels` (1 or 2) is what it sends and receives; stereo is PCM only.
     bool attach_session(const std::string& id,
-                        std::shared_ptr<TransportSession> session);
+                        std::shared_ptr<TransportSession> session,
+                        ParticipantSlot* slot_out = nullptr,
+                        AudioCodec codec = AudioCodec::Pcm,
+                        uint8_t channels = 1);
 
     /// Remove a participant from the room
     void remove_participant(const std::string& id);
@@ -60,9 +160,23 @@ public:
     /// Remove stale participants (unbound or inactive). Returns count reaped.
     size_t reap_stale_participants();
 
-    /// Handle incoming audio datagram from a participant
-    void on_audio_received(const std::string& participant_id,
-                           const uint8_t* data, size_t len);
+    /// Handle incoming audio datagram from a participant. Lock-free.
+    /// Listeners whose only audible source is this participant (both sides
+    /// of a 2-party room; students who mute each other and hear only the
+    /// teacher) get the packet forwarded directly; with 3+ participants it
+    /// also goes to the mixer for everyone else. Silent frames (gated, or a
+    /// header-only silence marker) are never mixed. A stereo session's
+    /// frames must be full stereo datagrams.
+    void on_audio_received(ParticipantSlot slot, const uint8_t* data, size_t len) override;
+
+    /// Send listeners a header-only silence marker instead of an all-zero
+    /// frame (default on). Off keeps every datagram full-size.
+    void set_silence_markers(bool enabled) {
+        silence_markers_.store(enabled, std::memory_order_relaxed);
+    }
+
+    /// Mixer slot for a participant (invalid if not in the room)
+    ParticipantSlot slot_of(const std::string& id) const { return mixer_.slot_of(id); }
 
     /// Set gain for a participant's mix
     void set_gain(const std::string& listener_id,
@@ -74,6 +188,11 @@ public:
                   const std::string& source_id,
                   bool muted);
 
+    /// Set where a source sits in a stereo listener's mix (-1 left, +1 right)
+    void set_pan(const std::string& listener_id,
+                 const std::string& source_id,
+                 float pan);
+
     /// Claim the room with a password
     bool claim(const std::string& password);
 
@@ -83,62 +202,241 @@ public:
     /// Clear password (when room empties)
     void clear_password();
 
-    // Accessors
+    // Accessors. Counts and capacity are of performers; listen-only
+    // participants are counted apart.
     const std::string& name() const { return name_; }
     size_t participant_count() const;
+    size_t listener_count() const { return listener_count_.load(std::memory_order_relaxed); }
     size_t max_participants() const { return max_participants_; }
     RoomStatus status() const;
-    bool is_empty() const { return participant_count() == 0; }
+    bool is_empty() const { return participant_count() == 0 && listener_count() == 0; }
     bool is_full() const { return participant_count() >= max_participants_; }
+    bool listeners_full() const { return listener_count() >= kListenOnlySeats; }
 
     /// Get participant info for room state messages
     struct ParticipantInfo {
         std::string id;
         std::string alias;
+        uint32_t slot = ParticipantSlot::kInvalid;
+        bool listen_only = false;
     };
     std::vector<ParticipantInfo> get_participants() const;
 
+    /// Codec a participant's session receives (PCM if absent)
+    AudioCodec codec_of(const std::string& id) const;
+
+    /// Immutable participant list, republished on join/leave.
+    /// Readers never take participants_mutex_.
+    std::shared_ptr<const std::vector<ParticipantInfo>> roster() const {
+        return std::atomic_load(&roster_);
+    }
+
+    /// Notified whenever what the lobby shows (occupancy, claimed) may have
+    /// changed. Set before the room is shared.
+    void set_lobby_signal(std::shared_ptr<LobbySignal> signal) { lobby_signal_ = std::move(signal); }
+
+    /// Audio-path counters, histograms and queue depths. Takes no room locks.
+    RoomAudioMetrics audio_metrics() const;
+
+    /// Ping/RTT tracking and the last mix duration
+    const LatencyTracker& latency() const { return latency_; }
+
+    /// Record inbound datagrams, mix cycles, joins, binds, leaves and gain
+    /// changes to `path` for CaptureReplay. The room as it stands is
+    /// recorded first. False if already capturing or the file can't be made.
+    bool start_capture(const std::string& path);
+    void stop_capture();
+    bool capturing() const;
+
+    /// Record every participant's input, and each listener's mix if
+    /// `mixes`, as WAV files in `dir` (see SessionRecorder). The room mixes
+    /// while recording, even a room direct forwarding could serve; with
+    /// `mixes` nobody is forwarded to, since a forwarded stream has no mix
+    /// to record. Participants are told with a "recording" message. False if already recording or
+    /// `dir` can't be made.
+    bool start_recording(const std::string& dir, bool mixes);
+    void stop_recording();
+    bool recording() const { return recording_.load(std::memory_order_relaxed); }
+
 private:
-    /// RT mixer thread function
-    void mixer_thread_func();
+    /// Queue mixed output for all participants
+    void send_outputs(DatagramBatch& batch);
+
+    /// Hand one frame to the mixer
+    void push_to_mixer(ParticipantSlot slot, const AudioFrame& frame);
+    /// The same for a PCM datagram, which goes straight into the jitter buffer
+    void push_to_mixer(ParticipantSlot slot, const uint8_t* data, uint8_t channels, bool silent);
+    /// Count a push; once every occupied slot has delivered, wake the worker
+    void note_delivery(ParticipantSlot slot, bool accepted);
+    /// Signal the owning worker's eventfd, if the room has one
+    void wake_worker();
+    /// While the room is parked, send each listener `source` keys a
+    /// silence marker (a zero frame with markers off) in place of the mix
+    void forward_rest(uint32_t source, uint32_t listeners, const uint8_t* data, int64_t now);
+    /// Mark a source as sending sound; wakes the worker if that makes the
+    /// room need mixing
+    void note_sound(uint32_t slot, int64_t now);
+    /// Drop sources that have been quiet for kStreamingTimeout (worker)
+    void expire_streams();
+
+    /// Record an event if capturing
+    void capture_event(CaptureEvent kind, uint32_t slot, const uint8_t* data = nullptr,
+                       size_t len = 0);
+    /// Record a gain, mute or pan change between two participants
+    void capture_gain_change(CaptureEvent kind, const std::string& listener_id,
+                             const std::string& source_id, float value);
+    /// Record a participant's join, and bind if they have a session
+    /// (participants_mutex_ held)
+    void capture_participant(const std::string& id);
+    /// Record every participant's join and bind, and the gains they set
+    /// (participants_mutex_ held)
+    void capture_snapshot();
+
+    /// Tell every participant whether the room is recording (participants_mutex_ held)
+    void announce_recording();
+
+    /// Rebuild roster_, room_state_ and the counts from participants_
+    /// (participants_mutex_ held)
+    void publish_roster();
+
+    /// Queue a control message for `session` (ignored if null). Messages are
+    /// queued under participants_mutex_, in the order the changes are made,
+    /// and sent by flush_outbox() once it's released.
+    void post(const std::shared_ptr<TransportSession>& session,
+              std::shared_ptr<const std::string> message);
+    /// Queue one serialized message for every participant but `except`
+    /// (participants_mutex_ held)
+    void broadcast(const std::shared_ptr<const std::string>& message,
+                   const std::string& except = {});
+    /// Send everything queued (participants_mutex_ NOT held, so sends never
+    /// hold up the mixer worker's send_outputs)
+    void flush_outbox();
+
+    /// Recompute direct-forward routes from membership, sessions and gains
+    /// (participants_mutex_ held)
+    void publish_routes();
+
+    /// Forward a received packet to `listeners` (bit per slot) as-is,
+    /// rewriting the sequence and applying the listener's gain
+    void forward_direct(uint32_t source, uint32_t listeners, const uint8_t* data,
+                        size_t len, uint8_t channels, bool silent, int64_t now);
+
+    /// Datagram length for a PCM frame: header only for silence, if enabled
+    size_t wire_size(bool silent, size_t channels) const {
+        return silent && silence_markers_.load(std::memory_order_relaxed)
+                   ? kAudioHeaderSize : pcm_packet_size(channels);
+    }
 
-    /// Send mixed output to all participants
-    void send_outputs();
+    // Grace periods for sessions read without the lock: readers pin the
+    // current phase (a forward in its source slot, the mixer's sends in
+    // send_readers_ until their batch flushes), and a writer flips it and
+    // waits for every old-phase reader to drain before releasing a session
+    // a reader may still be sending to.
+    uint32_t enter_routes(std::atomic<uint32_t>* readers);
+    void synchronize_routes();
 
     std::string name_;
     size_t max_participants_;
+    size_t slot_count_;  // mixer slots: performers and listen-only seats
     Mixer mixer_;
 
     // Participant sessions and aliases
     struct Participant {
         std::string alias;
         std::shared_ptr<TransportSession> session;
-        uint32_t output_sequence = 0;
+        ParticipantSlot slot;
         std::chrono::steady_clock::time_point join_time;
-        int64_t last_audio_received_ns = 0;  // updated under participants_mutex_
-        int64_t last_audio_sent_ns = 0;       // updated under participants_mutex_
+        AudioCodec codec = AudioCodec::Pcm;
+        uint8_t channels = 1;
+        bool listen_only = false;
     };
     std::unordered_map<std::string, Participant> participants_;
     mutable std::mutex participants_mutex_;
+    // participants_.size(), split by seat
+    std::atomic<size_t> performer_count_{0};
+    std::atomic<size_t> listener_count_{0};
+    std::atomic<uint32_t> listen_only_mask_{0};  // bit per listen-only slot
+    std::shared_ptr<const std::vector<ParticipantInfo>> roster_;  // std::atomic_load/store only
+    std::shared_ptr<LobbySignal> lobby_signal_;  // may be null
+    // {"type":"room_state",...} for the current roster (participants_mutex_)
+    std::shared_ptr<const std::string> room_state_;
+
+    // Control messages waiting to be sent, each serialized once and shared
+    // by its recipients
+    struct OutboxEntry {
+        std::shared_ptr<TransportSession> session;
+        std::shared_ptr<const std::string> message;
+    };
+    std::mutex outbox_mutex_;  // guards outbox_; taken under participants_mutex_
+    std::vector<OutboxEntry> outbox_;
+    std::mutex outbox_send_mutex_;  // one flush at a time, so sends keep queue order
+
+    // Audio activity for the reaper, indexed by mixer slot.
+    // Stamped from the receive/send paths without taking participants_mutex_.
+    struct SlotActivity {
+        std::atomic<int64_t> last_audio_received_ns{0};
+        std::atomic<int64_t> last_audio_sent_ns{0};
+        std::atomic<int64_t> last_sound_ns{0};  // last non-silent frame
+    };
+    std::unique_ptr<SlotActivity[]> slot_activity_;
+
+    // Direct-forward routing, indexed by mixer slot. Published by
+    // publish_routes(); read lock-free by every receive thread.
+    struct alignas(64) SlotRoute {
+        std::atomic<TransportSession*> session{nullptr};  // as a listener
+        std::atomic<uint32_t> direct_listeners{0};        // as a source: bit per listener slot
+        std::atomic<uint32_t> resting_listeners{0};       // as a source: mixed listeners it keys while parked
+        std::atomic<uint32_t> output_sequence{0};         // as a listener, shared with the mixer path
+        std::atomic<uint32_t> readers[2]{};               // as a source: forwards in flight per phase
+        SilenceGate gate;                                 // as a source, receive thread
+        std::atomic<AudioCodec> codec{AudioCodec::Pcm};   // as a listener
+        std::atomic<uint8_t> channels{1};                 // as a source and a listener
+    };
+    std::unique_ptr<SlotRoute[]> routes_;
+    std::atomic<uint32_t> route_phase_{0};
+    std::atomic<uint32_t> send_readers_[2]{};  // send_outputs() batches in flight per phase
+    std::mutex route_sync_mutex_;              // serializes synchronize_routes()
+    std::atomic<bool> silence_markers_{true};
+    std::atomic<bool> mixing_{false};  // see needs_mixing()
+    std::atomic<uint32_t> mixed_sources_{0};   // sources some mixed listener hears
+    std::atomic<uint32_t> streaming_mask_{0};  // sources with recent sound
+    uint32_t cycles_since_stream_check_ = 0;   // mixer worker
+
+    // Opus state per slot, allocated only when the build supports Opus.
+    // Decoders belong to each slot's receive thread, encoders to the mixer
+    // worker; the shared encoder serves every listener whose mix is the
+    // unmodified room total.
+    std::unique_ptr<OpusStreamDecoder[]> opus_decoders_;
+    std::unique_ptr<OpusStreamEncoder[]> opus_encoders_;
+    std::unique_ptr<OpusStreamEncoder> shared_encoder_;
 
     // Password for claimed rooms
     std::string password_;
     mutable std::mutex password_mutex_;
 
-    // Pre-allocated buffer for send_outputs() to avoid RT allocation
-    struct PendingSend {
-        std::shared_ptr<TransportSession> session;
-        uint8_t buf[kAudioPacketSize];
-    };
-    std::vector<PendingSend> pending_sends_;
+    // Telemetry (lock-free on the audio path)
+    RoomMetrics metrics_;
+    LatencyTracker latency_;
+
+    // Pre-allocated batch for process_cycle() without a caller-supplied batch
+    DatagramBatch own_batch_;
+
+    // Opt-in capture: created on first start and kept for the room's
+    // lifetime, so the audio path never sees it go away
+    std::unique_ptr<PacketCapture> capture_owner_;
+    std::atomic<PacketCapture*> capture_{nullptr};
+    mutable std::mutex capture_mutex_;
 
-    // RT mixer thread
-    std::thread mixer_thread_;
-    std::atomic<bool> running_{false};
+    // Recording: created on first start and kept, as for capture
+    std::unique_ptr<SessionRecorder> recorder_;
+    std::atomic<bool> recording_{false};
+    bool recording_mixes_ = false;  // participants_mutex_
+    std::mutex recording_mutex_;
 
-    // Event-driven mixer: fires when all participants submit a frame
-    int notify_fd_ = -1;  // Linux eventfd, -1 on other platforms
-    std::atomic<uint32_t> frames_received_{0};
+    // Event-driven mixer: wake the worker early when all participants submit a frame
+    std::atomic<int> wake_fd_{-1};  // owning worker's eventfd, -1 if unassigned
+    std::atomic<bool> mix_ready_{false};
+    std::atomic<uint32_t> delivered_mask_{0};  // bit per mixer slot, cleared each cycle
 };
 
 } // namespace tutti
@@ -0,0 +1,265 @@
+#include "session_recorder.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace tutti {
+
+namespace {
+// Writer wakes this often; the queue holds ~0.3s, so this is far from full
+constexpr auto kWriterInterval = std::chrono::milliseconds(20);
+// Track buffers go to disk in blocks of ~1s of audio
+constexpr size_t kFlushSamples = kSampleRate * kMaxChannels;
+// File space reserved ahead of the write position (~40s of stereo)
+constexpr int64_t kPreallocBytes = 8 << 20;
+constexpr int64_t kWavHeaderSize = 44;
+
+static_assert((SessionRecorder::kQueueCapacity & (SessionRecorder::kQueueCapacity - 1)) == 0,
+              "queue capacity must be a power of two");
+
+void put_u16(uint8_t* p, uint16_t v) { std::memcpy(p, &v, sizeof(v)); }
+void put_u32(uint8_t* p, uint32_t v) { std::memcpy(p, &v, sizeof(v)); }
+
+/// Canonical 44-byte PCM WAV header for `data_bytes` of 16-bit samples
+void wav_header(uint8_t* h, uint8_t channels, int64_t data_bytes) {
+    const auto data = static_cast<uint32_t>(std::min<int64_t>(data_bytes, UINT32_MAX - 36));
+    std::memcpy(h, "RIFF", 4);
+    put_u32(h + 4, 36 + data);
+    std::memcpy(h + 8, "WAVEfmt ", 8);
+    put_u32(h + 16, 16);
+    put_u16(h + 20, 1);  // PCM
+    put_u16(h + 22, channels);
+    put_u32(h + 24, kSampleRate);
+    put_u32(h + 28, kSampleRate * channels * 2);
+    put_u16(h + 32, static_cast<uint16_t>(channels * 2));
+    put_u16(h + 34, 16);
+    std::memcpy(h + 36, "data", 4);
+    put_u32(h + 40, data);
+}
+
+/// Participant IDs as file names: anything unusual becomes '_'
+std::string file_name(const std::string& id) {
+    std::string out = id.empty() ? "unnamed" : id;
+    for (char& c : out) {
+        bool plain = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                     (c >= '0' && c <= '9') || c == '-' || c == '_';
+        if (!plain) c = '_';
+    }
+    return out;
+}
+
+bool write_all(int fd, const void* data, size_t len, int64_t offset) {
+    const auto* p = static_cast<const uint8_t*>(data);
+    while (len > 0) {
+        ssize_t n = ::pwrite(fd, p, len, offset);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += n;
+        len -= static_cast<size_t>(n);
+        offset += n;
+    }
+    return true;
+}
+} // namespace
+
+SessionRecorder::SessionRecorder() : ring_(new Entry[kQueueCapacity]) {}
+
+SessionRecorder::~SessionRecorder() { stop(); }
+
+bool SessionRecorder::start(const std::string& dir, bool mixes) {
+    if (writer_.joinable()) return false;
+    if (::mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST) {
+        std::cerr << "[Recorder] Cannot create " << dir << ": " << std::strerror(errno) << "\n";
+        return false;
+    }
+    dir_ = dir;
+    mixes_ = mixes;
+    {
+        std::lock_guard<std::mutex> lock(names_mutex_);
+        names_.clear();
+    }
+    // The mixer stopped producing at the last stop(): the ring is ours to reset
+    write_.store(0, std::memory_order_relaxed);
+    read_.store(0, std::memory_order_relaxed);
+    cycle_.store(0, std::memory_order_relaxed);
+
+    stopping_ = false;
+    writer_ = std::thread([this] { run_writer(); });
+    active_.store(true, std::memory_order_release);
+    std::cout << "[Recorder] Recording to " << dir << (mixes ? " (with mixes)" : "") << "\n";
+    return true;
+}
+
+void SessionRecorder::stop() {
+    if (!writer_.joinable()) return;
+    active_.store(false, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    writer_.join();
+    std::cout << "[Recorder] Stopped recording to " << dir_ << " (" << dropped()
+              << " frames dropped)\n";
+}
+
+void SessionRecorder::name_track(uint32_t slot, uint32_t generation, const std::string& id) {
+    std::lock_guard<std::mutex> lock(names_mutex_);
+    names_[(static_cast<uint64_t>(generation) << 32) | slot] = id;
+}
+
+void SessionRecorder::enqueue(uint32_t slot, uint32_t generation, bool mix,
+                              const AudioFrame& frame) {
+    if (!active_.load(std::memory_order_relaxed)) return;
+    const size_t write = write_.load(std::memory_order_relaxed);
+    if (write - read_.load(std::memory_order_acquire) == kQueueCapacity) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    Entry& e = ring_[write & (kQueueCapacity - 1)];
+    e.cycle = cycle_.load(std::memory_order_relaxed);
+    e.slot = slot;
+    e.generation = generation;
+    e.mix = mix;
+    e.frame = frame;
+    write_.store(write + 1, std::memory_order_release);
+}
+
+void SessionRecorder::run_writer() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        lock.unlock();
+        while (drain()) {}
+        lock.lock();
+        cv_.wait_for(lock, kWriterInterval, [this] { return stopping_; });
+    }
+    lock.unlock();
+    while (drain()) {}  // the mixer has stopped producing: write out the tail
+    for (auto& [key, track] : tracks_) close_track(track);
+    tracks_.clear();
+}
+
+bool SessionRecorder::drain() {
+    const size_t read = read_.load(std::memory_order_relaxed);
+    if (read == write_.load(std::memory_order_acquire)) return false;
+    place(ring_[read & (kQueueCapacity - 1)]);
+    read_.store(read + 1, std::memory_order_release);
+    return true;
+}
+
+void SessionRecorder::place(const Entry& e) {
+    Track& track = open_track(e);
+    if (track.fd < 0) return;
+
+    // Cycle 1 is the first cycle recorded: it starts the file
+    const int64_t position = e.cycle > 0 ? static_cast<int64_t>(e.cycle - 1) * kSamplesPerFrame : 0;
+    if (position < track.length) return;  // a second frame in one cycle
+    append_silence(track, position - track.length);
+
+    const AudioFrame& f = e.frame;
+    const size_t out = kSamplesPerFrame * track.channels;
+    const size_t at = track.buffer.size();
+    track.buffer.resize(at + out);
+    int16_t* dst = track.buffer.data() + at;
+    if (f.silent) {
+        std::fill_n(dst, out, int16_t{0});
+    } else if (f.channels == track.channels) {
+        std::copy_n(f.samples.begin(), out, dst);
+    } else if (f.channels == 1) {  // mono into a stereo track: centred
+        for (size_t s = 0; s < kSamplesPerFrame; ++s) dst[2 * s] = dst[2 * s + 1] = f.samples[s];
+    } else {  // stereo into a mono track: downmixed
+        for (size_t s = 0; s < kSamplesPerFrame; ++s) {
+            dst[s] = static_cast<int16_t>((f.samples[2 * s] + f.samples[2 * s + 1]) / 2);
+        }
+    }
+    track.length += kSamplesPerFrame;
+    written_.fetch_add(1, std::memory_order_relaxed);
+    if (track.buffer.size() >= kFlushSamples) flush(track);
+}
+
+SessionRecorder::Track& SessionRecorder::open_track(const Entry& e) {
+    const uint64_t occupant = (static_cast<uint64_t>(e.generation) << 32) | e.slot;
+    auto [it, inserted] = tracks_.try_emplace({occupant, e.mix});
+    Track& track = it->second;
+    if (!inserted) return track;
+
+    std::string id;
+    {
+        std::lock_guard<std::mutex> lock(names_mutex_);
+        auto name = names_.find(occupant);
+        id = name != names_.end() ? name->second : "slot" + std::to_string(e.slot);
+    }
+    // A participant who rejoins gets a second file
+    const std::string stem = dir_ + "/" + (e.mix ? "mix-" : "") + file_name(id);
+    std::string path = stem + ".wav";
+    for (int n = 2; ::access(path.c_str(), F_OK) == 0; ++n) {
+        path = stem + "-" + std::to_string(n) + ".wav";
+    }
+
+    track.fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (track.fd < 0) {
+        std::cerr << "[Recorder] Cannot create " << path << ": " << std::strerror(errno) << "\n";
+        return track;
+    }
+    track.channels = e.frame.channels == 2 ? 2 : 1;
+    track.buffer.reserve(kFlushSamples + kSamplesPerFrame * kMaxChannels);
+    flush(track);  // the header, so the file plays from the start
+    return track;
+}
+
+void SessionRecorder::append_silence(Track& track, int64_t frames) {
+    while (frames > 0) {
+        const size_t room = kFlushSamples > track.buffer.size()
+                                ? (kFlushSamples - track.buffer.size()) / track.channels
+                                : 0;
+        const auto n = static_cast<int64_t>(std::min<size_t>(room, static_cast<size_t>(frames)));
+        track.buffer.resize(track.buffer.size() + static_cast<size_t>(n) * track.channels, 0);
+        track.length += n;
+        frames -= n;
+        if (track.buffer.size() >= kFlushSamples) flush(track);
+    }
+}
+
+void SessionRecorder::flush(Track& track) {
+    const int64_t frame_bytes = 2 * track.channels;
+    const int64_t offset = kWavHeaderSize + track.flushed * frame_bytes;
+    const int64_t bytes = static_cast<int64_t>(track.buffer.size()) * 2;
+#ifdef __linux__
+    // Grow the file in large steps, so the data stays contiguous and no
+    // write waits on block allocation
+    if (offset + bytes > track.allocated) {
+        track.allocated = offset + bytes + kPreallocBytes;
+        (void)::fallocate(track.fd, FALLOC_FL_KEEP_SIZE, 0, track.allocated);
+    }
+#endif
+    if (bytes > 0 && !write_all(track.fd, track.buffer.data(), static_cast<size_t>(bytes), offset)) {
+        std::cerr << "[Recorder] Write failed: " << std::strerror(errno) << "\n";
+    }
+    track.flushed += static_cast<int64_t>(track.buffer.size()) / track.channels;
+    track.buffer.clear();
+
+    uint8_t header[kWavHeaderSize];
+    wav_header(header, track.channels, track.flushed * frame_bytes);
+    write_all(track.fd, header, sizeof(header), 0);
+}
+
+void SessionRecorder::close_track(Track& track) {
+    if (track.fd < 0) return;
+    flush(track);
+    // Give back the preallocated tail
+    if (::ftruncate(track.fd, kWavHeaderSize + track.flushed * 2 * track.channels) != 0) {
+        std::cerr << "[Recorder] Truncate failed: " << std::strerror(errno) << "\n";
+    }
+    ::close(track.fd);
+    track.fd = -1;
+}
+
+} // namespace tutti
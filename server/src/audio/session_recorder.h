@@ -0,0 +1,135 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "ring_buffer.h"
+
+namespace tutti {
+
+/// Multitrack recording of a room to a directory of WAV files (16-bit,
+/// 48kHz): every participant's input as the mixer played it, concealment
+/// included, and optionally every mixed listener's mix.
+///
+/// The room's mixer thread is the only producer: record_input() and
+/// record_mix() copy the frame into a bounded SPSC ring, or count a drop,
+/// and never block, allocate or touch a file. A writer thread drains the
+/// ring into per-track buffers and writes them out in large blocks, into
+/// file space preallocated ahead of the write position.
+///
+/// Tracks are sample-aligned on the mix timeline and all start at the
+/// start of the recording: each frame lands at the cycle it was played in,
+/// so inputs line up with each other and with the mixes however the
+/// senders' clocks drift (the jitter buffer has already turned timestamps
+/// into one frame per cycle). Cycles that played nothing for a track —
+/// before a late join, losses past concealment — are silence.
+class SessionRecorder {
+public:
+    /// Frames queued between writer passes (~0.3s of a full room with mixes)
+    static constexpr size_t kQueueCapacity = 4096;
+
+    SessionRecorder();
+    ~SessionRecorder();
+
+    SessionRecorder(const SessionRecorder&) = delete;
+    SessionRecorder& operator=(const SessionRecorder&) = delete;
+
+    /// Create `dir` and start recording into it; `mixes` also records each
+    /// listener's mix. False if already recording or `dir` can't be made.
+    /// Start and stop are control-path calls, serialized by the caller.
+    bool start(const std::string& dir, bool mixes);
+
+    /// Write out what's queued, finish the WAV headers and close the files
+    void stop();
+
+    bool active() const { return active_.load(std::memory_order_relaxed); }
+    bool recording_mixes() const { return mixes_; }
+    const std::string& directory() const { return dir_; }
+
+    /// Name the tracks of the participant in `slot` from slot-table epoch
+    /// `generation` on (`<id>.wav`, `mix-<id>.wav`). Control path. Tracks
+    /// without a name are called after their slot.
+    void name_track(uint32_t slot, uint32_t generation, const std::string& id);
+
+    /// Mixer thread: call at the start of every mix cycle
+    void begin_cycle() { cycle_.fetch_add(1, std::memory_order_relaxed); }
+
+    /// Mixer thread: the frame played for `slot` this cycle
+    void record_input(uint32_t slot, uint32_t generation, const AudioFrame& frame) {
+        enqueue(slot, generation, false, frame);
+    }
+
+    /// Mixer thread: the mix built for `slot` this cycle (ignored unless
+    /// recording mixes)
+    void record_mix(uint32_t slot, uint32_t generation, const AudioFrame& frame) {
+        if (mixes_) enqueue(slot, generation, true, frame);
+    }
+
+    /// Frames lost to a full queue, and written, since construction
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+    uint64_t frames_written() const { return written_.load(std::memory_order_relaxed); }
+
+private:
+    struct Entry {
+        uint64_t cycle;
+        uint32_t slot;
+        uint32_t generation;
+        bool mix;
+        AudioFrame frame;
+    };
+
+    /// One WAV file. Writer thread only.
+    struct Track {
+        int fd = -1;
+        uint8_t channels = 1;
+        int64_t length = 0;         // sample frames written or buffered
+        int64_t flushed = 0;        // sample frames on disk
+        int64_t allocated = 0;      // bytes of file space preallocated
+        std::vector<int16_t> buffer;
+    };
+
+    void enqueue(uint32_t slot, uint32_t generation, bool mix, const AudioFrame& frame);
+
+    void run_writer();
+    /// Place every queued frame in its track; false once the queue is empty
+    bool drain();
+    void place(const Entry& e);
+    Track& open_track(const Entry& e);
+    /// Buffer `frames` sample frames of silence, flushing as it fills
+    void append_silence(Track& track, int64_t frames);
+    /// Write a track's buffer to disk and bring its header up to date
+    void flush(Track& track);
+    void close_track(Track& track);
+
+    // SPSC ring: the mixer thread produces, the writer consumes
+    std::unique_ptr<Entry[]> ring_;
+    alignas(64) std::atomic<size_t> write_{0};
+    alignas(64) std::atomic<size_t> read_{0};
+
+    std::atomic<bool> active_{false};
+    bool mixes_ = false;
+    std::atomic<uint64_t> cycle_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> written_{0};
+
+    std::string dir_;
+    std::mutex names_mutex_;
+    std::map<uint64_t, std::string> names_;  // generation << 32 | slot → id
+
+    // Writer thread while running
+    std::map<std::pair<uint64_t, bool>, Track> tracks_;  // (generation << 32 | slot, mix)
+    std::thread writer_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stopping_ = false;
+};
+
+} // namespace tutti
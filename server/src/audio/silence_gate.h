@@ -0,0 +1,47 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace tutti {
+
+/// Energy gate with hangover for one participant's input.
+///
+/// A frame is quiet when its energy (sum of squares, see
+/// MixKernels::energy) is below -60 dBFS RMS. The gate closes only after
+/// kHangoverFrames consecutive quiet frames, so note tails and breaths
+/// between phrases still reach listeners. A digitally silent frame (all
+/// zeros) closes it at once: skipping it changes nothing audible.
+///
+/// Updated by the participant's receive thread. The run counter is atomic
+/// only so the control path can reset it when the slot changes hands.
+class SilenceGate {
+public:
+    /// -60 dBFS RMS over a 128-sample frame: (32768 * 10^(-60/20))^2 * 128
+    static constexpr uint64_t kQuietEnergy = 137439;
+    /// Quiet frames before the gate closes (~100ms)
+    static constexpr uint32_t kHangoverFrames = 38;
+
+    /// Classify one frame by its energy. True if it should be treated as silence.
+    bool update(uint64_t energy) {
+        if (energy == 0) {
+            quiet_run_.store(kHangoverFrames, std::memory_order_relaxed);
+            return true;
+        }
+        if (energy >= kQuietEnergy) {
+            quiet_run_.store(0, std::memory_order_relaxed);
+            return false;
+        }
+        uint32_t run = quiet_run_.load(std::memory_order_relaxed);
+        if (run < kHangoverFrames) quiet_run_.store(++run, std::memory_order_relaxed);
+        return run >= kHangoverFrames;
+    }
+
+    /// Treat the next frames as the start of a new stream
+    void reset() { quiet_run_.store(0, std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint32_t> quiet_run_{0};
+};
+
+} // namespace tutti
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include "mix_kernels.h"
+
+namespace tutti {
+
+/// Look-ahead-free limiter for one listener's mix bus.
+///
+/// Each block's gain is chosen from its own peak: enough reduction to
+/// bring that peak down to kSoftClipKnee, applied as a linear ramp from
+/// the previous block's gain so there is no zipper noise. Because the ramp
+/// only reaches the new gain by the block's end, samples early in a block
+/// can still overshoot the knee; the soft clip in MixKernels::limit rounds
+/// those off below full scale instead of hard clipping. Gain recovers with
+/// an ~80 ms release. A bus that stays under the knee at unity gain takes
+/// the plain store() path and comes out bit-exact.
+///
+/// Mixer thread only. Stereo buses are limited with one linked gain, so
+/// the image doesn't shift.
+class SoftLimiter {
+public:
+    /// Per-block release towards unity: 1 - exp(-128 / (0.08 s * 48 kHz))
+    static constexpr float kRelease = 0.0328f;
+    /// Gains this close to unity snap back to it (and the fast path)
+    static constexpr float kUnitySnap = 0.999f;
+
+    /// Convert `n` bus samples to int16 into `dst`, limiting as needed
+    void process(const MixKernels& k, int16_t* dst, const float* acc, size_t n) {
+        // At unity, store optimistically: a bus under the knee is done in
+        // one pass, and an over is rewritten through limit()
+        float peak = gain_ == 1.0f ? k.store(dst, acc, n) : k.peak(acc, n);
+        if (gain_ == 1.0f && peak <= kSoftClipKnee) return;
+
+        float target = kSoftClipKnee / std::max(peak, kSoftClipKnee);
+        float next = std::min(target, gain_ + (1.0f - gain_) * kRelease);
+        if (next >= kUnitySnap) next = 1.0f;
+        k.limit(dst, acc, gain_, (next - gain_) / static_cast<float>(n), n);
+        gain_ = next;
+    }
+
+    /// Gain applied at the end of the last block (1 = not limiting)
+    float gain() const { return gain_; }
+
+    /// Start afresh at unity (slot handover)
+    void reset() { gain_ = 1.0f; }
+
+private:
+    float gain_ = 1.0f;
+};
+
+} // namespace tutti
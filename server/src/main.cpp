@@ -1,20 +1,27 @@
+#include <algorithm>
+#include <chrono>
 #include <csignal>
 #include <cstdlib>
 #include <execinfo.h>
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <string>
 #include <unistd.h>
 
+#include "rooms/directory_agent.h"
+#include "rooms/room_directory.h"
 #include "rooms/room_manager.h"
 #include "signaling/http_server.h"
 #include "signaling/ws_signaling.h"
+#include "telemetry/trace.h"
 #include "transport/rtc_transport.h"
 #include "transport/session_binder.h"
 #include "transport/wt_transport.h"
 
 namespace {
 std::atomic<int> g_signal_count{0};
+std::atomic<bool> g_trace_requested{false};
 
 void crash_handler(int sig) {
     void* frames[64];
@@ -37,6 +44,22 @@ void signal_handler(int) {
         _exit(1);
     }
 }
+
+void trace_signal_handler(int) {
+    g_trace_requested = true;
+}
+
+/// Write the hot-path trace to the working directory
+void write_trace() {
+    const std::string path = "tutti-trace-" + std::to_string(::getpid()) + ".json";
+    std::ofstream out(path);
+    out << tutti::trace::dump_chrome_json();
+    if (out) {
+        std::cout << "[Tutti] Trace written to " << path << "\n";
+    } else {
+        std::cerr << "[Tutti] Could not write trace to " << path << "\n";
+    }
+}
 } // namespace
 
 int main(int argc, char* argv[]) {
@@ -46,9 +69,20 @@ int main(int argc, char* argv[]) {
     uint16_t ws_port = 8081;
     uint16_t wt_port = 4433;
     size_t max_participants = 4;
+    tutti::MixerSchedulerConfig mixer_config;
     std::string hostname = "localhost";
     std::string cert_file = "certs/cert.pem";
     std::string key_file = "certs/key.pem";
+    bool silence_markers = true;
+    std::string node_id;
+    std::string region;
+    std::string api_url;
+    bool host_directory = false;
+    std::string directory_url;
+    std::string cluster_secret;
+    std::string capture_dir = ".";
+    std::string capture_rooms;
+    std::string recording_dir;
 
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
@@ -61,13 +95,42 @@ int main(int argc, char* argv[]) {
         } else if (arg == "--wt-port" && i + 1 < argc) {
             wt_port = static_cast<uint16_t>(std::stoi(argv[++i]));
         } else if (arg == "--max-participants" && i + 1 < argc) {
-            max_participants = static_cast<size_t>(std::stoi(argv[++i]));
+            max_participants = static_cast<size_t>(std::max(0, std::stoi(argv[++i])));
+            if (max_participants == 0 || max_participants > tutti::Room::kMaxParticipants) {
+                std::cerr << "[Tutti] --max-participants must be 1-" << tutti::Room::kMaxParticipants
+                          << "\n";
+                return 1;
+            }
+        } else if (arg == "--mixer-threads" && i + 1 < argc) {
+            mixer_config.worker_count = static_cast<size_t>(std::stoi(argv[++i]));
+        } else if (arg == "--mixer-cpus" && i + 1 < argc) {
+            mixer_config.cpus = tutti::MixerScheduler::parse_cpu_list(argv[++i]);
+        } else if (arg == "--no-silence-markers") {
+            silence_markers = false;
         } else if (arg == "--hostname" && i + 1 < argc) {
             hostname = argv[++i];
         } else if (arg == "--cert" && i + 1 < argc) {
             cert_file = argv[++i];
         } else if (arg == "--key" && i + 1 < argc) {
             key_file = argv[++i];
+        } else if (arg == "--node-id" && i + 1 < argc) {
+            node_id = argv[++i];
+        } else if (arg == "--region" && i + 1 < argc) {
+            region = argv[++i];
+        } else if (arg == "--api-url" && i + 1 < argc) {
+            api_url = argv[++i];
+        } else if (arg == "--directory") {
+            host_directory = true;
+        } else if (arg == "--directory-url" && i + 1 < argc) {
+            directory_url = argv[++i];
+        } else if (arg == "--cluster-secret" && i + 1 < argc) {
+            cluster_secret = argv[++i];
+        } else if (arg == "--recording-dir" && i + 1 < argc) {
+            recording_dir = argv[++i];
+        } else if (arg == "--capture" && i + 1 < argc) {
+            capture_rooms = argv[++i];
+        } else if (arg == "--capture-dir" && i + 1 < argc) {
+            capture_dir = argv[++i];
         } else if (arg == "--help") {
             std::cout << "Tutti Server - Low-Latency Music Rehearsal\n\n"
                       << "Usage: tutti-server [options]\n\n"
@@ -76,15 +139,41 @@ int main(int argc, char* argv[]) {
                       << "  --http-port <port>       HTTP API port (default: 8080)\n"
                       << "  --ws-port <port>         WebSocket signaling port (default: 8081)\n"
                       << "  --wt-port <port>         WebTransport port (default: 4433)\n"
-                      << "  --max-participants <n>   Max participants per room (default: 4)\n"
+                      << "  --max-participants <n>   Max participants per room (default: 4, at most "
+                      << tutti::Room::kMaxParticipants << ")\n"
+                      << "  --mixer-threads <n>      RT mixer worker threads (default: 1)\n"
+                      << "  --mixer-cpus <list>      CPUs to pin mixer workers to, e.g. 2-5\n"
+                      << "                           (default: isolated CPUs, else 1, 2, ...)\n"
+                      << "  --no-silence-markers     Send silent listeners full zero frames\n"
                       << "  --hostname <name>        Public hostname for URLs (default: localhost)\n"
                       << "  --cert <path>            TLS certificate file (default: certs/cert.pem)\n"
                       << "  --key <path>             TLS private key file (default: certs/key.pem)\n"
+                      << "  --recording-dir <dir>    Let rooms record rehearsals into <dir>\n"
+                      << "                           (default: recording disabled)\n"
+                      << "\nDebugging:\n"
+                      << "  --capture <rooms>        Record these rooms (comma-separated, or all)\n"
+                      << "                           for replay with tutti-replay\n"
+                      << "  --capture-dir <dir>      Where captures go (default: .)\n"
+                      << "\nMulti-node (room sharding):\n"
+                      << "  --directory              Host the room directory on this node\n"
+                      << "  --directory-url <url>    Report to the directory at this HTTP API URL\n"
+                      << "  --cluster-secret <s>     Shared secret for heartbeats and drain (required)\n"
+                      << "  --node-id <id>           This node's ID (default: hostname)\n"
+                      << "  --region <name>          Region label shown in /api/nodes\n"
+                      << "  --api-url <url>          This node's API as the directory reaches it\n"
+                      << "                           (default: http://<hostname>:<http-port>)\n"
                       << "  --help                   Show this help\n";
             return 0;
         }
     }
 
+    // Node reports decide where joins are proxied and which transport URLs
+    // clients get: a directory must not take them from just anyone
+    if ((host_directory || !directory_url.empty()) && cluster_secret.empty()) {
+        std::cerr << "[Tutti] --directory and --directory-url require --cluster-secret\n";
+        return 1;
+    }
+
     std::cout << "╔══════════════════════════════════════╗\n"
               << "║       Tutti - All Together           ║\n"
               << "║   Low-Latency Music Rehearsal        ║\n"
@@ -95,21 +184,46 @@ int main(int argc, char* argv[]) {
     std::signal(SIGTERM, signal_handler);
     std::signal(SIGSEGV, crash_handler);
     std::signal(SIGABRT, crash_handler);
+    if (tutti::trace::kEnabled) {
+        std::signal(SIGUSR1, trace_signal_handler);
+    }
 
     // Initialize room manager
-    auto room_manager = std::make_shared<tutti::RoomManager>(max_participants);
+    auto room_manager = std::make_shared<tutti::RoomManager>(max_participants,
+                                                             mixer_config);
     room_manager->initialize_default_rooms();
+    room_manager->set_silence_markers(silence_markers);
+    room_manager->set_recording_dir(recording_dir);
     room_manager->start_reaper();
     std::cout << "[Tutti] Initialized 16 rooms\n";
 
+    if (!capture_rooms.empty()) {
+        const auto epoch = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        for (const auto& room : room_manager->all_rooms()) {
+            const std::string& name = room->name();
+            bool wanted = capture_rooms == "all" ||
+                          ("," + capture_rooms + ",").find("," + name + ",") != std::string::npos;
+            if (wanted) {
+                room->start_capture(capture_dir + "/" + name + "-" + std::to_string(epoch) + ".tcap");
+            }
+        }
+    }
+
     // Create session binder — routes transport events to rooms
     auto session_binder = std::make_shared<tutti::SessionBinder>(room_manager);
     auto binder_callbacks = session_binder->make_callbacks();
 
+    // WebTransport server, started below; /metrics reads its send pool
+    auto wt_transport = std::make_unique<tutti::WtTransportServer>();
+
     // Start HTTP API server
     auto http_server = std::make_unique<tutti::HttpServer>(room_manager, hostname, wt_port);
+    http_server->set_session_binder(session_binder);
+    http_server->set_send_pool_stats([wt = wt_transport.get()] { return wt->send_pool_stats(); });
 
     // Load cert hash for WebTransport (from hash.txt alongside cert)
+    std::string cert_hash;
     {
         std::string hash_path = cert_file;
         auto last_slash = hash_path.rfind('/');
@@ -119,17 +233,42 @@ int main(int argc, char* argv[]) {
             hash_path = "hash.txt";
         }
         std::ifstream hf(hash_path);
-        std::string hash;
-        if (hf && std::getline(hf, hash) && !hash.empty()) {
-            http_server->set_cert_hash(hash);
+        if (hf && std::getline(hf, cert_hash) && !cert_hash.empty()) {
+            http_server->set_cert_hash(cert_hash);
             std::cout << "[Tutti] Cert hash loaded for WebTransport\n";
         }
     }
 
+    // Room directory: host it, report to a remote one, or neither (single node)
+    std::unique_ptr<tutti::DirectoryAgent> directory_agent;
+    if (host_directory || !directory_url.empty()) {
+        tutti::NodeInfo self;
+        self.id = node_id.empty() ? hostname : node_id;
+        self.region = region;
+        self.api_url = api_url.empty()
+            ? "http://" + hostname + ":" + std::to_string(http_port) : api_url;
+        self.probe_url = "https://" + hostname + "/api/health";
+        self.wt_url = "https://" + hostname + ":" + std::to_string(wt_port) + "/wt";
+        self.ws_url = "wss://" + hostname + "/ws";
+        self.cert_hash = cert_hash;
+
+        directory_agent = std::make_unique<tutti::DirectoryAgent>(room_manager, self);
+        if (host_directory) {
+            auto directory = std::make_shared<tutti::RoomDirectory>();
+            http_server->set_directory(directory, self.id, cluster_secret);
+            directory_agent->set_local_directory(directory);
+            std::cout << "[Tutti] Hosting room directory as node " << self.id << "\n";
+        } else {
+            directory_agent->set_directory_url(directory_url, cluster_secret);
+            std::cout << "[Tutti] Node " << self.id << " reporting to " << directory_url << "\n";
+        }
+    }
+
     if (!http_server->listen(bind_address, http_port)) {
         std::cerr << "[Tutti] Failed to start HTTP server\n";
         return 1;
     }
+    if (directory_agent) directory_agent->start();
 
     // Start WebSocket signaling server (for WebRTC fallback)
     auto ws_signaling = std::make_unique<tutti::WsSignaling>();
@@ -151,17 +290,8 @@ int main(int argc, char* argv[]) {
             std::cout << "[Tutti] WebRTC session established: " << session_id << "\n";
 
             // Wire datagram and message callbacks for this session.
-            // Capture session shared_ptr to prevent premature destruction.
-            audio_dc->onMessage([binder_callbacks, session](auto data) {
-                if (auto* binary = std::get_if<rtc::binary>(&data)) {
-                    if (binder_callbacks.on_datagram) {
-                        binder_callbacks.on_datagram(
-                            session.get(),
-                            reinterpret_cast<const uint8_t*>(binary->data()),
-                            binary->size());
-                    }
-                }
-            });
+            // Datagrams go straight to the bound room slot.
+            session->receive_datagrams(binder_callbacks.on_datagram);
 
             control_dc->onMessage([binder_callbacks, session](auto data) {
                 if (auto* text = std::get_if<std::string>(&data)) {
@@ -195,26 +325,38 @@ int main(int argc, char* argv[]) {
     }
 
     // WebTransport server
-    auto wt_transport = std::make_unique<tutti::WtTransportServer>();
     wt_transport->set_callbacks(binder_callbacks);
     wt_transport->set_cert_files(cert_file, key_file);
     wt_transport->listen(bind_address, wt_port);
 
     std::cout << "\n[Tutti] Server running. Press Ctrl+C to stop.\n"
               << "  HTTP API:     http://" << bind_address << ":" << http_port << "/api/rooms\n"
+              << "  Metrics:      http://" << bind_address << ":" << http_port << "/metrics\n"
               << "  WS Signaling: ws://" << bind_address << ":" << ws_port << "\n"
-              << "  WebTransport: https://" << bind_address << ":" << wt_port << "\n\n";
+              << "  WebTransport: https://" << bind_address << ":" << wt_port << "\n";
+    if (tutti::trace::kEnabled) {
+        std::cout << "  Trace:        http://" << bind_address << ":" << http_port
+                  << "/debug/trace (or kill -USR1 " << ::getpid() << ")\n";
+    }
+    std::cout << "\n";
 
     // Main loop - wait for shutdown (Ctrl+C)
     while (g_signal_count == 0) {
         std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        if (g_trace_requested.exchange(false)) write_trace();
     }
 
     std::cout << "\n[Tutti] Shutting down...\n";
+    if (directory_agent) directory_agent->stop();
     room_manager->stop_reaper();
     http_server->stop();
     ws_signaling->stop();
     wt_transport->stop();
+    room_manager->stop_mixers();
+    for (const auto& room : room_manager->all_rooms()) {
+        room->stop_recording();
+        room->stop_capture();
+    }
 
     std::cout << "[Tutti] Goodbye.\n";
     return 0;
@@ -0,0 +1,67 @@
+#include "directory_agent.h"
+
+#include <iostream>
+
+#include "signaling/http_client.h"
+
+namespace tutti {
+
+DirectoryAgent::DirectoryAgent(std::shared_ptr<RoomManager> room_manager, NodeInfo self)
+    : room_manager_(std::move(room_manager)), self_(std::move(self)) {}
+
+DirectoryAgent::~DirectoryAgent() { stop(); }
+
+bool DirectoryAgent::report_once() {
+    NodeReport report{self_, {}};
+    for (const auto& room : room_manager_->list_rooms()) {
+        report.rooms.push_back({room.name, room.participant_count,
+                                room.max_participants, room.claimed});
+    }
+
+    if (directory_) {
+        directory_->report(report);
+        return true;
+    }
+    if (directory_url_.empty()) return false;
+
+    HttpClientResponse resp;
+    bool ok = http_request("POST", directory_url_ + "/api/nodes/heartbeat",
+                           serialize_report(report, secret_), resp) &&
+              resp.status == 200;
+    if (ok != reachable_) {
+        // Log transitions only: a missing directory would otherwise log every 2s
+        if (ok) {
+            std::cout << "[Directory] Reporting to " << directory_url_ << "\n";
+        } else {
+            std::cerr << "[Directory] Cannot reach directory at " << directory_url_ << "\n";
+        }
+        reachable_ = ok;
+    }
+    return ok;
+}
+
+void DirectoryAgent::start() {
+    if (running_) return;
+    running_ = true;
+    thread_ = std::thread(&DirectoryAgent::run, this);
+}
+
+void DirectoryAgent::stop() {
+    running_ = false;
+    if (thread_.joinable()) thread_.join();
+}
+
+void DirectoryAgent::run() {
+    // Sleep in short chunks so stop() doesn't wait out a whole interval
+    constexpr auto kChunk = std::chrono::milliseconds(100);
+    auto next = std::chrono::steady_clock::now();
+    while (running_) {
+        if (std::chrono::steady_clock::now() >= next) {
+            report_once();
+            next = std::chrono::steady_clock::now() + kInterval;
+        }
+        std::this_thread::sleep_for(kChunk);
+    }
+}
+
+} // namespace tutti
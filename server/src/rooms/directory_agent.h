@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "room_directory.h"
+#include "room_manager.h"
+
+namespace tutti {
+
+/// Announces this node to the room directory every kInterval: its
+/// NodeInfo and the occupancy of its rooms. The directory is either
+/// in-process (this node hosts it) or reached over HTTP at
+/// `<directory_url>/api/nodes/heartbeat`.
+class DirectoryAgent {
+public:
+    static constexpr auto kInterval = std::chrono::seconds(2);
+
+    DirectoryAgent(std::shared_ptr<RoomManager> room_manager, NodeInfo self);
+    ~DirectoryAgent();
+
+    DirectoryAgent(const DirectoryAgent&) = delete;
+    DirectoryAgent& operator=(const DirectoryAgent&) = delete;
+
+    /// Report to a directory in this process
+    void set_local_directory(std::shared_ptr<RoomDirectory> directory) {
+        directory_ = std::move(directory);
+    }
+
+    /// Report to a remote directory node (e.g. http://10.0.0.2:8080),
+    /// authenticating with the cluster secret if it requires one
+    void set_directory_url(const std::string& url, const std::string& secret = "") {
+        directory_url_ = url;
+        secret_ = secret;
+    }
+
+    /// Send one report now. False if a remote directory didn't accept it.
+    bool report_once();
+
+    void start();
+    void stop();
+
+private:
+    void run();
+
+    std::shared_ptr<RoomManager> room_manager_;
+    NodeInfo self_;
+    std::shared_ptr<RoomDirectory> directory_;
+    std::string directory_url_;
+    std::string secret_;
+    bool reachable_ = true;  // last remote report succeeded (agent thread only)
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+};
+
+} // namespace tutti
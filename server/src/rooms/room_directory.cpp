@@ -0,0 +1,229 @@
+#include "room_directory.h"
+
+#include <algorithm>
+#include <iostream>
+#include <tuple>
+
+#include <nlohmann/json.hpp>
+
+namespace tutti {
+
+std::string serialize_report(const NodeReport& report, const std::string& secret) {
+    const NodeInfo& n = report.node;
+    nlohmann::json rooms = nlohmann::json::array();
+    for (const auto& room : report.rooms) {
+        rooms.push_back({{"name", room.name},
+                         {"participant_count", room.participant_count},
+                         {"max_participants", room.max_participants},
+                         {"claimed", room.claimed}});
+    }
+    nlohmann::json j = {{"id", n.id},
+                        {"region", n.region},
+                        {"api_url", n.api_url},
+                        {"probe_url", n.probe_url},
+                        {"wt_url", n.wt_url},
+                        {"ws_url", n.ws_url},
+                        {"cert_hash", n.cert_hash},
+                        {"rooms", rooms}};
+    if (!secret.empty()) j["secret"] = secret;
+    return j.dump();
+}
+
+bool parse_report(const std::string& json, NodeReport& out) {
+    try {
+        auto j = nlohmann::json::parse(json);
+        NodeInfo& n = out.node;
+        n.id = j.value("id", "");
+        n.region = j.value("region", "");
+        n.api_url = j.value("api_url", "");
+        n.probe_url = j.value("probe_url", "");
+        n.wt_url = j.value("wt_url", "");
+        n.ws_url = j.value("ws_url", "");
+        n.cert_hash = j.value("cert_hash", "");
+        out.rooms.clear();
+        for (const auto& room : j.value("rooms", nlohmann::json::array())) {
+            out.rooms.push_back({room.value("name", ""),
+                                 room.value("participant_count", size_t{0}),
+                                 room.value("max_participants", size_t{0}),
+                                 room.value("claimed", false)});
+        }
+        return !n.id.empty();
+    } catch (...) {
+        return false;
+    }
+}
+
+size_t RoomDirectory::participants(const Node& node) {
+    size_t total = 0;
+    for (const auto& room : node.rooms) total += room.participant_count;
+    return total;
+}
+
+void RoomDirectory::expire(Clock::time_point now) {
+    for (auto it = nodes_.begin(); it != nodes_.end();) {
+        if (live(it->second, now)) {
+            ++it;
+            continue;
+        }
+        std::cerr << "[Directory] Node " << it->first << " stopped reporting, freeing its rooms\n";
+        for (auto p = placements_.begin(); p != placements_.end();) {
+            p = p->second.node_id == it->first ? placements_.erase(p) : std::next(p);
+        }
+        it = nodes_.erase(it);
+        ++version_;
+    }
+}
+
+const RoomDirectory::Node* RoomDirectory::live_owner(const std::string& room,
+                                                     Clock::time_point now) const {
+    auto p = placements_.find(room);
+    if (p == placements_.end()) return nullptr;
+    auto n = nodes_.find(p->second.node_id);
+    if (n == nodes_.end() || !live(n->second, now)) return nullptr;
+    return &n->second;
+}
+
+void RoomDirectory::report(const NodeReport& report, Clock::time_point now) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    expire(now);
+
+    auto [it, added] = nodes_.try_emplace(report.node.id);
+    Node& node = it->second;
+    if (added) {
+        std::cout << "[Directory] Node " << report.node.id << " joined (region="
+                  << report.node.region << ")\n";
+    }
+    node.info = report.node;
+    if (node.rooms != report.rooms) {
+        node.rooms = report.rooms;
+        ++version_;
+    }
+    node.last_report = now;
+
+    // A room this node owns and reports empty is free for re-placement,
+    // unless the placement is newer than the report could know about
+    for (const auto& room : report.rooms) {
+        if (room.participant_count != 0) continue;
+        auto p = placements_.find(room.name);
+        if (p != placements_.end() && p->second.node_id == report.node.id &&
+            now - p->second.placed_at >= kPlacementHold) {
+            placements_.erase(p);
+            ++version_;
+        }
+    }
+}
+
+const RoomDirectory::Node* RoomDirectory::choose(const std::string& room) const {
+    static const std::vector<Member> kNoMembers;
+    auto m = members_.find(room);
+    const auto& members = m != members_.end() ? m->second : kNoMembers;
+
+    // Minimax RTT over the room's members, then mean RTT, then load
+    const Node* best = nullptr;
+    std::tuple<double, double, size_t> best_cost;
+    for (const auto& [id, node] : nodes_) {
+        if (node.draining) continue;
+        double worst = 0.0;
+        double sum = 0.0;
+        for (const auto& member : members) {
+            auto r = member.rtts.find(id);
+            double rtt = r != member.rtts.end() ? r->second : kUnmeasuredRttMs;
+            worst = std::max(worst, rtt);
+            sum += rtt;
+        }
+        double mean = members.empty() ? 0.0 : sum / static_cast<double>(members.size());
+        auto cost = std::make_tuple(worst, mean, participants(node));
+        if (!best || cost < best_cost || (cost == best_cost && id < best->info.id)) {
+            best = &node;
+            best_cost = cost;
+        }
+    }
+    return best;
+}
+
+std::optional<NodeInfo> RoomDirectory::place(const std::string& room,
+                                             const std::string& member,
+                                             const NodeRtts& rtts,
+                                             Clock::time_point now) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    expire(now);
+
+    // Remember this member's latencies, most recent last
+    if (!rtts.empty()) {
+        auto& members = members_[room];
+        members.erase(std::remove_if(members.begin(), members.end(),
+                                     [&](const Member& m) { return m.alias == member; }),
+                      members.end());
+        if (members.size() == kMaxMembers) members.erase(members.begin());
+        members.push_back({member, rtts});
+    }
+
+    if (const Node* owner = live_owner(room, now)) return owner->info;
+
+    const Node* node = choose(room);
+    if (!node) return std::nullopt;
+    placements_[room] = {node->info.id, now};
+    ++version_;
+    std::cout << "[Directory] Placed room " << room << " on node " << node->info.id << "\n";
+    return node->info;
+}
+
+std::optional<NodeInfo> RoomDirectory::owner(const std::string& room,
+                                             Clock::time_point now) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (const Node* node = live_owner(room, now)) return node->info;
+    return std::nullopt;
+}
+
+bool RoomDirectory::set_draining(const std::string& node_id, bool draining,
+                                 Clock::time_point now) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    expire(now);
+    auto it = nodes_.find(node_id);
+    if (it == nodes_.end()) return false;
+    if (it->second.draining != draining) {
+        std::cout << "[Directory] Node " << node_id
+                  << (draining ? " draining" : " accepting rooms again") << "\n";
+    }
+    it->second.draining = draining;
+    return true;
+}
+
+std::vector<RoomDirectory::NodeStatus> RoomDirectory::nodes(Clock::time_point now) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<NodeStatus> result;
+    for (const auto& [id, node] : nodes_) {
+        if (!live(node, now)) continue;
+        NodeStatus status{node.info, node.draining, 0, participants(node)};
+        for (const auto& [room, placement] : placements_) {
+            if (placement.node_id == id) ++status.rooms;
+        }
+        result.push_back(std::move(status));
+    }
+    std::sort(result.begin(), result.end(),
+              [](const NodeStatus& a, const NodeStatus& b) { return a.node.id < b.node.id; });
+    return result;
+}
+
+std::vector<RoomDirectory::OwnedRoom> RoomDirectory::owned_rooms(Clock::time_point now) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<OwnedRoom> result;
+    for (const auto& [room, placement] : placements_) {
+        const Node* node = live_owner(room, now);
+        if (!node) continue;
+        auto it = std::find_if(node->rooms.begin(), node->rooms.end(),
+                               [&](const NodeRoom& r) { return r.name == room; });
+        if (it != node->rooms.end()) result.push_back({placement.node_id, *it});
+    }
+    std::sort(result.begin(), result.end(),
+              [](const OwnedRoom& a, const OwnedRoom& b) { return a.room.name < b.room.name; });
+    return result;
+}
+
+uint64_t RoomDirectory::version(Clock::time_point now) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    expire(now);
+    return version_;
+}
+
+} // namespace tutti
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace tutti {
+
+/// A tutti-server node as announced in its heartbeats
+struct NodeInfo {
+    std::string id;
+    std::string region;
+    std::string api_url;    // HTTP API base, as reachable from the directory
+    std::string probe_url;  // public URL clients time to measure RTT
+    std::string wt_url;
+    std::string ws_url;
+    std::string cert_hash;  // WebTransport cert hash (may be empty)
+};
+
+/// Occupancy of one room on the node that reported it
+struct NodeRoom {
+    std::string name;
+    size_t participant_count = 0;
+    size_t max_participants = 0;
+    bool claimed = false;
+};
+
+inline bool operator==(const NodeRoom& a, const NodeRoom& b) {
+    return a.name == b.name && a.participant_count == b.participant_count &&
+           a.max_participants == b.max_participants && a.claimed == b.claimed;
+}
+
+/// One heartbeat: who the node is and what its rooms look like
+struct NodeReport {
+    NodeInfo node;
+    std::vector<NodeRoom> rooms;
+};
+
+/// Heartbeat wire format (JSON), shared by DirectoryAgent and HttpServer.
+/// `secret` is the cluster secret.
+std::string serialize_report(const NodeReport& report, const std::string& secret = "");
+/// False if `json` isn't a report with a node ID
+bool parse_report(const std::string& json, NodeReport& out);
+
+/// Client-measured round-trip times to nodes, in ms, keyed by node ID
+using NodeRtts = std::unordered_map<std::string, double>;
+
+/// Room → node directory for a multi-node deployment.
+///
+/// Nodes report themselves every few seconds (NodeReport); a node that
+/// stops reporting is dropped after kNodeTimeout and its rooms are freed.
+/// A room is placed when someone joins it while it has no owner, and
+/// stays on that node until the node reports it empty.
+///
+/// Placement aims for the group's latency centroid: joins carry the
+/// joiner's RTT to each node, the directory remembers the last few
+/// members of each room, and an unowned room goes to the node that
+/// minimises the worst member RTT (then the mean, then load). Draining
+/// nodes keep their rooms but receive no new ones.
+///
+/// Thread-safe; every call takes one mutex. Not on the audio path.
+class RoomDirectory {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr auto kNodeTimeout = std::chrono::seconds(10);
+    /// A new placement survives reports that predate its first join
+    static constexpr auto kPlacementHold = std::chrono::seconds(10);
+    /// Members remembered per room for placement
+    static constexpr size_t kMaxMembers = 8;
+    /// RTT assumed for a node a member didn't measure
+    static constexpr double kUnmeasuredRttMs = 1000.0;
+
+    /// Record a heartbeat. Frees the node's rooms that it reports empty.
+    void report(const NodeReport& report, Clock::time_point now = Clock::now());
+
+    /// Owner of `room`, placing it first if unowned. `member` (the joiner's
+    /// alias) and `rtts` update the room's latency history.
+    /// Empty if no live node can take it.
+    std::optional<NodeInfo> place(const std::string& room,
+                                  const std::string& member,
+                                  const NodeRtts& rtts,
+                                  Clock::time_point now = Clock::now());
+
+    /// Current owner of `room`, if any
+    std::optional<NodeInfo> owner(const std::string& room,
+                                  Clock::time_point now = Clock::now()) const;
+
+    /// Stop (or resume) placing rooms on a node. False if it isn't live.
+    bool set_draining(const std::string& node_id, bool draining,
+                      Clock::time_point now = Clock::now());
+
+    /// Live node as the directory sees it
+    struct NodeStatus {
+        NodeInfo node;
+        bool draining = false;
+        size_t rooms = 0;         // rooms placed on it
+        size_t participants = 0;  // as of its last report
+    };
+    std::vector<NodeStatus> nodes(Clock::time_point now = Clock::now()) const;
+
+    /// A placed room, as last reported by the live node that owns it
+    struct OwnedRoom {
+        std::string node_id;
+        NodeRoom room;
+    };
+    std::vector<OwnedRoom> owned_rooms(Clock::time_point now = Clock::now()) const;
+
+    /// Changes whenever owned_rooms() may have (expires silent nodes first)
+    uint64_t version(Clock::time_point now = Clock::now());
+
+private:
+    struct Node {
+        NodeInfo info;
+        std::vector<NodeRoom> rooms;
+        Clock::time_point last_report;
+        bool draining = false;
+    };
+    struct Placement {
+        std::string node_id;
+        Clock::time_point placed_at;
+    };
+    struct Member {
+        std::string alias;
+        NodeRtts rtts;
+    };
+
+    bool live(const Node& node, Clock::time_point now) const {
+        return now - node.last_report < kNodeTimeout;
+    }
+
+    /// Drop nodes past kNodeTimeout and their placements (mutex_ held)
+    void expire(Clock::time_point now);
+
+    /// Best live, non-draining node for `room` (mutex_ held)
+    const Node* choose(const std::string& room) const;
+
+    static size_t participants(const Node& node);
+
+    /// Owner of a placement if it's live (mutex_ held)
+    const Node* live_owner(const std::string& room, Clock::time_point now) const;
+
+    mutable std::mutex mutex_;
+    uint64_t version_ = 0;
+    std::unordered_map<std::string, Node> nodes_;
+    std::unordered_map<std::string, Placement> placements_;  // room → node
+    std::unordered_map<std::string, std::vector<Member>> members_;   // room → recent joiners
+};
+
+} // namespace tutti
@@ -9,20 +9,31 @@
 
 namespace tutti {
 
-RoomManager::RoomManager(size_t max_participants_per_room)
-    : max_participants_per_room_(max_participants_per_room) {}
+RoomManager::RoomManager(size_t max_participants_per_room,
+                         MixerSchedulerConfig mixer_config)
+    : max_participants_per_room_(max_participants_per_room),
+      mixer_scheduler_(std::move(mixer_config)) {}
 
 RoomManager::~RoomManager() {
     stop_reaper();
+    stop_mixers();
 }
 
 void RoomManager::initialize_default_rooms() {
-    std::lock_guard<std::mutex> lock(rooms_mutex_);
-    for (const auto& def : kDefaultRooms) {
-        auto room = std::make_shared<Room>(def.name, max_participants_per_room_);
-        room->start();
-        rooms_[def.name] = std::move(room);
+    {
+        std::lock_guard<std::mutex> lock(rooms_mutex_);
+        for (const auto& def : kDefaultRooms) {
+            auto room = std::make_shared<Room>(def.name, max_participants_per_room_);
+            room->set_lobby_signal(lobby_signal_);
+            mixer_scheduler_.add_room(room);
+            rooms_[def.name] = std::move(room);
+        }
     }
+    mixer_scheduler_.start();
+}
+
+void RoomManager::stop_mixers() {
+    mixer_scheduler_.stop();
 }
 
 std::shared_ptr<Room> RoomManager::get_room(const std::string& name) {
@@ -31,6 +42,22 @@ std::shared_ptr<Room> RoomManager::get_room(const std::string& name) {
     return it != rooms_.end() ? it->second : nullptr;
 }
 
+void RoomManager::set_silence_markers(bool enabled) {
+    for (const auto& room : all_rooms()) room->set_silence_markers(enabled);
+}
+
+std::vector<std::shared_ptr<Room>> RoomManager::all_rooms() const {
+    std::vector<std::shared_ptr<Room>> result;
+    {
+        std::lock_guard<std::mutex> lock(rooms_mutex_);
+        result.reserve(rooms_.size());
+        for (const auto& [name, room] : rooms_) result.push_back(room);
+    }
+    std::sort(result.begin(), result.end(),
+              [](const auto& a, const auto& b) { return a->name() < b->name(); });
+    return result;
+}
+
 std::vector<RoomManager::RoomInfo> RoomManager::list_rooms() const {
     std::lock_guard<std::mutex> lock(rooms_mutex_);
     std::vector<RoomInfo> result;
@@ -56,10 +83,11 @@ RoomManager::JoinResult RoomManager::join_room(
     const std::string& alias,
     const std::string& password,
     std::shared_ptr<TransportSession> session,
-    std::string& out_participant_id) {
+    std::string& out_participant_id,
+    bool listen_only) {
     auto room = get_room(room_name);
     if (!room) return JoinResult::RoomNotFound;
-    if (room->is_full()) return JoinResult::RoomFull;
+    if (listen_only ? room->listeners_full() : room->is_full()) return JoinResult::RoomFull;
 
     if (room->status() == RoomStatus::Claimed) {
         if (password.empty()) return JoinResult::PasswordRequired;
@@ -67,7 +95,7 @@ RoomManager::JoinResult RoomManager::join_room(
     }
 
     out_participant_id = generate_id();
-    if (!room->add_participant(out_participant_id, alias, std::move(session))) {
+    if (!room->add_participant(out_participant_id, alias, std::move(session), listen_only)) {
         return JoinResult::RoomFull;
     }
 
@@ -79,6 +107,7 @@ void RoomManager::leave_room(const std::string& room_name,
     auto room = get_room(room_name);
     if (room) {
         room->remove_participant(participant_id);
+        if (room->recording() && room->is_empty()) room->stop_recording();
     }
 }
 
@@ -157,10 +186,33 @@ void RoomManager::reaper_thread_func() {
 
         for (auto& room : snapshot) {
             room->reap_stale_participants();
+            if (room->recording() && room->is_empty()) room->stop_recording();
         }
+
+        // Rooms are placed when empty; spread the ones that got busy
+        mixer_scheduler_.rebalance();
     }
 }
 
+RoomManager::RecordingResult RoomManager::set_recording(const std::string& room_name,
+                                                        const std::string& participant_id,
+                                                        bool recording, bool mixes) {
+    auto room = get_room(room_name);
+    if (!room) return RecordingResult::RoomNotFound;
+    if (!room->slot_of(participant_id).valid()) return RecordingResult::NotParticipant;
+    if (!recording) {
+        room->stop_recording();
+        return RecordingResult::Ok;
+    }
+    if (recording_dir_.empty()) return RecordingResult::Disabled;
+    if (room->recording()) return RecordingResult::Ok;
+
+    const auto epoch = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    const std::string dir = recording_dir_ + "/" + room_name + "-" + std::to_string(epoch);
+    return room->start_recording(dir, mixes) ? RecordingResult::Ok : RecordingResult::Failed;
+}
+
 std::string RoomManager::generate_id() {
     static std::random_device rd;
     static std::mt19937 gen(rd());
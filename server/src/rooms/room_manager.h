@@ -8,6 +8,7 @@
 #include <thread>
 #include <unordered_map>
 
+#include "audio/mixer_scheduler.h"
 #include "audio/room.h"
 
 namespace tutti {
@@ -15,13 +16,17 @@ namespace tutti {
 /// Manages all rooms and handles join/leave/claim/vacate operations.
 class RoomManager {
 public:
-    explicit RoomManager(size_t max_participants_per_room = 4);
+    explicit RoomManager(size_t max_participants_per_room = 4,
+                         MixerSchedulerConfig mixer_config = {});
 
     ~RoomManager();
 
-    /// Initialize default rooms from kDefaultRooms
+    /// Initialize default rooms from kDefaultRooms and start the mixer workers
     void initialize_default_rooms();
 
+    /// Stop the mixer workers
+    void stop_mixers();
+
     /// Start the background reaper thread
     void start_reaper();
 
@@ -40,6 +45,26 @@ public:
     };
     std::vector<RoomInfo> list_rooms() const;
 
+    /// Changes whenever list_rooms() may have; read it before listing
+    uint64_t lobby_version() const { return lobby_signal_->version(); }
+
+    /// Block until lobby_version() differs from `seen` or `timeout` passes
+    uint64_t wait_lobby_change(uint64_t seen, std::chrono::milliseconds timeout) const {
+        return lobby_signal_->wait(seen, timeout);
+    }
+
+    /// Wake wait_lobby_change() callers as if the lobby had changed
+    void notify_lobby_change() { lobby_signal_->notify(); }
+
+    /// All rooms, sorted by name (for metrics snapshots)
+    std::vector<std::shared_ptr<Room>> all_rooms() const;
+
+    /// Header-only silence markers for silent listeners, in every room
+    void set_silence_markers(bool enabled);
+
+    /// Early / on-time / late mix cycle counts across the mixer workers
+    MixClockStats mix_clock_stats() const { return mixer_scheduler_.clock_stats(); }
+
     /// Join a participant to a room
     /// Returns participant ID on success, empty string on failure
     enum class JoinResult {
@@ -53,7 +78,8 @@ public:
                          const std::string& alias,
                          const std::string& password,
                          std::shared_ptr<TransportSession> session,
-                         std::string& out_participant_id);
+                         std::string& out_participant_id,
+                         bool listen_only = false);
 
     /// Remove a participant from a room
     void leave_room(const std::string& room_name,
@@ -73,10 +99,31 @@ public:
     VacateResult vacate_request(const std::string& room_name,
                                 const std::string& source_ip);
 
+    /// Let participants record their rooms, into a directory per recording
+    /// under `dir` (empty: recording disabled, the default)
+    void set_recording_dir(const std::string& dir) { recording_dir_ = dir; }
+
+    /// Start or stop recording a room on a participant's request. A room
+    /// also stops recording once everyone has left.
+    enum class RecordingResult {
+        Ok,
+        RoomNotFound,
+        NotParticipant,
+        Disabled,
+        Failed
+    };
+    RecordingResult set_recording(const std::string& room_name,
+                                  const std::string& participant_id,
+                                  bool recording, bool mixes = false);
+
 private:
     size_t max_participants_per_room_;
     std::unordered_map<std::string, std::shared_ptr<Room>> rooms_;
     mutable std::mutex rooms_mutex_;
+    std::shared_ptr<LobbySignal> lobby_signal_ = std::make_shared<LobbySignal>();
+
+    // Shared RT mixer workers driving all rooms
+    MixerScheduler mixer_scheduler_;
 
     // Vacate cooldown: source_ip → last request time
     std::unordered_map<std::string, std::chrono::steady_clock::time_point>
@@ -84,6 +131,8 @@ private:
     std::mutex vacate_mutex_;
     static constexpr auto kVacateCooldown = std::chrono::hours(24);
 
+    std::string recording_dir_;
+
     /// Generate a unique participant ID
     static std::string generate_id();
 
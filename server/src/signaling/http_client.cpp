@@ -0,0 +1,131 @@
+#include "http_client.h"
+
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <cstring>
+
+namespace tutti {
+
+namespace {
+
+struct ParsedUrl {
+    std::string host;
+    std::string port = "80";
+    std::string path = "/";
+};
+
+bool parse_http_url(const std::string& url, ParsedUrl& out) {
+    constexpr const char* kScheme = "http://";
+    if (url.compare(0, std::strlen(kScheme), kScheme) != 0) return false;
+    std::string rest = url.substr(std::strlen(kScheme));
+    auto slash = rest.find('/');
+    if (slash != std::string::npos) {
+        out.path = rest.substr(slash);
+        rest.resize(slash);
+    }
+    auto colon = rest.rfind(':');
+    if (colon != std::string::npos) {
+        out.port = rest.substr(colon + 1);
+        rest.resize(colon);
+    }
+    out.host = rest;
+    return !out.host.empty() && !out.port.empty();
+}
+
+int connect_to(const ParsedUrl& url, std::chrono::milliseconds timeout) {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* res = nullptr;
+    if (getaddrinfo(url.host.c_str(), url.port.c_str(), &hints, &res) != 0) return -1;
+
+    timeval tv{};
+    tv.tv_sec = static_cast<time_t>(timeout.count() / 1000);
+    tv.tv_usec = static_cast<suseconds_t>((timeout.count() % 1000) * 1000);
+
+    int fd = -1;
+    for (addrinfo* ai = res; ai; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd < 0) continue;
+        // SO_SNDTIMEO also bounds connect() on Linux
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+        if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) break;
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(res);
+    return fd;
+}
+
+bool send_all(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+} // namespace
+
+bool http_request(const std::string& method, const std::string& url,
+                  const std::string& body, HttpClientResponse& out,
+                  std::chrono::milliseconds timeout) {
+    ParsedUrl parsed;
+    if (!parse_http_url(url, parsed)) return false;
+
+    int fd = connect_to(parsed, timeout);
+    if (fd < 0) return false;
+
+    std::string request = method + " " + parsed.path + " HTTP/1.1\r\n"
+                          "Host: " + parsed.host + "\r\n"
+                          "Content-Type: application/json\r\n"
+                          "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                          "Connection: close\r\n"
+                          "\r\n" + body;
+    if (!send_all(fd, request)) {
+        close(fd);
+        return false;
+    }
+
+    // Read to the end of the body: Content-Length if given, else EOF
+    std::string data;
+    char buf[4096];
+    size_t header_end = std::string::npos;
+    size_t content_length = std::string::npos;
+    while (true) {
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n <= 0) break;
+        data.append(buf, static_cast<size_t>(n));
+        if (header_end == std::string::npos) {
+            header_end = data.find("\r\n\r\n");
+            if (header_end == std::string::npos) continue;
+            for (const char* name : {"Content-Length: ", "content-length: "}) {
+                auto pos = data.find(name);
+                if (pos != std::string::npos && pos < header_end) {
+                    content_length = std::strtoul(data.c_str() + pos + std::strlen(name), nullptr, 10);
+                }
+            }
+            header_end += 4;
+        }
+        if (content_length != std::string::npos && data.size() >= header_end + content_length) break;
+    }
+    close(fd);
+
+    // Status line: HTTP/1.1 <code> ...
+    if (header_end == std::string::npos || data.compare(0, 5, "HTTP/") != 0) return false;
+    auto space = data.find(' ');
+    if (space == std::string::npos) return false;
+    out.status = std::atoi(data.c_str() + space + 1);
+    out.body = data.substr(header_end, content_length == std::string::npos
+                                           ? std::string::npos : content_length);
+    return out.status > 0;
+}
+
+} // namespace tutti
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+
+namespace tutti {
+
+/// Response from http_request()
+struct HttpClientResponse {
+    int status = 0;
+    std::string body;
+};
+
+/// Minimal blocking HTTP/1.1 client for node-to-node calls (directory
+/// heartbeats, proxied joins). Plain http:// only: nodes talk over the
+/// private network, behind the TLS-terminating proxy. One request per
+/// connection; `timeout` bounds connect, send and each read.
+/// Returns false if the URL is unusable or the exchange failed.
+bool http_request(const std::string& method, const std::string& url,
+                  const std::string& body, HttpClientResponse& out,
+                  std::chrono::milliseconds timeout = std::chrono::milliseconds(2000));
+
+} // namespace tutti
@@ -0,0 +1,101 @@
+#include "http_parser.h"
+
+#include <charconv>
+
+namespace tutti {
+
+namespace {
+
+constexpr std::string_view kCrlf = "\r\n";
+
+bool iequals(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        char x = a[i], y = b[i];
+        if (x >= 'A' && x <= 'Z') x = static_cast<char>(x - 'A' + 'a');
+        if (y >= 'A' && y <= 'Z') y = static_cast<char>(y - 'A' + 'a');
+        if (x != y) return false;
+    }
+    return true;
+}
+
+std::string_view trim(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+    return s;
+}
+
+/// True if comma-separated `value` contains `token` (case-insensitive)
+bool has_token(std::string_view value, std::string_view token) {
+    while (!value.empty()) {
+        auto comma = value.find(',');
+        if (iequals(trim(value.substr(0, comma)), token)) return true;
+        if (comma == std::string_view::npos) break;
+        value.remove_prefix(comma + 1);
+    }
+    return false;
+}
+
+} // namespace
+
+HttpParseStatus parse_http_request(std::string_view data, HttpRequestView& out) {
+    auto head_end = data.find("\r\n\r\n");
+    if (head_end == std::string_view::npos) {
+        return data.size() > kMaxHeaderBytes ? HttpParseStatus::TooLarge
+                                             : HttpParseStatus::Incomplete;
+    }
+    if (head_end > kMaxHeaderBytes) return HttpParseStatus::TooLarge;
+    std::string_view head = data.substr(0, head_end);
+
+    // Request line: METHOD SP target SP HTTP/x.y
+    auto eol = head.find(kCrlf);
+    std::string_view line = head.substr(0, eol);
+    auto sp1 = line.find(' ');
+    auto sp2 = sp1 == std::string_view::npos ? sp1 : line.find(' ', sp1 + 1);
+    if (sp2 == std::string_view::npos || sp1 == 0 || sp2 == sp1 + 1) {
+        return HttpParseStatus::Invalid;
+    }
+    std::string_view version = line.substr(sp2 + 1);
+    if (version.substr(0, 5) != "HTTP/") return HttpParseStatus::Invalid;
+    std::string_view target = line.substr(sp1 + 1, sp2 - sp1 - 1);
+
+    out.method = line.substr(0, sp1);
+    out.path = target.substr(0, target.find('?'));
+    out.keep_alive = version != "HTTP/1.0";
+
+    size_t content_length = 0;
+    std::string_view headers = eol == std::string_view::npos ? std::string_view{}
+                                                             : head.substr(eol + 2);
+    while (!headers.empty()) {
+        auto next = headers.find(kCrlf);
+        std::string_view header = headers.substr(0, next);
+        headers = next == std::string_view::npos ? std::string_view{} : headers.substr(next + 2);
+
+        auto colon = header.find(':');
+        if (colon == std::string_view::npos) return HttpParseStatus::Invalid;
+        std::string_view name = header.substr(0, colon);
+        std::string_view value = trim(header.substr(colon + 1));
+
+        if (iequals(name, "Content-Length")) {
+            auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(),
+                                             content_length);
+            if (ec != std::errc() || end != value.data() + value.size()) {
+                return HttpParseStatus::Invalid;
+            }
+        } else if (iequals(name, "Connection")) {
+            if (has_token(value, "keep-alive")) out.keep_alive = true;
+            if (has_token(value, "close")) out.keep_alive = false;
+        } else if (iequals(name, "Transfer-Encoding")) {
+            return HttpParseStatus::Invalid;
+        }
+    }
+
+    if (content_length > kMaxBodyBytes) return HttpParseStatus::TooLarge;
+    size_t body_start = head_end + 4;
+    if (data.size() - body_start < content_length) return HttpParseStatus::Incomplete;
+    out.body = data.substr(body_start, content_length);
+    out.size = body_start + content_length;
+    return HttpParseStatus::Complete;
+}
+
+} // namespace tutti
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+namespace tutti {
+
+/// One HTTP/1.1 request, as views into the connection's input buffer.
+/// Valid until that buffer is modified.
+struct HttpRequestView {
+    std::string_view method;
+    std::string_view path;   // request target without the query string
+    std::string_view body;
+    bool keep_alive = true;  // HTTP/1.1 default; "Connection: close" or HTTP/1.0 clear it
+    size_t size = 0;         // bytes of input the request occupies
+};
+
+enum class HttpParseStatus {
+    Complete,
+    Incomplete,  // need more input
+    Invalid,
+    TooLarge,    // headers over kMaxHeaderBytes or body over kMaxBodyBytes
+};
+
+/// Limits for requests on the REST API (rooms, joins, heartbeats)
+constexpr size_t kMaxHeaderBytes = 8 * 1024;
+constexpr size_t kMaxBodyBytes = 64 * 1024;
+
+/// Parse the request at the start of `data` without copying. Reads only
+/// Content-Length and Connection; chunked bodies are rejected as Invalid.
+HttpParseStatus parse_http_request(std::string_view data, HttpRequestView& out);
+
+} // namespace tutti
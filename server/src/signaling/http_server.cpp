@@ -2,16 +2,24 @@
 
 #include <arpa/inet.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/socket.h>
 #include <unistd.h>
 
 #include <algorithm>
+#include <cerrno>
 #include <cstring>
 #include <iostream>
-#include <sstream>
 
 #include <nlohmann/json.hpp>
 
+#include "http_client.h"
+#include "http_parser.h"
+#include "telemetry/prometheus.h"
+#include "telemetry/trace.h"
+
 namespace tutti {
 
 HttpServer::HttpServer(std::shared_ptr<RoomManager> room_manager,
@@ -24,7 +32,7 @@ HttpServer::HttpServer(std::shared_ptr<RoomManager> room_manager,
 HttpServer::~HttpServer() { stop(); }
 
 bool HttpServer::listen(const std::string& address, uint16_t port) {
-    server_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    server_fd_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
     if (server_fd_ < 0) {
         std::cerr << "[HTTP] Failed to create socket\n";
         return false;
@@ -45,118 +53,444 @@ bool HttpServer::listen(const std::string& address, uint16_t port) {
         return false;
     }
 
-    if (::listen(server_fd_, 16) < 0) {
+    if (::listen(server_fd_, 128) < 0) {
         std::cerr << "[HTTP] Failed to listen\n";
         close(server_fd_);
         server_fd_ = -1;
         return false;
     }
 
+    socklen_t addr_len = sizeof(addr);
+    getsockname(server_fd_, reinterpret_cast<sockaddr*>(&addr), &addr_len);
+    port_ = ntohs(addr.sin_port);
+
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epoll_fd_ < 0 || wake_fd_ < 0) {
+        std::cerr << "[HTTP] Failed to create epoll instance\n";
+        stop();
+        return false;
+    }
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = server_fd_;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, server_fd_, &ev);
+    ev.data.fd = wake_fd_;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &ev);
+
+    // Streams opened before the lobby thread's first pass still get a snapshot
+    lobby_feed_.update(lobby_rooms());
+    lobby_snapshot_ = lobby_feed_.snapshot_event();
+
     running_ = true;
-    accept_thread_ = std::thread([this]() {
-        while (running_) {
-            sockaddr_in client_addr{};
-            socklen_t client_len = sizeof(client_addr);
-            int client_fd = accept(server_fd_,
-                                   reinterpret_cast<sockaddr*>(&client_addr),
-                                   &client_len);
-            if (client_fd < 0) {
-                if (running_) std::cerr << "[HTTP] Accept failed\n";
-                continue;
-            }
-            // Handle in-line for simplicity (Phase 1)
-            handle_connection(client_fd);
-        }
-    });
+    event_thread_ = std::thread(&HttpServer::event_loop, this);
+    lobby_thread_ = std::thread(&HttpServer::lobby_loop, this);
+    for (size_t i = 0; i < kWorkerThreads; ++i) {
+        workers_.emplace_back(&HttpServer::worker_loop, this);
+    }
 
-    std::cout << "[HTTP] Listening on " << address << ":" << port << "\n";
+    std::cout << "[HTTP] Listening on " << address << ":" << port_ << "\n";
     return true;
 }
 
 void HttpServer::stop() {
     running_ = false;
-    if (server_fd_ >= 0) {
-        shutdown(server_fd_, SHUT_RDWR);
-        close(server_fd_);
-        server_fd_ = -1;
+    if (wake_fd_ >= 0) {
+        uint64_t one = 1;
+        (void)write(wake_fd_, &one, sizeof(one));
     }
-    if (accept_thread_.joinable()) {
-        accept_thread_.join();
+    if (event_thread_.joinable()) event_thread_.join();
+    if (lobby_thread_.joinable()) {
+        room_manager_->notify_lobby_change();
+        lobby_thread_.join();
+    }
+    ready_cv_.notify_all();
+    for (auto& worker : workers_) worker.join();
+    workers_.clear();
+
+    ready_.clear();
+    for (auto& [fd, conn] : connections_) close(fd);
+    connections_.clear();
+    for (int* fd : {&server_fd_, &epoll_fd_, &wake_fd_}) {
+        if (*fd >= 0) close(*fd);
+        *fd = -1;
     }
 }
 
-void HttpServer::handle_connection(int client_fd) {
-    std::string data;
-    char buf[4096];
+void HttpServer::event_loop() {
+    constexpr int kMaxEvents = 64;
+    constexpr int kSweepMs = 1000;  // idle-connection sweep period
+    epoll_event events[kMaxEvents];
+    auto next_sweep = std::chrono::steady_clock::now();
+
+    while (running_) {
+        int n = epoll_wait(epoll_fd_, events, kMaxEvents, kSweepMs);
+        if (n < 0 && errno != EINTR) {
+            std::cerr << "[HTTP] epoll_wait failed\n";
+            break;
+        }
+        for (int i = 0; i < n; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == wake_fd_) continue;
+            if (fd == server_fd_) {
+                accept_connections();
+                continue;
+            }
+            // EPOLLONESHOT: nothing else touches it until the worker re-arms
+            Connection* conn = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(conn_mutex_);
+                auto it = connections_.find(fd);
+                if (it == connections_.end()) continue;
+                conn = it->second.get();
+                conn->busy = true;
+            }
+            {
+                std::lock_guard<std::mutex> lock(ready_mutex_);
+                ready_.push_back(conn);
+            }
+            ready_cv_.notify_one();
+        }
 
-    // Read until we have headers + full body
-    size_t content_length = 0;
-    size_t header_end = std::string::npos;
+        auto now = std::chrono::steady_clock::now();
+        if (now >= next_sweep) {
+            close_idle_connections();
+            next_sweep = now + std::chrono::milliseconds(kSweepMs);
+        }
+    }
+}
 
+void HttpServer::accept_connections() {
     while (true) {
-        ssize_t n = recv(client_fd, buf, sizeof(buf) - 1, 0);
-        if (n <= 0) break;
-        data.append(buf, n);
-
-        if (header_end == std::string::npos) {
-            header_end = data.find("\r\n\r\n");
-            if (header_end != std::string::npos) {
-                // Parse Content-Length from headers
-                auto cl_pos = data.find("Content-Length: ");
-                if (cl_pos == std::string::npos)
-                    cl_pos = data.find("content-length: ");
-                if (cl_pos != std::string::npos && cl_pos < header_end) {
-                    content_length = std::stoul(data.substr(cl_pos + 16));
-                }
-                header_end += 4; // skip past \r\n\r\n
+        sockaddr_in client_addr{};
+        socklen_t client_len = sizeof(client_addr);
+        int fd = accept4(server_fd_, reinterpret_cast<sockaddr*>(&client_addr),
+                         &client_len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR && running_) {
+                std::cerr << "[HTTP] Accept failed\n";
             }
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(conn_mutex_);
+        if (connections_.size() >= kMaxConnections) {
+            close(fd);
+            continue;
         }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        auto conn = std::make_unique<Connection>();
+        conn->fd = fd;
+        char ip_buf[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &client_addr.sin_addr, ip_buf, sizeof(ip_buf));
+        conn->remote_ip = ip_buf;
+        conn->last_active = std::chrono::steady_clock::now();
+
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+        ev.data.fd = fd;
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            close(fd);
+            continue;
+        }
+        connections_.emplace(fd, std::move(conn));
+    }
+}
 
-        if (header_end != std::string::npos &&
-            data.size() >= header_end + content_length) {
+void HttpServer::close_idle_connections() {
+    auto cutoff = std::chrono::steady_clock::now() - kIdleTimeout;
+    std::lock_guard<std::mutex> lock(conn_mutex_);
+    for (auto it = connections_.begin(); it != connections_.end();) {
+        Connection& conn = *it->second;
+        if (conn.busy || conn.stream || conn.last_active > cutoff) {
+            ++it;
+            continue;
+        }
+        epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, conn.fd, nullptr);
+        close(conn.fd);
+        it = connections_.erase(it);
+    }
+}
+
+void HttpServer::worker_loop() {
+    while (true) {
+        Connection* conn = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(ready_mutex_);
+            ready_cv_.wait(lock, [this] { return !running_ || !ready_.empty(); });
+            if (!running_) return;
+            conn = ready_.front();
+            ready_.pop_front();
+        }
+        service(*conn);
+    }
+}
+
+void HttpServer::service(Connection& conn) {
+    if (conn.stream) return service_stream(conn);
+    conn.last_active = std::chrono::steady_clock::now();
+
+    // Finish a response the socket couldn't take last time
+    if (conn.out_offset < conn.out.size()) {
+        if (!flush(conn)) return close_connection(conn);
+        if (conn.out_offset < conn.out.size()) return rearm(conn);
+        if (conn.close_after_send) return close_connection(conn);
+    }
+
+    char buf[4096];
+    bool peer_closed = false;
+    while (true) {
+        ssize_t n = recv(conn.fd, buf, sizeof(buf), 0);
+        if (n > 0) {
+            conn.in.append(buf, static_cast<size_t>(n));
+            if (conn.in.size() > kMaxHeaderBytes + kMaxBodyBytes) break;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) peer_closed = true;
+        break;
+    }
+
+    // Answer every complete request in the buffer (pipelining)
+    size_t consumed = 0;
+    while (!conn.close_after_send) {
+        HttpRequestView view;
+        auto status = parse_http_request(std::string_view(conn.in).substr(consumed), view);
+        if (status == HttpParseStatus::Incomplete) break;
+        if (status != HttpParseStatus::Complete) {
+            HttpResponse error = status == HttpParseStatus::TooLarge
+                ? HttpResponse{413, "application/json", R"({"error":"request_too_large"})"}
+                : HttpResponse{400, "application/json", R"({"error":"bad_request"})"};
+            append_response(conn.out, error, false);
+            conn.close_after_send = true;
             break;
         }
+
+        if (view.method == "GET" && view.path == "/api/rooms/events") {
+            // Anything after this on the connection is ignored
+            return start_stream(conn);
+        }
+
+        HttpRequest req;
+        req.method.assign(view.method);
+        req.path.assign(view.path);
+        req.body.assign(view.body);
+        req.remote_ip = conn.remote_ip;
+        append_response(conn.out, route(req), view.keep_alive);
+        conn.close_after_send = !view.keep_alive;
+        consumed += view.size;
     }
+    conn.in.erase(0, consumed);
+
+    if (!flush(conn) || peer_closed) return close_connection(conn);
+    if (conn.close_after_send && conn.out.empty()) return close_connection(conn);
+    rearm(conn);
+}
+
+void HttpServer::start_stream(Connection& conn) {
+    conn.in.clear();
+    std::lock_guard<std::mutex> lock(conn_mutex_);
+    conn.stream = true;
+    conn.out += "HTTP/1.1 200 OK\r\n"
+                "Content-Type: text/event-stream\r\n"
+                "Cache-Control: no-store\r\n"
+                "Access-Control-Allow-Origin: *\r\n"
+                "\r\n";
+    conn.out += lobby_snapshot_;
+    if (!flush(conn)) return close_locked(conn);
+    rearm_locked(conn);
+}
+
+void HttpServer::service_stream(Connection& conn) {
+    std::lock_guard<std::mutex> lock(conn_mutex_);
+    // Stream clients don't send; readable means gone (or noise to drop)
+    char buf[512];
+    bool gone = false;
+    while (true) {
+        ssize_t n = recv(conn.fd, buf, sizeof(buf), 0);
+        if (n > 0) continue;
+        if (n < 0 && errno == EINTR) continue;
+        gone = n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK);
+        break;
+    }
+    if (gone || conn.out.size() - conn.out_offset > kMaxStreamBacklog || !flush(conn)) {
+        return close_locked(conn);
+    }
+    rearm_locked(conn);
+}
+
+bool HttpServer::flush(Connection& conn) {
+    while (conn.out_offset < conn.out.size()) {
+        ssize_t n = send(conn.fd, conn.out.data() + conn.out_offset,
+                         conn.out.size() - conn.out_offset, MSG_NOSIGNAL);
+        if (n > 0) {
+            conn.out_offset += static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+    }
+    conn.out.clear();
+    conn.out_offset = 0;
+    return true;
+}
+
+void HttpServer::rearm(Connection& conn) {
+    // Under conn_mutex_: once busy is clear the idle sweep may close it
+    std::lock_guard<std::mutex> lock(conn_mutex_);
+    rearm_locked(conn);
+}
+
+void HttpServer::rearm_locked(Connection& conn) {
+    epoll_event ev{};
+    ev.events = (conn.out.empty() ? EPOLLIN : EPOLLOUT) | EPOLLRDHUP | EPOLLONESHOT;
+    ev.data.fd = conn.fd;
+    conn.last_active = std::chrono::steady_clock::now();
+    conn.busy = false;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, conn.fd, &ev);
+}
+
+void HttpServer::close_connection(Connection& conn) {
+    std::lock_guard<std::mutex> lock(conn_mutex_);
+    close_locked(conn);
+}
+
+void HttpServer::close_locked(Connection& conn) {
+    int fd = conn.fd;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    connections_.erase(fd);  // destroys conn
+    close(fd);
+}
+
+void HttpServer::lobby_loop() {
+    // Bounds how stale a directory node's remote occupancy can get, and stop()
+    constexpr auto kPoll = std::chrono::milliseconds(500);
+    auto next_keep_alive = std::chrono::steady_clock::now() + kStreamKeepAlive;
+    bool published = false;
+    uint64_t published_version = 0;
+
+    while (running_) {
+        uint64_t local = room_manager_->lobby_version();
+        uint64_t version = local + (directory_ ? directory_->version() : 0);
+        if (!published || version != published_version) {
+            std::string event = lobby_feed_.update(lobby_rooms());
+            publish_lobby(event, lobby_feed_.snapshot_event());
+            published = true;
+            published_version = version;
+        }
 
-    if (data.empty()) {
-        close(client_fd);
-        return;
+        auto now = std::chrono::steady_clock::now();
+        if (now >= next_keep_alive) {
+            publish_lobby(LobbyFeed::kKeepAlive, lobby_feed_.snapshot_event());
+            next_keep_alive = now + kStreamKeepAlive;
+        }
+        room_manager_->wait_lobby_change(local, kPoll);
     }
+}
 
-    // Parse request line
-    HttpRequest req;
-    std::istringstream stream(data);
-    stream >> req.method >> req.path;
+void HttpServer::publish_lobby(const std::string& event, const std::string& snapshot) {
+    std::lock_guard<std::mutex> lock(conn_mutex_);
+    lobby_snapshot_ = snapshot;
+    if (event.empty()) return;
 
-    // Extract body
-    if (header_end != std::string::npos && header_end < data.size()) {
-        req.body = data.substr(header_end);
+    for (auto it = connections_.begin(); it != connections_.end();) {
+        Connection& conn = *it->second;
+        if (!conn.stream) {
+            ++it;
+            continue;
+        }
+        conn.out += event;
+        if (conn.busy) {
+            // Its worker flushes (or drops it) when done
+            ++it;
+            continue;
+        }
+        if (conn.out.size() - conn.out_offset > kMaxStreamBacklog || !flush(conn)) {
+            epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, conn.fd, nullptr);
+            close(conn.fd);
+            it = connections_.erase(it);
+            continue;
+        }
+        if (!conn.out.empty()) rearm_locked(conn);  // wait for EPOLLOUT
+        ++it;
     }
+}
 
-    // Get remote IP
-    sockaddr_in peer_addr{};
-    socklen_t peer_len = sizeof(peer_addr);
-    getpeername(client_fd, reinterpret_cast<sockaddr*>(&peer_addr), &peer_len);
-    char ip_buf[INET_ADDRSTRLEN];
-    inet_ntop(AF_INET, &peer_addr.sin_addr, ip_buf, sizeof(ip_buf));
-    req.remote_ip = ip_buf;
+std::vector<RoomManager::RoomInfo> HttpServer::lobby_rooms() {
+    auto rooms = room_manager_->list_rooms();
+    if (directory_) {
+        // Rooms placed on other nodes: show their owner's occupancy
+        for (const auto& owned : directory_->owned_rooms()) {
+            if (owned.node_id == node_id_) continue;
+            for (auto& room : rooms) {
+                if (room.name != owned.room.name) continue;
+                room.participant_count = owned.room.participant_count;
+                room.max_participants = owned.room.max_participants;
+                room.claimed = owned.room.claimed;
+            }
+        }
+    }
+    return rooms;
+}
 
-    auto resp = route(req);
+uint64_t HttpServer::lobby_version() {
+    // Both counters only grow, so their sum changes whenever either does
+    uint64_t version = room_manager_->lobby_version();
+    if (directory_) version += directory_->version();
+    return version;
+}
 
-    // Build HTTP response
-    std::ostringstream http_resp;
-    http_resp << "HTTP/1.1 " << resp.status << " OK\r\n"
-              << "Content-Type: " << resp.content_type << "\r\n"
-              << "Content-Length: " << resp.body.size() << "\r\n"
-              << "Access-Control-Allow-Origin: *\r\n"
-              << "Access-Control-Allow-Methods: GET, POST, OPTIONS\r\n"
-              << "Access-Control-Allow-Headers: Content-Type\r\n"
-              << "\r\n"
-              << resp.body;
+namespace {
+
+const char* reason_phrase(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 204: return "No Content";
+        case 400: return "Bad Request";
+        case 401: return "Unauthorized";
+        case 403: return "Forbidden";
+        case 404: return "Not Found";
+        case 409: return "Conflict";
+        case 413: return "Payload Too Large";
+        case 429: return "Too Many Requests";
+        case 502: return "Bad Gateway";
+        case 503: return "Service Unavailable";
+        default: return status < 400 ? "OK" : "Error";
+    }
+}
+
+/// Compare secrets in time that depends only on the expected one's length
+bool secrets_match(const std::string& given, const std::string& expected) {
+    unsigned char diff = given.size() != expected.size();
+    for (size_t i = 0; i < expected.size(); ++i) {
+        const char c = i < given.size() ? given[i] : '\0';
+        diff |= static_cast<unsigned char>(c ^ expected[i]);
+    }
+    return diff == 0;
+}
 
-    std::string response = http_resp.str();
-    send(client_fd, response.data(), response.size(), 0);
-    close(client_fd);
+} // namespace
+
+void HttpServer::append_response(std::string& out, const HttpResponse& resp, bool keep_alive) {
+    out.reserve(out.size() + 256 + resp.body.size());
+    out += "HTTP/1.1 ";
+    out += std::to_string(resp.status);
+    out += ' ';
+    out += reason_phrase(resp.status);
+    out += "\r\nContent-Type: ";
+    out += resp.content_type;
+    out += "\r\nContent-Length: ";
+    out += std::to_string(resp.body.size());
+    out += "\r\nConnection: ";
+    out += keep_alive ? "keep-alive" : "close";
+    out += "\r\n"
+           "Access-Control-Allow-Origin: *\r\n"
+           "Access-Control-Allow-Methods: GET, POST, OPTIONS\r\n"
+           "Access-Control-Allow-Headers: Content-Type\r\n"
+           "\r\n";
+    out += resp.body;
 }
 
 HttpServer::HttpResponse HttpServer::route(const HttpRequest& req) {
@@ -169,6 +503,18 @@ HttpServer::HttpResponse HttpServer::route(const HttpRequest& req) {
         return handle_list_rooms();
     }
 
+    if (req.method == "GET" && req.path == "/metrics") {
+        return handle_metrics();
+    }
+
+    // Like /metrics, outside /api/* so the public proxy doesn't serve it
+    if (req.method == "GET" && req.path == "/debug/trace") {
+        if (!trace::kEnabled) {
+            return {404, "application/json", R"({"error":"tracing_disabled"})"};
+        }
+        return {200, "application/json", trace::dump_chrome_json()};
+    }
+
     if (req.method == "GET" && req.path == "/api/health") {
         return {200, "application/json", R"({"status":"ok"})"};
     }
@@ -183,6 +529,10 @@ HttpServer::HttpResponse HttpServer::route(const HttpRequest& req) {
         return {200, "application/json", resp.dump()};
     }
 
+    if (directory_ && req.path.compare(0, 10, "/api/nodes") == 0) {
+        return route_nodes(req);
+    }
+
     // Extract room name from path: /api/rooms/:name/action
     if (req.path.substr(0, 11) == "/api/rooms/") {
         auto rest = req.path.substr(11);
@@ -193,6 +543,28 @@ HttpServer::HttpResponse HttpServer::route(const HttpRequest& req) {
         std::string room_name = rest.substr(0, slash);
         std::string action = rest.substr(slash + 1);
 
+        // Directory: the room may live on another node
+        if (directory_ && req.method == "POST" && room_manager_->get_room(room_name)) {
+            std::optional<NodeInfo> owner;
+            if (action == "join") {
+                auto body = nlohmann::json::parse(req.body, nullptr, false);
+                if (body.is_object()) {
+                    NodeRtts rtts;
+                    auto measured = body.value("rtts", nlohmann::json::object());
+                    for (const auto& [node, ms] : measured.items()) {
+                        if (ms.is_number()) rtts[node] = ms.get<double>();
+                    }
+                    owner = directory_->place(room_name, body.value("alias", "Anonymous"), rtts);
+                    if (!owner) {
+                        return {503, "application/json", R"({"error":"no_nodes_available"})"};
+                    }
+                }
+            } else {
+                owner = remote_owner(room_name);
+            }
+            if (owner && owner->id != node_id_) return proxy(*owner, req);
+        }
+
         if (req.method == "POST" && action == "join") {
             return handle_join_room(room_name, req.body);
         }
@@ -205,13 +577,100 @@ HttpServer::HttpResponse HttpServer::route(const HttpRequest& req) {
         if (req.method == "POST" && action == "vacate-request") {
             return handle_vacate_request(room_name, req.remote_ip);
         }
+        if (req.method == "POST" && action == "recording") {
+            return handle_recording(room_name, req.body);
+        }
     }
 
     return {404, "application/json", R"({"error":"not_found"})"};
 }
 
+HttpServer::HttpResponse HttpServer::route_nodes(const HttpRequest& req) {
+    if (req.method == "GET" && req.path == "/api/nodes") {
+        // Public view: what a client needs to probe each node, no internal URLs
+        nlohmann::json nodes = nlohmann::json::array();
+        for (const auto& status : directory_->nodes()) {
+            nodes.push_back({{"id", status.node.id},
+                             {"region", status.node.region},
+                             {"probe_url", status.node.probe_url},
+                             {"draining", status.draining},
+                             {"rooms", status.rooms},
+                             {"participants", status.participants}});
+        }
+        return {200, "application/json", nlohmann::json{{"nodes", nodes}}.dump()};
+    }
+    if (req.method != "POST") return {404, "application/json", R"({"error":"not_found"})"};
+
+    auto body = nlohmann::json::parse(req.body, nullptr, false);
+    if (!body.is_object()) return {400, "application/json", R"({"error":"invalid_json"})"};
+    // Reports steer joins and proxied requests: never take them unauthenticated
+    if (cluster_secret_.empty() || !secrets_match(body.value("secret", ""), cluster_secret_)) {
+        return {403, "application/json", R"({"error":"forbidden"})"};
+    }
+
+    if (req.path == "/api/nodes/heartbeat") {
+        NodeReport report;
+        if (!parse_report(req.body, report)) {
+            return {400, "application/json", R"({"error":"invalid_report"})"};
+        }
+        directory_->report(report);
+        return {200, "application/json", R"({"ok":true})"};
+    }
+
+    // /api/nodes/:id/drain  {"draining": true|false}
+    constexpr size_t kPrefix = 11;  // "/api/nodes/"
+    auto slash = req.path.find('/', kPrefix);
+    if (slash != std::string::npos && req.path.substr(slash + 1) == "drain") {
+        std::string node_id = req.path.substr(kPrefix, slash - kPrefix);
+        if (!directory_->set_draining(node_id, body.value("draining", true))) {
+            return {404, "application/json", R"({"error":"node_not_found"})"};
+        }
+        for (const auto& status : directory_->nodes()) {
+            if (status.node.id != node_id) continue;
+            nlohmann::json resp = {{"id", node_id},
+                                   {"draining", status.draining},
+                                   {"rooms", status.rooms},
+                                   {"participants", status.participants}};
+            return {200, "application/json", resp.dump()};
+        }
+    }
+    return {404, "application/json", R"({"error":"not_found"})"};
+}
+
+std::optional<NodeInfo> HttpServer::remote_owner(const std::string& room_name) const {
+    if (!directory_) return std::nullopt;
+    auto owner = directory_->owner(room_name);
+    if (owner && owner->id == node_id_) return std::nullopt;
+    return owner;
+}
+
+HttpServer::HttpResponse HttpServer::proxy(const NodeInfo& owner, const HttpRequest& req) {
+    HttpClientResponse resp;
+    if (!http_request(req.method, owner.api_url + req.path, req.body, resp)) {
+        std::cerr << "[HTTP] Node " << owner.id << " unreachable at " << owner.api_url << "\n";
+        return {502, "application/json", R"({"error":"node_unreachable"})"};
+    }
+    // Tell the client where its room lives
+    auto body = nlohmann::json::parse(resp.body, nullptr, false);
+    if (resp.status == 200 && body.is_object() && body.contains("participant_id")) {
+        body["node"] = owner.id;
+        body["remote"] = true;
+        return {resp.status, "application/json", body.dump()};
+    }
+    return {resp.status, "application/json", resp.body};
+}
+
 HttpServer::HttpResponse HttpServer::handle_list_rooms() {
-    auto rooms = room_manager_->list_rooms();
+    // Read before listing: a change in between just rebuilds next time
+    uint64_t version = lobby_version();
+    {
+        std::lock_guard<std::mutex> lock(rooms_cache_mutex_);
+        if (rooms_cache_valid_ && rooms_cache_version_ == version) {
+            return {200, "application/json", rooms_cache_};
+        }
+    }
+
+    auto rooms = lobby_rooms();
     nlohmann::json result = nlohmann::json::array();
     for (const auto& room : rooms) {
         result.push_back({
@@ -221,7 +680,208 @@ HttpServer::HttpResponse HttpServer::handle_list_rooms() {
             {"claimed", room.claimed}
         });
     }
-    return {200, "application/json", nlohmann::json{{"rooms", result}}.dump()};
+    std::string body = nlohmann::json{{"rooms", result}}.dump();
+    {
+        std::lock_guard<std::mutex> lock(rooms_cache_mutex_);
+        rooms_cache_ = body;
+        rooms_cache_version_ = version;
+        rooms_cache_valid_ = true;
+    }
+    return {200, "application/json", std::move(body)};
+}
+
+HttpServer::HttpResponse HttpServer::handle_metrics() {
+    // Snapshot everything first. Rooms are read through their lock-free
+    // metrics and roster, so a scrape never contends with a mixer worker.
+    struct RoomSnapshot {
+        std::string name;
+        size_t participants;
+        RoomAudioMetrics audio;
+        std::vector<LatencyStats> latency;  // parallel to audio.participants
+    };
+    std::vector<RoomSnapshot> rooms;
+    for (const auto& room : room_manager_->all_rooms()) {
+        RoomSnapshot snap{room->name(), room->participant_count(), room->audio_metrics(), {}};
+        for (const auto& p : snap.audio.participants) {
+            snap.latency.push_back(room->latency().get_stats(p.id));
+        }
+        rooms.push_back(std::move(snap));
+    }
+    auto clock = room_manager_->mix_clock_stats();
+    std::vector<SessionBinder::SessionCounts> sessions;
+    if (session_binder_) sessions = session_binder_->session_counts();
+    std::optional<PacketPool::Stats> send_pool;
+    if (send_pool_stats_) send_pool = send_pool_stats_();
+
+    PrometheusWriter w;
+    using Labels = PrometheusWriter::Labels;
+
+    w.family("tutti_rooms", "gauge", "Rooms on this server");
+    w.sample("tutti_rooms", {}, static_cast<uint64_t>(rooms.size()));
+
+    w.family("tutti_room_participants", "gauge", "Participants in a room");
+    for (const auto& r : rooms) {
+        w.sample("tutti_room_participants", {{"room", r.name}},
+                 static_cast<uint64_t>(r.participants));
+    }
+
+    w.family("tutti_transport_sessions", "gauge",
+             "Open transport sessions by transport and bind state");
+    for (const auto& s : sessions) {
+        w.sample("tutti_transport_sessions", {{"transport", s.transport}, {"state", "pending"}},
+                 static_cast<uint64_t>(s.pending));
+        w.sample("tutti_transport_sessions", {{"transport", s.transport}, {"state", "bound"}},
+                 static_cast<uint64_t>(s.bound));
+    }
+
+    if (send_pool) {
+        w.family("tutti_send_pool_buffers", "gauge", "Send buffers in the WebTransport pool");
+        w.sample("tutti_send_pool_buffers", {}, static_cast<uint64_t>(send_pool->capacity));
+        w.family("tutti_send_pool_in_use_buffers", "gauge",
+                 "Pooled send buffers currently handed to the transport");
+        w.sample("tutti_send_pool_in_use_buffers", {}, static_cast<uint64_t>(send_pool->in_use));
+        w.family("tutti_send_pool_heap_fallbacks_total", "counter",
+                 "Sends that fell back to the heap: pool exhausted or message too large");
+        w.sample("tutti_send_pool_heap_fallbacks_total", {{"reason", "exhausted"}},
+                 send_pool->exhausted);
+        w.sample("tutti_send_pool_heap_fallbacks_total", {{"reason", "oversized"}},
+                 send_pool->oversized);
+    }
+
+    w.family("tutti_mix_cycles_total", "counter",
+             "Room mix cycles by trigger: all frames in (early), at the quantum "
+             "deadline (on_time), or after it (late)");
+    w.sample("tutti_mix_cycles_total", {{"trigger", "early"}}, clock.early);
+    w.sample("tutti_mix_cycles_total", {{"trigger", "on_time"}}, clock.on_time);
+    w.sample("tutti_mix_cycles_total", {{"trigger", "late"}}, clock.late);
+
+    w.family("tutti_mix_cycle_duration_seconds", "histogram",
+             "Time to mix a room and queue its outputs");
+    for (const auto& r : rooms) {
+        w.histogram("tutti_mix_cycle_duration_seconds", {{"room", r.name}}, r.audio.mix_cycles);
+    }
+
+    w.family("tutti_mix_cycle_p99_seconds", "gauge",
+             "99th percentile mix cycle duration (bucket upper bound)");
+    for (const auto& r : rooms) {
+        w.sample("tutti_mix_cycle_p99_seconds", {{"room", r.name}},
+                 r.audio.mix_cycles.quantile_ns(0.99) / 1e9);
+    }
+
+    // Per-participant series are labelled by room and mixer slot;
+    // tutti_participant_info maps a slot to the participant in it
+    auto for_each_participant = [&](auto&& fn) {
+        for (const auto& r : rooms) {
+            for (size_t i = 0; i < r.audio.participants.size(); ++i) {
+                const auto& p = r.audio.participants[i];
+                fn(Labels{{"room", r.name}, {"slot", std::to_string(p.slot)}}, p, r.latency[i]);
+            }
+        }
+    };
+
+    w.family("tutti_participant_info", "gauge", "Participant occupying a room slot");
+    for (const auto& r : rooms) {
+        for (const auto& p : r.audio.participants) {
+            w.sample("tutti_participant_info",
+                     {{"room", r.name}, {"slot", std::to_string(p.slot)},
+                      {"participant", p.id}, {"alias", p.alias}},
+                     uint64_t{1});
+        }
+    }
+
+    w.family("tutti_audio_packets_total", "counter",
+             "Audio packets received, by path (fast = 2-party forward, mixed = mixer)");
+    for_each_participant([&](Labels labels, const ParticipantAudioMetrics& p, const LatencyStats&) {
+        auto fast = labels;
+        fast.emplace_back("path", "fast");
+        w.sample("tutti_audio_packets_total", fast, p.counters.fast_path_packets);
+        labels.emplace_back("path", "mixed");
+        w.sample("tutti_audio_packets_total", labels, p.counters.mixed_path_packets);
+    });
+
+    w.family("tutti_silent_packets_total", "counter",
+             "Audio packets gated as silence (not mixed, sent as silence markers)");
+    for_each_participant([&](const Labels& labels, const ParticipantAudioMetrics& p, const LatencyStats&) {
+        w.sample("tutti_silent_packets_total", labels, p.counters.silent_packets);
+    });
+
+    w.family("tutti_sequence_lost_total", "counter",
+             "Audio packets missing from the received sequence numbers");
+    for_each_participant([&](const Labels& labels, const ParticipantAudioMetrics& p, const LatencyStats&) {
+        w.sample("tutti_sequence_lost_total", labels, p.counters.sequence_lost);
+    });
+
+    w.family("tutti_input_drops_total", "counter",
+             "Received frames rejected by the jitter buffer (late, duplicate, overflow)");
+    for_each_participant([&](const Labels& labels, const ParticipantAudioMetrics& p, const LatencyStats&) {
+        w.sample("tutti_input_drops_total", labels, p.counters.input_drops);
+    });
+
+    w.family("tutti_output_drops_total", "counter",
+             "Mixed frames dropped because the output queue was full");
+    for_each_participant([&](const Labels& labels, const ParticipantAudioMetrics& p, const LatencyStats&) {
+        w.sample("tutti_output_drops_total", labels, p.output_drops);
+    });
+
+    w.family("tutti_concealed_frames_total", "counter",
+             "Frames synthesized by packet loss concealment");
+    for_each_participant([&](const Labels& labels, const ParticipantAudioMetrics& p, const LatencyStats&) {
+        w.sample("tutti_concealed_frames_total", labels, p.jitter.concealed);
+    });
+
+    w.family("tutti_jitter_buffer_depth_frames", "gauge",
+             "Frames buffered for the mixer at the last cycle");
+    for_each_participant([&](const Labels& labels, const ParticipantAudioMetrics& p, const LatencyStats&) {
+        w.sample("tutti_jitter_buffer_depth_frames", labels, static_cast<uint64_t>(p.jitter.depth));
+    });
+
+    w.family("tutti_jitter_buffer_target_frames", "gauge",
+             "Adaptive jitter buffer target depth");
+    for_each_participant([&](const Labels& labels, const ParticipantAudioMetrics& p, const LatencyStats&) {
+        w.sample("tutti_jitter_buffer_target_frames", labels,
+                 static_cast<uint64_t>(p.jitter.target_depth));
+    });
+
+    w.family("tutti_input_jitter_seconds", "gauge",
+             "RFC 3550 interarrival jitter of received audio");
+    for_each_participant([&](const Labels& labels, const ParticipantAudioMetrics& p, const LatencyStats&) {
+        w.sample("tutti_input_jitter_seconds", labels, p.jitter.jitter_us / 1e6);
+    });
+
+    w.family("tutti_input_clock_drift_ppm", "gauge",
+             "Sender's audio clock against the mix clock (+ fast), 0 until estimated");
+    for_each_participant([&](const Labels& labels, const ParticipantAudioMetrics& p, const LatencyStats&) {
+        w.sample("tutti_input_clock_drift_ppm", labels, static_cast<double>(p.jitter.drift_ppm));
+    });
+
+    w.family("tutti_input_samples_slipped_total", "counter",
+             "Input samples dropped to keep pace with a fast sender clock");
+    for_each_participant([&](const Labels& labels, const ParticipantAudioMetrics& p, const LatencyStats&) {
+        w.sample("tutti_input_samples_slipped_total", labels, p.jitter.slipped);
+    });
+
+    w.family("tutti_input_samples_inserted_total", "counter",
+             "Input samples added to keep a slow sender clock fed");
+    for_each_participant([&](const Labels& labels, const ParticipantAudioMetrics& p, const LatencyStats&) {
+        w.sample("tutti_input_samples_inserted_total", labels, p.jitter.inserted);
+    });
+
+    w.family("tutti_output_queue_depth_frames", "gauge", "Mixed frames waiting to be sent");
+    for_each_participant([&](const Labels& labels, const ParticipantAudioMetrics& p, const LatencyStats&) {
+        w.sample("tutti_output_queue_depth_frames", labels, static_cast<uint64_t>(p.output_depth));
+    });
+
+    w.family("tutti_rtt_seconds", "gauge", "Smoothed round-trip time (LatencyTracker)");
+    for_each_participant([&](const Labels& labels, const ParticipantAudioMetrics&, const LatencyStats& l) {
+        w.sample("tutti_rtt_seconds", labels, l.rtt_ms / 1e3);
+    });
+
+    w.family("tutti_rtt_jitter_seconds", "gauge", "Round-trip time jitter (LatencyTracker)");
+    for_each_participant([&](const Labels& labels, const ParticipantAudioMetrics&, const LatencyStats& l) {
+        w.sample("tutti_rtt_jitter_seconds", labels, l.jitter_ms / 1e3);
+    });
+
+    return {200, "text/plain; version=0.0.4; charset=utf-8", w.str()};
 }
 
 HttpServer::HttpResponse HttpServer::handle_join_room(
@@ -235,12 +895,13 @@ HttpServer::HttpResponse HttpServer::handle_join_room(
 
     std::string alias = req.value("alias", "Anonymous");
     std::string password = req.value("password", "");
+    bool listen_only = req.value("listen_only", false);
 
     // Create a placeholder session for HTTP-only join
     // Real transport session will be established via WebTransport/WebRTC
     std::string participant_id;
     auto result = room_manager_->join_room(
-        room_name, alias, password, nullptr, participant_id);
+        room_name, alias, password, nullptr, participant_id, listen_only);
 
     switch (result) {
         case RoomManager::JoinResult::Success: {
@@ -249,6 +910,8 @@ HttpServer::HttpResponse HttpServer::handle_join_room(
                 {"wt_url", "https://" + hostname_ + ":" + std::to_string(wt_port_) + "/wt"},
                 {"ws_url", "wss://" + hostname_ + "/ws"}
             };
+            if (!cert_hash_.empty()) resp["cert_hash"] = cert_hash_;
+            if (!node_id_.empty()) resp["node"] = node_id_;
             return {200, "application/json", resp.dump()};
         }
         case RoomManager::JoinResult::RoomNotFound:
@@ -317,4 +980,36 @@ HttpServer::HttpResponse HttpServer::handle_vacate_request(
     return {500, "application/json", R"({"error":"internal"})"};
 }
 
+HttpServer::HttpResponse HttpServer::handle_recording(
+    const std::string& room_name, const std::string& body) {
+    nlohmann::json req;
+    try {
+        req = nlohmann::json::parse(body);
+    } catch (...) {
+        return {400, "application/json", R"({"error":"invalid_json"})"};
+    }
+
+    std::string participant_id = req.value("participant_id", "");
+    if (participant_id.empty()) {
+        return {400, "application/json", R"({"error":"missing_participant_id"})"};
+    }
+
+    bool recording = req.value("recording", true);
+    auto result = room_manager_->set_recording(room_name, participant_id, recording,
+                                               req.value("mixes", false));
+    switch (result) {
+        case RoomManager::RecordingResult::Ok:
+            return {200, "application/json", nlohmann::json{{"ok", true}, {"recording", recording}}.dump()};
+        case RoomManager::RecordingResult::RoomNotFound:
+            return {404, "application/json", R"({"error":"room_not_found"})"};
+        case RoomManager::RecordingResult::NotParticipant:
+            return {403, "application/json", R"({"error":"not_participant"})"};
+        case RoomManager::RecordingResult::Disabled:
+            return {403, "application/json", R"({"error":"recording_disabled"})"};
+        case RoomManager::RecordingResult::Failed:
+            return {500, "application/json", R"({"error":"recording_failed"})"};
+    }
+    return {500, "application/json", R"({"error":"internal"})"};
+}
+
 } // namespace tutti
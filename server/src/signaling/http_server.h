@@ -1,12 +1,23 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <thread>
-#include <atomic>
+#include <unordered_map>
+#include <vector>
 
+#include "lobby_feed.h"
+#include "rooms/room_directory.h"
 #include "rooms/room_manager.h"
+#include "transport/packet_pool.h"
+#include "transport/session_binder.h"
 
 namespace tutti {
 
@@ -16,13 +27,42 @@ namespace tutti {
 /// Routes:
 ///   GET  /api/health             - Health check
 ///   GET  /api/rooms              - List all rooms
+///   GET  /api/rooms/events       - Room list changes (Server-Sent Events)
 ///   GET  /api/transport          - Transport connection info
+///   GET  /metrics                - Prometheus metrics
+///   GET  /debug/trace            - Hot-path trace (Chrome JSON; TUTTI_ENABLE_TRACING builds)
 ///   POST /api/rooms/:name/join   - Join a room
 ///   POST /api/rooms/:name/leave  - Leave a room
 ///   POST /api/rooms/:name/claim  - Claim a room (set password)
 ///   POST /api/rooms/:name/vacate-request - Request occupants to vacate
+///
+/// On the node hosting the room directory, also:
+///   GET  /api/nodes              - Live nodes (clients probe them for RTT)
+///   POST /api/nodes/heartbeat    - Node report (DirectoryAgent)
+///   POST /api/nodes/:id/drain    - Stop placing rooms on a node
+/// and room requests go to whichever node owns the room: handled here if
+/// it's this one, proxied to the owner's API otherwise.
+///
+/// One epoll thread accepts non-blocking connections and waits for input;
+/// a ready connection is handed (EPOLLONESHOT) to one of kWorkerThreads,
+/// which parses and answers every complete request in its buffer, so a
+/// slow client or a slow proxied join only holds up its own connection.
+/// Connections are kept alive unless the client asks otherwise and are
+/// closed after kIdleTimeout. The /api/rooms body is cached and rebuilt
+/// only when room membership (or the directory's view of it) changes.
+///
+/// /api/rooms/events turns its connection into a stream. A lobby thread
+/// waits for RoomManager membership changes and writes each update event
+/// (LobbyFeed) into every stream's buffer; streams that fall more than
+/// kMaxStreamBacklog behind are dropped.
 class HttpServer {
 public:
+    static constexpr size_t kWorkerThreads = 4;
+    static constexpr size_t kMaxConnections = 1024;
+    static constexpr auto kIdleTimeout = std::chrono::seconds(30);
+    static constexpr size_t kMaxStreamBacklog = 256 * 1024;
+    static constexpr auto kStreamKeepAlive = std::chrono::seconds(15);
+
     HttpServer(std::shared_ptr<RoomManager> room_manager,
                const std::string& hostname = "localhost",
                uint16_t wt_port = 4433);
@@ -31,17 +71,77 @@ public:
     /// Set the TLS certificate hash (base64-encoded SHA-256) for WebTransport
     void set_cert_hash(const std::string& hash) { cert_hash_ = hash; }
 
-    /// Start listening for HTTP connections
+    /// Source of per-transport session counts for /metrics (optional)
+    void set_session_binder(std::shared_ptr<SessionBinder> binder) {
+        session_binder_ = std::move(binder);
+    }
+
+    /// Source of the WebTransport send pool's counters for /metrics (optional)
+    void set_send_pool_stats(std::function<PacketPool::Stats()> stats) {
+        send_pool_stats_ = std::move(stats);
+    }
+
+    /// Host the room directory; `node_id` is this node's ID in it.
+    /// Heartbeats and drain requests must carry `secret`; without one they
+    /// are all refused.
+    void set_directory(std::shared_ptr<RoomDirectory> directory, const std::string& node_id,
+                       const std::string& secret = "") {
+        directory_ = std::move(directory);
+        node_id_ = node_id;
+        cluster_secret_ = secret;
+    }
+
+    /// Start listening for HTTP connections (port 0: any free port)
     bool listen(const std::string& address, uint16_t port);
 
+    /// Port actually bound by listen()
+    uint16_t port() const { return port_; }
+
     /// Stop the server
     void stop();
 
 private:
-    /// Handle an HTTP request (simple single-threaded for Phase 1)
-    void handle_connection(int client_fd);
+    struct Connection {
+        int fd = -1;
+        std::string remote_ip;
+        std::string in;            // unparsed input
+        std::string out;           // response bytes not yet sent
+        size_t out_offset = 0;
+        bool close_after_send = false;
+        bool busy = false;         // owned by a worker (conn_mutex_)
+        bool stream = false;       // event stream: out is guarded by conn_mutex_
+        std::chrono::steady_clock::time_point last_active;
+    };
 
-    /// Parse HTTP request and route to handler
+    void event_loop();
+    void worker_loop();
+    void accept_connections();
+    void close_idle_connections();
+
+    /// Read, answer and flush one ready connection (worker thread)
+    void service(Connection& conn);
+    /// Turn `conn` into a lobby event stream, starting with the snapshot
+    void start_stream(Connection& conn);
+    /// Flush a stream and watch for its client leaving (worker thread)
+    void service_stream(Connection& conn);
+    /// Send what's buffered; false on a dead socket
+    bool flush(Connection& conn);
+    /// Re-arm for the next event once this worker is done with it
+    void rearm(Connection& conn);
+    void rearm_locked(Connection& conn);
+    void close_connection(Connection& conn);
+    void close_locked(Connection& conn);
+
+    /// Wait for lobby changes and publish them to the streams
+    void lobby_loop();
+    /// Append `event` to every stream (and take `snapshot` for new ones)
+    void publish_lobby(const std::string& event, const std::string& snapshot);
+    /// Current listing, with remote owners' occupancy on a directory node
+    std::vector<RoomManager::RoomInfo> lobby_rooms();
+    /// Changes whenever lobby_rooms() may have
+    uint64_t lobby_version();
+
+    /// Route a request to its handler
     struct HttpRequest {
         std::string method;
         std::string path;
@@ -55,8 +155,13 @@ private:
         std::string body;
     };
 
+    /// Serialize `resp` onto the end of `out`
+    static void append_response(std::string& out, const HttpResponse& resp, bool keep_alive);
+
     HttpResponse route(const HttpRequest& req);
+    HttpResponse route_nodes(const HttpRequest& req);
     HttpResponse handle_list_rooms();
+    HttpResponse handle_metrics();
     HttpResponse handle_join_room(const std::string& room_name,
                                   const std::string& body);
     HttpResponse handle_leave_room(const std::string& room_name,
@@ -65,14 +170,48 @@ private:
                                    const std::string& body);
     HttpResponse handle_vacate_request(const std::string& room_name,
                                        const std::string& remote_ip);
+    HttpResponse handle_recording(const std::string& room_name,
+                                  const std::string& body);
+
+    /// Forward a room request to the node that owns the room
+    HttpResponse proxy(const NodeInfo& owner, const HttpRequest& req);
+
+    /// Owner of `room_name` if it's another node (directory only)
+    std::optional<NodeInfo> remote_owner(const std::string& room_name) const;
 
     std::shared_ptr<RoomManager> room_manager_;
+    std::shared_ptr<SessionBinder> session_binder_;
+    std::function<PacketPool::Stats()> send_pool_stats_;
+    std::shared_ptr<RoomDirectory> directory_;
+    std::string node_id_;
+    std::string cluster_secret_;
     std::string hostname_;
     uint16_t wt_port_;
     std::string cert_hash_;
+
     int server_fd_ = -1;
-    std::thread accept_thread_;
+    int epoll_fd_ = -1;
+    int wake_fd_ = -1;  // eventfd: wakes the event loop for stop()
+    uint16_t port_ = 0;
+    std::thread event_thread_;
+    std::thread lobby_thread_;
+    std::vector<std::thread> workers_;
     std::atomic<bool> running_{false};
+
+    std::mutex conn_mutex_;
+    std::unordered_map<int, std::unique_ptr<Connection>> connections_;  // by fd
+    std::string lobby_snapshot_;  // conn_mutex_; first event of a new stream
+    LobbyFeed lobby_feed_;        // lobby thread only
+
+    std::mutex ready_mutex_;
+    std::condition_variable ready_cv_;
+    std::deque<Connection*> ready_;  // busy connections awaiting a worker
+
+    // Pre-serialized /api/rooms body and the lobby version it reflects
+    std::mutex rooms_cache_mutex_;
+    uint64_t rooms_cache_version_ = 0;
+    bool rooms_cache_valid_ = false;
+    std::string rooms_cache_;
 };
 
 } // namespace tutti
@@ -0,0 +1,48 @@
+#include "lobby_feed.h"
+
+#include <algorithm>
+
+#include <nlohmann/json.hpp>
+
+namespace tutti {
+
+namespace {
+
+nlohmann::json room_json(const RoomManager::RoomInfo& room) {
+    return {{"name", room.name},
+            {"participant_count", room.participant_count},
+            {"max_participants", room.max_participants},
+            {"claimed", room.claimed}};
+}
+
+bool same(const RoomManager::RoomInfo& a, const RoomManager::RoomInfo& b) {
+    return a.name == b.name && a.participant_count == b.participant_count &&
+           a.max_participants == b.max_participants && a.claimed == b.claimed;
+}
+
+/// One SSE event; the JSON is a single line, so one data: field
+std::string sse_event(const char* name, const nlohmann::json& rooms) {
+    return std::string("event: ") + name + "\ndata: " +
+           nlohmann::json{{"rooms", rooms}}.dump() + "\n\n";
+}
+
+} // namespace
+
+std::string LobbyFeed::update(const std::vector<RoomInfo>& rooms) {
+    nlohmann::json changed = nlohmann::json::array();
+    for (const auto& room : rooms) {
+        auto it = std::find_if(rooms_.begin(), rooms_.end(),
+                               [&](const RoomInfo& r) { return r.name == room.name; });
+        if (it == rooms_.end() || !same(*it, room)) changed.push_back(room_json(room));
+    }
+    if (changed.empty() && !snapshot_.empty()) return "";
+
+    rooms_ = rooms;
+    nlohmann::json all = nlohmann::json::array();
+    for (const auto& room : rooms_) all.push_back(room_json(room));
+    // retry: how long the browser's EventSource waits before reconnecting
+    snapshot_ = "retry: 2000\n" + sse_event("snapshot", all);
+    return changed.empty() ? "" : sse_event("update", changed);
+}
+
+} // namespace tutti
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "rooms/room_manager.h"
+
+namespace tutti {
+
+/// The lobby room listing as Server-Sent Events for GET /api/rooms/events.
+///
+/// New subscribers get snapshot_event() (every room); after that each
+/// change to the listing becomes one "update" event carrying only the
+/// rooms that changed, serialized once and sent to every subscriber.
+/// Not thread-safe: HttpServer's lobby thread owns it.
+class LobbyFeed {
+public:
+    using RoomInfo = RoomManager::RoomInfo;
+
+    /// Comment line that keeps idle proxies from closing the stream
+    static constexpr const char* kKeepAlive = ": keep-alive\n\n";
+
+    /// Take the current listing. Returns the update event for the rooms
+    /// that differ from the last listing, or "" if none do.
+    std::string update(const std::vector<RoomInfo>& rooms);
+
+    /// `event: snapshot` with the whole listing as of the last update()
+    const std::string& snapshot_event() const { return snapshot_; }
+
+private:
+    std::vector<RoomInfo> rooms_;
+    std::string snapshot_;
+};
+
+} // namespace tutti
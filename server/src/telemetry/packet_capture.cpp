@@ -0,0 +1,129 @@
+#include "packet_capture.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+namespace tutti {
+
+namespace {
+// Writer wakes this often; the queue holds ~1s, so this is far from full
+constexpr auto kWriterInterval = std::chrono::milliseconds(5);
+static_assert((PacketCapture::kQueueCapacity & (PacketCapture::kQueueCapacity - 1)) == 0,
+              "queue capacity must be a power of two");
+} // namespace
+
+PacketCapture::PacketCapture() : cells_(new Cell[kQueueCapacity]) {
+    for (size_t i = 0; i < kQueueCapacity; ++i) {
+        cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+PacketCapture::~PacketCapture() { stop(); }
+
+bool PacketCapture::start(const std::string& path, const std::string& room_name,
+                          size_t max_participants) {
+    if (writer_.joinable()) return false;
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) {
+        std::cerr << "[Capture] Cannot create " << path << ": " << std::strerror(errno) << "\n";
+        return false;
+    }
+
+    uint8_t header[20];
+    std::memcpy(header, kCaptureMagic, sizeof(kCaptureMagic));
+    std::memcpy(header + 8, &kCaptureVersion, sizeof(kCaptureVersion));
+    uint32_t max = static_cast<uint32_t>(max_participants);
+    std::memcpy(header + 12, &max, sizeof(max));
+    uint32_t name_len = static_cast<uint32_t>(room_name.size());
+    std::memcpy(header + 16, &name_len, sizeof(name_len));
+    std::fwrite(header, 1, sizeof(header), file_);
+    std::fwrite(room_name.data(), 1, room_name.size(), file_);
+
+    stopping_ = false;
+    start_ns_.store(std::chrono::steady_clock::now().time_since_epoch().count(),
+                    std::memory_order_relaxed);
+    writer_ = std::thread([this] { run_writer(); });
+    active_.store(true, std::memory_order_release);
+    std::cout << "[Capture] Recording room " << room_name << " to " << path << "\n";
+    return true;
+}
+
+void PacketCapture::stop() {
+    if (!writer_.joinable()) return;
+    active_.store(false, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    writer_.join();
+    std::fclose(file_);
+    file_ = nullptr;
+}
+
+void PacketCapture::record(CaptureEvent kind, uint32_t slot, const uint8_t* data,
+                           size_t len, int64_t now_ns) {
+    if (!active_.load(std::memory_order_relaxed)) return;
+
+    size_t pos = enqueue_.load(std::memory_order_relaxed);
+    Cell* cell;
+    for (;;) {
+        cell = &cells_[pos & (kQueueCapacity - 1)];
+        size_t seq = cell->sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            if (enqueue_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);  // full
+            return;
+        } else {
+            pos = enqueue_.load(std::memory_order_relaxed);
+        }
+    }
+
+    CaptureRecord& rec = cell->record;
+    rec.t_ns = now_ns - start_ns_.load(std::memory_order_relaxed);
+    rec.kind = kind;
+    rec.slot = static_cast<uint16_t>(slot);
+    rec.len = static_cast<uint16_t>(std::min(len, CaptureRecord::kMaxPayload));
+    if (rec.len) std::memcpy(rec.data, data, rec.len);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+}
+
+void PacketCapture::run_writer() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        lock.unlock();
+        while (drain()) {}
+        std::fflush(file_);
+        lock.lock();
+        cv_.wait_for(lock, kWriterInterval, [this] { return stopping_; });
+    }
+    lock.unlock();
+    while (drain()) {}  // producers have stopped: write out the tail
+}
+
+bool PacketCapture::drain() {
+    Cell& cell = cells_[dequeue_ & (kQueueCapacity - 1)];
+    if (cell.sequence.load(std::memory_order_acquire) != dequeue_ + 1) return false;
+
+    const CaptureRecord& rec = cell.record;
+    if (rec.t_ns >= 0) {  // negative: queued by a previous capture's stragglers
+        uint8_t header[kCaptureRecordHeaderSize] = {};
+        std::memcpy(header, &rec.t_ns, sizeof(rec.t_ns));
+        header[8] = static_cast<uint8_t>(rec.kind);
+        std::memcpy(header + 10, &rec.slot, sizeof(rec.slot));
+        std::memcpy(header + 12, &rec.len, sizeof(rec.len));
+        std::fwrite(header, 1, sizeof(header), file_);
+        std::fwrite(rec.data, 1, rec.len, file_);
+        written_.fetch_add(1, std::memory_order_relaxed);
+    }
+    cell.sequence.store(dequeue_ + kQueueCapacity, std::memory_order_release);
+    ++dequeue_;
+    return true;
+}
+
+} // namespace tutti
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "transport/transport_interface.h"
+
+namespace tutti {
+
+/// What a capture record holds. Values are the on-disk encoding.
+enum class CaptureEvent : uint8_t {
+    Datagram = 1,  // inbound audio datagram, as received
+    MixCycle = 2,  // the room ran a mix cycle
+    Join = 3,      // payload: u8 listen_only, then the participant id
+    Bind = 4,      // payload: u8 codec, u8 channels
+    Leave = 5,
+    Gain = 6,      // slot is the listener; payload: u16 source slot, f32 gain
+    Mute = 7,      // payload: u16 source slot, u8 muted
+    Pan = 8,       // payload: u16 source slot, f32 pan
+};
+
+/// One captured event. `t_ns` is relative to the start of the capture.
+struct CaptureRecord {
+    static constexpr size_t kMaxPayload = kMaxAudioPacketSize;
+
+    int64_t t_ns = 0;
+    CaptureEvent kind = CaptureEvent::Datagram;
+    uint16_t slot = 0;
+    uint16_t len = 0;
+    uint8_t data[kMaxPayload];
+};
+
+/// Capture file layout (little-endian, append-only):
+///   header: "TUTTICAP", u32 version, u32 max participants, u32 name
+///           length, room name
+///   records: i64 t_ns, u8 kind, u8 reserved, u16 slot, u16 len, len bytes
+constexpr char kCaptureMagic[8] = {'T', 'U', 'T', 'T', 'I', 'C', 'A', 'P'};
+constexpr uint32_t kCaptureVersion = 1;
+constexpr size_t kCaptureRecordHeaderSize = 14;
+
+/// Opt-in capture of one room's inbound audio and control events.
+///
+/// record() is called from the audio path (receive threads, the mixer
+/// worker) and control threads: it copies the event into a bounded
+/// lock-free MPSC queue, or counts a drop if the queue is full, and never
+/// blocks or allocates. A writer thread drains the queue to the file.
+///
+/// Start and stop are control-path calls, serialized by the caller. The
+/// capture object outlives every start/stop, so producers never race its
+/// destruction.
+class PacketCapture {
+public:
+    /// Records queued between writer passes (~1s of a full room)
+    static constexpr size_t kQueueCapacity = 4096;
+
+    PacketCapture();
+    ~PacketCapture();
+
+    PacketCapture(const PacketCapture&) = delete;
+    PacketCapture& operator=(const PacketCapture&) = delete;
+
+    /// Create `path` and start writing. False if already capturing or the
+    /// file can't be created.
+    bool start(const std::string& path, const std::string& room_name, size_t max_participants);
+
+    /// Write out what's queued and close the file
+    void stop();
+
+    bool active() const { return active_.load(std::memory_order_relaxed); }
+
+    /// Queue an event stamped `now_ns` (steady clock). Payloads longer
+    /// than CaptureRecord::kMaxPayload are truncated. Lock-free.
+    void record(CaptureEvent kind, uint32_t slot, const uint8_t* data, size_t len, int64_t now_ns);
+
+    /// Records lost to a full queue, and written, since construction
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+    uint64_t written() const { return written_.load(std::memory_order_relaxed); }
+
+private:
+    void run_writer();
+    /// Write every queued record; false once the queue is empty
+    bool drain();
+
+    // Bounded MPSC queue (per-cell sequence numbers): producers claim a
+    // cell with one CAS, the writer is the only consumer
+    struct Cell {
+        std::atomic<size_t> sequence{0};
+        CaptureRecord record;
+    };
+    std::unique_ptr<Cell[]> cells_;
+    alignas(64) std::atomic<size_t> enqueue_{0};
+    alignas(64) size_t dequeue_ = 0;  // writer only
+
+    std::atomic<bool> active_{false};
+    std::atomic<int64_t> start_ns_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> written_{0};
+
+    std::FILE* file_ = nullptr;  // writer thread while running
+    std::thread writer_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stopping_ = false;
+};
+
+} // namespace tutti
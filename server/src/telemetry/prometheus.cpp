@@ -0,0 +1,77 @@
+#include "prometheus.h"
+
+#include <cstdio>
+
+namespace tutti {
+
+namespace {
+std::string format_double(double value) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.9g", value);
+    return buf;
+}
+} // namespace
+
+void PrometheusWriter::family(const std::string& name, const char* type, const char* help) {
+    out_ += "# HELP " + name + " " + help + "\n";
+    out_ += "# TYPE " + name + " " + type + "\n";
+}
+
+void PrometheusWriter::sample(const std::string& name, const Labels& labels, double value) {
+    out_ += name;
+    write_labels(labels);
+    out_ += " " + format_double(value) + "\n";
+}
+
+void PrometheusWriter::sample(const std::string& name, const Labels& labels, uint64_t value) {
+    out_ += name;
+    write_labels(labels);
+    out_ += " " + std::to_string(value) + "\n";
+}
+
+void PrometheusWriter::histogram(const std::string& name, const Labels& labels,
+                                 const LatencyHistogram::Snapshot& snapshot) {
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < LatencyHistogram::kBuckets; ++i) {
+        cumulative += snapshot.counts[i];
+        uint64_t bound = LatencyHistogram::upper_bound_ns(i);
+        std::string le = bound == UINT64_MAX ? "+Inf" : format_double(bound / 1e9);
+        out_ += name + "_bucket";
+        write_labels(labels, le.c_str());
+        out_ += " " + std::to_string(cumulative) + "\n";
+    }
+    sample(name + "_sum", labels, snapshot.sum_ns / 1e9);
+    sample(name + "_count", labels, cumulative);
+}
+
+std::string PrometheusWriter::escape_label(const std::string& value) {
+    std::string out;
+    out.reserve(value.size());
+    for (char c : value) {
+        switch (c) {
+            case '\\': out += "\\\\"; break;
+            case '"':  out += "\\\""; break;
+            case '\n': out += "\\n"; break;
+            default:   out += c;
+        }
+    }
+    return out;
+}
+
+void PrometheusWriter::write_labels(const Labels& labels, const char* le) {
+    if (labels.empty() && !le) return;
+    out_ += "{";
+    bool first = true;
+    for (const auto& [key, value] : labels) {
+        if (!first) out_ += ",";
+        out_ += key + "=\"" + escape_label(value) + "\"";
+        first = false;
+    }
+    if (le) {
+        if (!first) out_ += ",";
+        out_ += std::string("le=\"") + le + "\"";
+    }
+    out_ += "}";
+}
+
+} // namespace tutti
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "room_metrics.h"
+
+namespace tutti {
+
+/// Builds a Prometheus text exposition (format 0.0.4).
+///
+/// Each metric family is declared once with family(), followed by all of
+/// its samples. Latency histograms are exported in seconds.
+class PrometheusWriter {
+public:
+    using Labels = std::vector<std::pair<std::string, std::string>>;
+
+    /// Emit the # HELP and # TYPE lines. `type` is counter, gauge or histogram.
+    void family(const std::string& name, const char* type, const char* help);
+
+    void sample(const std::string& name, const Labels& labels, double value);
+    void sample(const std::string& name, const Labels& labels, uint64_t value);
+
+    /// _bucket (cumulative, with le), _sum and _count samples
+    void histogram(const std::string& name, const Labels& labels,
+                   const LatencyHistogram::Snapshot& snapshot);
+
+    const std::string& str() const { return out_; }
+
+    /// Escape a label value (backslash, double quote, newline)
+    static std::string escape_label(const std::string& value);
+
+private:
+    void write_labels(const Labels& labels, const char* le = nullptr);
+
+    std::string out_;
+};
+
+} // namespace tutti
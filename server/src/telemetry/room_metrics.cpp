@@ -0,0 +1,148 @@
+#include "room_metrics.h"
+
+#include <algorithm>
+
+namespace tutti {
+
+namespace {
+// Sequence jumps larger than this (either way) are a stream restart, not loss
+constexpr uint32_t kMaxSequenceJump = 3000;
+
+uint64_t span_lost(uint32_t base, uint32_t highest, uint64_t received) {
+    uint64_t expected = static_cast<uint64_t>(highest - base) + 1;
+    return expected > received ? expected - received : 0;
+}
+} // namespace
+
+// ── LatencyHistogram ────────────────────────────────────────────────────────
+
+void LatencyHistogram::record(uint64_t ns) {
+    size_t bucket = 0;
+    while (bucket + 1 < kBuckets && ns > upper_bound_ns(bucket)) ++bucket;
+    counts_[bucket].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_ns_.fetch_add(ns, std::memory_order_relaxed);
+
+    uint64_t prev = max_ns_.load(std::memory_order_relaxed);
+    while (ns > prev &&
+           !max_ns_.compare_exchange_weak(prev, ns, std::memory_order_relaxed)) {}
+}
+
+uint64_t LatencyHistogram::upper_bound_ns(size_t bucket) {
+    if (bucket + 1 >= kBuckets) return UINT64_MAX;
+    return 1000ULL << bucket;
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const {
+    Snapshot s;
+    for (size_t i = 0; i < kBuckets; ++i) {
+        s.counts[i] = counts_[i].load(std::memory_order_relaxed);
+        s.count += s.counts[i];
+    }
+    s.sum_ns = sum_ns_.load(std::memory_order_relaxed);
+    s.max_ns = max_ns_.load(std::memory_order_relaxed);
+    return s;
+}
+
+uint64_t LatencyHistogram::Snapshot::quantile_ns(double q) const {
+    if (count == 0) return 0;
+    auto rank = static_cast<uint64_t>(std::clamp(q, 0.0, 1.0) * static_cast<double>(count));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+        seen += counts[i];
+        if (seen > rank || seen == count) {
+            return i + 1 < kBuckets ? upper_bound_ns(i) : max_ns;
+        }
+    }
+    return max_ns;
+}
+
+// ── RoomMetrics ─────────────────────────────────────────────────────────────
+
+RoomMetrics::RoomMetrics(size_t slots)
+    : slot_count_(slots), slots_(new Slot[slots]) {}
+
+void RoomMetrics::record_received(uint32_t slot, uint32_t sequence) {
+    if (slot >= slot_count_) return;
+    Slot& s = slots_[slot];
+    s.received.fetch_add(1, std::memory_order_relaxed);
+
+    // Single writer per slot: plain load/store sequences are enough
+    if (!s.have_sequence.load(std::memory_order_relaxed)) {
+        s.base_sequence.store(sequence, std::memory_order_relaxed);
+        s.highest_sequence.store(sequence, std::memory_order_relaxed);
+        s.span_received.store(1, std::memory_order_relaxed);
+        s.have_sequence.store(true, std::memory_order_relaxed);
+        return;
+    }
+
+    uint32_t highest = s.highest_sequence.load(std::memory_order_relaxed);
+    uint32_t ahead = sequence - highest;
+    uint32_t behind = highest - sequence;
+    if (ahead != 0 && ahead <= kMaxSequenceJump) {
+        s.highest_sequence.store(sequence, std::memory_order_relaxed);
+    } else if (ahead > kMaxSequenceJump && behind > kMaxSequenceJump) {
+        // Restart (client reload): close out the old span
+        uint32_t base = s.base_sequence.load(std::memory_order_relaxed);
+        uint64_t lost = span_lost(base, highest, s.span_received.load(std::memory_order_relaxed));
+        s.lost_before.fetch_add(lost, std::memory_order_relaxed);
+        s.base_sequence.store(sequence, std::memory_order_relaxed);
+        s.highest_sequence.store(sequence, std::memory_order_relaxed);
+        s.span_received.store(1, std::memory_order_relaxed);
+        return;
+    } else {
+        // Reordered or duplicate: no new span, but it may fill a gap
+        uint32_t base = s.base_sequence.load(std::memory_order_relaxed);
+        if (static_cast<int32_t>(sequence - base) < 0) return;
+    }
+    s.span_received.fetch_add(1, std::memory_order_relaxed);
+}
+
+void RoomMetrics::record_fast_path(uint32_t slot) {
+    if (slot < slot_count_) slots_[slot].fast_path.fetch_add(1, std::memory_order_relaxed);
+}
+
+void RoomMetrics::record_mixed_path(uint32_t slot) {
+    if (slot < slot_count_) slots_[slot].mixed_path.fetch_add(1, std::memory_order_relaxed);
+}
+
+void RoomMetrics::record_input_drop(uint32_t slot) {
+    if (slot < slot_count_) slots_[slot].input_drops.fetch_add(1, std::memory_order_relaxed);
+}
+
+void RoomMetrics::record_silent(uint32_t slot) {
+    if (slot < slot_count_) slots_[slot].silent.fetch_add(1, std::memory_order_relaxed);
+}
+
+void RoomMetrics::reset_slot(uint32_t slot) {
+    if (slot >= slot_count_) return;
+    Slot& s = slots_[slot];
+    s.received.store(0, std::memory_order_relaxed);
+    s.fast_path.store(0, std::memory_order_relaxed);
+    s.mixed_path.store(0, std::memory_order_relaxed);
+    s.input_drops.store(0, std::memory_order_relaxed);
+    s.silent.store(0, std::memory_order_relaxed);
+    s.have_sequence.store(false, std::memory_order_relaxed);
+    s.span_received.store(0, std::memory_order_relaxed);
+    s.lost_before.store(0, std::memory_order_relaxed);
+}
+
+SlotMetrics RoomMetrics::slot(uint32_t slot) const {
+    if (slot >= slot_count_) return {};
+    const Slot& s = slots_[slot];
+    SlotMetrics m;
+    m.received = s.received.load(std::memory_order_relaxed);
+    m.fast_path_packets = s.fast_path.load(std::memory_order_relaxed);
+    m.mixed_path_packets = s.mixed_path.load(std::memory_order_relaxed);
+    m.input_drops = s.input_drops.load(std::memory_order_relaxed);
+    m.silent_packets = s.silent.load(std::memory_order_relaxed);
+    m.sequence_lost = s.lost_before.load(std::memory_order_relaxed);
+    if (s.have_sequence.load(std::memory_order_relaxed)) {
+        m.sequence_lost += span_lost(s.base_sequence.load(std::memory_order_relaxed),
+                                     s.highest_sequence.load(std::memory_order_relaxed),
+                                     s.span_received.load(std::memory_order_relaxed));
+    }
+    return m;
+}
+
+} // namespace tutti
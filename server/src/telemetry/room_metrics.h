@@ -0,0 +1,102 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace tutti {
+
+/// Lock-free latency histogram with power-of-two microsecond buckets.
+/// record() is a handful of relaxed atomic adds, safe from the RT thread;
+/// snapshot() may be called from any thread.
+class LatencyHistogram {
+public:
+    /// Buckets: <=1us, <=2us, ... <=16.384ms, then +Inf
+    static constexpr size_t kBuckets = 16;
+
+    void record(uint64_t ns);
+
+    /// Inclusive upper bound of a bucket in nanoseconds (UINT64_MAX for +Inf)
+    static uint64_t upper_bound_ns(size_t bucket);
+
+    struct Snapshot {
+        std::array<uint64_t, kBuckets> counts{};  // per bucket, not cumulative
+        uint64_t count = 0;
+        uint64_t sum_ns = 0;
+        uint64_t max_ns = 0;
+
+        /// Upper bound of the bucket holding quantile `q` (0..1), 0 if empty
+        uint64_t quantile_ns(double q) const;
+    };
+    Snapshot snapshot() const;
+
+private:
+    std::array<std::atomic<uint64_t>, kBuckets> counts_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_ns_{0};
+    std::atomic<uint64_t> max_ns_{0};
+};
+
+/// Receive-side counters for one participant slot
+struct SlotMetrics {
+    uint64_t received = 0;            // packets accepted from the transport
+    uint64_t fast_path_packets = 0;   // forwarded directly (2-party rooms)
+    uint64_t mixed_path_packets = 0;  // handed to the mixer
+    uint64_t input_drops = 0;         // rejected by the jitter buffer
+    uint64_t silent_packets = 0;      // gated as silence (or silence markers)
+    uint64_t sequence_lost = 0;       // expected minus received, from sequence numbers
+};
+
+/// Lock-free audio-path instrumentation for one room.
+///
+/// Per-slot counters are written by that slot's receive thread (one
+/// transport session per slot) and the room-wide histogram by the owning
+/// mixer worker, all with relaxed atomics. Readers never take room locks.
+/// Slots are reset when a new participant takes them.
+class RoomMetrics {
+public:
+    explicit RoomMetrics(size_t slots);
+
+    /// Mixer worker: one process_cycle took `ns`
+    void record_mix_cycle(uint64_t ns) { mix_cycles_.record(ns); }
+
+    /// Receive path: a packet with `sequence` arrived on `slot`
+    void record_received(uint32_t slot, uint32_t sequence);
+    void record_fast_path(uint32_t slot);
+    void record_mixed_path(uint32_t slot);
+    void record_input_drop(uint32_t slot);
+    void record_silent(uint32_t slot);
+
+    /// Control path: a new participant took `slot`
+    void reset_slot(uint32_t slot);
+
+    SlotMetrics slot(uint32_t slot) const;
+    LatencyHistogram::Snapshot mix_cycles() const { return mix_cycles_.snapshot(); }
+
+private:
+    // One cache line per slot: each is written by a different network thread
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> received{0};
+        std::atomic<uint64_t> fast_path{0};
+        std::atomic<uint64_t> mixed_path{0};
+        std::atomic<uint64_t> input_drops{0};
+        std::atomic<uint64_t> silent{0};
+
+        // Sequence-gap loss (RFC 3550 §A.3 style): expected = span of
+        // sequence numbers seen, lost = expected - received. A restart
+        // folds the current span into lost_before and starts a new one.
+        std::atomic<bool> have_sequence{false};
+        std::atomic<uint32_t> base_sequence{0};
+        std::atomic<uint32_t> highest_sequence{0};
+        std::atomic<uint64_t> span_received{0};
+        std::atomic<uint64_t> lost_before{0};
+    };
+
+    size_t slot_count_;
+    std::unique_ptr<Slot[]> slots_;
+    LatencyHistogram mix_cycles_;
+};
+
+} // namespace tutti
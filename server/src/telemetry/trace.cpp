@@ -0,0 +1,141 @@
+#include "trace.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <nlohmann/json.hpp>
+
+namespace tutti {
+namespace trace {
+
+namespace {
+static_assert((kRingCapacity & (kRingCapacity - 1)) == 0, "ring capacity must be a power of two");
+
+/// Where dump timestamps start: a raw timestamp and steady_clock at once
+struct Origin {
+    uint64_t ticks = now();
+    std::chrono::steady_clock::time_point time = std::chrono::steady_clock::now();
+};
+
+const Origin& origin() {
+    static const Origin o;
+    return o;
+}
+
+struct Thread {
+    std::unique_ptr<ThreadRing> ring;
+    uint32_t tid;
+    std::string name;
+};
+
+// Rings outlive their threads, so a dump still shows threads that have exited
+std::mutex g_registry_mutex;
+std::vector<Thread> g_threads;
+
+/// Raw timestamp ticks per microsecond, measured against steady_clock over
+/// the life of the process (at least 10ms of it)
+double ticks_per_us() {
+#if defined(__x86_64__) || defined(__i386__)
+    const Origin& o = origin();
+    auto elapsed = std::chrono::steady_clock::now() - o.time;
+    if (elapsed < std::chrono::milliseconds(10)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10) - elapsed);
+    }
+    const uint64_t ticks = now();
+    elapsed = std::chrono::steady_clock::now() - o.time;
+    const double us = std::chrono::duration<double, std::micro>(elapsed).count();
+    return static_cast<double>(ticks - o.ticks) / us;
+#else
+    return 1000.0;  // steady_clock nanoseconds
+#endif
+}
+} // namespace
+
+void ThreadRing::snapshot(std::vector<Event>& out) const {
+    // The oldest cell is the one the writer's next event overwrites: skip it
+    const uint64_t head = head_.load(std::memory_order_acquire);
+    const uint64_t begin = head >= kRingCapacity ? head - kRingCapacity + 1 : 0;
+    const size_t at = out.size();
+    out.reserve(at + static_cast<size_t>(head - begin));
+    for (uint64_t i = begin; i < head; ++i) {
+        const Cell& cell = cells_[i & (kRingCapacity - 1)];
+        out.push_back({cell.name.load(std::memory_order_relaxed),
+                       cell.start.load(std::memory_order_relaxed),
+                       cell.end.load(std::memory_order_relaxed),
+                       cell.arg.load(std::memory_order_relaxed)});
+    }
+
+    // Cells the writer has started on since may be torn: the writer is at
+    // most at index `after`, which overwrites index `after - capacity`
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint64_t after = head_.load(std::memory_order_relaxed);
+    if (after >= begin + kRingCapacity) {
+        const auto stale = static_cast<size_t>(std::min(after - kRingCapacity + 1, head) - begin);
+        out.erase(out.begin() + static_cast<std::ptrdiff_t>(at),
+                  out.begin() + static_cast<std::ptrdiff_t>(at + stale));
+    }
+}
+
+ThreadRing* register_thread() {
+    origin();
+    std::lock_guard<std::mutex> lock(g_registry_mutex);
+    const auto tid = static_cast<uint32_t>(g_threads.size() + 1);
+    g_threads.push_back({std::make_unique<ThreadRing>(), tid, "thread-" + std::to_string(tid)});
+    return g_threads.back().ring.get();
+}
+
+void set_thread_name(const std::string& name) {
+    const ThreadRing* ring = &thread_ring();
+    std::lock_guard<std::mutex> lock(g_registry_mutex);
+    for (auto& t : g_threads) {
+        if (t.ring.get() == ring) t.name = name;
+    }
+}
+
+std::string dump_chrome_json() {
+    const double per_us = ticks_per_us();
+    const uint64_t base = origin().ticks;
+    auto us = [&](uint64_t ticks) {
+        return ticks > base ? static_cast<double>(ticks - base) / per_us : 0.0;
+    };
+
+    std::string out = R"({"displayTimeUnit":"ns","traceEvents":[)";
+    bool first = true;
+    char buf[256];
+    std::vector<Event> events;
+
+    std::lock_guard<std::mutex> lock(g_registry_mutex);
+    for (const auto& t : g_threads) {
+        if (!first) out += ',';
+        first = false;
+        out += R"({"name":"thread_name","ph":"M","pid":1,"tid":)" + std::to_string(t.tid) +
+               R"(,"args":{"name":)" + nlohmann::json(t.name).dump() + "}}";
+
+        events.clear();
+        t.ring->snapshot(events);
+        for (const Event& e : events) {
+            if (e.end != 0) {
+                const double dur = e.end > e.start ? static_cast<double>(e.end - e.start) / per_us : 0.0;
+                std::snprintf(buf, sizeof(buf),
+                              R"(,{"name":"%s","ph":"X","pid":1,"tid":%u,"ts":%.3f,"dur":%.3f,)"
+                              R"("args":{"arg":%)" PRIu64 "}}",
+                              e.name, t.tid, us(e.start), dur, e.arg);
+            } else {
+                std::snprintf(buf, sizeof(buf),
+                              R"(,{"name":"%s","ph":"i","s":"t","pid":1,"tid":%u,"ts":%.3f,)"
+                              R"("args":{"arg":%)" PRIu64 "}}",
+                              e.name, t.tid, us(e.start), e.arg);
+            }
+            out += buf;
+        }
+    }
+    out += "]}";
+    return out;
+}
+
+} // namespace trace
+} // namespace tutti
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace tutti {
+namespace trace {
+
+/// Hot-path tracing: TUTTI_TRACE scopes stamp their start and end into the
+/// calling thread's ring, and dump_chrome_json() turns every ring into a
+/// Chrome trace (chrome://tracing, ui.perfetto.dev) on demand.
+///
+/// The macros exist only in builds configured with TUTTI_ENABLE_TRACING
+/// (TUTTI_TRACING defined); otherwise they compile to nothing and their
+/// arguments aren't evaluated. The rings themselves are always built, so
+/// tests and benchmarks can drive them directly.
+///
+/// A ring has one writer, its thread: recording an event is two timestamp
+/// reads and five relaxed stores, with no lock, allocation or syscall (the
+/// ring is allocated by the thread's first event). Full rings
+/// overwrite their oldest events. A dump reads rings while they are being
+/// written and drops any event overwritten mid-read.
+#ifdef TUTTI_TRACING
+inline constexpr bool kEnabled = true;
+#else
+inline constexpr bool kEnabled = false;
+#endif
+
+/// Events kept per thread (~0.5 MB): a couple of seconds of a busy mixer
+static constexpr size_t kRingCapacity = 16384;
+
+/// Raw timestamp: the TSC on x86, steady_clock nanoseconds elsewhere.
+/// Dumps convert to time against steady_clock.
+inline uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+/// One traced scope, or an instant (end == 0). `name` must be a string
+/// literal: it is stored as a pointer, and written into dumps unescaped.
+struct Event {
+    const char* name = nullptr;
+    uint64_t start = 0;
+    uint64_t end = 0;
+    uint64_t arg = 0;
+};
+
+/// A thread's events. record() is for the owning thread only; snapshot()
+/// may run on any thread, concurrently.
+class ThreadRing {
+public:
+    void record(const char* name, uint64_t start, uint64_t end, uint64_t arg) {
+        const uint64_t head = head_.load(std::memory_order_relaxed);
+        // Orders the last publish before these stores, so a snapshot that
+        // sees any of them also sees the head that invalidates the cell
+        std::atomic_thread_fence(std::memory_order_release);
+        Cell& cell = cells_[head & (kRingCapacity - 1)];
+        cell.name.store(name, std::memory_order_relaxed);
+        cell.start.store(start, std::memory_order_relaxed);
+        cell.end.store(end, std::memory_order_relaxed);
+        cell.arg.store(arg, std::memory_order_relaxed);
+        head_.store(head + 1, std::memory_order_release);
+    }
+
+    /// Append the newest kRingCapacity - 1 events, oldest first
+    void snapshot(std::vector<Event>& out) const;
+
+    /// Events recorded since construction, overwritten ones included
+    uint64_t recorded() const { return head_.load(std::memory_order_acquire); }
+
+private:
+    struct Cell {
+        std::atomic<const char*> name{nullptr};
+        std::atomic<uint64_t> start{0};
+        std::atomic<uint64_t> end{0};
+        std::atomic<uint64_t> arg{0};
+    };
+
+    alignas(64) std::atomic<uint64_t> head_{0};
+    Cell cells_[kRingCapacity];
+};
+
+/// Allocate and register the calling thread's ring
+ThreadRing* register_thread();
+
+inline thread_local ThreadRing* t_ring = nullptr;
+
+/// The calling thread's ring
+inline ThreadRing& thread_ring() {
+    ThreadRing* ring = t_ring;
+    if (!ring) ring = t_ring = register_thread();
+    return *ring;
+}
+
+/// Record a finished scope on the calling thread
+inline void record(const char* name, uint64_t start, uint64_t end, uint64_t arg = 0) {
+    thread_ring().record(name, start, end, arg);
+}
+
+/// Record an instant on the calling thread
+inline void instant(const char* name, uint64_t arg = 0) {
+    thread_ring().record(name, now(), 0, arg);
+}
+
+/// Records from construction to destruction
+class Scope {
+public:
+    explicit Scope(const char* name, uint64_t arg = 0)
+        : name_(name), arg_(arg), start_(now()) {}
+    ~Scope() { record(name_, start_, now(), arg_); }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    const char* name_;
+    uint64_t arg_;
+    uint64_t start_;
+};
+
+/// Name the calling thread in dumps (registers its ring)
+void set_thread_name(const std::string& name);
+
+/// Every thread's events as Chrome trace JSON: complete ("X") events for
+/// scopes, instant ("i") events, and a thread_name record per thread.
+/// Timestamps are microseconds since the first thread registered.
+std::string dump_chrome_json();
+
+} // namespace trace
+} // namespace tutti
+
+#define TUTTI_TRACE_CONCAT_(a, b) a##b
+#define TUTTI_TRACE_CONCAT(a, b) TUTTI_TRACE_CONCAT_(a, b)
+
+#ifdef TUTTI_TRACING
+/// Trace the rest of the enclosing scope as `name` (a string literal)
+#define TUTTI_TRACE(name) \
+    ::tutti::trace::Scope TUTTI_TRACE_CONCAT(tutti_trace_, __LINE__)(name)
+/// The same, with a number shown as the event's "arg"
+#define TUTTI_TRACE_ARG(name, arg) \
+    ::tutti::trace::Scope TUTTI_TRACE_CONCAT(tutti_trace_, __LINE__)( \
+        name, static_cast<uint64_t>(arg))
+/// A point in time rather than a span
+#define TUTTI_TRACE_INSTANT(name, arg) \
+    ::tutti::trace::instant(name, static_cast<uint64_t>(arg))
+/// Name the calling thread in dumps
+#define TUTTI_TRACE_THREAD(name) ::tutti::trace::set_thread_name(name)
+#else
+#define TUTTI_TRACE(name) static_cast<void>(0)
+#define TUTTI_TRACE_ARG(name, arg) static_cast<void>(0)
+#define TUTTI_TRACE_INSTANT(name, arg) static_cast<void>(0)
+#define TUTTI_TRACE_THREAD(name) static_cast<void>(0)
+#endif
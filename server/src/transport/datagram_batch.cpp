@@ -0,0 +1,67 @@
+#include "datagram_batch.h"
+#include "telemetry/trace.h"
+
+#include <algorithm>
+
+namespace tutti {
+
+DatagramBatch::DatagramBatch(size_t capacity)
+    : entries_(std::max<size_t>(1, capacity)) {
+    group_.reserve(entries_.size());
+    holds_.reserve(entries_.size());
+    sent_.resize(entries_.size());
+}
+
+uint8_t* DatagramBatch::append(TransportSession* session, size_t len) {
+    if (count_ == entries_.size()) flush();
+    Entry& e = entries_[count_++];
+    e.server = session ? session->transport_server() : nullptr;
+    e.session = session;
+    e.len = std::min(len, kMaxDatagramSize);
+    return e.data;
+}
+
+void DatagramBatch::hold(std::atomic<uint32_t>* readers) {
+    if (holds_.size() == holds_.capacity()) flush();
+    holds_.push_back(readers);
+}
+
+void DatagramBatch::flush() {
+    if (count_ == 0) {
+        release_holds();
+        return;
+    }
+    TUTTI_TRACE_ARG("transport.send", count_);
+
+    std::fill(sent_.begin(), sent_.begin() + count_, 0);
+    for (size_t i = 0; i < count_; ++i) {
+        if (sent_[i]) continue;
+        Entry& e = entries_[i];
+        if (!e.session) continue;
+
+        if (!e.server) {
+            e.session->send_datagram(e.data, e.len);
+            continue;
+        }
+
+        // Everything else in the batch for the same server, in order
+        group_.clear();
+        for (size_t j = i; j < count_; ++j) {
+            Entry& other = entries_[j];
+            if (sent_[j] || other.server != e.server || !other.session) continue;
+            group_.push_back({other.session, other.data, other.len});
+            sent_[j] = 1;
+        }
+        e.server->send_datagrams(group_.data(), group_.size());
+    }
+
+    count_ = 0;
+    release_holds();
+}
+
+void DatagramBatch::release_holds() {
+    for (std::atomic<uint32_t>* readers : holds_) readers->fetch_sub(1, std::memory_order_release);
+    holds_.clear();
+}
+
+} // namespace tutti
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "transport_interface.h"
+
+namespace tutti {
+
+/// Outgoing datagrams collected over a mix pass and sent together.
+///
+/// A MixerScheduler worker appends every room's outputs for a pass, then
+/// flushes once. flush() groups entries by transport server and hands
+/// each group to TransportServer::send_datagrams, so a transport can
+/// amortize pool acquisition across them. Storage is pre-allocated;
+/// append() and hold() never allocate.
+///
+/// Sessions are held by raw pointer: the caller keeps each one alive
+/// until the flush, typically by pinning a grace period that hold()
+/// releases once the datagrams are out. The RT thread never owns, and so
+/// never destroys, a session.
+///
+/// Not thread-safe: owned by one thread.
+class DatagramBatch {
+public:
+    static constexpr size_t kDefaultCapacity = 256;
+    static constexpr size_t kMaxDatagramSize = kMaxAudioPacketSize;
+
+    explicit DatagramBatch(size_t capacity = kDefaultCapacity);
+
+    DatagramBatch(const DatagramBatch&) = delete;
+    DatagramBatch& operator=(const DatagramBatch&) = delete;
+
+    /// Reserve a `len`-byte buffer (len <= kMaxDatagramSize) to be sent to
+    /// `session` on the next flush. Flushes first if the batch is full.
+    uint8_t* append(TransportSession* session, size_t len);
+
+    /// Decrement `readers` once everything appended so far has been sent.
+    /// Flushes first if the batch already holds `capacity` counters.
+    void hold(std::atomic<uint32_t>* readers);
+
+    /// Send everything appended since the last flush
+    void flush();
+
+    size_t size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+
+private:
+    void release_holds();
+
+    struct Entry {
+        TransportSession* session = nullptr;
+        TransportServer* server = nullptr;
+        size_t len = 0;
+        uint8_t data[kMaxDatagramSize];
+    };
+
+    std::vector<Entry> entries_;
+    size_t count_ = 0;
+    std::vector<std::atomic<uint32_t>*> holds_;  // released by flush()
+
+    // flush() scratch (pre-allocated to capacity)
+    std::vector<OutgoingDatagram> group_;
+    std::vector<uint8_t> sent_;
+};
+
+} // namespace tutti
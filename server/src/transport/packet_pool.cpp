@@ -0,0 +1,181 @@
+#include "packet_pool.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace tutti {
+
+/// Sits immediately before every buffer's payload
+struct PacketPool::BlockHeader {
+    PacketPool* pool;              // nullptr = heap allocation
+    std::atomic<uint32_t> next;    // free-list link (pooled blocks only)
+    uint32_t index;
+};
+
+namespace {
+constexpr size_t kHeaderSpace = 16;  // keeps payloads 16-byte aligned
+constexpr size_t kCacheLine = 64;
+
+uint64_t pack(uint32_t tag, uint32_t index) {
+    return (static_cast<uint64_t>(tag) << 32) | index;
+}
+} // namespace
+
+PacketPool::PacketPool(size_t block_count, size_t block_size)
+    : block_count_(block_count),
+      block_size_(block_size),
+      stride_((kHeaderSpace + block_size + kCacheLine - 1) / kCacheLine * kCacheLine),
+      storage_(new uint8_t[stride_ * block_count + kCacheLine]),
+      free_head_(pack(0, kNil)) {
+    static_assert(sizeof(BlockHeader) <= kHeaderSpace, "header must fit before the payload");
+    auto addr = reinterpret_cast<uintptr_t>(storage_.get());
+    base_ = storage_.get() + ((kCacheLine - addr % kCacheLine) % kCacheLine);
+
+    // Touch every page now so the first sends don't take page faults
+    std::memset(base_, 0, stride_ * block_count_);
+
+    uint32_t next = kNil;
+    for (size_t i = block_count_; i-- > 0;) {
+        auto* h = new (base_ + i * stride_) BlockHeader;
+        h->pool = this;
+        h->index = static_cast<uint32_t>(i);
+        h->next.store(next, std::memory_order_relaxed);
+        next = static_cast<uint32_t>(i);
+    }
+    free_head_.store(pack(0, next), std::memory_order_release);
+}
+
+PacketPool::~PacketPool() = default;
+
+PacketPool::BlockHeader* PacketPool::header_at(uint32_t index) const {
+    return reinterpret_cast<BlockHeader*>(base_ + static_cast<size_t>(index) * stride_);
+}
+
+bool PacketPool::pop_free(uint32_t& index) {
+    uint64_t head = free_head_.load(std::memory_order_acquire);
+    for (;;) {
+        uint32_t top = static_cast<uint32_t>(head);
+        if (top == kNil) return false;
+        uint32_t next = header_at(top)->next.load(std::memory_order_relaxed);
+        // The tag changes on every successful pop, so a stale `next` read
+        // from a block that was popped and pushed back can't win the CAS
+        uint64_t desired = pack(static_cast<uint32_t>(head >> 32) + 1, next);
+        if (free_head_.compare_exchange_weak(head, desired,
+                                             std::memory_order_acq_rel,
+                                             std::memory_order_acquire)) {
+            index = top;
+            return true;
+        }
+    }
+}
+
+size_t PacketPool::pop_free_bulk(uint32_t* indices, size_t n) {
+    uint64_t head = free_head_.load(std::memory_order_acquire);
+    for (;;) {
+        // Walk up to n blocks from the top, then detach them with one CAS.
+        // As in pop_free, the tag makes a walk over a changed list fail.
+        size_t taken = 0;
+        uint32_t cursor = static_cast<uint32_t>(head);
+        while (taken < n && cursor != kNil) {
+            indices[taken++] = cursor;
+            cursor = header_at(cursor)->next.load(std::memory_order_relaxed);
+        }
+        if (taken == 0) return 0;
+        uint64_t desired = pack(static_cast<uint32_t>(head >> 32) + 1, cursor);
+        if (free_head_.compare_exchange_weak(head, desired,
+                                             std::memory_order_acq_rel,
+                                             std::memory_order_acquire)) {
+            return taken;
+        }
+    }
+}
+
+void PacketPool::push_free(uint32_t index) {
+    BlockHeader* h = header_at(index);
+    uint64_t head = free_head_.load(std::memory_order_relaxed);
+    for (;;) {
+        h->next.store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+        uint64_t desired = pack(static_cast<uint32_t>(head >> 32), index);
+        if (free_head_.compare_exchange_weak(head, desired,
+                                             std::memory_order_release,
+                                             std::memory_order_relaxed)) {
+            return;
+        }
+    }
+}
+
+uint8_t* PacketPool::heap_acquire(size_t len) {
+    void* mem = std::malloc(kHeaderSpace + len);
+    if (!mem) return nullptr;
+    auto* h = new (mem) BlockHeader;
+    h->pool = nullptr;
+    h->index = kNil;
+    return static_cast<uint8_t*>(mem) + kHeaderSpace;
+}
+
+uint8_t* PacketPool::acquire(size_t len) {
+    if (len > block_size_) {
+        oversized_.fetch_add(1, std::memory_order_relaxed);
+        return heap_acquire(len);
+    }
+
+    uint32_t index;
+    if (!pop_free(index)) {
+        exhausted_.fetch_add(1, std::memory_order_relaxed);
+        return heap_acquire(len);
+    }
+    in_use_.fetch_add(1, std::memory_order_relaxed);
+    return reinterpret_cast<uint8_t*>(header_at(index)) + kHeaderSpace;
+}
+
+size_t PacketPool::acquire_bulk(size_t len, uint8_t** out, size_t n) {
+    size_t got = 0;
+    if (len > block_size_) {
+        oversized_.fetch_add(n, std::memory_order_relaxed);
+    } else {
+        constexpr size_t kMaxWalk = 64;
+        uint32_t indices[kMaxWalk];
+        while (got < n) {
+            size_t taken = pop_free_bulk(indices, std::min(kMaxWalk, n - got));
+            if (taken == 0) break;
+            for (size_t i = 0; i < taken; ++i) {
+                out[got++] = reinterpret_cast<uint8_t*>(header_at(indices[i])) + kHeaderSpace;
+            }
+            in_use_.fetch_add(taken, std::memory_order_relaxed);
+        }
+        if (got < n) exhausted_.fetch_add(n - got, std::memory_order_relaxed);
+    }
+
+    for (; got < n; ++got) {
+        out[got] = heap_acquire(len);
+        if (!out[got]) break;
+    }
+    return got;
+}
+
+void PacketPool::release(uint8_t* data) {
+    if (!data) return;
+    auto* h = reinterpret_cast<BlockHeader*>(data - kHeaderSpace);
+    PacketPool* pool = h->pool;
+    if (!pool) {
+        h->~BlockHeader();
+        std::free(h);
+        return;
+    }
+    pool->in_use_.fetch_sub(1, std::memory_order_relaxed);
+    pool->push_free(h->index);
+}
+
+PacketPool::Stats PacketPool::stats() const {
+    Stats s;
+    s.capacity = block_count_;
+    s.block_size = block_size_;
+    s.in_use = in_use_.load(std::memory_order_relaxed);
+    s.exhausted = exhausted_.load(std::memory_order_relaxed);
+    s.oversized = oversized_.load(std::memory_order_relaxed);
+    return s;
+}
+
+} // namespace tutti
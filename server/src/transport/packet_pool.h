@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace tutti {
+
+/// Fixed-size, pre-allocated pool of send buffers for the transport layer.
+///
+/// Replaces a malloc/free per outgoing datagram or control message payload
+/// (a control message's wtf_buffer_t is still malloc'd; see
+/// WtSession::send_reliable). Buffers
+/// are handed to the transport library on send and returned from its
+/// send-complete callback, which runs on an arbitrary library thread, so
+/// acquire and release are lock-free (a tagged Treiber stack of block
+/// indices) and safe from any thread.
+///
+/// Each buffer is preceded by a small header naming its owner, so
+/// release() needs only the data pointer the library hands back. When the pool
+/// is exhausted or a request is larger than the block size, acquire() falls
+/// back to the heap and counts it; release() handles both transparently.
+class PacketPool {
+public:
+    /// Block payload size: fits a PCM datagram and typical control messages
+    static constexpr size_t kDefaultBlockSize = 1024;
+    static constexpr size_t kDefaultBlockCount = 2048;
+
+    explicit PacketPool(size_t block_count = kDefaultBlockCount,
+                        size_t block_size = kDefaultBlockSize);
+    ~PacketPool();
+
+    PacketPool(const PacketPool&) = delete;
+    PacketPool& operator=(const PacketPool&) = delete;
+
+    /// Get a buffer of at least `len` bytes. Returns nullptr only if the
+    /// heap fallback also fails.
+    uint8_t* acquire(size_t len);
+
+    /// Get `n` buffers of at least `len` bytes each with a single free-list
+    /// update (heap fallback for any the pool can't cover). Returns the
+    /// number of buffers obtained; fewer than `n` only if the heap fails.
+    size_t acquire_bulk(size_t len, uint8_t** out, size_t n);
+
+    /// Return a buffer from acquire() (pooled or heap). Safe from any thread.
+    /// The owning pool must outlive every buffer it handed out.
+    static void release(uint8_t* data);
+
+    struct Stats {
+        size_t capacity = 0;         // blocks in the pool
+        size_t block_size = 0;
+        size_t in_use = 0;           // pooled blocks currently handed out
+        uint64_t exhausted = 0;      // heap fallbacks because the pool was empty
+        uint64_t oversized = 0;      // heap fallbacks because len > block_size
+    };
+    Stats stats() const;
+
+private:
+    struct BlockHeader;
+
+    BlockHeader* header_at(uint32_t index) const;
+    bool pop_free(uint32_t& index);
+    size_t pop_free_bulk(uint32_t* indices, size_t n);
+    void push_free(uint32_t index);
+    static uint8_t* heap_acquire(size_t len);
+
+    static constexpr uint32_t kNil = UINT32_MAX;
+
+    size_t block_count_;
+    size_t block_size_;
+    size_t stride_;
+    std::unique_ptr<uint8_t[]> storage_;
+    uint8_t* base_ = nullptr;  // storage_ aligned to a cache line
+
+    // Free-list head: high 32 bits = ABA tag, low 32 bits = block index
+    std::atomic<uint64_t> free_head_;
+
+    std::atomic<size_t> in_use_{0};
+    std::atomic<uint64_t> exhausted_{0};
+    std::atomic<uint64_t> oversized_{0};
+};
+
+} // namespace tutti
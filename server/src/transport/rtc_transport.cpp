@@ -1,4 +1,5 @@
 #include "rtc_transport.h"
+#include "telemetry/trace.h"
 
 #include <iostream>
 #include <rtc/rtc.hpp>
@@ -29,6 +30,21 @@ bool RtcSession::send_datagram(const uint8_t* data, size_t len) {
     }
 }
 
+void RtcSession::receive_datagrams(
+    std::function<void(TransportSession*, const uint8_t*, size_t)> unbound) {
+    // onMessage hands each message over by value; registering it also
+    // delivers anything queued before the session was ready
+    audio_dc_->onMessage([this, unbound = std::move(unbound)](rtc::message_variant message) {
+        auto* binary = std::get_if<rtc::binary>(&message);
+        if (!binary) return;
+        const auto* data = reinterpret_cast<const uint8_t*>(binary->data());
+        TUTTI_TRACE_ARG("rtc.datagram", binary->size());
+        // Bound sessions go straight to their room: no lock, no lookup
+        if (deliver_datagram(data, binary->size())) return;
+        if (unbound) unbound(this, data, binary->size());
+    });
+}
+
 bool RtcSession::send_reliable(const std::string& message) {
     if (!connected_ || !control_dc_ || !control_dc_->isOpen()) return false;
     try {
@@ -125,16 +141,7 @@ void RtcTransportServer::handle_offer(const std::string& session_id,
     auto session = std::make_shared<RtcSession>(
         session_id, pc, audio_dc, control_dc);
 
-    audio_dc->onMessage([this, raw_session = session.get()](auto data) {
-        if (auto* binary = std::get_if<rtc::binary>(&data)) {
-            if (callbacks_.on_datagram) {
-                callbacks_.on_datagram(
-                    raw_session,
-                    reinterpret_cast<const uint8_t*>(binary->data()),
-                    binary->size());
-            }
-        }
-    });
+    session->receive_datagrams(callbacks_.on_datagram);
 
     control_dc->onMessage([this, raw_session = session.get()](auto data) {
         if (auto* text = std::get_if<std::string>(&data)) {
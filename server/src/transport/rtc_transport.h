@@ -3,6 +3,7 @@
 #include "transport_interface.h"
 
 #include <atomic>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -35,6 +36,12 @@ public:
     std::string id() const override;
     std::string remote_address() const override;
     bool is_connected() const override;
+    const char* transport_name() const override { return "webrtc"; }
+
+    /// Deliver the audio channel's datagrams to the bound room slot.
+    /// Datagrams arriving before the bind go to `unbound` (may be empty).
+    void receive_datagrams(
+        std::function<void(TransportSession*, const uint8_t*, size_t)> unbound);
 
 private:
     std::string session_id_;
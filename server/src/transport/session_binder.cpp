@@ -1,6 +1,8 @@
 #include "session_binder.h"
+#include "telemetry/trace.h"
 
 #include <iostream>
+#include <map>
 #include <nlohmann/json.hpp>
 
 namespace tutti {
@@ -62,6 +64,15 @@ void SessionBinder::on_message(TransportSession* session,
                         room->set_gain(it->second.participant_id, source_id, gain);
                     }
                 }
+            } else if (type == "pan") {
+                auto source_id = msg.value("participant_id", "");
+                float pan = msg.value("value", 0.0f);
+                if (!source_id.empty()) {
+                    auto room = room_manager_->get_room(it->second.room_name);
+                    if (room) {
+                        room->set_pan(it->second.participant_id, source_id, pan);
+                    }
+                }
             } else if (type == "mute") {
                 auto source_id = msg.value("participant_id", "");
                 bool muted = msg.value("muted", false);
@@ -95,6 +106,12 @@ void SessionBinder::on_message(TransportSession* session,
     std::string participant_id = msg.value("participant_id", "");
     std::string room_name = msg.value("room", "");
 
+    // Codec the client would like to receive; PCM unless this build has it
+    AudioCodec codec = parse_codec(msg.value("codec", "pcm"));
+    if (!codec_supported(codec)) codec = AudioCodec::Pcm;
+    // Channels it sends and receives: stereo is PCM only
+    uint8_t channels = msg.value("channels", 1) == 2 && codec == AudioCodec::Pcm ? 2 : 1;
+
     if (participant_id.empty() || room_name.empty()) {
         std::cerr << "[SessionBinder] Bind message missing fields from "
                   << sid << "\n";
@@ -126,7 +143,8 @@ void SessionBinder::on_message(TransportSession* session,
     }
 
     // Attach session to the participant in the room
-    if (!room->attach_session(participant_id, owned_session)) {
+    ParticipantSlot slot;
+    if (!room->attach_session(participant_id, owned_session, &slot, codec, channels)) {
         std::cerr << "[SessionBinder] Failed to attach session for participant "
                   << participant_id << " in room " << room_name << "\n";
         session->send_reliable(R"({"type":"error","error":"participant_not_found"})");
@@ -136,38 +154,34 @@ void SessionBinder::on_message(TransportSession* session,
         return;
     }
 
-    // Store binding
+    // Store binding, then route the session's datagrams straight to the room
     {
         std::lock_guard<std::mutex> lock(bindings_mutex_);
-        bindings_[sid] = {room_name, participant_id, owned_session};
+        bindings_[sid] = {room_name, participant_id, slot, owned_session};
     }
+    owned_session->bind_datagram_sink(room.get(), slot);
+    owned_session->send_reliable(
+        nlohmann::json{{"type", "bound"}, {"codec", codec_name(codec)},
+                       {"channels", channels}}.dump());
 
     std::cout << "[SessionBinder] Bound session " << sid
               << " → room=" << room_name
-              << " participant=" << participant_id << "\n";
+              << " participant=" << participant_id
+              << " slot=" << slot.index
+              << " codec=" << codec_name(codec)
+              << " channels=" << static_cast<int>(channels) << "\n";
 }
 
 void SessionBinder::on_datagram(TransportSession* session,
                                  const uint8_t* data, size_t len) {
-    std::string sid = session->id();
-
-    std::string room_name;
-    std::string participant_id;
-    {
-        std::lock_guard<std::mutex> lock(bindings_mutex_);
-        auto it = bindings_.find(sid);
-        if (it == bindings_.end()) return; // Not yet bound, drop datagram
-        room_name = it->second.room_name;
-        participant_id = it->second.participant_id;
-    }
-
-    auto room = room_manager_->get_room(room_name);
-    if (room) {
-        room->on_audio_received(participant_id, data, len);
-    }
+    TUTTI_TRACE_ARG("binder.on_datagram", len);
+    // Bound sessions carry their room and slot directly (set at bind time);
+    // unbound sessions drop datagrams
+    session->deliver_datagram(data, len);
 }
 
 void SessionBinder::on_session_close(TransportSession* session) {
+    session->unbind_datagram_sink();
     std::string sid = session->id();
 
     // Remove from pending if not yet bound
@@ -197,4 +211,28 @@ void SessionBinder::on_session_close(TransportSession* session) {
     }
 }
 
+std::vector<SessionBinder::SessionCounts> SessionBinder::session_counts() const {
+    std::map<std::string, SessionCounts> by_transport;
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        for (const auto& [sid, session] : pending_) {
+            by_transport[session->transport_name()].pending++;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(bindings_mutex_);
+        for (const auto& [sid, binding] : bindings_) {
+            by_transport[binding.session->transport_name()].bound++;
+        }
+    }
+
+    std::vector<SessionCounts> result;
+    result.reserve(by_transport.size());
+    for (auto& [name, counts] : by_transport) {
+        counts.transport = name;
+        result.push_back(std::move(counts));
+    }
+    return result;
+}
+
 } // namespace tutti
@@ -4,6 +4,7 @@
 #include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "transport_interface.h"
 #include "rooms/room_manager.h"
@@ -16,7 +17,7 @@ namespace tutti {
 /// 1. Waits for the first reliable message ("bind" message) from the client
 /// 2. Looks up the room and participant in RoomManager
 /// 3. Calls Room::attach_session() to wire the session
-/// 4. Routes subsequent datagrams to Room::on_audio_received
+/// 4. Binds the session's datagrams to Room::on_audio_received (lock-free)
 /// 5. Handles session close → Room::remove_participant
 class SessionBinder {
 public:
@@ -26,6 +27,17 @@ public:
     /// Pass the returned callbacks to any TransportServer.
     TransportCallbacks make_callbacks();
 
+    /// Open sessions for one transport family
+    struct SessionCounts {
+        std::string transport;   // TransportSession::transport_name()
+        size_t pending = 0;      // waiting for a bind message
+        size_t bound = 0;        // attached to a room
+    };
+
+    /// Per-transport session counts, sorted by transport name.
+    /// Takes the binder's own locks only, never a room's.
+    std::vector<SessionCounts> session_counts() const;
+
 private:
     /// Called when a new transport session opens (either WebTransport or WebRTC)
     void on_session_open(std::shared_ptr<TransportSession> session);
@@ -45,16 +57,17 @@ private:
     struct BoundSession {
         std::string room_name;
         std::string participant_id;
+        ParticipantSlot slot;                      // mixer slot (also bound on the session)
         std::shared_ptr<TransportSession> session; // prevent premature destruction
     };
 
     // session id → binding info
     std::unordered_map<std::string, BoundSession> bindings_;
-    std::mutex bindings_mutex_;
+    mutable std::mutex bindings_mutex_;
 
     // sessions awaiting a bind message (session id → shared_ptr)
     std::unordered_map<std::string, std::shared_ptr<TransportSession>> pending_;
-    std::mutex pending_mutex_;
+    mutable std::mutex pending_mutex_;
 };
 
 } // namespace tutti
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
@@ -18,26 +19,98 @@ static constexpr size_t kAudioPacketSize = kAudioHeaderSize + kAudioPayloadSize;
 static constexpr size_t kSamplesPerFrame = 128;
 // Sample rate
 static constexpr uint32_t kSampleRate = 48000;
+// Channels a session may send and receive: mono, or interleaved stereo
+static constexpr size_t kMaxChannels = 2;
+// Largest PCM datagram (stereo)
+static constexpr size_t kMaxAudioPacketSize = kAudioHeaderSize + kAudioPayloadSize * kMaxChannels;
+
+/// PCM datagram size for `channels` interleaved channels
+inline constexpr size_t pcm_packet_size(size_t channels) {
+    return kAudioHeaderSize + kAudioPayloadSize * channels;
+}
+
+/// Handle to a participant's slot in a room's mixer.
+/// Assigned at join time and carried by the Room, the SessionBinder binding
+/// and the datagram path so per-packet routing is an array index, not a
+/// string lookup. `generation` is the mixer's slot-table epoch when the
+/// participant was added; a stale handle (participant left, slot reused)
+/// no longer matches and is rejected.
+struct ParticipantSlot {
+    static constexpr uint32_t kInvalid = UINT32_MAX;
+
+    uint32_t index = kInvalid;
+    uint32_t generation = 0;
+
+    bool valid() const { return index != kInvalid; }
+};
 
-/// Represents a single audio datagram
+/// Represents a single audio datagram (stereo samples are interleaved L/R)
 struct AudioPacket {
     uint32_t sequence;
     uint32_t timestamp;
-    int16_t samples[kSamplesPerFrame];
+    int16_t samples[kSamplesPerFrame * kMaxChannels];
+    uint8_t channels = 1;
+
+    /// Bytes serialize() writes
+    size_t size() const { return pcm_packet_size(channels); }
 
     /// Serialize to wire format (little-endian)
     void serialize(uint8_t* buf) const;
 
-    /// Deserialize from wire format (little-endian)
+    /// Deserialize from wire format (little-endian). The length gives the
+    /// channel count: a stereo datagram is kMaxAudioPacketSize bytes.
     static AudioPacket deserialize(const uint8_t* buf, size_t len);
 };
 
+class TransportServer;
+class TransportSession;
+
+/// One datagram in a batched send (see TransportServer::send_datagrams)
+struct OutgoingDatagram {
+    TransportSession* session;
+    const uint8_t* data;
+    size_t len;
+};
+
+/// Receiver for a bound session's audio datagrams (implemented by Room).
+/// Called from transport receive threads; must not block.
+class DatagramSink {
+public:
+    virtual ~DatagramSink() = default;
+    virtual void on_audio_received(ParticipantSlot slot, const uint8_t* data, size_t len) = 0;
+};
+
 /// Abstract transport session for a single connected participant.
 /// Implemented by WebTransport (wt_transport) and WebRTC (rtc_transport).
 class TransportSession {
 public:
     virtual ~TransportSession() = default;
 
+    /// Route this session's datagrams straight to `sink` as `slot`.
+    /// Called by SessionBinder at bind time. `sink` must outlive the binding
+    /// (rooms live for the server's lifetime).
+    void bind_datagram_sink(DatagramSink* sink, ParticipantSlot slot) {
+        datagram_slot_.store(pack_slot(slot), std::memory_order_relaxed);
+        datagram_sink_.store(sink, std::memory_order_release);
+    }
+
+    /// Stop direct routing (session closed or participant left)
+    void unbind_datagram_sink() {
+        datagram_sink_.store(nullptr, std::memory_order_release);
+    }
+
+    /// Hand a received datagram to the bound sink: no locks, no lookups.
+    /// Returns false if the session is not bound.
+    bool deliver_datagram(const uint8_t* data, size_t len) {
+        DatagramSink* sink = datagram_sink_.load(std::memory_order_acquire);
+        if (!sink) return false;
+        uint64_t packed = datagram_slot_.load(std::memory_order_relaxed);
+        sink->on_audio_received({static_cast<uint32_t>(packed),
+                                 static_cast<uint32_t>(packed >> 32)},
+                                data, len);
+        return true;
+    }
+
     /// Send an unreliable audio datagram to this participant
     virtual bool send_datagram(const uint8_t* data, size_t len) = 0;
 
@@ -55,6 +128,21 @@ public:
 
     /// Check if session is still connected
     virtual bool is_connected() const = 0;
+
+    /// Transport family for metrics ("webtransport", "webrtc")
+    virtual const char* transport_name() const { return "unknown"; }
+
+    /// Server that can send this session's datagrams in batches
+    /// (TransportServer::send_datagrams), or nullptr to send one at a time
+    virtual TransportServer* transport_server() const { return nullptr; }
+
+private:
+    static uint64_t pack_slot(ParticipantSlot slot) {
+        return (static_cast<uint64_t>(slot.generation) << 32) | slot.index;
+    }
+
+    std::atomic<DatagramSink*> datagram_sink_{nullptr};
+    std::atomic<uint64_t> datagram_slot_{0};  // generation << 32 | index
 };
 
 /// Callbacks for transport events
@@ -85,6 +173,15 @@ public:
 
     /// Set callbacks for transport events
     virtual void set_callbacks(TransportCallbacks callbacks) = 0;
+
+    /// Send a batch of datagrams to this server's sessions in one go.
+    /// Every entry's session must report this server as transport_server().
+    /// The default sends them one at a time.
+    virtual void send_datagrams(const OutgoingDatagram* batch, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            batch[i].session->send_datagram(batch[i].data, batch[i].len);
+        }
+    }
 };
 
 } // namespace tutti
@@ -1,5 +1,7 @@
 #include "wt_transport.h"
+#include "telemetry/trace.h"
 
+#include <algorithm>
 #include <cstring>
 #include <iostream>
 #include <random>
@@ -14,7 +16,7 @@ void AudioPacket::serialize(uint8_t* buf) const {
     // Little-endian uint32 writes
     std::memcpy(buf, &sequence, sizeof(uint32_t));
     std::memcpy(buf + 4, &timestamp, sizeof(uint32_t));
-    std::memcpy(buf + kAudioHeaderSize, samples, kAudioPayloadSize);
+    std::memcpy(buf + kAudioHeaderSize, samples, kAudioPayloadSize * channels);
 }
 
 AudioPacket AudioPacket::deserialize(const uint8_t* buf, size_t len) {
@@ -25,7 +27,8 @@ AudioPacket AudioPacket::deserialize(const uint8_t* buf, size_t len) {
     }
     std::memcpy(&pkt.sequence, buf, sizeof(uint32_t));
     std::memcpy(&pkt.timestamp, buf + 4, sizeof(uint32_t));
-    std::memcpy(pkt.samples, buf + kAudioHeaderSize, kAudioPayloadSize);
+    pkt.channels = len >= kMaxAudioPacketSize ? kMaxChannels : 1;
+    std::memcpy(pkt.samples, buf + kAudioHeaderSize, kAudioPayloadSize * pkt.channels);
     return pkt;
 }
 
@@ -45,18 +48,19 @@ std::string generate_session_id() {
 // ── WtSession ───────────────────────────────────────────────────────────────
 
 WtSession::WtSession(const std::string& session_id,
-                     const std::string& remote_addr)
-    : session_id_(session_id), remote_addr_(remote_addr) {}
+                     const std::string& remote_addr,
+                     PacketPool* pool)
+    : session_id_(session_id), remote_addr_(remote_addr), pool_(pool) {}
 
 WtSession::~WtSession() { close(); }
 
 bool WtSession::send_datagram(const uint8_t* data, size_t len) {
     if (!connected_) return false;
 #ifdef TUTTI_WEBTRANSPORT
-    if (!wt_session_) return false;
+    if (!wt_session_ || !pool_) return false;
 
-    // Allocate buffer that libwtf will own — freed in DATAGRAM_SEND_STATE_CHANGE
-    auto* buf_data = static_cast<uint8_t*>(malloc(len));
+    // Pooled buffer that libwtf holds until DATAGRAM_SEND_STATE_CHANGE
+    uint8_t* buf_data = pool_->acquire(len);
     if (!buf_data) return false;
     std::memcpy(buf_data, data, len);
 
@@ -66,7 +70,7 @@ bool WtSession::send_datagram(const uint8_t* data, size_t len) {
 
     wtf_result_t result = wtf_session_send_datagram(wt_session_, &buffer, 1);
     if (result != WTF_SUCCESS) {
-        free(buf_data);
+        PacketPool::release(buf_data);
         return false;
     }
     return true;
@@ -80,29 +84,33 @@ bool WtSession::send_datagram(const uint8_t* data, size_t len) {
 bool WtSession::send_reliable(const std::string& message) {
     if (!connected_) return false;
 #ifdef TUTTI_WEBTRANSPORT
-    if (!control_stream_) return false;
+    if (!control_stream_ || !pool_) return false;
 
-    // Newline-delimited framing (matching client's WebTransport implementation)
-    std::string framed = message + "\n";
-
-    // Allocate both data AND buffer struct on the heap.
-    // wtf_stream_send() stores a direct pointer to the wtf_buffer_t (no copy),
-    // so the struct must outlive the call. Both are freed in SEND_COMPLETE.
-    auto* buf_data = static_cast<uint8_t*>(malloc(framed.size()));
+    // Newline-delimited framing (matching client's WebTransport implementation),
+    // written straight into a pooled buffer
+    size_t framed_len = message.size() + 1;
+    uint8_t* buf_data = pool_->acquire(framed_len);
     if (!buf_data) return false;
-    std::memcpy(buf_data, framed.data(), framed.size());
+    std::memcpy(buf_data, message.data(), message.size());
+    buf_data[message.size()] = '\n';
 
+    // wtf_stream_send() stores a direct pointer to the wtf_buffer_t (no copy),
+    // so the struct must outlive the call. libwtf free()s the struct itself
+    // after SEND_COMPLETE, so it can't live in a pool block: control messages
+    // (join/leave signalling, a handful per session) keep this one malloc,
+    // and only the payload goes back to the pool in SEND_COMPLETE. The audio
+    // path, send_datagram(), allocates nothing.
     auto* buffer = static_cast<wtf_buffer_t*>(malloc(sizeof(wtf_buffer_t)));
     if (!buffer) {
-        free(buf_data);
+        PacketPool::release(buf_data);
         return false;
     }
-    buffer->length = static_cast<uint32_t>(framed.size());
+    buffer->length = static_cast<uint32_t>(framed_len);
     buffer->data = buf_data;
 
     wtf_result_t result = wtf_stream_send(control_stream_, buffer, 1, false);
     if (result != WTF_SUCCESS) {
-        free(buf_data);
+        PacketPool::release(buf_data);
         free(buffer);
         return false;
     }
@@ -129,6 +137,14 @@ std::string WtSession::id() const { return session_id_; }
 std::string WtSession::remote_address() const { return remote_addr_; }
 bool WtSession::is_connected() const { return connected_; }
 
+TransportServer* WtSession::transport_server() const {
+#ifdef TUTTI_WEBTRANSPORT
+    return server_;
+#else
+    return nullptr;
+#endif
+}
+
 // ── WtTransportServer ───────────────────────────────────────────────────────
 
 WtTransportServer::WtTransportServer() = default;
@@ -144,18 +160,41 @@ void WtTransportServer::set_callbacks(TransportCallbacks callbacks) {
     callbacks_ = std::move(callbacks);
 }
 
+void WtTransportServer::send_datagrams(const OutgoingDatagram* batch, size_t count) {
 #ifdef TUTTI_WEBTRANSPORT
-
-std::shared_ptr<WtSession> WtTransportServer::find_session(wtf_session_t* wt_session) {
-    std::lock_guard<std::mutex> lock(sessions_mutex_);
-    for (auto& [id, session] : sessions_) {
-        if (session->wtf_session() == wt_session) {
-            return session;
+    constexpr size_t kChunk = 64;
+    uint8_t* bufs[kChunk];
+
+    for (size_t base = 0; base < count; base += kChunk) {
+        size_t n = std::min(kChunk, count - base);
+        const OutgoingDatagram* chunk = batch + base;
+
+        size_t max_len = 0;
+        for (size_t i = 0; i < n; ++i) max_len = std::max(max_len, chunk[i].len);
+        size_t got = send_pool_.acquire_bulk(max_len, bufs, n);
+
+        // One send call per datagram: MsQuic joins the buffers of a call
+        // into a single QUIC datagram
+        for (size_t i = 0; i < got; ++i) {
+            auto* session = static_cast<WtSession*>(chunk[i].session);
+            std::memcpy(bufs[i], chunk[i].data, chunk[i].len);
+            wtf_buffer_t buffer;
+            buffer.length = static_cast<uint32_t>(chunk[i].len);
+            buffer.data = bufs[i];
+
+            wtf_session_t* ws = session->is_connected() ? session->wtf_session() : nullptr;
+            if (!ws || wtf_session_send_datagram(ws, &buffer, 1) != WTF_SUCCESS) {
+                PacketPool::release(bufs[i]);
+            }
         }
     }
-    return nullptr;
+#else
+    TransportServer::send_datagrams(batch, count);
+#endif
 }
 
+#ifdef TUTTI_WEBTRANSPORT
+
 wtf_connection_decision_t WtTransportServer::on_connection(
     const wtf_connection_request_t* request, void* user_context) {
     (void)user_context;
@@ -166,91 +205,110 @@ wtf_connection_decision_t WtTransportServer::on_connection(
 }
 
 void WtTransportServer::on_session_event(const wtf_session_event_t* event) {
-    // Retrieve the WtTransportServer instance from session user_context.
-    // On CONNECTED, the user_context is the server (set via server config).
-    // After CONNECTED, we set the session context to the WtSession.
-    auto* server = static_cast<WtTransportServer*>(event->user_context);
-
-    switch (event->type) {
-        case WTF_SESSION_EVENT_CONNECTED: {
-            std::string sid = generate_session_id();
-            std::cout << "[WebTransport] Session connected: " << sid << "\n";
-
-            auto session = std::make_shared<WtSession>(sid, "");
-            session->set_wtf_session(event->session);
-
-            // Store session and set the session's user_context to the server
-            // so we can look up sessions in future callbacks
-            {
-                std::lock_guard<std::mutex> lock(server->sessions_mutex_);
-                server->sessions_[sid] = session;
+    // Return send buffers to the pool when the send is finalized. May arrive
+    // after DISCONNECTED, so this must not touch the session context.
+    if (event->type == WTF_SESSION_EVENT_DATAGRAM_SEND_STATE_CHANGE) {
+        if (WTF_DATAGRAM_SEND_STATE_IS_FINAL(
+                event->datagram_send_state_changed.state)) {
+            for (uint32_t i = 0;
+                 i < event->datagram_send_state_changed.buffer_count; i++) {
+                PacketPool::release(event->datagram_send_state_changed.buffers[i].data);
             }
-            wtf_session_set_context(event->session, server);
+        }
+        return;
+    }
 
-            if (server->callbacks_.on_session_open) {
-                server->callbacks_.on_session_open(session);
-            }
-            break;
+    if (event->type == WTF_SESSION_EVENT_CONNECTED) {
+        // On CONNECTED, the user_context is the server (set via server config).
+        auto* server = static_cast<WtTransportServer*>(event->user_context);
+        std::string sid = generate_session_id();
+        std::cout << "[WebTransport] Session connected: " << sid << "\n";
+
+        auto session = std::make_shared<WtSession>(sid, "", &server->send_pool_);
+        session->set_wtf_session(event->session);
+        session->set_server(server);
+
+        // From here on the session's context is the WtSession itself, so
+        // every later event (notably each datagram) reaches it without a lookup.
+        // The sessions_ map keeps it alive until DISCONNECTED.
+        {
+            std::lock_guard<std::mutex> lock(server->sessions_mutex_);
+            server->sessions_[sid] = session;
         }
+        wtf_session_set_context(event->session, session.get());
+
+        if (server->callbacks_.on_session_open) {
+            server->callbacks_.on_session_open(session);
+        }
+        return;
+    }
 
+    auto* session = static_cast<WtSession*>(event->user_context);
+    if (!session) return;
+    WtTransportServer* server = session->server();
+
+    switch (event->type) {
         case WTF_SESSION_EVENT_STREAM_OPENED: {
-            auto session = server->find_session(event->session);
-            if (!session) break;
+            wtf_stream_t* stream = event->stream_opened.stream;
+            wtf_stream_set_callback(stream, on_stream_event);
 
             wtf_stream_type_t stype = event->stream_opened.stream_type;
             if (stype == WTF_STREAM_BIDIRECTIONAL) {
                 // Client opened a bidirectional stream — use as control stream
-                session->set_control_stream(event->stream_opened.stream);
+                session->set_control_stream(stream);
+                wtf_stream_set_context(stream, session);
                 std::cout << "[WebTransport] Control stream opened for "
                           << session->id() << "\n";
+            } else {
+                // Other streams are ignored (send completions need no context)
+                wtf_stream_set_context(stream, nullptr);
             }
-
-            // Set stream callback and context to the server for dispatching
-            wtf_stream_set_callback(event->stream_opened.stream, on_stream_event);
-            wtf_stream_set_context(event->stream_opened.stream, server);
             break;
         }
 
         case WTF_SESSION_EVENT_DATAGRAM_RECEIVED: {
-            auto session = server->find_session(event->session);
-            if (!session) break;
-
+            TUTTI_TRACE_ARG("wt.datagram", event->datagram_received.length);
+            // Bound sessions go straight to their room: no lock, no lookup
+            if (session->deliver_datagram(event->datagram_received.data,
+                                          event->datagram_received.length)) {
+                break;
+            }
             if (server->callbacks_.on_datagram) {
                 server->callbacks_.on_datagram(
-                    session.get(),
+                    session,
                     event->datagram_received.data,
                     event->datagram_received.length);
             }
             break;
         }
 
-        case WTF_SESSION_EVENT_DATAGRAM_SEND_STATE_CHANGE: {
-            // Free send buffers when the send is finalized
-            if (WTF_DATAGRAM_SEND_STATE_IS_FINAL(
-                    event->datagram_send_state_changed.state)) {
-                for (uint32_t i = 0;
-                     i < event->datagram_send_state_changed.buffer_count; i++) {
-                    free(event->datagram_send_state_changed.buffers[i].data);
-                }
-            }
-            break;
-        }
-
         case WTF_SESSION_EVENT_DISCONNECTED: {
-            auto session = server->find_session(event->session);
-            if (!session) break;
-
             std::cout << "[WebTransport] Session disconnected: "
                       << session->id() << " (error: "
                       << event->disconnected.error_code << ")\n";
 
+            // Detach contexts first so late events can't reach a freed session
+            wtf_session_set_context(event->session, nullptr);
+            if (session->control_stream()) {
+                wtf_stream_set_context(session->control_stream(), nullptr);
+            }
+
+            // Hold a reference while the close callback runs
+            std::shared_ptr<WtSession> owned;
+            {
+                std::lock_guard<std::mutex> lock(server->sessions_mutex_);
+                auto it = server->sessions_.find(session->id());
+                if (it != server->sessions_.end()) owned = it->second;
+            }
+            if (!owned) break;
+
             if (server->callbacks_.on_session_close) {
-                server->callbacks_.on_session_close(session.get());
+                server->callbacks_.on_session_close(owned.get());
             }
 
             {
                 std::lock_guard<std::mutex> lock(server->sessions_mutex_);
-                server->sessions_.erase(session->id());
+                server->sessions_.erase(owned->id());
             }
             break;
         }
@@ -264,11 +322,14 @@ void WtTransportServer::on_session_event(const wtf_session_event_t* event) {
 }
 
 void WtTransportServer::on_stream_event(const wtf_stream_event_t* event) {
-    auto* server = static_cast<WtTransportServer*>(event->user_context);
-    if (!server) return;
-
     switch (event->type) {
         case WTF_STREAM_EVENT_DATA_RECEIVED: {
+            // Only the control stream carries a context (its WtSession)
+            auto* session = static_cast<WtSession*>(event->user_context);
+            if (!session) break;
+            WtTransportServer* server = session->server();
+            if (!server->callbacks_.on_message) break;
+
             // Reconstruct the message from buffers
             std::string data;
             for (uint32_t i = 0; i < event->data_received.buffer_count; i++) {
@@ -278,40 +339,23 @@ void WtTransportServer::on_stream_event(const wtf_stream_event_t* event) {
                     event->data_received.buffers[i].length);
             }
 
-            // Find which session owns this stream
-            // The stream is the control stream for one of our sessions
-            std::shared_ptr<WtSession> session;
-            {
-                std::lock_guard<std::mutex> lock(server->sessions_mutex_);
-                for (auto& [id, s] : server->sessions_) {
-                    if (s->control_stream() == event->stream) {
-                        session = s;
-                        break;
-                    }
-                }
-            }
-
-            if (session && server->callbacks_.on_message) {
-                // Split on newlines (our message delimiter)
-                // Buffer partial messages per-session if needed
-                std::istringstream iss(data);
-                std::string line;
-                while (std::getline(iss, line)) {
-                    if (!line.empty()) {
-                        server->callbacks_.on_message(session.get(), line);
-                    }
+            // Split on newlines (our message delimiter)
+            // Buffer partial messages per-session if needed
+            std::istringstream iss(data);
+            std::string line;
+            while (std::getline(iss, line)) {
+                if (!line.empty()) {
+                    server->callbacks_.on_message(session, line);
                 }
             }
             break;
         }
 
         case WTF_STREAM_EVENT_SEND_COMPLETE: {
-            // Free the data payloads we malloc'd in send_reliable().
+            // Return the payloads acquired in send_reliable() to the pool.
             // Do NOT free the wtf_buffer_t struct — libwtf frees it internally.
             for (uint32_t i = 0; i < event->send_complete.buffer_count; i++) {
-                if (event->send_complete.buffers[i].data) {
-                    free(event->send_complete.buffers[i].data);
-                }
+                PacketPool::release(event->send_complete.buffers[i].data);
             }
             break;
         }
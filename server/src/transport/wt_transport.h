@@ -1,5 +1,6 @@
 #pragma once
 
+#include "packet_pool.h"
 #include "transport_interface.h"
 
 #include <atomic>
@@ -14,6 +15,8 @@
 
 namespace tutti {
 
+class WtTransportServer;
+
 /// WebTransport session.
 /// Provides unreliable datagrams for audio and bidirectional streams for control.
 ///
@@ -21,8 +24,10 @@ namespace tutti {
 /// Otherwise, acts as a stub (WebTransport disabled at build time).
 class WtSession : public TransportSession {
 public:
-    explicit WtSession(const std::string& session_id,
-                       const std::string& remote_addr);
+    /// `pool` supplies send buffers and must outlive the session's in-flight sends
+    WtSession(const std::string& session_id,
+              const std::string& remote_addr,
+              PacketPool* pool = nullptr);
     ~WtSession() override;
 
     bool send_datagram(const uint8_t* data, size_t len) override;
@@ -31,21 +36,27 @@ public:
     std::string id() const override;
     std::string remote_address() const override;
     bool is_connected() const override;
+    const char* transport_name() const override { return "webtransport"; }
+    TransportServer* transport_server() const override;
 
 #ifdef TUTTI_WEBTRANSPORT
     void set_wtf_session(wtf_session_t* s) { wt_session_ = s; }
     wtf_session_t* wtf_session() const { return wt_session_; }
     void set_control_stream(wtf_stream_t* s) { control_stream_ = s; }
     wtf_stream_t* control_stream() const { return control_stream_; }
+    void set_server(WtTransportServer* server) { server_ = server; }
+    WtTransportServer* server() const { return server_; }
 #endif
 
 private:
     std::string session_id_;
     std::string remote_addr_;
     std::atomic<bool> connected_{true};
+    PacketPool* pool_;
 #ifdef TUTTI_WEBTRANSPORT
     wtf_session_t* wt_session_ = nullptr;
     wtf_stream_t* control_stream_ = nullptr;
+    WtTransportServer* server_ = nullptr;
 #endif
 };
 
@@ -61,15 +72,22 @@ public:
     void stop() override;
     void set_callbacks(TransportCallbacks callbacks) override;
 
+    /// Batched datagram send: pool buffers are acquired in bulk, then each
+    /// datagram goes out in its own send (a multi-buffer send would be
+    /// joined into one QUIC datagram)
+    void send_datagrams(const OutgoingDatagram* batch, size_t count) override;
+
     /// Set TLS certificate files (required for WebTransport)
     void set_cert_files(const std::string& cert_file, const std::string& key_file);
 
-#ifdef TUTTI_WEBTRANSPORT
-    /// Look up a WtSession by its libwtf session pointer
-    std::shared_ptr<WtSession> find_session(wtf_session_t* wt_session);
-#endif
+    /// Send buffer pool usage (shared by all WebTransport sessions)
+    PacketPool::Stats send_pool_stats() const { return send_pool_.stats(); }
 
 private:
+    // Send buffers for every session's datagrams and control messages.
+    // Declared first so it is destroyed after everything that can hold them.
+    PacketPool send_pool_;
+
     TransportCallbacks callbacks_;
     std::atomic<bool> running_{false};
     std::mutex sessions_mutex_;
@@ -81,7 +99,8 @@ private:
     wtf_context_t* ctx_ = nullptr;
     wtf_server_t* server_ = nullptr;
 
-    // libwtf callbacks (static, dispatch through user_context → this)
+    // libwtf callbacks (static). The server config's user_context is this
+    // server; each libwtf session's and control stream's context is its WtSession.
     static wtf_connection_decision_t on_connection(
         const wtf_connection_request_t* request, void* user_context);
     static void on_session_event(const wtf_session_event_t* event);
@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "transport/datagram_batch.h"
+
+namespace tutti {
+namespace {
+
+/// Server that records batched sends
+class RecordingServer : public TransportServer {
+public:
+    bool listen(const std::string&, uint16_t) override { return true; }
+    void stop() override {}
+    void set_callbacks(TransportCallbacks) override {}
+    void send_datagrams(const OutgoingDatagram* batch, size_t count) override {
+        batch_sizes.push_back(count);
+        for (size_t i = 0; i < count; ++i) first_bytes.push_back(batch[i].data[0]);
+    }
+
+    std::vector<size_t> batch_sizes;
+    std::vector<uint8_t> first_bytes;
+};
+
+class FakeSession : public TransportSession {
+public:
+    explicit FakeSession(TransportServer* server) : server_(server) {}
+    bool send_datagram(const uint8_t*, size_t) override {
+        direct_sends++;
+        return true;
+    }
+    bool send_reliable(const std::string&) override { return true; }
+    void close() override {}
+    std::string id() const override { return "fake"; }
+    std::string remote_address() const override { return "test"; }
+    bool is_connected() const override { return true; }
+    TransportServer* transport_server() const override { return server_; }
+
+    int direct_sends = 0;
+
+private:
+    TransportServer* server_;
+};
+
+TEST(DatagramBatchTest, GroupsByServerInOrder) {
+    RecordingServer server;
+    auto a = std::make_shared<FakeSession>(&server);
+    auto b = std::make_shared<FakeSession>(&server);
+    auto plain = std::make_shared<FakeSession>(nullptr);
+
+    DatagramBatch batch(8);
+    batch.append(a.get(), kAudioPacketSize)[0] = 1;
+    batch.append(plain.get(), kAudioPacketSize)[0] = 2;
+    batch.append(b.get(), kAudioPacketSize)[0] = 3;
+    EXPECT_EQ(batch.size(), 3u);
+
+    batch.flush();
+    EXPECT_TRUE(batch.empty());
+    ASSERT_EQ(server.batch_sizes, (std::vector<size_t>{2}));
+    EXPECT_EQ(server.first_bytes, (std::vector<uint8_t>{1, 3}));
+    EXPECT_EQ(plain->direct_sends, 1);
+    EXPECT_EQ(a->direct_sends + b->direct_sends, 0);
+}
+
+TEST(DatagramBatchTest, FlushesWhenFull) {
+    RecordingServer server;
+    auto a = std::make_shared<FakeSession>(&server);
+
+    DatagramBatch batch(2);
+    for (int i = 0; i < 5; ++i) batch.append(a.get(), kAudioPacketSize)[0] = static_cast<uint8_t>(i);
+    batch.flush();
+
+    EXPECT_EQ(server.batch_sizes, (std::vector<size_t>{2, 2, 1}));
+    EXPECT_EQ(server.first_bytes, (std::vector<uint8_t>{0, 1, 2, 3, 4}));
+}
+
+TEST(DatagramBatchTest, ReleasesHoldsOnceSent) {
+    RecordingServer server;
+    FakeSession a(&server);
+    std::atomic<uint32_t> readers{2};
+
+    DatagramBatch batch(2);
+    batch.append(&a, kAudioPacketSize);
+    batch.hold(&readers);
+    EXPECT_EQ(readers, 2u);
+
+    // A full batch flushes, releasing holds taken for what it sent
+    batch.append(&a, kAudioPacketSize);
+    batch.append(&a, kAudioPacketSize);
+    EXPECT_EQ(readers, 1u);
+    batch.hold(&readers);
+    batch.flush();
+    EXPECT_EQ(readers, 0u);
+    EXPECT_EQ(server.batch_sizes, (std::vector<size_t>{2, 1}));
+
+    // Holds with nothing left to send are released too
+    readers = 1;
+    batch.hold(&readers);
+    batch.flush();
+    EXPECT_EQ(readers, 0u);
+}
+
+} // namespace
+} // namespace tutti
@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "signaling/http_parser.h"
+
+namespace tutti {
+namespace {
+
+TEST(HttpParserTest, ParsesRequestWithBody) {
+    std::string data =
+        "POST /api/rooms/Allegro/join HTTP/1.1\r\n"
+        "Host: localhost\r\n"
+        "content-length: 17\r\n"
+        "\r\n"
+        R"({"alias":"alice"})";
+    HttpRequestView req;
+    ASSERT_EQ(parse_http_request(data, req), HttpParseStatus::Complete);
+    EXPECT_EQ(req.method, "POST");
+    EXPECT_EQ(req.path, "/api/rooms/Allegro/join");
+    EXPECT_EQ(req.body, R"({"alias":"alice"})");
+    EXPECT_TRUE(req.keep_alive);
+    EXPECT_EQ(req.size, data.size());
+    // Views point into the input, not copies
+    EXPECT_EQ(req.body.data(), data.data() + data.size() - req.body.size());
+}
+
+TEST(HttpParserTest, IncompleteUntilHeadersAndBodyArrive) {
+    std::string data = "POST /api/rooms/Allegro/leave HTTP/1.1\r\nContent-Length: 4\r\n";
+    HttpRequestView req;
+    EXPECT_EQ(parse_http_request(data, req), HttpParseStatus::Incomplete);
+    data += "\r\n{}";
+    EXPECT_EQ(parse_http_request(data, req), HttpParseStatus::Incomplete);
+    data += "{}";
+    EXPECT_EQ(parse_http_request(data, req), HttpParseStatus::Complete);
+    EXPECT_EQ(req.body, "{}{}");
+}
+
+TEST(HttpParserTest, PipelinedRequestsParseOneAtATime) {
+    std::string data =
+        "GET /api/rooms HTTP/1.1\r\n\r\n"
+        "GET /api/health?probe=1 HTTP/1.1\r\nConnection: close\r\n\r\n";
+    HttpRequestView first, second;
+    ASSERT_EQ(parse_http_request(data, first), HttpParseStatus::Complete);
+    EXPECT_EQ(first.path, "/api/rooms");
+    ASSERT_EQ(parse_http_request(std::string_view(data).substr(first.size), second),
+              HttpParseStatus::Complete);
+    EXPECT_EQ(second.path, "/api/health");  // query string dropped
+    EXPECT_FALSE(second.keep_alive);
+    EXPECT_EQ(first.size + second.size, data.size());
+}
+
+TEST(HttpParserTest, ConnectionSemantics) {
+    HttpRequestView req;
+    ASSERT_EQ(parse_http_request("GET / HTTP/1.0\r\n\r\n", req), HttpParseStatus::Complete);
+    EXPECT_FALSE(req.keep_alive);
+    ASSERT_EQ(parse_http_request("GET / HTTP/1.0\r\nConnection: Keep-Alive\r\n\r\n", req),
+              HttpParseStatus::Complete);
+    EXPECT_TRUE(req.keep_alive);
+    ASSERT_EQ(parse_http_request("GET / HTTP/1.1\r\nConnection: upgrade, CLOSE\r\n\r\n", req),
+              HttpParseStatus::Complete);
+    EXPECT_FALSE(req.keep_alive);
+}
+
+TEST(HttpParserTest, RejectsMalformedRequests) {
+    HttpRequestView req;
+    EXPECT_EQ(parse_http_request("GARBAGE\r\n\r\n", req), HttpParseStatus::Invalid);
+    EXPECT_EQ(parse_http_request("GET / SPDY/3\r\n\r\n", req), HttpParseStatus::Invalid);
+    EXPECT_EQ(parse_http_request("GET / HTTP/1.1\r\nNoColon\r\n\r\n", req),
+              HttpParseStatus::Invalid);
+    EXPECT_EQ(parse_http_request("POST / HTTP/1.1\r\nContent-Length: 12x\r\n\r\n", req),
+              HttpParseStatus::Invalid);
+    EXPECT_EQ(parse_http_request("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n", req),
+              HttpParseStatus::Invalid);
+}
+
+TEST(HttpParserTest, EnforcesSizeLimits) {
+    HttpRequestView req;
+    std::string huge_header = "GET / HTTP/1.1\r\nX-Pad: " + std::string(kMaxHeaderBytes, 'a');
+    EXPECT_EQ(parse_http_request(huge_header, req), HttpParseStatus::TooLarge);
+    std::string huge_body = "POST / HTTP/1.1\r\nContent-Length: " +
+                            std::to_string(kMaxBodyBytes + 1) + "\r\n\r\n";
+    EXPECT_EQ(parse_http_request(huge_body, req), HttpParseStatus::TooLarge);
+}
+
+} // namespace
+} // namespace tutti
@@ -0,0 +1,361 @@
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include <nlohmann/json.hpp>
+
+#include "rooms/room_directory.h"
+#include "rooms/room_manager.h"
+#include "rooms/room_names.h"
+#include "signaling/http_server.h"
+#include "telemetry/trace.h"
+
+namespace tutti {
+namespace {
+
+/// Raw client socket, so tests control keep-alive and pipelining
+class TestClient {
+public:
+    explicit TestClient(uint16_t port) {
+        fd_ = socket(AF_INET, SOCK_STREAM, 0);
+        timeval tv{2, 0};
+        setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+        connected_ = connect(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+    }
+    ~TestClient() { close(fd_); }
+
+    bool connected() const { return connected_; }
+
+    void send_raw(const std::string& data) {
+        ASSERT_EQ(send(fd_, data.data(), data.size(), MSG_NOSIGNAL),
+                  static_cast<ssize_t>(data.size()));
+    }
+
+    /// Read one response; false on timeout or EOF first
+    bool read_response(std::string& headers, std::string& body) {
+        while (true) {
+            auto end = buffer_.find("\r\n\r\n");
+            if (end != std::string::npos) {
+                auto cl = buffer_.find("Content-Length: ");
+                size_t length = std::stoul(buffer_.substr(cl + 16));
+                if (buffer_.size() >= end + 4 + length) {
+                    headers = buffer_.substr(0, end);
+                    body = buffer_.substr(end + 4, length);
+                    buffer_.erase(0, end + 4 + length);
+                    return true;
+                }
+            }
+            char buf[4096];
+            ssize_t n = recv(fd_, buf, sizeof(buf), 0);
+            if (n <= 0) return false;
+            buffer_.append(buf, static_cast<size_t>(n));
+        }
+    }
+
+    /// Read until `marker` has arrived; returns everything up to and
+    /// including it. False on timeout or EOF first.
+    bool read_until(const std::string& marker, std::string& out) {
+        while (true) {
+            auto pos = buffer_.find(marker);
+            if (pos != std::string::npos) {
+                out = buffer_.substr(0, pos + marker.size());
+                buffer_.erase(0, pos + marker.size());
+                return true;
+            }
+            char buf[4096];
+            ssize_t n = recv(fd_, buf, sizeof(buf), 0);
+            if (n <= 0) return false;
+            buffer_.append(buf, static_cast<size_t>(n));
+        }
+    }
+
+    /// True once the server has closed its end
+    bool closed_by_server() {
+        char c;
+        return recv(fd_, &c, 1, 0) == 0;
+    }
+
+private:
+    int fd_ = -1;
+    bool connected_ = false;
+    std::string buffer_;
+};
+
+std::string get(const std::string& path, const std::string& extra = "") {
+    return "GET " + path + " HTTP/1.1\r\nHost: test\r\n" + extra + "\r\n";
+}
+
+std::string post(const std::string& path, const std::string& body) {
+    return "POST " + path + " HTTP/1.1\r\nHost: test\r\nContent-Length: " +
+           std::to_string(body.size()) + "\r\n\r\n" + body;
+}
+
+class HttpServerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        manager_ = std::make_shared<RoomManager>(4);
+        manager_->initialize_default_rooms();
+        server_ = std::make_unique<HttpServer>(manager_);
+        ASSERT_TRUE(server_->listen("127.0.0.1", 0));
+        ASSERT_NE(server_->port(), 0);
+    }
+
+    void TearDown() override {
+        server_->stop();
+        manager_->stop_mixers();
+    }
+
+    size_t occupancy(const std::string& body, const std::string& room) {
+        auto listing = nlohmann::json::parse(body);
+        for (const auto& r : listing["rooms"]) {
+            if (r["name"] == room) return r["participant_count"];
+        }
+        return SIZE_MAX;
+    }
+
+    std::shared_ptr<RoomManager> manager_;
+    std::unique_ptr<HttpServer> server_;
+};
+
+TEST_F(HttpServerTest, KeepAliveServesManyRequestsOnOneConnection) {
+    TestClient client(server_->port());
+    ASSERT_TRUE(client.connected());
+    std::string headers, body;
+    for (int i = 0; i < 5; ++i) {
+        client.send_raw(get("/api/health"));
+        ASSERT_TRUE(client.read_response(headers, body));
+        EXPECT_NE(headers.find("HTTP/1.1 200 OK"), std::string::npos);
+        EXPECT_NE(headers.find("Connection: keep-alive"), std::string::npos);
+        EXPECT_EQ(body, R"({"status":"ok"})");
+    }
+}
+
+TEST_F(HttpServerTest, PipelinedRequestsAnsweredInOrder) {
+    TestClient client(server_->port());
+    client.send_raw(get("/api/health") + get("/api/rooms") + get("/nope"));
+    std::string headers, body;
+    ASSERT_TRUE(client.read_response(headers, body));
+    EXPECT_EQ(body, R"({"status":"ok"})");
+    ASSERT_TRUE(client.read_response(headers, body));
+    EXPECT_NE(body.find("\"rooms\""), std::string::npos);
+    ASSERT_TRUE(client.read_response(headers, body));
+    EXPECT_NE(headers.find("HTTP/1.1 404 Not Found"), std::string::npos);
+}
+
+TEST_F(HttpServerTest, HonoursConnectionClose) {
+    TestClient client(server_->port());
+    client.send_raw(get("/api/health", "Connection: close\r\n"));
+    std::string headers, body;
+    ASSERT_TRUE(client.read_response(headers, body));
+    EXPECT_NE(headers.find("Connection: close"), std::string::npos);
+    EXPECT_TRUE(client.closed_by_server());
+}
+
+TEST_F(HttpServerTest, SlowClientDoesNotBlockOthers) {
+    TestClient slow(server_->port());
+    slow.send_raw("POST /api/rooms/" + std::string(kDefaultRooms[0].name) +
+                  "/join HTTP/1.1\r\nContent-Length: 100\r\n\r\n{");
+
+    TestClient fast(server_->port());
+    auto start = std::chrono::steady_clock::now();
+    fast.send_raw(get("/api/health"));
+    std::string headers, body;
+    ASSERT_TRUE(fast.read_response(headers, body));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(500));
+}
+
+TEST_F(HttpServerTest, MalformedRequestGets400AndClose) {
+    TestClient client(server_->port());
+    client.send_raw("NONSENSE\r\n\r\n");
+    std::string headers, body;
+    ASSERT_TRUE(client.read_response(headers, body));
+    EXPECT_NE(headers.find("HTTP/1.1 400"), std::string::npos);
+    EXPECT_TRUE(client.closed_by_server());
+}
+
+TEST_F(HttpServerTest, RoomListCacheFollowsMembership) {
+    const std::string room = kDefaultRooms[0].name;
+    TestClient client(server_->port());
+    std::string headers, body;
+
+    client.send_raw(get("/api/rooms"));
+    ASSERT_TRUE(client.read_response(headers, body));
+    EXPECT_EQ(occupancy(body, room), 0u);
+    client.send_raw(get("/api/rooms"));  // served from the cache
+    ASSERT_TRUE(client.read_response(headers, body));
+    EXPECT_EQ(occupancy(body, room), 0u);
+
+    client.send_raw(post("/api/rooms/" + room + "/join", R"({"alias":"alice"})"));
+    ASSERT_TRUE(client.read_response(headers, body));
+    std::string participant = nlohmann::json::parse(body)["participant_id"];
+    client.send_raw(get("/api/rooms"));
+    ASSERT_TRUE(client.read_response(headers, body));
+    EXPECT_EQ(occupancy(body, room), 1u);
+
+    // Changes made outside the HTTP API invalidate it too (e.g. the reaper)
+    manager_->leave_room(room, participant);
+    client.send_raw(get("/api/rooms"));
+    ASSERT_TRUE(client.read_response(headers, body));
+    EXPECT_EQ(occupancy(body, room), 0u);
+}
+
+TEST_F(HttpServerTest, ListenOnlyJoinsAFullRoom) {
+    const std::string room = kDefaultRooms[2].name;
+    std::string participant;
+    for (const char* alias : {"a", "b", "c", "d"}) {
+        ASSERT_EQ(manager_->join_room(room, alias, "", nullptr, participant),
+                  RoomManager::JoinResult::Success);
+    }
+
+    TestClient client(server_->port());
+    std::string headers, body;
+    client.send_raw(post("/api/rooms/" + room + "/join", R"({"alias":"eve"})"));
+    ASSERT_TRUE(client.read_response(headers, body));
+    EXPECT_NE(headers.find("HTTP/1.1 409"), std::string::npos);
+
+    client.send_raw(post("/api/rooms/" + room + "/join", R"({"alias":"eve","listen_only":true})"));
+    ASSERT_TRUE(client.read_response(headers, body));
+    EXPECT_NE(headers.find("HTTP/1.1 200"), std::string::npos);
+    client.send_raw(get("/api/rooms"));
+    ASSERT_TRUE(client.read_response(headers, body));
+    EXPECT_EQ(occupancy(body, room), 4u);  // performers only
+}
+
+TEST_F(HttpServerTest, RecordingIsForParticipantsOnAServerThatAllowsIt) {
+    const std::string room = kDefaultRooms[3].name;
+    std::string participant;
+    ASSERT_EQ(manager_->join_room(room, "a", "", nullptr, participant),
+              RoomManager::JoinResult::Success);
+
+    TestClient client(server_->port());
+    std::string headers, body;
+    client.send_raw(post("/api/rooms/" + room + "/recording", R"({"participant_id":"nobody"})"));
+    ASSERT_TRUE(client.read_response(headers, body));
+    EXPECT_NE(headers.find("HTTP/1.1 403"), std::string::npos);
+    EXPECT_NE(body.find("not_participant"), std::string::npos);
+
+    // No --recording-dir
+    client.send_raw(post("/api/rooms/" + room + "/recording",
+                         R"({"participant_id":")" + participant + R"("})"));
+    ASSERT_TRUE(client.read_response(headers, body));
+    EXPECT_NE(body.find("recording_disabled"), std::string::npos);
+    EXPECT_FALSE(manager_->get_room(room)->recording());
+}
+
+TEST_F(HttpServerTest, NodeReportsNeedTheClusterSecret) {
+    NodeReport report;
+    report.node.id = "intruder";
+    report.node.api_url = "http://198.51.100.1:8080";
+
+    for (const std::string secret : {"", "s3cret"}) {
+        auto directory = std::make_shared<RoomDirectory>();
+        HttpServer server(manager_);
+        server.set_directory(directory, "self", secret);
+        ASSERT_TRUE(server.listen("127.0.0.1", 0));
+        TestClient client(server.port());
+        std::string headers, body;
+
+        for (const char* attempt : {"", "s3cre", "s3creT", "s3cret!"}) {
+            client.send_raw(post("/api/nodes/heartbeat", serialize_report(report, attempt)));
+            ASSERT_TRUE(client.read_response(headers, body));
+            EXPECT_NE(headers.find("HTTP/1.1 403"), std::string::npos) << attempt;
+        }
+        client.send_raw(post("/api/nodes/self/drain", R"({"draining":true})"));
+        ASSERT_TRUE(client.read_response(headers, body));
+        EXPECT_NE(headers.find("HTTP/1.1 403"), std::string::npos);
+        EXPECT_TRUE(directory->nodes().empty());
+
+        // A directory without a secret takes no reports at all
+        client.send_raw(post("/api/nodes/heartbeat", serialize_report(report, "s3cret")));
+        ASSERT_TRUE(client.read_response(headers, body));
+        EXPECT_NE(headers.find(secret.empty() ? "HTTP/1.1 403" : "HTTP/1.1 200"), std::string::npos);
+        EXPECT_EQ(directory->nodes().size(), secret.empty() ? 0u : 1u);
+        server.stop();
+    }
+}
+
+TEST_F(HttpServerTest, MetricsExportTheSendPool) {
+    TestClient client(server_->port());
+    std::string headers, body;
+    client.send_raw(get("/metrics"));
+    ASSERT_TRUE(client.read_response(headers, body));
+    EXPECT_EQ(body.find("tutti_send_pool"), std::string::npos);  // no source set
+
+    PacketPool pool(4, 64);
+    uint8_t* held = pool.acquire(16);
+    PacketPool::release(pool.acquire(128));  // oversized: from the heap
+    server_->set_send_pool_stats([&pool] { return pool.stats(); });
+    client.send_raw(get("/metrics"));
+    ASSERT_TRUE(client.read_response(headers, body));
+    EXPECT_NE(body.find("\ntutti_send_pool_buffers 4\n"), std::string::npos);
+    EXPECT_NE(body.find("\ntutti_send_pool_in_use_buffers 1\n"), std::string::npos);
+    EXPECT_NE(body.find("\ntutti_send_pool_heap_fallbacks_total{reason=\"exhausted\"} 0\n"),
+              std::string::npos);
+    EXPECT_NE(body.find("\ntutti_send_pool_heap_fallbacks_total{reason=\"oversized\"} 1\n"),
+              std::string::npos);
+    server_->set_send_pool_stats(nullptr);
+    PacketPool::release(held);
+}
+
+TEST_F(HttpServerTest, TraceIsServedByTracingBuildsOnly) {
+    TestClient client(server_->port());
+    std::string headers, body;
+    // Not under /api/*, which the public proxy forwards
+    client.send_raw(get("/api/trace"));
+    ASSERT_TRUE(client.read_response(headers, body));
+    EXPECT_EQ(body, R"({"error":"not_found"})");
+
+    client.send_raw(get("/debug/trace"));
+    ASSERT_TRUE(client.read_response(headers, body));
+    if (!trace::kEnabled) {
+        EXPECT_NE(headers.find("HTTP/1.1 404"), std::string::npos);
+        EXPECT_EQ(body, R"({"error":"tracing_disabled"})");
+        return;
+    }
+    EXPECT_NE(headers.find("HTTP/1.1 200 OK"), std::string::npos);
+    EXPECT_TRUE(nlohmann::json::parse(body)["traceEvents"].is_array());
+}
+
+TEST_F(HttpServerTest, LobbyEventsStreamSnapshotThenDeltas) {
+    const std::string room = kDefaultRooms[1].name;
+    TestClient watcher(server_->port());
+    watcher.send_raw(get("/api/rooms/events"));
+
+    std::string headers, event;
+    ASSERT_TRUE(watcher.read_until("\r\n\r\n", headers));
+    EXPECT_NE(headers.find("Content-Type: text/event-stream"), std::string::npos);
+    ASSERT_TRUE(watcher.read_until("\n\n", event));
+    EXPECT_NE(event.find("event: snapshot"), std::string::npos);
+    EXPECT_NE(event.find(kDefaultRooms[15].name), std::string::npos);  // every room
+
+    // A join elsewhere is pushed as a one-room update
+    std::string participant;
+    ASSERT_EQ(manager_->join_room(room, "bob", "", nullptr, participant),
+              RoomManager::JoinResult::Success);
+    ASSERT_TRUE(watcher.read_until("\n\n", event));
+    EXPECT_NE(event.find("event: update"), std::string::npos);
+    auto data = nlohmann::json::parse(event.substr(event.find("data: ") + 6));
+    ASSERT_EQ(data["rooms"].size(), 1u);
+    EXPECT_EQ(data["rooms"][0]["name"], room);
+    EXPECT_EQ(data["rooms"][0]["participant_count"], 1);
+
+    // Other requests keep working alongside the stream
+    TestClient client(server_->port());
+    client.send_raw(get("/api/health"));
+    ASSERT_TRUE(client.read_response(headers, event));
+}
+
+} // namespace
+} // namespace tutti
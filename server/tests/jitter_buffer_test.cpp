@@ -0,0 +1,301 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#include "audio/jitter_buffer.h"
+
+namespace tutti {
+namespace {
+
+constexpr int64_t kFrameNs = 1000000000LL * kSamplesPerFrame / kSampleRate;
+
+AudioFrame make_frame(uint32_t seq, int16_t value) {
+    AudioFrame frame;
+    frame.sequence = seq;
+    frame.timestamp = seq * kSamplesPerFrame;
+    frame.samples.fill(value);
+    return frame;
+}
+
+/// Push `seq` as if it arrived exactly on its quantum (zero jitter)
+bool push_on_time(JitterBuffer& jb, uint32_t seq, int16_t value) {
+    return jb.push(make_frame(seq, value), static_cast<int64_t>(seq) * kFrameNs);
+}
+
+/// What a DriftRun's consumer saw
+struct DriftResult {
+    JitterStats stats;
+    uint64_t concealed_late = 0;  // concealed in the second half
+    uint32_t max_depth = 0;
+    uint64_t breaks = 0;          // output ramp steps outside 0..2
+};
+
+/// Play `seconds` of a sender whose clock is off ours by `ratio` (1.001 is
+/// 1000ppm fast), arriving `lead` frames before the cycle that plays them,
+/// give or take up to `jitter_ns`. The sender's samples are a ramp, so a
+/// slip, insert or stretch shows up as a step of 2 or 0 and anything
+/// else (a trim, a concealment) as a break, away from where it wraps.
+DriftResult drift_run(double ratio, double seconds, double lead = 0.5, int64_t jitter_ns = 0) {
+    JitterBuffer jb;
+    DriftResult r;
+    const auto cycles = static_cast<uint32_t>(seconds * kSampleRate / kSamplesPerFrame);
+    const double period_ns = kFrameNs / ratio;
+    std::srand(1);
+    uint32_t seq = 0;
+    int16_t last = -1;
+    for (uint32_t cycle = 0; cycle < cycles; ++cycle) {
+        const double now = static_cast<double>(cycle) * kFrameNs;
+        for (;;) {
+            double arrival = seq * period_ns - lead * kFrameNs;
+            if (jitter_ns > 0) arrival += std::rand() % (2 * jitter_ns) - jitter_ns;
+            if (arrival > now) break;
+            AudioFrame frame = make_frame(seq, 0);
+            for (size_t i = 0; i < kSamplesPerFrame; ++i) {
+                frame.samples[i] = static_cast<int16_t>((seq * kSamplesPerFrame + i) % 8192);
+            }
+            jb.push(frame, static_cast<int64_t>(arrival));
+            ++seq;
+        }
+
+        const AudioFrame* out;
+        JitterBuffer::PopResult result = jb.front(out);
+        r.max_depth = std::max(r.max_depth, jb.stats().depth);
+        if (result == JitterBuffer::PopResult::Concealed && cycle >= cycles / 2) ++r.concealed_late;
+        if (out) {
+            for (size_t i = 0; i < kSamplesPerFrame; ++i) {
+                const int16_t sample = out->samples[i];
+                const bool wrapping = sample < 64 || sample >= 8192 - 64 || last < 64 || last >= 8192 - 64;
+                if (!wrapping && (sample < last || sample > last + 2)) ++r.breaks;
+                last = sample;
+            }
+        }
+        jb.pop();
+    }
+    r.stats = jb.stats();
+    return r;
+}
+
+TEST(JitterBufferTest, CleanLinkPlaysImmediately) {
+    JitterBuffer jb;
+    AudioFrame out;
+    for (uint32_t seq = 0; seq < 10; ++seq) {
+        ASSERT_TRUE(push_on_time(jb, seq, static_cast<int16_t>(seq)));
+        ASSERT_EQ(jb.pop(out), JitterBuffer::PopResult::Frame);
+        EXPECT_EQ(out.sequence, seq);
+    }
+    auto stats = jb.stats();
+    EXPECT_EQ(stats.target_depth, 0u);
+    EXPECT_EQ(stats.played, 10u);
+    EXPECT_EQ(stats.concealed, 0u);
+}
+
+TEST(JitterBufferTest, ReordersWithinBuffer) {
+    JitterBuffer jb;
+    AudioFrame out;
+    push_on_time(jb, 0, 100);
+    ASSERT_EQ(jb.pop(out), JitterBuffer::PopResult::Frame);
+
+    // 2 arrives before 1
+    push_on_time(jb, 2, 102);
+    push_on_time(jb, 1, 101);
+    ASSERT_EQ(jb.pop(out), JitterBuffer::PopResult::Frame);
+    EXPECT_EQ(out.samples[0], 101);
+    ASSERT_EQ(jb.pop(out), JitterBuffer::PopResult::Frame);
+    EXPECT_EQ(out.samples[0], 102);
+    EXPECT_EQ(jb.stats().reordered, 1u);
+}
+
+TEST(JitterBufferTest, LossIsConcealedWithFade) {
+    JitterBuffer jb;
+    AudioFrame out;
+    push_on_time(jb, 0, 10000);
+    ASSERT_EQ(jb.pop(out), JitterBuffer::PopResult::Frame);
+
+    // 1 is lost; 2 is already here, so 1 is concealed and skipped
+    push_on_time(jb, 2, 2000);
+    ASSERT_EQ(jb.pop(out), JitterBuffer::PopResult::Concealed);
+    EXPECT_EQ(out.samples[0], 10000);                    // starts at full level
+    EXPECT_LT(out.samples[kSamplesPerFrame - 1], 10000); // and fades
+    ASSERT_EQ(jb.pop(out), JitterBuffer::PopResult::Frame);
+    EXPECT_EQ(out.samples[0], 2000);
+
+    // The lost frame turning up afterwards is late
+    EXPECT_FALSE(push_on_time(jb, 1, 1000));
+    EXPECT_EQ(jb.stats().late, 1u);
+}
+
+TEST(JitterBufferTest, LateFrameStillPlaysAfterOneConcealment) {
+    JitterBuffer jb;
+    AudioFrame out;
+    push_on_time(jb, 0, 100);
+    ASSERT_EQ(jb.pop(out), JitterBuffer::PopResult::Frame);
+
+    // Nothing buffered: conceal but hold the playout point
+    ASSERT_EQ(jb.pop(out), JitterBuffer::PopResult::Concealed);
+    EXPECT_TRUE(push_on_time(jb, 1, 101));
+    ASSERT_EQ(jb.pop(out), JitterBuffer::PopResult::Frame);
+    EXPECT_EQ(out.samples[0], 101);
+}
+
+TEST(JitterBufferTest, StoppedStreamFadesThenGoesQuiet) {
+    JitterBuffer jb;
+    AudioFrame out;
+    push_on_time(jb, 0, 8000);
+    ASSERT_EQ(jb.pop(out), JitterBuffer::PopResult::Frame);
+
+    for (uint32_t i = 0; i < JitterBuffer::kMaxConcealed; ++i) {
+        ASSERT_EQ(jb.pop(out), JitterBuffer::PopResult::Concealed);
+    }
+    EXPECT_LT(out.samples[kSamplesPerFrame - 1], 8000 / 100);  // faded out
+    EXPECT_EQ(jb.pop(out), JitterBuffer::PopResult::None);
+
+    // Resumes without a prebuffer
+    EXPECT_TRUE(push_on_time(jb, 40, 500));
+    ASSERT_EQ(jb.pop(out), JitterBuffer::PopResult::Frame);
+    EXPECT_EQ(out.samples[0], 500);
+}
+
+TEST(JitterBufferTest, TargetDepthAdaptsToJitter) {
+    JitterBuffer jb;
+    // Arrivals alternate ±2ms around the nominal schedule
+    for (uint32_t seq = 0; seq < 200; ++seq) {
+        int64_t wobble = (seq % 2) ? 2000000 : -2000000;
+        jb.push(make_frame(seq, 1), static_cast<int64_t>(seq) * kFrameNs + wobble);
+        AudioFrame out;
+        jb.pop(out);
+    }
+    auto stats = jb.stats();
+    EXPECT_GT(stats.jitter_us, 1000u);
+    EXPECT_GT(stats.target_depth, 0u);
+    EXPECT_LE(stats.target_depth, JitterBuffer::kMaxTargetDepth);
+}
+
+TEST(JitterBufferTest, SequenceRestartResyncs) {
+    JitterBuffer jb;
+    AudioFrame out;
+    for (uint32_t seq = 1000; seq < 1003; ++seq) {
+        push_on_time(jb, seq, 1);
+        jb.pop(out);
+    }
+    // Client reloaded: sequence starts again from 0
+    EXPECT_FALSE(jb.push(make_frame(0, 7), 1003 * kFrameNs));
+    EXPECT_EQ(jb.pop(out), JitterBuffer::PopResult::None);  // resync
+    EXPECT_TRUE(jb.push(make_frame(1, 7), 1004 * kFrameNs));
+    ASSERT_EQ(jb.pop(out), JitterBuffer::PopResult::Frame);
+    EXPECT_EQ(out.sequence, 1u);
+}
+
+TEST(JitterBufferTest, BurstIsTrimmedTowardTarget) {
+    JitterBuffer jb;
+    AudioFrame out;
+    push_on_time(jb, 0, 1);
+    ASSERT_EQ(jb.pop(out), JitterBuffer::PopResult::Frame);
+
+    // Six frames land at once after a stall
+    for (uint32_t seq = 1; seq <= 6; ++seq) push_on_time(jb, seq, 1);
+    for (int i = 0; i < 3; ++i) jb.pop(out);
+    EXPECT_GT(jb.stats().trimmed, 0u);
+    EXPECT_LE(jb.stats().depth, 4u);
+}
+
+TEST(JitterBufferTest, ResetDiscardsBufferedFrames) {
+    JitterBuffer jb;
+    AudioFrame out;
+    push_on_time(jb, 0, 1);
+    push_on_time(jb, 1, 1);
+    jb.reset();
+    EXPECT_EQ(jb.pop(out), JitterBuffer::PopResult::None);
+}
+
+TEST(JitterBufferTest, FramesAreReadInPlaceUntilPopped) {
+    JitterBuffer jb;
+    uint8_t datagram[kAudioPacketSize] = {};
+    const int16_t sample = 1234;
+    std::memcpy(datagram + kAudioHeaderSize, &sample, sizeof(sample));
+    ASSERT_TRUE(jb.push_datagram(datagram, 1, false));
+
+    const AudioFrame* frame;
+    ASSERT_EQ(jb.front(frame), JitterBuffer::PopResult::Frame);
+    EXPECT_EQ(frame->samples[0], 1234);
+
+    // The held cell can't be reused under the reader
+    AudioFrame wrapped = make_frame(JitterBuffer::kCapacity, 9);
+    EXPECT_FALSE(jb.push(wrapped, 0));
+    EXPECT_EQ(frame->samples[0], 1234);
+    jb.pop();
+
+    // The played frame lives on as the concealment source
+    push_on_time(jb, 2, 0);
+    ASSERT_EQ(jb.front(frame), JitterBuffer::PopResult::Concealed);
+    EXPECT_NEAR(frame->samples[0], 1234, 2);
+    jb.pop();
+}
+
+TEST(JitterBufferTest, SilentDatagramsAreStoredAsZeros) {
+    JitterBuffer jb;
+    uint8_t datagram[kAudioPacketSize];
+    std::memset(datagram, 0x7f, sizeof(datagram));
+    std::memset(datagram, 0, kAudioHeaderSize);
+    ASSERT_TRUE(jb.push_datagram(datagram, 1, true));
+
+    AudioFrame out;
+    ASSERT_EQ(jb.pop(out), JitterBuffer::PopResult::Frame);
+    EXPECT_TRUE(out.silent);
+    EXPECT_EQ(out.samples[0], 0);
+    EXPECT_EQ(out.samples[kSamplesPerFrame - 1], 0);
+}
+
+TEST(JitterBufferTest, InStepSenderIsLeftAlone) {
+    DriftResult r = drift_run(1.0, 30);
+    EXPECT_EQ(r.stats.drift_ppm, 0);
+    EXPECT_EQ(r.stats.slipped, 0u);
+    EXPECT_EQ(r.stats.inserted, 0u);
+    EXPECT_EQ(r.stats.concealed, 0u);
+    EXPECT_EQ(r.breaks, 0u);
+}
+
+TEST(JitterBufferTest, FastSenderIsSlippedInsteadOfTrimmed) {
+    // 300ppm fast gains a frame every ~9s: trimmed a dozen times in two minutes
+    DriftResult r = drift_run(1.0003, 120);
+    EXPECT_NEAR(r.stats.drift_ppm, 300, 15);
+    EXPECT_GT(r.stats.slipped, 1500u);
+    EXPECT_EQ(r.stats.trimmed, 0u);
+    EXPECT_EQ(r.stats.concealed, 0u);
+    EXPECT_LE(r.max_depth, 2u);
+    EXPECT_EQ(r.breaks, 0u);
+}
+
+TEST(JitterBufferTest, SlowSenderIsInsertedInsteadOfConcealed) {
+    // Half a frame of slack runs out before the estimate is in: one loss,
+    // concealed, and none after
+    DriftResult r = drift_run(0.9997, 120);
+    EXPECT_NEAR(r.stats.drift_ppm, -300, 15);
+    EXPECT_GT(r.stats.inserted, 1500u);
+    EXPECT_LE(r.stats.concealed, 2u);
+    EXPECT_EQ(r.concealed_late, 0u);
+    EXPECT_EQ(r.stats.trimmed, 0u);
+    EXPECT_LE(r.breaks, 2u);
+}
+
+TEST(JitterBufferTest, SenderAt44100IsResampledOntoTheMixClock) {
+    // ~8% fewer frames than cycles: concealed until the estimate is in,
+    // then stretched, a frame at a time, without a gap
+    DriftResult r = drift_run(44100.0 / 48000.0, 60);
+    EXPECT_NEAR(r.stats.drift_ppm, -81250, 200);
+    EXPECT_EQ(r.concealed_late, 0u);
+    EXPECT_GT(r.stats.inserted, 100000u);
+    EXPECT_LE(r.max_depth, 3u);
+}
+
+TEST(JitterBufferTest, SkewEstimateRidesOutJitter) {
+    DriftResult r = drift_run(1.0001, 120, 0.5, 500000);
+    EXPECT_NEAR(r.stats.drift_ppm, 100, 20);
+    EXPECT_EQ(r.stats.trimmed, 0u);
+    EXPECT_EQ(r.stats.concealed, 0u);
+    EXPECT_EQ(r.breaks, 0u);
+}
+
+} // namespace
+} // namespace tutti
@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "signaling/lobby_feed.h"
+
+namespace tutti {
+namespace {
+
+using RoomInfo = LobbyFeed::RoomInfo;
+
+/// The JSON payload of a single-event SSE message
+nlohmann::json data_of(const std::string& event) {
+    auto start = event.find("data: ");
+    auto end = event.find('\n', start);
+    return nlohmann::json::parse(event.substr(start + 6, end - start - 6));
+}
+
+TEST(LobbyFeedTest, FirstUpdateListsEveryRoom) {
+    LobbyFeed feed;
+    std::vector<RoomInfo> rooms = {{"Allegro", 0, 4, false}, {"Ballata", 1, 4, false}};
+    std::string event = feed.update(rooms);
+    EXPECT_EQ(event.rfind("event: update\n", 0), 0u);
+    EXPECT_EQ(data_of(event)["rooms"].size(), 2u);
+    EXPECT_EQ(event.substr(event.size() - 2), "\n\n");
+
+    const std::string& snapshot = feed.snapshot_event();
+    EXPECT_NE(snapshot.find("retry: "), std::string::npos);
+    EXPECT_NE(snapshot.find("event: snapshot\n"), std::string::npos);
+    EXPECT_EQ(data_of(snapshot)["rooms"].size(), 2u);
+}
+
+TEST(LobbyFeedTest, UpdateCarriesOnlyChangedRooms) {
+    LobbyFeed feed;
+    std::vector<RoomInfo> rooms = {{"Allegro", 0, 4, false}, {"Ballata", 1, 4, false}};
+    feed.update(rooms);
+
+    rooms[1].participant_count = 2;
+    auto changed = data_of(feed.update(rooms))["rooms"];
+    ASSERT_EQ(changed.size(), 1u);
+    EXPECT_EQ(changed[0]["name"], "Ballata");
+    EXPECT_EQ(changed[0]["participant_count"], 2);
+
+    rooms[0].claimed = true;
+    changed = data_of(feed.update(rooms))["rooms"];
+    ASSERT_EQ(changed.size(), 1u);
+    EXPECT_EQ(changed[0]["name"], "Allegro");
+    EXPECT_TRUE(changed[0]["claimed"]);
+
+    // The snapshot follows along
+    auto all = data_of(feed.snapshot_event())["rooms"];
+    EXPECT_EQ(all[0]["claimed"], true);
+    EXPECT_EQ(all[1]["participant_count"], 2);
+}
+
+TEST(LobbyFeedTest, NoChangeNoEvent) {
+    LobbyFeed feed;
+    std::vector<RoomInfo> rooms = {{"Allegro", 1, 4, false}};
+    feed.update(rooms);
+    EXPECT_EQ(feed.update(rooms), "");
+}
+
+} // namespace
+} // namespace tutti
@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+
+#include "audio/mix_kernels.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <random>
+
+namespace tutti {
+namespace {
+
+// Odd length exercises the scalar tail of the vector paths
+constexpr size_t kLen = 131;
+
+std::array<int16_t, kLen> random_samples(uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> dist(std::numeric_limits<int16_t>::min(),
+                                            std::numeric_limits<int16_t>::max());
+    std::array<int16_t, kLen> out;
+    for (auto& s : out) s = static_cast<int16_t>(dist(rng));
+    return out;
+}
+
+TEST(MixKernelsTest, SelectedMatchesScalar) {
+    const MixKernels& ref = scalar_mix_kernels();
+    const MixKernels& k = mix_kernels();
+
+    auto a = random_samples(1);
+    auto b = random_samples(2);
+    auto c = random_samples(3);
+
+    auto run = [&](const MixKernels& impl) {
+        std::array<float, kLen> acc{};
+        impl.accumulate(acc.data(), a.data(), kLen);
+        impl.accumulate(acc.data(), b.data(), kLen);
+        impl.subtract(acc.data(), c.data(), kLen);
+        impl.accumulate_scaled(acc.data(), c.data(), 0.3f, kLen);
+        impl.accumulate_scaled(acc.data(), a.data(), -0.75f, kLen);
+        return acc;
+    };
+    auto acc_ref = run(ref);
+    auto acc = run(k);
+    EXPECT_EQ(acc, acc_ref) << "kernel: " << k.name;
+
+    std::array<int16_t, kLen> out_ref{}, out{};
+    float peak_ref = ref.store(out_ref.data(), acc_ref.data(), kLen);
+    EXPECT_EQ(k.store(out.data(), acc.data(), kLen), peak_ref) << "kernel: " << k.name;
+    EXPECT_EQ(out, out_ref) << "kernel: " << k.name;
+    EXPECT_EQ(peak_ref, ref.peak(acc_ref.data(), kLen));
+}
+
+TEST(MixKernelsTest, EnergyMatchesScalarAndIsExactAtFullScale) {
+    const MixKernels& ref = scalar_mix_kernels();
+    const MixKernels& k = mix_kernels();
+
+    auto a = random_samples(4);
+    EXPECT_EQ(k.energy(a.data(), kLen), ref.energy(a.data(), kLen)) << "kernel: " << k.name;
+
+    // Every pair at -32768 would overflow a signed 32-bit pair sum
+    std::array<int16_t, kLen> loud;
+    loud.fill(std::numeric_limits<int16_t>::min());
+    EXPECT_EQ(k.energy(loud.data(), kLen), uint64_t{kLen} << 30) << "kernel: " << k.name;
+
+    std::array<int16_t, kLen> quiet{};
+    EXPECT_EQ(k.energy(quiet.data(), kLen), 0u);
+}
+
+TEST(MixKernelsTest, StereoKernelsMatchScalar) {
+    const MixKernels& ref = scalar_mix_kernels();
+    const MixKernels& k = mix_kernels();
+
+    // kLen samples: one mono source, or kLen / 2 interleaved frames (odd count)
+    constexpr size_t kFrames = kLen / 2;
+    auto mono = random_samples(5);
+    auto stereo = random_samples(6);
+
+    auto run = [&](const MixKernels& impl) {
+        std::array<float, 2 * kLen> acc{};
+        impl.accumulate_panned(acc.data(), mono.data(), 1.0f, 0.4f, kLen);
+        impl.accumulate_panned(acc.data(), stereo.data(), -0.25f, -1.0f, kLen);
+        impl.accumulate_balanced(acc.data(), stereo.data(), 0.7f, 1.0f, kFrames);
+        return acc;
+    };
+    auto acc = run(k);
+    EXPECT_EQ(acc, run(ref)) << "kernel: " << k.name;
+    EXPECT_EQ(acc[0], std::fmaf(stereo[0], 0.7f, std::fmaf(stereo[0], -0.25f, mono[0])));
+    EXPECT_EQ(acc[1], std::fmaf(stereo[1], 1.0f, std::fmaf(stereo[0], -1.0f, mono[0] * 0.4f)));
+
+    std::array<int16_t, kFrames> down{}, down_ref{};
+    k.downmix(down.data(), stereo.data(), kFrames);
+    ref.downmix(down_ref.data(), stereo.data(), kFrames);
+    EXPECT_EQ(down, down_ref) << "kernel: " << k.name;
+    EXPECT_EQ(down[0], (stereo[0] + stereo[1]) >> 1);
+}
+
+TEST(MixKernelsTest, StoreRoundsHalfEvenAndClampsBothEnds) {
+    const MixKernels& k = mix_kernels();
+    std::array<float, kLen> acc{};
+    for (size_t i = 0; i < kLen; ++i) {
+        acc[i] = (i % 2) ? 100000.0f : -100000.0f;
+    }
+    acc[0] = 2.5f;
+    acc[1] = -3.5f;
+    std::array<int16_t, kLen> out{};
+    k.store(out.data(), acc.data(), kLen);
+    EXPECT_EQ(out[0], 2);
+    EXPECT_EQ(out[1], -4);
+    for (size_t i = 2; i < kLen; ++i) {
+        EXPECT_EQ(out[i], (i % 2) ? std::numeric_limits<int16_t>::max()
+                                  : std::numeric_limits<int16_t>::min());
+    }
+}
+
+TEST(MixKernelsTest, LimitMatchesScalarAndStaysBelowFullScale) {
+    const MixKernels& ref = scalar_mix_kernels();
+    const MixKernels& k = mix_kernels();
+
+    // Several full-scale sources summed: well past int16 range
+    auto a = random_samples(7);
+    auto b = random_samples(8);
+    std::array<float, kLen> acc{};
+    k.accumulate_scaled(acc.data(), a.data(), 3.0f, kLen);
+    k.accumulate(acc.data(), b.data(), kLen);
+
+    EXPECT_EQ(k.peak(acc.data(), kLen), ref.peak(acc.data(), kLen)) << "kernel: " << k.name;
+    float peak = 0.0f;
+    for (float v : acc) peak = std::max(peak, std::fabs(v));
+    EXPECT_EQ(k.peak(acc.data(), kLen), peak);
+
+    // Ramp from unity down to 0.5 across the block
+    std::array<int16_t, kLen> out{}, out_ref{};
+    k.limit(out.data(), acc.data(), 1.0f, -0.5f / kLen, kLen);
+    ref.limit(out_ref.data(), acc.data(), 1.0f, -0.5f / kLen, kLen);
+    EXPECT_EQ(out, out_ref) << "kernel: " << k.name;
+    for (size_t i = 0; i < kLen; ++i) {
+        ASSERT_LT(std::abs(out[i]), kSoftClipCeiling) << "sample " << i;
+    }
+
+    // Below the knee the curve is linear: plain gain
+    std::array<float, kLen> quiet{};
+    for (size_t i = 0; i < kLen; ++i) quiet[i] = static_cast<float>(a[i]) * 0.5f;
+    k.limit(out.data(), quiet.data(), 0.5f, 0.0f, kLen);
+    for (size_t i = 0; i < kLen; ++i) {
+        EXPECT_EQ(out[i], std::lrintf(quiet[i] * 0.5f)) << "sample " << i;
+    }
+}
+
+} // namespace
+} // namespace tutti
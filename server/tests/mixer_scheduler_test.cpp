@@ -0,0 +1,268 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "audio/mixer_scheduler.h"
+#include "audio/room.h"
+
+namespace tutti {
+namespace {
+
+/// Transport session that only counts outgoing datagrams
+class CountingSession : public TransportSession {
+public:
+    explicit CountingSession(std::string id) : id_(std::move(id)) {}
+    bool send_datagram(const uint8_t*, size_t) override {
+        datagrams++;
+        return true;
+    }
+    bool send_reliable(const std::string&) override { return true; }
+    void close() override {}
+    std::string id() const override { return id_; }
+    std::string remote_address() const override { return "test"; }
+    bool is_connected() const override { return true; }
+
+    std::atomic<int> datagrams{0};
+
+private:
+    std::string id_;
+};
+
+void send_frame(Room& room, const std::string& id, int16_t value, uint32_t seq = 0) {
+    AudioPacket pkt{};
+    pkt.sequence = seq;
+    pkt.timestamp = seq * kSamplesPerFrame;
+    for (auto& s : pkt.samples) s = value;
+    uint8_t buf[kAudioPacketSize];
+    pkt.serialize(buf);
+    room.on_audio_received(room.slot_of(id), buf, sizeof(buf));
+}
+
+TEST(MixerSchedulerTest, ParseCpuList) {
+    EXPECT_EQ(MixerScheduler::parse_cpu_list("2-5,7"),
+              (std::vector<int>{2, 3, 4, 5, 7}));
+    EXPECT_EQ(MixerScheduler::parse_cpu_list("1"), (std::vector<int>{1}));
+    EXPECT_TRUE(MixerScheduler::parse_cpu_list("").empty());
+    EXPECT_EQ(MixerScheduler::parse_cpu_list("x,3"), (std::vector<int>{3}));
+}
+
+TEST(MixerSchedulerTest, SpreadsRoomsAcrossWorkers) {
+    MixerSchedulerConfig config;
+    config.worker_count = 2;
+    MixerScheduler scheduler(config);
+    EXPECT_EQ(scheduler.worker_count(), 2u);
+
+    auto a = std::make_shared<Room>("A");
+    auto b = std::make_shared<Room>("B");
+    auto c = std::make_shared<Room>("C");
+    scheduler.add_room(a);
+    scheduler.add_room(b);
+    EXPECT_LT(scheduler.worker_of(a.get()), 2u);
+    EXPECT_LT(scheduler.worker_of(b.get()), 2u);
+    EXPECT_NE(scheduler.worker_of(a.get()), scheduler.worker_of(b.get()));
+
+    // A freed worker takes the next room
+    const size_t freed = scheduler.worker_of(a.get());
+    scheduler.remove_room(a.get());
+    EXPECT_EQ(scheduler.worker_of(a.get()), 2u);
+    scheduler.add_room(c);
+    EXPECT_EQ(scheduler.worker_of(c.get()), freed);
+
+    scheduler.remove_room(b.get());
+    scheduler.remove_room(c.get());
+    EXPECT_EQ(scheduler.worker_of(b.get()), 2u);
+    EXPECT_EQ(scheduler.worker_of(c.get()), 2u);
+}
+
+TEST(MixerSchedulerTest, RebalanceSpreadsRoomsThatNeedMixing) {
+    MixerSchedulerConfig config;
+    config.worker_count = 2;
+    MixerScheduler scheduler(config);
+
+    // Placed empty, A and C share a worker
+    std::vector<std::shared_ptr<Room>> rooms;
+    for (const char* name : {"A", "B", "C", "D"}) {
+        rooms.push_back(std::make_shared<Room>(name, 4));
+        scheduler.add_room(rooms.back());
+    }
+    auto& a = rooms[0];
+    auto& c = rooms[2];
+    ASSERT_EQ(scheduler.worker_of(a.get()), scheduler.worker_of(c.get()));
+    EXPECT_EQ(scheduler.rebalance(), 0u);  // nothing needs mixing yet
+
+    for (auto* room : {a.get(), c.get()}) {
+        for (const char* id : {"alice", "bob", "carol"}) {
+            ASSERT_TRUE(room->add_participant(id, id, std::make_shared<CountingSession>(id)));
+        }
+        send_frame(*room, "alice", 1000);
+        ASSERT_TRUE(room->needs_mixing());
+    }
+
+    // Both busy rooms on one worker: one moves once its worker lets go
+    scheduler.start();
+    EXPECT_EQ(scheduler.rebalance(), 1u);
+    EXPECT_NE(scheduler.worker_of(a.get()), scheduler.worker_of(c.get()));
+    EXPECT_EQ(scheduler.rebalance(), 0u);
+
+    // Busy counts tie, so a new room goes to the worker with fewer rooms
+    auto e = std::make_shared<Room>("E", 4);
+    scheduler.add_room(e);
+    EXPECT_EQ(scheduler.worker_of(e.get()), scheduler.worker_of(a.get()));
+    scheduler.stop();
+}
+
+TEST(MixerSchedulerTest, WorkerMixesActiveRoom) {
+    MixerScheduler scheduler;
+    auto room = std::make_shared<Room>("Allegro", 4);
+
+    std::vector<std::shared_ptr<CountingSession>> sessions;
+    for (const char* id : {"alice", "bob", "carol"}) {
+        auto s = std::make_shared<CountingSession>(id);
+        ASSERT_TRUE(room->add_participant(id, id, s));
+        sessions.push_back(s);
+    }
+    EXPECT_FALSE(room->needs_mixing());  // nobody is playing yet
+
+    scheduler.add_room(room);
+    scheduler.start();
+
+    send_frame(*room, "alice", 1000);
+    EXPECT_TRUE(room->needs_mixing());
+    send_frame(*room, "bob", 2000);
+    send_frame(*room, "carol", 3000);
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    auto all_sent = [&] {
+        for (auto& s : sessions)
+            if (s->datagrams == 0) return false;
+        return true;
+    };
+    while (!all_sent() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    scheduler.stop();
+
+    // One mix per frame sent, possibly followed by concealment frames
+    // as each input's jitter buffer fades out
+    for (auto& s : sessions) EXPECT_GE(s->datagrams, 1);
+
+    auto clock = scheduler.clock_stats();
+    EXPECT_GE(clock.early + clock.on_time + clock.late, 1u);
+}
+
+TEST(MixerSchedulerTest, ReadyNeedsEverySlotNotEveryFrame) {
+    Room room("Corrente", 4);
+    for (const char* id : {"alice", "bob", "carol"}) {
+        ASSERT_TRUE(room.add_participant(id, id, std::make_shared<CountingSession>(id)));
+    }
+
+    // Three frames from two participants is not a complete cycle
+    send_frame(room, "alice", 1000, 0);
+    send_frame(room, "alice", 1000, 1);
+    send_frame(room, "bob", 1000, 0);
+    EXPECT_FALSE(room.take_mix_ready());
+
+    send_frame(room, "carol", 1000, 0);
+    EXPECT_TRUE(room.take_mix_ready());
+    EXPECT_FALSE(room.take_mix_ready());  // once
+
+    // The next cycle starts from an empty set
+    room.process_cycle();
+    send_frame(room, "bob", 1000, 1);
+    EXPECT_FALSE(room.take_mix_ready());
+}
+
+TEST(MixerSchedulerTest, CountsDeadlineCycles) {
+    MixerScheduler scheduler;
+    auto room = std::make_shared<Room>("Sarabanda", 4);
+    for (const char* id : {"alice", "bob", "carol"}) {
+        ASSERT_TRUE(room->add_participant(id, id, std::make_shared<CountingSession>(id)));
+    }
+    send_frame(*room, "alice", 1000);  // keeps the room streaming for kStreamingTimeout
+    scheduler.add_room(room);
+    scheduler.start();
+
+    // No more audio: every cycle is driven by the quantum clock
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    scheduler.stop();
+
+    auto clock = scheduler.clock_stats();
+    EXPECT_EQ(clock.early, 0u);
+    EXPECT_GE(clock.on_time + clock.late, 5u);
+}
+
+TEST(MixerSchedulerTest, IdleWorkerSleepsUntilARoomNeedsMixing) {
+    MixerScheduler scheduler;
+    auto empty = std::make_shared<Room>("Pastorale", 4);
+    auto duo = std::make_shared<Room>("Notturno", 4);
+    for (const char* id : {"alice", "bob"}) {
+        ASSERT_TRUE(duo->add_participant(id, id, std::make_shared<CountingSession>(id)));
+    }
+    scheduler.add_room(empty);
+    scheduler.add_room(duo);
+    scheduler.start();
+
+    // Nothing to mix: the clock never starts
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    auto idle = scheduler.clock_stats();
+#ifdef __linux__
+    EXPECT_LE(idle.wakeups, 2u);
+#endif
+    EXPECT_EQ(idle.on_time + idle.late, 0u);
+
+    // A third participant joins: the worker sleeps on until someone plays
+    ASSERT_TRUE(duo->add_participant("carol", "carol", std::make_shared<CountingSession>("carol")));
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_EQ(scheduler.clock_stats().on_time + scheduler.clock_stats().late, 0u);
+
+    // Playing wakes the worker, which mixes on the clock
+    send_frame(*duo, "alice", 1000);
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    auto busy = scheduler.clock_stats();
+    EXPECT_GE(busy.on_time + busy.late, 5u);
+
+    // Back to two: parked, and asleep again
+    duo->remove_participant("carol");
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    auto parked = scheduler.clock_stats();
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+#ifdef __linux__
+    EXPECT_EQ(scheduler.clock_stats().wakeups, parked.wakeups);
+#endif
+    scheduler.stop();  // wakes the sleeping worker to exit
+}
+
+TEST(MixerSchedulerTest, OnlyBoundStreamingParticipantsAreMixed) {
+    Room room("Ciaccona", 4);
+    for (const char* id : {"alice", "bob", "carol"}) {
+        ASSERT_TRUE(room.add_participant(id, id, nullptr));
+    }
+    EXPECT_FALSE(room.needs_mixing());  // nobody bound to hear or be heard
+
+    auto bob = std::make_shared<CountingSession>("bob");
+    auto carol = std::make_shared<CountingSession>("carol");
+    ASSERT_TRUE(room.attach_session("bob", bob));
+    ASSERT_TRUE(room.attach_session("carol", carol));
+    EXPECT_FALSE(room.needs_mixing());  // bob and carol are forwarded to each other
+
+    ASSERT_TRUE(room.attach_session("alice", std::make_shared<CountingSession>("alice")));
+    EXPECT_FALSE(room.needs_mixing());  // three bound, all quiet
+    send_frame(room, "bob", 0, 1);
+    EXPECT_FALSE(room.needs_mixing());  // silence doesn't count
+    send_frame(room, "bob", 1000, 2);
+    EXPECT_TRUE(room.needs_mixing());
+}
+
+TEST(MixerSchedulerTest, TwoParticipantRoomIsNotMixed) {
+    Room room("Ballata", 4);
+    room.add_participant("alice", "alice", nullptr);
+    room.add_participant("bob", "bob", nullptr);
+    EXPECT_FALSE(room.needs_mixing());
+}
+
+} // namespace
+} // namespace tutti
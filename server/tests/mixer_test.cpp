@@ -3,6 +3,11 @@
 #include "audio/mixer.h"
 #include "transport/transport_interface.h"
 
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
 namespace tutti {
 namespace {
 
@@ -14,6 +19,16 @@ AudioFrame make_frame(int16_t value, uint32_t seq = 0) {
     return frame;
 }
 
+AudioFrame make_stereo_frame(int16_t left, int16_t right, uint32_t seq = 0) {
+    AudioFrame frame = make_frame(0, seq);
+    frame.channels = 2;
+    for (size_t i = 0; i < kSamplesPerFrame; ++i) {
+        frame.samples[2 * i] = left;
+        frame.samples[2 * i + 1] = right;
+    }
+    return frame;
+}
+
 TEST(MixerTest, EmptyMixProducesNothing) {
     Mixer mixer(4);
     mixer.mix_cycle();
@@ -90,6 +105,40 @@ TEST(MixerTest, ThreeParticipantsMixing) {
     EXPECT_EQ(out.samples[0], 3000);
 }
 
+TEST(MixerTest, SilentInputsAreNotMixed) {
+    Mixer mixer(4);
+    mixer.add_participant("alice");
+    mixer.add_participant("bob");
+    mixer.add_participant("carol");
+
+    auto resting = make_frame(500);  // flagged silent: samples are ignored
+    resting.silent = true;
+    mixer.push_input("alice", make_frame(1000));
+    mixer.push_input("bob", resting);
+    mixer.push_input("carol", resting);
+
+    mixer.mix_cycle();
+
+    AudioFrame out;
+    ASSERT_TRUE(mixer.pop_output("bob", out));
+    EXPECT_FALSE(out.silent);
+    EXPECT_EQ(out.samples[0], 1000);
+
+    // Alice can only hear silence: a silent frame, not a gap
+    ASSERT_TRUE(mixer.pop_output("alice", out));
+    EXPECT_TRUE(out.silent);
+    EXPECT_EQ(out.samples[0], 0);
+
+    // Muting the resting players leaves Alice nothing at all
+    mixer.set_mute("alice", "bob", true);
+    mixer.set_mute("alice", "carol", true);
+    resting.sequence = 1;
+    mixer.push_input("bob", resting);
+    mixer.push_input("carol", resting);
+    mixer.mix_cycle();
+    EXPECT_FALSE(mixer.pop_output("alice", out));
+}
+
 TEST(MixerTest, GainControl) {
     Mixer mixer(4);
     mixer.add_participant("alice");
@@ -122,22 +171,194 @@ TEST(MixerTest, MuteControl) {
     EXPECT_FALSE(mixer.pop_output("alice", out));
 }
 
-TEST(MixerTest, ClampingPreventsOverflow) {
+TEST(MixerTest, GainResetWhenSlotReused) {
+    Mixer mixer(2);
+    mixer.add_participant("alice");
+    mixer.add_participant("bob");
+    mixer.set_gain("alice", "bob", 0.25f);
+    EXPECT_FLOAT_EQ(mixer.get_gain_entry("alice", "bob").gain, 0.25f);
+
+    // Carol takes Bob's slot and must start at unity gain
+    mixer.remove_participant("bob");
+    mixer.add_participant("carol");
+    EXPECT_FLOAT_EQ(mixer.get_gain_entry("alice", "carol").gain, 1.0f);
+
+    mixer.mix_cycle(); // Mixer observes the handover before Carol streams
+    mixer.push_input("carol", make_frame(8000));
+    mixer.mix_cycle();
+
+    AudioFrame out;
+    ASSERT_TRUE(mixer.pop_output("alice", out));
+    EXPECT_EQ(out.samples[0], 8000);
+}
+
+TEST(MixerTest, GainForUnknownParticipantIgnored) {
+    Mixer mixer(4);
+    mixer.add_participant("alice");
+    mixer.set_gain("alice", "nobody", 0.5f);
+    mixer.set_mute("nobody", "alice", true);
+
+    GainEntry ge = mixer.get_gain_entry("alice", "nobody");
+    EXPECT_FLOAT_EQ(ge.gain, 1.0f);
+    EXPECT_FALSE(ge.muted);
+}
+
+TEST(MixerTest, LoudSumIsLimitedNotClipped) {
     Mixer mixer(4);
     mixer.add_participant("alice");
     mixer.add_participant("bob");
     mixer.add_participant("carol");
 
-    // Both send max positive values
+    // Both send near full scale
     mixer.push_input("bob", make_frame(30000));
     mixer.push_input("carol", make_frame(30000));
 
     mixer.mix_cycle();
 
-    // Alice should hear clamped sum (30000 + 30000 = 60000 → clamped to 32767)
+    // 60000 is soft-clipped below full scale at once, and the limiter's
+    // gain ramps the frame down to the knee by its last sample
+    AudioFrame out;
+    ASSERT_TRUE(mixer.pop_output("alice", out));
+    EXPECT_GT(out.samples[0], kSoftClipKnee);
+    EXPECT_LT(out.samples[0], std::numeric_limits<int16_t>::max());
+    for (size_t i = 1; i < kSamplesPerFrame; ++i) {
+        ASSERT_LE(out.samples[i], out.samples[i - 1]) << "sample " << i;
+    }
+    EXPECT_NEAR(out.samples[kSamplesPerFrame - 1], kSoftClipKnee, 1);
+}
+
+TEST(MixerTest, SumMinusSelfWithGainsAndMutes) {
+    Mixer mixer(4);
+    const std::vector<std::string> ids = {"alice", "bob", "carol", "dave"};
+    const int16_t values[] = {1000, 2000, 3000, 4000};
+    for (const auto& id : ids) mixer.add_participant(id);
+
+    mixer.set_gain("alice", "bob", 0.5f);
+    mixer.set_mute("alice", "carol", true);
+    mixer.set_gain("bob", "dave", 0.0f);
+
+    for (size_t i = 0; i < ids.size(); ++i) {
+        mixer.push_input(ids[i], make_frame(values[i]));
+    }
+    mixer.mix_cycle();
+
     AudioFrame out;
     ASSERT_TRUE(mixer.pop_output("alice", out));
-    EXPECT_EQ(out.samples[0], std::numeric_limits<int16_t>::max());
+    EXPECT_EQ(out.samples[0], 1000 + 4000);         // bob at half, carol muted
+    ASSERT_TRUE(mixer.pop_output("bob", out));
+    EXPECT_EQ(out.samples[0], 1000 + 3000);         // dave at zero gain
+    ASSERT_TRUE(mixer.pop_output("carol", out));
+    EXPECT_EQ(out.samples[0], 1000 + 2000 + 4000);  // unity: total minus self
+    ASSERT_TRUE(mixer.pop_output("dave", out));
+    EXPECT_EQ(out.samples[0], 1000 + 2000 + 3000);
+}
+
+TEST(MixerTest, FullyMutedListenerGetsNoOutput) {
+    Mixer mixer(4);
+    mixer.add_participant("alice");
+    mixer.add_participant("bob");
+    mixer.add_participant("carol");
+    mixer.set_mute("alice", "bob", true);
+    mixer.set_mute("alice", "carol", true);
+
+    mixer.push_input("bob", make_frame(1000));
+    mixer.push_input("carol", make_frame(2000));
+    mixer.mix_cycle();
+
+    AudioFrame out;
+    EXPECT_FALSE(mixer.pop_output("alice", out));
+    ASSERT_TRUE(mixer.pop_output("bob", out));
+    EXPECT_EQ(out.samples[0], 2000);
+}
+
+TEST(MixerTest, StereoMixesPanAndMonoMixesDownmix) {
+    Mixer mixer(4);
+    mixer.add_participant("alice");  // stereo listener, sends mono
+    mixer.add_participant("bob");    // mono
+    mixer.add_participant("carol");  // stereo both ways
+    mixer.set_output_channels("alice", 2);
+    mixer.set_output_channels("carol", 2);
+    mixer.set_pan("alice", "bob", 1.0f);      // hard right
+    mixer.set_gain("alice", "carol", 0.5f);
+    mixer.set_pan("bob", "carol", -1.0f);     // no effect on a mono mix
+
+    mixer.push_input("alice", make_frame(500));
+    mixer.push_input("bob", make_frame(1000));
+    mixer.push_input("carol", make_stereo_frame(3000, 1000));
+    mixer.mix_cycle();
+
+    AudioFrame out;
+    ASSERT_TRUE(mixer.pop_output("alice", out));
+    ASSERT_EQ(out.channels, 2);
+    EXPECT_EQ(out.samples[0], 1500);                 // carol's left at half
+    EXPECT_EQ(out.samples[1], 1000 + 500);           // bob, and carol's right at half
+    EXPECT_EQ(out.samples[2 * kSamplesPerFrame - 1], 1500);
+
+    ASSERT_TRUE(mixer.pop_output("bob", out));
+    ASSERT_EQ(out.channels, 1);
+    EXPECT_EQ(out.samples[0], 500 + (3000 + 1000) / 2);
+
+    ASSERT_TRUE(mixer.pop_output("carol", out));     // mono sources centred
+    ASSERT_EQ(out.channels, 2);
+    EXPECT_EQ(out.samples[0], 1500);
+    EXPECT_EQ(out.samples[1], 1500);
+}
+
+TEST(MixerTest, OutputsAreReadInPlaceAsDatagrams) {
+    Mixer mixer(4);
+    auto alice = mixer.add_participant("alice");
+    auto bob = mixer.add_participant("bob");
+    mixer.push_input(alice, make_frame(5000, 1));
+    mixer.push_input(bob, make_frame(3000, 1));
+    mixer.mix_cycle();
+
+    // Bob's mix, straight out of the queue slot in wire format
+    const AudioFrame* out = mixer.front_output(bob);
+    ASSERT_NE(out, nullptr);
+    uint8_t expected[kAudioPacketSize];
+    out->to_packet().serialize(expected);
+    EXPECT_EQ(std::memcmp(out->wire_data(), expected, sizeof(expected)), 0);
+    mixer.pop_front_output(bob);
+    EXPECT_EQ(mixer.front_output(bob), nullptr);
+
+    // Datagrams go into the jitter buffer without building a frame
+    uint8_t datagram[kAudioPacketSize];
+    make_frame(2000, 2).to_packet().serialize(datagram);
+    EXPECT_TRUE(mixer.push_input(alice, datagram, 1, false));
+    mixer.push_input(bob, make_frame(0, 2));
+    mixer.mix_cycle();
+    out = mixer.front_output(bob);
+    ASSERT_NE(out, nullptr);
+    EXPECT_EQ(out->samples[0], 2000);
+}
+
+TEST(MixerTest, IdenticalMixesAreBuiltOnce) {
+    Mixer mixer(8);
+    std::vector<ParticipantSlot> performers, listeners;
+    for (const char* id : {"alice", "bob", "carol"}) performers.push_back(mixer.add_participant(id));
+    for (const char* id : {"l1", "l2", "l3", "l4"}) listeners.push_back(mixer.add_participant(id));
+    mixer.set_gain("l4", "alice", 0.5f);
+
+    // Listeners send nothing: l1-l3 all hear the room total, l4 its own mix
+    int16_t level = 1000;
+    for (auto slot : performers) mixer.push_input(slot, make_frame(level += 1000, 1));
+    mixer.mix_cycle();
+    EXPECT_EQ(mixer.shared_mixes(), 2u);
+
+    AudioFrame first, out;
+    ASSERT_TRUE(mixer.pop_output(listeners[0], first));
+    EXPECT_EQ(first.samples[0], 9000);
+    for (size_t i = 1; i < 3; ++i) {
+        ASSERT_TRUE(mixer.pop_output(listeners[i], out));
+        EXPECT_TRUE(std::equal(out.samples.begin(), out.samples.end(), first.samples.begin()));
+        EXPECT_TRUE(out.room_total);
+    }
+    ASSERT_TRUE(mixer.pop_output(listeners[3], out));
+    EXPECT_EQ(out.samples[0], 8000);
+
+    // Performers each hear everyone but themselves
+    ASSERT_TRUE(mixer.pop_output(performers[0], out));
+    EXPECT_EQ(out.samples[0], 7000);
 }
 
 TEST(MixerTest, RemoveParticipant) {
@@ -153,6 +374,66 @@ TEST(MixerTest, RemoveParticipant) {
     EXPECT_FALSE(mixer.push_input("bob", make_frame(1000)));
 }
 
+TEST(MixerTest, StaleSlotHandleRejected) {
+    Mixer mixer(2);
+    ParticipantSlot alice = mixer.add_participant("alice");
+    ParticipantSlot bob = mixer.add_participant("bob");
+    ASSERT_TRUE(alice.valid());
+    ASSERT_TRUE(bob.valid());
+    EXPECT_NE(alice.index, bob.index);
+    EXPECT_TRUE(mixer.push_input(bob, make_frame(1000)));
+
+    // Carol reuses Bob's slot; Bob's old handle must not reach her queue
+    mixer.remove_participant("bob");
+    ParticipantSlot carol = mixer.add_participant("carol");
+    ASSERT_EQ(carol.index, bob.index);
+    EXPECT_NE(carol.generation, bob.generation);
+    EXPECT_FALSE(mixer.is_current(bob));
+    EXPECT_FALSE(mixer.push_input(bob, make_frame(1000)));
+
+    // Bob's queued frame is dropped when the mixer observes the handover
+    mixer.mix_cycle();
+    AudioFrame out;
+    EXPECT_FALSE(mixer.pop_output(alice, out));
+
+    EXPECT_TRUE(mixer.push_input(carol, make_frame(2000)));
+
+    mixer.mix_cycle();
+    ASSERT_TRUE(mixer.pop_output(alice, out));
+    EXPECT_EQ(out.samples[0], 2000);
+}
+
+TEST(MixerTest, SlotStateIsAllocatedByItsFirstOccupant) {
+    Mixer mixer(8);
+    EXPECT_EQ(mixer.allocated_slots(), 0u);
+    mixer.mix_cycle();
+    mixer.clear_queues();
+    EXPECT_EQ(mixer.output_depth(5), 0u);
+    EXPECT_EQ(mixer.jitter_stats(5).played, 0u);
+    EXPECT_FALSE(mixer.is_current({5, 1}));
+
+    ParticipantSlot alice = mixer.add_participant("alice");
+    mixer.add_participant("bob");
+    EXPECT_EQ(mixer.allocated_slots(), 2u);
+    EXPECT_TRUE(mixer.push_input(alice, make_frame(1000)));
+
+    // A freed slot keeps its state for the next occupant
+    mixer.remove_participant("bob");
+    mixer.add_participant("carol");
+    mixer.remove_participant("carol");
+    EXPECT_EQ(mixer.allocated_slots(), 3u);
+    mixer.mix_cycle();
+    EXPECT_EQ(mixer.participant_count(), 1u);
+}
+
+TEST(MixerTest, AddBeyondCapacityReturnsInvalidSlot) {
+    Mixer mixer(1);
+    EXPECT_TRUE(mixer.add_participant("alice").valid());
+    EXPECT_FALSE(mixer.add_participant("bob").valid());
+    EXPECT_FALSE(mixer.add_participant("alice").valid());
+    EXPECT_EQ(mixer.participant_count(), 1u);
+}
+
 TEST(MixerTest, PacketSerialization) {
     AudioPacket pkt;
     pkt.sequence = 42;
@@ -172,6 +453,22 @@ TEST(MixerTest, PacketSerialization) {
     }
 }
 
+TEST(MixerTest, StereoPacketSerialization) {
+    AudioPacket pkt{};
+    pkt.channels = 2;
+    for (size_t i = 0; i < 2 * kSamplesPerFrame; ++i) {
+        pkt.samples[i] = static_cast<int16_t>(i);
+    }
+    ASSERT_EQ(pkt.size(), kMaxAudioPacketSize);
+
+    uint8_t buf[kMaxAudioPacketSize];
+    pkt.serialize(buf);
+    auto decoded = AudioPacket::deserialize(buf, sizeof(buf));
+    EXPECT_EQ(decoded.channels, 2);
+    EXPECT_EQ(decoded.samples[2 * kSamplesPerFrame - 1], static_cast<int16_t>(2 * kSamplesPerFrame - 1));
+    EXPECT_EQ(AudioPacket::deserialize(buf, kAudioPacketSize).channels, 1);
+}
+
 TEST(MixerTest, ShortPacketDeserialize) {
     uint8_t buf[4] = {0};
     auto pkt = AudioPacket::deserialize(buf, 4);
@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+
+#include "audio/opus_codec.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace tutti {
+namespace {
+
+#define REQUIRE_OPUS() \
+    if (!codec_supported(AudioCodec::Opus)) GTEST_SKIP() << "built without TUTTI_ENABLE_OPUS"
+
+AudioFrame tone_frame(uint32_t index) {
+    AudioFrame frame;
+    frame.sequence = index;
+    frame.timestamp = index * kSamplesPerFrame;
+    for (size_t s = 0; s < kSamplesPerFrame; ++s) {
+        double t = static_cast<double>(index * kSamplesPerFrame + s) / kSampleRate;
+        frame.samples[s] = static_cast<int16_t>(8000.0 * std::sin(2.0 * M_PI * 440.0 * t));
+    }
+    return frame;
+}
+
+std::vector<uint8_t> to_datagram(const OpusPacket& pkt, uint32_t seq) {
+    std::vector<uint8_t> buf(kAudioHeaderSize + pkt.payload_len);
+    std::memcpy(buf.data(), &seq, sizeof(seq));
+    std::memcpy(buf.data() + 4, &pkt.timestamp, sizeof(pkt.timestamp));
+    std::memcpy(buf.data() + kAudioHeaderSize, pkt.payload, pkt.payload_len);
+    return buf;
+}
+
+/// 15 mixer frames of tone, encoded: 16 Opus datagrams
+std::vector<std::vector<uint8_t>> encode_tone() {
+    OpusStreamEncoder encoder;
+    std::vector<std::vector<uint8_t>> out;
+    for (uint32_t i = 0; i < 15; ++i) {
+        OpusPacket packets[OpusStreamEncoder::kMaxPacketsPerFrame];
+        size_t n = encoder.encode(tone_frame(i), packets);
+        for (size_t p = 0; p < n; ++p) {
+            out.push_back(to_datagram(packets[p], static_cast<uint32_t>(out.size())));
+        }
+    }
+    return out;
+}
+
+TEST(OpusCodecTest, CodecNames) {
+    EXPECT_EQ(parse_codec("opus"), AudioCodec::Opus);
+    EXPECT_EQ(parse_codec("pcm"), AudioCodec::Pcm);
+    EXPECT_EQ(parse_codec("flac"), AudioCodec::Pcm);
+    EXPECT_STREQ(codec_name(AudioCodec::Opus), "opus");
+    EXPECT_TRUE(codec_supported(AudioCodec::Pcm));
+    EXPECT_FALSE(is_opus_datagram(kAudioHeaderSize));
+    EXPECT_FALSE(is_opus_datagram(kAudioPacketSize));
+}
+
+TEST(OpusCodecTest, EncoderReframesIntoTwoPointFiveMsPackets) {
+    REQUIRE_OPUS();
+    OpusStreamEncoder encoder;
+    size_t total = 0;
+    for (uint32_t i = 0; i < 15; ++i) {
+        OpusPacket packets[OpusStreamEncoder::kMaxPacketsPerFrame];
+        size_t n = encoder.encode(tone_frame(i), packets);
+        EXPECT_EQ(n, i == 14 ? 2u : 1u) << "frame " << i;  // 15 × 128 = 16 × 120
+        for (size_t p = 0; p < n; ++p) {
+            EXPECT_EQ(packets[p].timestamp, (total + p) * kOpusFrameSamples);
+            EXPECT_GT(packets[p].payload_len, 0u);
+            EXPECT_TRUE(is_opus_datagram(kAudioHeaderSize + packets[p].payload_len));
+        }
+        total += n;
+    }
+    EXPECT_EQ(total, 16u);
+}
+
+TEST(OpusCodecTest, DecoderReframesIntoMixerFrames) {
+    REQUIRE_OPUS();
+    auto datagrams = encode_tone();
+    OpusStreamDecoder decoder;
+    std::vector<AudioFrame> frames;
+    for (const auto& d : datagrams) {
+        AudioFrame out[OpusStreamDecoder::kMaxFramesPerPacket];
+        size_t n = decoder.decode(d.data(), d.size(), out);
+        EXPECT_LE(n, 1u);
+        frames.insert(frames.end(), out, out + n);
+    }
+    ASSERT_EQ(frames.size(), 15u);
+    for (size_t i = 0; i < frames.size(); ++i) {
+        EXPECT_EQ(frames[i].sequence, i);
+        EXPECT_EQ(frames[i].timestamp, i * kSamplesPerFrame);
+    }
+    int peak = 0;
+    for (int16_t s : frames.back().samples) peak = std::max(peak, std::abs(static_cast<int>(s)));
+    EXPECT_GT(peak, 1000);  // the tone survives the round trip
+}
+
+TEST(OpusCodecTest, DecoderConcealsShortGapsAndDropsLatePackets) {
+    REQUIRE_OPUS();
+    auto datagrams = encode_tone();
+    OpusStreamDecoder decoder;
+    size_t frames = 0;
+    for (size_t i = 0; i < datagrams.size(); ++i) {
+        if (i == 5) continue;  // lost: concealed when packet 6 arrives
+        AudioFrame out[OpusStreamDecoder::kMaxFramesPerPacket];
+        frames += decoder.decode(datagrams[i].data(), datagrams[i].size(), out);
+    }
+    EXPECT_EQ(frames, 15u);
+
+    AudioFrame out[OpusStreamDecoder::kMaxFramesPerPacket];
+    EXPECT_EQ(decoder.decode(datagrams[5].data(), datagrams[5].size(), out), 0u);
+}
+
+} // namespace
+} // namespace tutti
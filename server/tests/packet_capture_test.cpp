@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "audio/capture_replay.h"
+#include "audio/room.h"
+
+namespace tutti {
+namespace {
+
+std::string temp_path(const char* name) {
+    return "/tmp/tutti-" + std::to_string(::getpid()) + "-" + name + ".tcap";
+}
+
+void send_frame(Room& room, const std::string& id, int16_t value, uint32_t seq) {
+    AudioPacket pkt{};
+    pkt.sequence = seq;
+    pkt.timestamp = seq * kSamplesPerFrame;
+    for (size_t i = 0; i < kSamplesPerFrame; ++i) {
+        pkt.samples[i] = static_cast<int16_t>(value + i);
+    }
+    uint8_t buf[kAudioPacketSize];
+    pkt.serialize(buf);
+    room.on_audio_received(room.slot_of(id), buf, sizeof(buf));
+}
+
+size_t count(const CaptureFile& capture, CaptureEvent kind) {
+    size_t n = 0;
+    for (const auto& e : capture.events) n += e.kind == kind;
+    return n;
+}
+
+TEST(PacketCaptureTest, RecordsAreWrittenInOrder) {
+    const std::string path = temp_path("records");
+    PacketCapture capture;
+    ASSERT_TRUE(capture.start(path, "Allegro", 4));
+    EXPECT_FALSE(capture.start(path, "Allegro", 4));  // already capturing
+
+    int64_t t0 = now_ns();
+    for (uint8_t i = 0; i < 100; ++i) {
+        capture.record(CaptureEvent::Datagram, i % 4, &i, 1, t0 + i);
+    }
+    capture.stop();
+    EXPECT_FALSE(capture.active());
+    EXPECT_EQ(capture.written(), 100u);
+    EXPECT_EQ(capture.dropped(), 0u);
+
+    CaptureFile file;
+    ASSERT_TRUE(file.load(path));
+    EXPECT_EQ(file.room, "Allegro");
+    EXPECT_EQ(file.max_participants, 4u);
+    ASSERT_EQ(file.events.size(), 100u);
+    for (uint8_t i = 0; i < 100; ++i) {
+        EXPECT_EQ(file.events[i].slot, i % 4);
+        ASSERT_EQ(file.events[i].len, 1u);
+        EXPECT_EQ(file.data(file.events[i])[0], i);
+    }
+    std::remove(path.c_str());
+}
+
+TEST(PacketCaptureTest, ConcurrentProducersLoseNothingUnderCapacity) {
+    const std::string path = temp_path("producers");
+    PacketCapture capture;
+    ASSERT_TRUE(capture.start(path, "Presto", 4));
+
+    constexpr int kPerThread = 2000;
+    std::vector<std::thread> producers;
+    for (uint32_t t = 0; t < 4; ++t) {
+        producers.emplace_back([&capture, t] {
+            uint8_t payload[kAudioPacketSize] = {};
+            for (int i = 0; i < kPerThread; ++i) {
+                capture.record(CaptureEvent::Datagram, t, payload, sizeof(payload), now_ns());
+                if (i % 64 == 0) std::this_thread::yield();
+            }
+        });
+    }
+    for (auto& p : producers) p.join();
+    capture.stop();
+
+    EXPECT_EQ(capture.written() + capture.dropped(), 4u * kPerThread);
+    CaptureFile file;
+    ASSERT_TRUE(file.load(path));
+    EXPECT_EQ(file.events.size(), capture.written());
+    std::remove(path.c_str());
+}
+
+TEST(PacketCaptureTest, MissingOrForeignFilesDontLoad) {
+    CaptureFile file;
+    EXPECT_FALSE(file.load(temp_path("missing")));
+
+    const std::string path = temp_path("foreign");
+    std::FILE* f = std::fopen(path.c_str(), "wb");
+    std::fputs("RIFF....WAVEfmt ", f);
+    std::fclose(f);
+    EXPECT_FALSE(file.load(path));
+    std::remove(path.c_str());
+}
+
+TEST(PacketCaptureTest, ReplayReproducesTheRoomsOutput) {
+    const std::string path = temp_path("room");
+    Room room("Largo", 4);
+    std::vector<std::shared_ptr<ReplaySession>> live;
+    std::vector<uint32_t> slots;
+    for (const char* id : {"alice", "bob", "carol"}) {
+        ASSERT_TRUE(room.add_participant(id, id, nullptr));
+        live.push_back(std::make_shared<ReplaySession>(id, true));
+        ASSERT_TRUE(room.attach_session(id, live.back()));
+        slots.push_back(room.slot_of(id).index);
+    }
+    room.set_gain("bob", "alice", 0.5f);  // before the capture: in the snapshot
+
+    ASSERT_TRUE(room.start_capture(path));
+    EXPECT_TRUE(room.capturing());
+    for (uint32_t seq = 0; seq < 40; ++seq) {
+        send_frame(room, "alice", 1000, seq);
+        send_frame(room, "bob", -2000, seq);
+        if (seq != 7) send_frame(room, "carol", 300, seq);  // one frame lost
+        if (seq == 20) room.set_mute("carol", "bob", true);
+        if (seq == 30) room.set_pan("alice", "carol", -0.5f);
+        room.process_cycle();
+    }
+    room.remove_participant("carol");
+    send_frame(room, "alice", 1000, 40);
+    room.stop_capture();
+    EXPECT_FALSE(room.capturing());
+
+    CaptureFile capture;
+    ASSERT_TRUE(capture.load(path));
+    EXPECT_EQ(capture.room, "Largo");
+    EXPECT_EQ(count(capture, CaptureEvent::Join), 3u);
+    EXPECT_EQ(count(capture, CaptureEvent::Bind), 3u);
+    EXPECT_EQ(count(capture, CaptureEvent::Datagram), 120u);
+    EXPECT_EQ(count(capture, CaptureEvent::MixCycle), 40u);
+    EXPECT_EQ(count(capture, CaptureEvent::Gain), 1u);
+    EXPECT_EQ(count(capture, CaptureEvent::Mute), 1u);
+    EXPECT_EQ(count(capture, CaptureEvent::Pan), 1u);
+    EXPECT_EQ(count(capture, CaptureEvent::Leave), 1u);
+
+    Room replayed("Largo", capture.max_participants);
+    CaptureReplay replay(capture, replayed, 0.0, true);
+    CaptureReplay::Result result = replay.run();
+    EXPECT_EQ(result.datagrams, 40u * 3);
+    EXPECT_EQ(result.cycles, 40u);
+    EXPECT_EQ(result.skipped, 0u);
+    EXPECT_EQ(replayed.participant_count(), 2u);
+
+    // Same input, same order: the same bytes out, for everyone
+    for (size_t i = 0; i < live.size(); ++i) {
+        auto replay_session = replay.session(slots[i]);
+        ASSERT_NE(replay_session, nullptr) << live[i]->id();
+        EXPECT_GT(live[i]->sent(), 0u);
+        EXPECT_EQ(replay_session->datagrams(), live[i]->datagrams()) << live[i]->id();
+    }
+    std::remove(path.c_str());
+}
+
+} // namespace
+} // namespace tutti
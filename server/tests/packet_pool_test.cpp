@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "transport/packet_pool.h"
+
+namespace tutti {
+namespace {
+
+TEST(PacketPoolTest, AcquireReleaseRoundTrip) {
+    PacketPool pool(4, 512);
+    uint8_t* a = pool.acquire(264);
+    uint8_t* b = pool.acquire(264);
+    ASSERT_NE(a, nullptr);
+    ASSERT_NE(b, nullptr);
+    EXPECT_NE(a, b);
+    std::memset(a, 0xAB, 512);
+    std::memset(b, 0xCD, 512);
+    EXPECT_EQ(pool.stats().in_use, 2u);
+
+    PacketPool::release(a);
+    PacketPool::release(b);
+    auto stats = pool.stats();
+    EXPECT_EQ(stats.in_use, 0u);
+    EXPECT_EQ(stats.exhausted, 0u);
+}
+
+TEST(PacketPoolTest, ExhaustionFallsBackToHeap) {
+    PacketPool pool(2, 512);
+    uint8_t* a = pool.acquire(264);
+    uint8_t* b = pool.acquire(264);
+    uint8_t* c = pool.acquire(264);  // pool empty → heap
+    ASSERT_NE(c, nullptr);
+    EXPECT_EQ(pool.stats().exhausted, 1u);
+    EXPECT_EQ(pool.stats().in_use, 2u);
+
+    PacketPool::release(c);
+    PacketPool::release(a);
+    EXPECT_NE(pool.acquire(264), nullptr);  // freed block is reusable
+    EXPECT_EQ(pool.stats().exhausted, 1u);
+    PacketPool::release(b);
+}
+
+TEST(PacketPoolTest, OversizedRequestUsesHeap) {
+    PacketPool pool(2, 64);
+    uint8_t* big = pool.acquire(4096);
+    ASSERT_NE(big, nullptr);
+    std::memset(big, 0, 4096);
+    EXPECT_EQ(pool.stats().oversized, 1u);
+    EXPECT_EQ(pool.stats().in_use, 0u);
+    PacketPool::release(big);
+    PacketPool::release(nullptr);  // no-op
+}
+
+TEST(PacketPoolTest, BulkAcquireSpillsToHeap) {
+    PacketPool pool(3, 512);
+    uint8_t* bufs[5];
+    ASSERT_EQ(pool.acquire_bulk(264, bufs, 5), 5u);
+    auto stats = pool.stats();
+    EXPECT_EQ(stats.in_use, 3u);
+    EXPECT_EQ(stats.exhausted, 2u);
+    for (size_t i = 0; i < 5; ++i) {
+        for (size_t j = i + 1; j < 5; ++j) EXPECT_NE(bufs[i], bufs[j]);
+    }
+    for (auto* b : bufs) PacketPool::release(b);
+    EXPECT_EQ(pool.stats().in_use, 0u);
+}
+
+TEST(PacketPoolTest, ConcurrentAcquireRelease) {
+    PacketPool pool(64, 264);
+    constexpr int kThreads = 4;
+    constexpr int kIterations = 20000;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&pool, t] {
+            std::vector<uint8_t*> held;
+            for (int i = 0; i < kIterations; ++i) {
+                uint8_t* p = pool.acquire(264);
+                ASSERT_NE(p, nullptr);
+                p[0] = static_cast<uint8_t>(t);
+                held.push_back(p);
+                if (held.size() == 8) {
+                    for (auto* h : held) {
+                        EXPECT_EQ(h[0], static_cast<uint8_t>(t));
+                        PacketPool::release(h);
+                    }
+                    held.clear();
+                }
+            }
+            for (auto* h : held) PacketPool::release(h);
+        });
+    }
+    for (auto& th : threads) th.join();
+
+    auto stats = pool.stats();
+    EXPECT_EQ(stats.in_use, 0u);
+    EXPECT_EQ(stats.exhausted, 0u);  // 4 threads × 8 held fits in 64 blocks
+}
+
+} // namespace
+} // namespace tutti
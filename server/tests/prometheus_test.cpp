@@ -0,0 +1,42 @@
+#include <gtest/gtest.h>
+
+#include "telemetry/prometheus.h"
+
+namespace tutti {
+namespace {
+
+TEST(PrometheusWriterTest, FamiliesAndLabels) {
+    PrometheusWriter w;
+    w.family("tutti_rooms", "gauge", "Rooms on this server");
+    w.sample("tutti_rooms", {}, uint64_t{16});
+    w.sample("tutti_room_participants", {{"room", "Allegro"}, {"slot", "2"}}, 0.5);
+
+    EXPECT_EQ(w.str(),
+              "# HELP tutti_rooms Rooms on this server\n"
+              "# TYPE tutti_rooms gauge\n"
+              "tutti_rooms 16\n"
+              "tutti_room_participants{room=\"Allegro\",slot=\"2\"} 0.5\n");
+}
+
+TEST(PrometheusWriterTest, EscapesLabelValues) {
+    EXPECT_EQ(PrometheusWriter::escape_label("a\"b\\c\nd"), "a\\\"b\\\\c\\nd");
+}
+
+TEST(PrometheusWriterTest, HistogramBucketsAreCumulative) {
+    LatencyHistogram h;
+    h.record(500);      // <=1us
+    h.record(1500);     // <=2us
+    h.record(1800);     // <=2us
+    PrometheusWriter w;
+    w.histogram("mix_seconds", {{"room", "A"}}, h.snapshot());
+    const std::string& out = w.str();
+
+    EXPECT_NE(out.find("mix_seconds_bucket{room=\"A\",le=\"1e-06\"} 1\n"), std::string::npos);
+    EXPECT_NE(out.find("mix_seconds_bucket{room=\"A\",le=\"2e-06\"} 3\n"), std::string::npos);
+    EXPECT_NE(out.find("mix_seconds_bucket{room=\"A\",le=\"+Inf\"} 3\n"), std::string::npos);
+    EXPECT_NE(out.find("mix_seconds_sum{room=\"A\"} 3.8e-06\n"), std::string::npos);
+    EXPECT_NE(out.find("mix_seconds_count{room=\"A\"} 3\n"), std::string::npos);
+}
+
+} // namespace
+} // namespace tutti
@@ -0,0 +1,170 @@
+#include <gtest/gtest.h>
+
+#include "rooms/room_directory.h"
+
+namespace tutti {
+namespace {
+
+using Clock = RoomDirectory::Clock;
+using std::chrono::seconds;
+
+NodeReport make_report(const std::string& id, std::vector<NodeRoom> rooms = {}) {
+    NodeReport report;
+    report.node.id = id;
+    report.node.region = "region-" + id;
+    report.node.api_url = "http://" + id + ":8080";
+    report.node.wt_url = "https://" + id + ":4433/wt";
+    report.rooms = std::move(rooms);
+    return report;
+}
+
+class RoomDirectoryTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        directory_.report(make_report("eu"), t0_);
+        directory_.report(make_report("us"), t0_);
+        directory_.report(make_report("ap"), t0_);
+    }
+
+    RoomDirectory directory_;
+    Clock::time_point t0_ = Clock::now();
+};
+
+TEST_F(RoomDirectoryTest, PlacesNearestNodeForFirstMember) {
+    auto owner = directory_.place("Allegro", "ana", {{"eu", 20}, {"us", 90}, {"ap", 250}}, t0_);
+    ASSERT_TRUE(owner);
+    EXPECT_EQ(owner->id, "eu");
+    EXPECT_EQ(owner->wt_url, "https://eu:4433/wt");
+}
+
+TEST_F(RoomDirectoryTest, PlacementMinimisesWorstMemberRtt) {
+    RoomDirectory directory;
+    directory.report(make_report("eu"), t0_);
+    directory.report(make_report("us"), t0_);
+
+    // ana's first visit lands on eu; the room empties and is released
+    directory.set_draining("us", true, t0_);
+    directory.place("Brio", "ana", {{"eu", 10}, {"us", 80}}, t0_);
+    directory.report(make_report("us"), t0_ + seconds(5));
+    directory.report(make_report("eu", {{"Brio", 1, 4, false}}), t0_ + seconds(5));
+    auto later = t0_ + RoomDirectory::kPlacementHold;
+    directory.report(make_report("eu", {{"Brio", 0, 4, false}}), later);
+    directory.report(make_report("us"), later);
+    directory.set_draining("us", false, later);
+    EXPECT_FALSE(directory.owner("Brio", later));
+
+    // bob is far from eu: us is worst-case 80 ms for the pair, eu 150 ms
+    auto owner = directory.place("Brio", "bob", {{"eu", 150}, {"us", 60}}, later);
+    ASSERT_TRUE(owner);
+    EXPECT_EQ(owner->id, "us");
+}
+
+TEST_F(RoomDirectoryTest, StaysWithOwnerUntilReportedEmpty) {
+    directory_.place("Con Fuoco", "ana", {{"us", 30}}, t0_);
+    auto owner = directory_.place("Con Fuoco", "bob", {{"ap", 5}, {"us", 200}}, t0_ + seconds(1));
+    ASSERT_TRUE(owner);
+    EXPECT_EQ(owner->id, "us");
+
+    // Occupied: reports don't release it
+    directory_.report(make_report("us", {{"Con Fuoco", 2, 4, false}}), t0_ + seconds(8));
+    directory_.report(make_report("us", {{"Con Fuoco", 2, 4, false}}), t0_ + seconds(12));
+    ASSERT_TRUE(directory_.owner("Con Fuoco", t0_ + seconds(12)));
+
+    directory_.report(make_report("us", {{"Con Fuoco", 0, 4, false}}), t0_ + seconds(14));
+    EXPECT_FALSE(directory_.owner("Con Fuoco", t0_ + seconds(14)));
+}
+
+TEST_F(RoomDirectoryTest, EmptyReportWithinHoldKeepsPlacement) {
+    // The owner's next heartbeat may predate the proxied join
+    directory_.place("Dolce", "ana", {{"ap", 30}}, t0_);
+    directory_.report(make_report("ap", {{"Dolce", 0, 4, false}}), t0_ + seconds(1));
+    auto owner = directory_.owner("Dolce", t0_ + seconds(1));
+    ASSERT_TRUE(owner);
+    EXPECT_EQ(owner->id, "ap");
+}
+
+TEST_F(RoomDirectoryTest, DrainingNodeGetsNoNewRooms) {
+    ASSERT_TRUE(directory_.set_draining("eu", true, t0_));
+    auto owner = directory_.place("Espressivo", "ana", {{"eu", 10}, {"us", 90}}, t0_);
+    ASSERT_TRUE(owner);
+    EXPECT_EQ(owner->id, "us");
+
+    for (const auto& status : directory_.nodes(t0_)) {
+        EXPECT_EQ(status.draining, status.node.id == "eu");
+    }
+    EXPECT_FALSE(directory_.set_draining("nowhere", true, t0_));
+}
+
+TEST_F(RoomDirectoryTest, NoPlacementWhenAllDraining) {
+    for (const char* id : {"eu", "us", "ap"}) directory_.set_draining(id, true, t0_);
+    EXPECT_FALSE(directory_.place("Forte", "ana", {}, t0_));
+}
+
+TEST_F(RoomDirectoryTest, SilentNodeExpiresAndFreesRooms) {
+    directory_.place("Giocoso", "ana", {{"ap", 10}, {"eu", 100}}, t0_);
+    // Only eu keeps reporting
+    auto later = t0_ + RoomDirectory::kNodeTimeout + seconds(1);
+    directory_.report(make_report("eu"), later);
+    EXPECT_FALSE(directory_.owner("Giocoso", later));
+    ASSERT_EQ(directory_.nodes(later).size(), 1u);
+
+    auto owner = directory_.place("Giocoso", "ana", {{"ap", 10}, {"eu", 100}}, later);
+    ASSERT_TRUE(owner);
+    EXPECT_EQ(owner->id, "eu");
+}
+
+TEST_F(RoomDirectoryTest, UnmeasuredNodesFallBackToLoad) {
+    directory_.report(make_report("eu", {{"Largo", 3, 4, false}}), t0_);
+    directory_.report(make_report("ap", {{"Lento", 1, 4, false}}), t0_);
+    auto owner = directory_.place("Maestoso", "ana", {}, t0_);
+    ASSERT_TRUE(owner);
+    EXPECT_EQ(owner->id, "us");
+}
+
+TEST_F(RoomDirectoryTest, RejoiningMemberReplacesOldRtts) {
+    RoomDirectory directory;
+    directory.report(make_report("eu"), t0_);
+    directory.report(make_report("us"), t0_);
+    directory.set_draining("us", true, t0_);
+    directory.place("Presto", "ana", {{"eu", 10}, {"us", 500}}, t0_);
+    directory.report(make_report("us"), t0_ + seconds(5));
+    directory.report(make_report("eu", {{"Presto", 1, 4, false}}), t0_ + seconds(5));
+    directory.report(make_report("eu", {{"Presto", 0, 4, false}}), t0_ + seconds(11));
+    directory.set_draining("us", false, t0_ + seconds(11));
+    directory.report(make_report("us"), t0_ + seconds(11));
+
+    // Same alias, new measurements: the 500 ms sample is forgotten
+    auto owner = directory.place("Presto", "ana", {{"eu", 90}, {"us", 20}}, t0_ + seconds(11));
+    ASSERT_TRUE(owner);
+    EXPECT_EQ(owner->id, "us");
+}
+
+TEST_F(RoomDirectoryTest, OwnedRoomsReportOwnerOccupancy) {
+    directory_.place("Rubato", "ana", {{"us", 10}}, t0_);
+    directory_.report(make_report("us", {{"Rubato", 2, 4, true}}), t0_ + seconds(1));
+    auto owned = directory_.owned_rooms(t0_ + seconds(1));
+    ASSERT_EQ(owned.size(), 1u);
+    EXPECT_EQ(owned[0].node_id, "us");
+    EXPECT_EQ(owned[0].room.participant_count, 2u);
+    EXPECT_TRUE(owned[0].room.claimed);
+}
+
+TEST(RoomDirectoryReportTest, SerializeParseRoundTrip) {
+    NodeReport report = make_report("eu", {{"Allegro", 2, 4, true}, {"Brio", 0, 4, false}});
+    report.node.cert_hash = "abc=";
+    NodeReport parsed;
+    ASSERT_TRUE(parse_report(serialize_report(report, "s3cret"), parsed));
+    EXPECT_EQ(parsed.node.id, "eu");
+    EXPECT_EQ(parsed.node.api_url, "http://eu:8080");
+    EXPECT_EQ(parsed.node.cert_hash, "abc=");
+    ASSERT_EQ(parsed.rooms.size(), 2u);
+    EXPECT_EQ(parsed.rooms[0].name, "Allegro");
+    EXPECT_EQ(parsed.rooms[0].participant_count, 2u);
+    EXPECT_TRUE(parsed.rooms[0].claimed);
+
+    EXPECT_FALSE(parse_report("not json", parsed));
+    EXPECT_FALSE(parse_report(R"({"region":"x"})", parsed));
+}
+
+} // namespace
+} // namespace tutti
@@ -0,0 +1,504 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "audio/room.h"
+
+namespace tutti {
+namespace {
+
+/// Transport session that keeps every datagram it is asked to send
+class CapturingSession : public TransportSession {
+public:
+    explicit CapturingSession(std::string id) : id_(std::move(id)) {}
+    bool send_datagram(const uint8_t* data, size_t len) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        AudioPacket pkt = AudioPacket::deserialize(data, len);
+        if (len == kAudioHeaderSize) {  // silence marker
+            std::memcpy(&pkt.sequence, data, sizeof(pkt.sequence));
+            std::memcpy(&pkt.timestamp, data + 4, sizeof(pkt.timestamp));
+        }
+        packets_.push_back(pkt);
+        datagrams_.emplace_back(data, data + len);
+        return true;
+    }
+    bool send_reliable(const std::string&) override { return true; }
+    void close() override {}
+    std::string id() const override { return id_; }
+    std::string remote_address() const override { return "test"; }
+    bool is_connected() const override { return true; }
+
+    std::vector<AudioPacket> packets() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return packets_;
+    }
+
+    std::vector<size_t> sizes() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<size_t> out;
+        for (const auto& d : datagrams_) out.push_back(d.size());
+        return out;
+    }
+
+    std::vector<std::vector<uint8_t>> datagrams() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return datagrams_;
+    }
+
+private:
+    std::string id_;
+    std::mutex mutex_;
+    std::vector<AudioPacket> packets_;
+    std::vector<std::vector<uint8_t>> datagrams_;
+};
+
+/// Reads the room back from inside send_reliable, as a transport callback
+/// might, noting the participant count each control message arrived with
+class ReentrantSession : public TransportSession {
+public:
+    ReentrantSession(std::string id, Room& room) : id_(std::move(id)), room_(room) {}
+    bool send_datagram(const uint8_t*, size_t) override { return true; }
+    bool send_reliable(const std::string& msg) override {
+        messages.push_back(msg);
+        counts.push_back(room_.get_participants().size());
+        return true;
+    }
+    void close() override {}
+    std::string id() const override { return id_; }
+    std::string remote_address() const override { return "test"; }
+    bool is_connected() const override { return true; }
+
+    std::vector<std::string> messages;
+    std::vector<size_t> counts;
+
+private:
+    std::string id_;
+    Room& room_;
+};
+
+void send_frame(Room& room, const std::string& id, int16_t value, uint32_t seq) {
+    AudioPacket pkt{};
+    pkt.sequence = seq;
+    pkt.timestamp = seq * kSamplesPerFrame;
+    for (auto& s : pkt.samples) s = value;
+    uint8_t buf[kAudioPacketSize];
+    pkt.serialize(buf);
+    room.on_audio_received(room.slot_of(id), buf, sizeof(buf));
+}
+
+void send_stereo_frame(Room& room, const std::string& id, int16_t left, int16_t right, uint32_t seq) {
+    AudioPacket pkt{};
+    pkt.sequence = seq;
+    pkt.timestamp = seq * kSamplesPerFrame;
+    pkt.channels = 2;
+    for (size_t i = 0; i < kSamplesPerFrame; ++i) {
+        pkt.samples[2 * i] = left;
+        pkt.samples[2 * i + 1] = right;
+    }
+    uint8_t buf[kMaxAudioPacketSize];
+    pkt.serialize(buf);
+    room.on_audio_received(room.slot_of(id), buf, sizeof(buf));
+}
+
+void send_marker(Room& room, const std::string& id, uint32_t seq) {
+    uint8_t buf[kAudioHeaderSize];
+    uint32_t timestamp = seq * kSamplesPerFrame;
+    std::memcpy(buf, &seq, sizeof(seq));
+    std::memcpy(buf + 4, &timestamp, sizeof(timestamp));
+    room.on_audio_received(room.slot_of(id), buf, sizeof(buf));
+}
+
+class RoomTest : public ::testing::Test {
+protected:
+    std::shared_ptr<CapturingSession> join(const std::string& id) {
+        auto session = std::make_shared<CapturingSession>(id);
+        EXPECT_TRUE(room_.add_participant(id, id, session));
+        return session;
+    }
+
+    Room room_{"Minuetto", 4};
+};
+
+TEST_F(RoomTest, TwoPartyForwardsWithOwnSequenceAndGain) {
+    auto alice = join("alice");
+    auto bob = join("bob");
+
+    send_frame(room_, "alice", 1000, 77);
+    room_.set_gain("bob", "alice", 0.5f);
+    send_frame(room_, "alice", 1000, 78);
+
+    auto got = bob->packets();
+    ASSERT_EQ(got.size(), 2u);
+    EXPECT_EQ(got[0].sequence, 0u);  // listener's output sequence, not the sender's
+    EXPECT_EQ(got[0].samples[0], 1000);
+    EXPECT_EQ(got[1].sequence, 1u);
+    EXPECT_EQ(got[1].samples[0], 500);
+    EXPECT_TRUE(alice->packets().empty());
+
+    room_.set_mute("bob", "alice", true);
+    send_frame(room_, "alice", 1000, 79);
+    EXPECT_EQ(bob->packets().size(), 2u);
+}
+
+TEST_F(RoomTest, SingleSourceListenersBypassTheMixer) {
+    auto teacher = join("teacher");
+    std::vector<std::shared_ptr<CapturingSession>> students;
+    for (const char* id : {"s1", "s2", "s3"}) students.push_back(join(id));
+
+    // Students hear only the teacher; the teacher hears everyone
+    for (const char* listener : {"s1", "s2", "s3"}) {
+        for (const char* source : {"s1", "s2", "s3"}) {
+            if (std::string(listener) != source) room_.set_mute(listener, source, true);
+        }
+    }
+
+    send_frame(room_, "teacher", 3000, 0);
+    for (auto& s : students) {
+        auto got = s->packets();
+        ASSERT_EQ(got.size(), 1u);  // forwarded on arrival, before any mix
+        EXPECT_EQ(got[0].samples[0], 3000);
+    }
+
+    send_frame(room_, "s1", 100, 0);
+    send_frame(room_, "s2", 200, 0);
+    send_frame(room_, "s3", 300, 0);
+    room_.process_cycle();
+
+    // Only the teacher gets a mix
+    auto mix = teacher->packets();
+    ASSERT_EQ(mix.size(), 1u);
+    EXPECT_EQ(mix[0].samples[0], 600);
+    for (auto& s : students) EXPECT_EQ(s->packets().size(), 1u);
+}
+
+TEST_F(RoomTest, ThirdJoinerSwitchesToTheMixer) {
+    auto alice = join("alice");
+    auto bob = join("bob");
+    join("carol");
+
+    send_frame(room_, "alice", 1000, 0);
+    EXPECT_TRUE(bob->packets().empty());  // bob now hears two sources
+
+    room_.remove_participant("carol");
+    send_frame(room_, "alice", 1000, 1);
+    EXPECT_EQ(bob->packets().size(), 1u);
+}
+
+TEST_F(RoomTest, TwoPartySilenceIsSentAsMarkers) {
+    join("alice");
+    auto bob = join("bob");
+
+    send_frame(room_, "alice", 1000, 0);
+    send_frame(room_, "alice", 0, 1);  // digital silence gates at once
+    send_marker(room_, "alice", 2);    // client-side marker
+    room_.set_silence_markers(false);
+    send_frame(room_, "alice", 0, 3);
+
+    auto sizes = bob->sizes();
+    auto got = bob->packets();
+    ASSERT_EQ(sizes.size(), 4u);
+    EXPECT_EQ(sizes[0], kAudioPacketSize);
+    EXPECT_EQ(sizes[1], kAudioHeaderSize);
+    EXPECT_EQ(sizes[2], kAudioHeaderSize);
+    EXPECT_EQ(got[2].sequence, 2u);
+    EXPECT_EQ(got[2].timestamp, 2 * kSamplesPerFrame);
+    EXPECT_EQ(sizes[3], kAudioPacketSize);  // markers off: full zero frame
+    EXPECT_EQ(got[3].samples[0], 0);
+}
+
+TEST_F(RoomTest, MixerSkipsSilentSources) {
+    auto alice = join("alice");
+    auto bob = join("bob");
+    auto carol = join("carol");
+
+    send_frame(room_, "alice", 1000, 0);
+    send_frame(room_, "bob", 0, 0);
+    send_marker(room_, "carol", 0);
+    room_.process_cycle();
+
+    // Bob and Carol hear only Alice; Alice hears two resting players
+    for (auto& s : {bob, carol}) {
+        ASSERT_EQ(s->sizes().size(), 1u);
+        EXPECT_EQ(s->sizes()[0], kAudioPacketSize);
+        EXPECT_EQ(s->packets()[0].samples[0], 1000);
+    }
+    ASSERT_EQ(alice->sizes().size(), 1u);
+    EXPECT_EQ(alice->sizes()[0], kAudioHeaderSize);
+
+    auto metrics = room_.audio_metrics();
+    for (const auto& p : metrics.participants) {
+        EXPECT_EQ(p.counters.silent_packets, p.id == "alice" ? 0u : 1u) << p.id;
+    }
+}
+
+TEST_F(RoomTest, OpusToOpusForwardsUntouched) {
+    if (!codec_supported(AudioCodec::Opus)) GTEST_SKIP() << "built without TUTTI_ENABLE_OPUS";
+    join("alice");
+    auto bob = join("bob");
+    ASSERT_TRUE(room_.attach_session("alice", std::make_shared<CapturingSession>("alice"),
+                                     nullptr, AudioCodec::Opus));
+    ASSERT_TRUE(room_.attach_session("bob", bob, nullptr, AudioCodec::Opus));
+    EXPECT_FALSE(room_.needs_mixing());
+
+    std::vector<uint8_t> pkt(kAudioHeaderSize + 40, 0xAB);
+    uint32_t seq = 500;
+    std::memcpy(pkt.data(), &seq, sizeof(seq));
+    room_.on_audio_received(room_.slot_of("alice"), pkt.data(), pkt.size());
+
+    auto got = bob->datagrams();
+    ASSERT_EQ(got.size(), 1u);
+    ASSERT_EQ(got[0].size(), pkt.size());
+    EXPECT_TRUE(std::equal(pkt.begin() + 4, pkt.end(), got[0].begin() + 4));
+    uint32_t out_seq;
+    std::memcpy(&out_seq, got[0].data(), sizeof(out_seq));
+    EXPECT_EQ(out_seq, 0u);
+
+    // A gain can't be applied to Opus in passing: bob moves to the mixer
+    room_.set_gain("bob", "alice", 0.5f);
+    EXPECT_TRUE(room_.needs_mixing());
+}
+
+TEST_F(RoomTest, PcmRejectsOpusAndMixedCodecsNeedMixing) {
+    join("alice");
+    auto bob = join("bob");
+    EXPECT_FALSE(room_.needs_mixing());
+
+    // Opus-sized datagrams from a PCM session are dropped
+    std::vector<uint8_t> pkt(kAudioHeaderSize + 40, 0);
+    room_.on_audio_received(room_.slot_of("alice"), pkt.data(), pkt.size());
+    EXPECT_TRUE(bob->sizes().empty());
+
+    if (!codec_supported(AudioCodec::Opus)) {
+        EXPECT_FALSE(room_.attach_session("bob", bob, nullptr, AudioCodec::Opus));
+        return;
+    }
+    ASSERT_TRUE(room_.attach_session("bob", bob, nullptr, AudioCodec::Opus));
+    EXPECT_EQ(room_.codec_of("bob"), AudioCodec::Opus);
+    send_frame(room_, "alice", 1000, 0);
+    EXPECT_TRUE(room_.needs_mixing());  // PCM alice → Opus bob is transcoded
+}
+
+TEST_F(RoomTest, RoomTotalListenersShareOneEncode) {
+    if (!codec_supported(AudioCodec::Opus)) GTEST_SKIP() << "built without TUTTI_ENABLE_OPUS";
+    join("alice");
+    join("bob");
+    auto carol = join("carol");
+    auto dave = join("dave");
+    ASSERT_TRUE(room_.attach_session("carol", carol, nullptr, AudioCodec::Opus));
+    ASSERT_TRUE(room_.attach_session("dave", dave, nullptr, AudioCodec::Opus));
+
+    // Carol and Dave only listen, at unity gain: both hear exactly alice + bob
+    for (uint32_t seq = 0; seq < 3; ++seq) {
+        send_frame(room_, "alice", 1000, seq);
+        send_frame(room_, "bob", 2000, seq);
+        room_.process_cycle();
+    }
+
+    auto c = carol->datagrams();
+    auto d = dave->datagrams();
+    ASSERT_EQ(c.size(), 3u);
+    ASSERT_EQ(d.size(), c.size());
+    for (size_t i = 0; i < c.size(); ++i) {
+        EXPECT_TRUE(is_opus_datagram(c[i].size()));
+        EXPECT_EQ(c[i], d[i]);  // same sequence, timestamp and payload
+    }
+}
+
+TEST_F(RoomTest, StereoPairsForwardAndMonoListenersHearADownmix) {
+    auto alice = join("alice");
+    auto bob = join("bob");
+    ASSERT_TRUE(room_.attach_session("alice", alice, nullptr, AudioCodec::Pcm, 2));
+    EXPECT_FALSE(room_.attach_session("bob", bob, nullptr, AudioCodec::Opus, 2));
+    EXPECT_FALSE(room_.needs_mixing());  // nobody is playing yet
+
+    send_stereo_frame(room_, "alice", 3000, 1000, 0);
+    EXPECT_TRUE(room_.needs_mixing());  // stereo alice → mono bob is downmixed
+    send_frame(room_, "alice", 3000, 1);  // mono frame from a stereo session: dropped
+    room_.process_cycle();
+    ASSERT_EQ(bob->sizes().size(), 1u);
+    EXPECT_EQ(bob->sizes()[0], kAudioPacketSize);
+    EXPECT_EQ(bob->packets()[0].samples[0], 2000);
+
+    // Stereo to stereo is forwarded as sent, until a pan needs mixing
+    ASSERT_TRUE(room_.attach_session("bob", bob, nullptr, AudioCodec::Pcm, 2));
+    EXPECT_FALSE(room_.needs_mixing());
+    send_stereo_frame(room_, "alice", 3000, 1000, 2);
+    ASSERT_EQ(bob->sizes().size(), 2u);
+    EXPECT_EQ(bob->sizes()[1], kMaxAudioPacketSize);
+    EXPECT_EQ(bob->packets()[1].samples[0], 3000);
+    EXPECT_EQ(bob->packets()[1].samples[1], 1000);
+
+    room_.set_pan("bob", "alice", 0.5f);
+    EXPECT_TRUE(room_.needs_mixing());
+}
+
+TEST(RoomSeatsTest, OversizedRoomsAreClampedToTheMixer) {
+    Room big("Tutti", 40);
+    EXPECT_EQ(big.max_participants(), Room::kMaxParticipants);
+    for (size_t i = 0; i < Room::kMaxParticipants; ++i) {
+        const std::string id = "p" + std::to_string(i);
+        ASSERT_TRUE(big.add_participant(id, id, nullptr));
+    }
+    EXPECT_TRUE(big.is_full());
+    for (size_t i = 0; i < Room::kListenOnlySeats; ++i) {
+        const std::string id = "a" + std::to_string(i);
+        ASSERT_TRUE(big.add_participant(id, id, nullptr, true));  // every listen-only seat is left
+    }
+}
+
+TEST_F(RoomTest, ListenOnlySeatsHearTheRoomBeyondCapacity) {
+    std::vector<std::shared_ptr<CapturingSession>> players;
+    for (const char* id : {"p1", "p2", "p3", "p4"}) players.push_back(join(id));
+    EXPECT_TRUE(room_.is_full());
+    EXPECT_FALSE(room_.add_participant("late", "late", nullptr));
+
+    std::vector<std::shared_ptr<CapturingSession>> audience;
+    for (const char* id : {"a1", "a2"}) {
+        audience.push_back(std::make_shared<CapturingSession>(id));
+        ASSERT_TRUE(room_.add_participant(id, id, audience.back(), true));
+    }
+    EXPECT_EQ(room_.participant_count(), 4u);
+    EXPECT_EQ(room_.listener_count(), 2u);
+
+    // What the audience sends goes nowhere
+    send_frame(room_, "a1", 5000, 0);
+    for (size_t i = 0; i < players.size(); ++i) {
+        send_frame(room_, "p" + std::to_string(i + 1), 100, 0);
+    }
+    room_.process_cycle();
+
+    for (auto& a : audience) {
+        auto got = a->packets();
+        ASSERT_EQ(got.size(), 1u);
+        EXPECT_EQ(got[0].samples[0], 400);
+    }
+    for (auto& p : players) {
+        auto got = p->packets();
+        ASSERT_EQ(got.size(), 1u);
+        EXPECT_EQ(got[0].samples[0], 300);
+    }
+}
+
+TEST_F(RoomTest, ControlMessagesAreSentOutsideTheParticipantsLock) {
+    auto alice = std::make_shared<ReentrantSession>("alice", room_);
+    ASSERT_TRUE(room_.add_participant("alice", "alice", alice));
+    join("bob");
+    ASSERT_TRUE(room_.attach_session("alice", alice));
+    room_.remove_participant("bob");
+
+    ASSERT_EQ(alice->messages.size(), 4u);
+    EXPECT_NE(alice->messages[0].find(R"("type":"room_state")"), std::string::npos);
+    EXPECT_NE(alice->messages[1].find(R"("type":"participant_joined")"), std::string::npos);
+    EXPECT_NE(alice->messages[2].find(R"("id":"bob")"), std::string::npos);  // the roster
+    EXPECT_NE(alice->messages[3].find(R"("type":"participant_left")"), std::string::npos);
+    EXPECT_EQ(alice->counts, (std::vector<size_t>{1, 2, 2, 1}));
+}
+
+TEST_F(RoomTest, RoutesFollowGainsAcrossZeroAndUnity) {
+    auto alice = join("alice");
+    auto bob = join("bob");
+
+    // Fader moves short of zero keep the direct route, at the new gain
+    room_.set_gain("bob", "alice", 0.5f);
+    room_.set_gain("bob", "alice", 0.25f);
+    send_frame(room_, "alice", 1000, 0);
+    ASSERT_EQ(bob->packets().size(), 1u);
+    EXPECT_EQ(bob->packets()[0].samples[0], 250);
+
+    room_.set_gain("bob", "alice", 0.0f);
+    send_frame(room_, "alice", 1000, 1);
+    EXPECT_EQ(bob->packets().size(), 1u);  // nothing audible
+
+    room_.set_gain("bob", "alice", 0.75f);
+    send_frame(room_, "alice", 1000, 2);
+    ASSERT_EQ(bob->packets().size(), 2u);
+    EXPECT_EQ(bob->packets()[1].samples[0], 750);
+
+    room_.set_mute("bob", "alice", true);
+    room_.set_mute("bob", "alice", true);
+    room_.set_mute("bob", "alice", false);
+    send_frame(room_, "alice", 1000, 3);
+    EXPECT_EQ(bob->packets().size(), 3u);
+
+    // Stereo listeners: only moving off or back to centre switches routes
+    ASSERT_TRUE(room_.attach_session("alice", alice, nullptr, AudioCodec::Pcm, 2));
+    ASSERT_TRUE(room_.attach_session("bob", bob, nullptr, AudioCodec::Pcm, 2));
+    EXPECT_FALSE(room_.needs_mixing());
+    room_.set_pan("bob", "alice", 0.5f);
+    room_.set_pan("bob", "alice", -0.25f);
+    EXPECT_TRUE(room_.needs_mixing());
+    room_.set_pan("bob", "alice", 0.0f);
+    EXPECT_FALSE(room_.needs_mixing());
+}
+
+TEST_F(RoomTest, LeaveDuringForwardingIsSafe) {
+    join("alice");
+    join("bob");
+
+    std::atomic<bool> stop{false};
+    std::thread sender([&] {
+        for (uint32_t seq = 0; !stop; ++seq) send_frame(room_, "alice", 1, seq);
+    });
+    for (int i = 0; i < 50; ++i) {
+        room_.remove_participant("bob");
+        room_.add_participant("bob", "bob", std::make_shared<CapturingSession>("bob"));
+    }
+    stop = true;
+    sender.join();
+}
+
+TEST_F(RoomTest, ListenOnlySeatHearsSilenceWhileTheRoomRests) {
+    for (const char* id : {"alice", "bob", "carol"}) join(id);
+    auto seat = std::make_shared<CapturingSession>("seat");
+    ASSERT_TRUE(room_.add_participant("seat", "seat", seat, true));
+
+    // A long rest: the room is parked, and each frame period the seat
+    // gets one marker (from its lowest source) instead of a mix
+    for (uint32_t seq = 0; seq < 200; ++seq) {
+        for (const char* id : {"alice", "bob", "carol"}) send_marker(room_, id, seq);
+        EXPECT_FALSE(room_.needs_mixing());
+    }
+    auto sizes = seat->sizes();
+    ASSERT_EQ(sizes.size(), 200u);
+    for (size_t size : sizes) EXPECT_EQ(size, kAudioHeaderSize);
+    EXPECT_EQ(room_.reap_stale_participants(), 0u);
+
+    // Playing again brings the mix back
+    send_frame(room_, "alice", 1000, 200);
+    EXPECT_TRUE(room_.needs_mixing());
+    room_.process_cycle();
+    ASSERT_EQ(seat->packets().size(), 201u);
+    EXPECT_EQ(seat->packets().back().samples[0], 1000);
+}
+
+TEST_F(RoomTest, LeaveDuringMixingIsSafe) {
+    join("alice");
+    join("bob");
+    join("carol");
+
+    // The mixer sends from the published routes, outside the lock that
+    // leaving takes
+    std::atomic<bool> stop{false};
+    std::thread mixer([&] {
+        for (uint32_t seq = 0; !stop; ++seq) {
+            send_frame(room_, "alice", 1000, seq);
+            send_frame(room_, "bob", 1000, seq);
+            room_.process_cycle();
+        }
+    });
+    for (int i = 0; i < 50; ++i) {
+        room_.remove_participant("carol");
+        room_.add_participant("carol", "carol", std::make_shared<CapturingSession>("carol"));
+    }
+    stop = true;
+    mixer.join();
+}
+
+} // namespace
+} // namespace tutti
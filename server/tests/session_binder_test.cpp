@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+
+#include "rooms/room_manager.h"
+#include "rooms/room_names.h"
+#include "transport/session_binder.h"
+
+namespace tutti {
+namespace {
+
+/// Transport session that only counts outgoing datagrams
+class CountingSession : public TransportSession {
+public:
+    explicit CountingSession(std::string id) : id_(std::move(id)) {}
+    bool send_datagram(const uint8_t*, size_t) override {
+        datagrams++;
+        return true;
+    }
+    bool send_reliable(const std::string&) override { return true; }
+    void close() override {}
+    std::string id() const override { return id_; }
+    std::string remote_address() const override { return "test"; }
+    bool is_connected() const override { return true; }
+
+    std::atomic<int> datagrams{0};
+
+private:
+    std::string id_;
+};
+
+class SessionBinderTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        manager_ = std::make_shared<RoomManager>(4);
+        manager_->initialize_default_rooms();
+        binder_ = std::make_unique<SessionBinder>(manager_);
+        callbacks_ = binder_->make_callbacks();
+    }
+
+    void TearDown() override { manager_->stop_mixers(); }
+
+    /// Join the first default room (as POST /join would), then open and
+    /// bind a transport session for the new participant
+    std::shared_ptr<CountingSession> join_and_bind(const std::string& alias) {
+        std::string participant_id;
+        manager_->join_room(kRoom, alias, "", nullptr, participant_id);
+        auto session = std::make_shared<CountingSession>("session-" + alias);
+        callbacks_.on_session_open(session);
+        callbacks_.on_message(session.get(),
+                              R"({"type":"bind","participant_id":")" + participant_id +
+                                  R"(","room":")" + kRoom + R"("})");
+        return session;
+    }
+
+    const std::string kRoom = kDefaultRooms[0].name;
+    std::shared_ptr<RoomManager> manager_;
+    std::unique_ptr<SessionBinder> binder_;
+    TransportCallbacks callbacks_;
+};
+
+TEST_F(SessionBinderTest, BoundDatagramReachesRoom) {
+    auto alice = join_and_bind("alice");
+    auto bob = join_and_bind("bob");
+
+    AudioPacket pkt{};
+    uint8_t buf[kAudioPacketSize];
+    pkt.serialize(buf);
+
+    // 2 participants: the room forwards Alice's packet straight to Bob
+    callbacks_.on_datagram(alice.get(), buf, sizeof(buf));
+    EXPECT_EQ(bob->datagrams.load(), 1);
+    EXPECT_EQ(alice->datagrams.load(), 0);
+}
+
+TEST_F(SessionBinderTest, UnboundAndClosedSessionsAreDropped) {
+    auto alice = join_and_bind("alice");
+    auto bob = join_and_bind("bob");
+
+    AudioPacket pkt{};
+    uint8_t buf[kAudioPacketSize];
+    pkt.serialize(buf);
+
+    auto stranger = std::make_shared<CountingSession>("stranger");
+    callbacks_.on_session_open(stranger);
+    callbacks_.on_datagram(stranger.get(), buf, sizeof(buf));
+    EXPECT_EQ(alice->datagrams.load() + bob->datagrams.load(), 0);
+
+    callbacks_.on_session_close(alice.get());
+    callbacks_.on_datagram(alice.get(), buf, sizeof(buf));
+    EXPECT_EQ(bob->datagrams.load(), 0);
+}
+
+TEST_F(SessionBinderTest, CountsSessionsByTransport) {
+    join_and_bind("alice");
+    auto pending = std::make_shared<CountingSession>("session-pending");
+    callbacks_.on_session_open(pending);
+
+    auto counts = binder_->session_counts();
+    ASSERT_EQ(counts.size(), 1u);
+    EXPECT_EQ(counts[0].transport, "unknown");
+    EXPECT_EQ(counts[0].pending, 1u);
+    EXPECT_EQ(counts[0].bound, 1u);
+}
+
+} // namespace
+} // namespace tutti
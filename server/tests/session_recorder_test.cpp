@@ -0,0 +1,194 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#include "audio/room.h"
+#include "rooms/room_manager.h"
+
+namespace tutti {
+namespace {
+
+class SilentSession : public TransportSession {
+public:
+    explicit SilentSession(std::string id) : id_(std::move(id)) {}
+    bool send_datagram(const uint8_t*, size_t) override { return true; }
+    bool send_reliable(const std::string& msg) override {
+        messages.push_back(msg);
+        return true;
+    }
+    void close() override {}
+    std::string id() const override { return id_; }
+    std::string remote_address() const override { return "test"; }
+    bool is_connected() const override { return true; }
+
+    std::vector<std::string> messages;
+
+private:
+    std::string id_;
+};
+
+struct Wav {
+    uint16_t channels = 0;
+    uint32_t rate = 0;
+    std::vector<int16_t> samples;
+};
+
+bool read_wav(const std::string& path, Wav& out) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (bytes.size() < 44 || std::memcmp(bytes.data(), "RIFF", 4) != 0 ||
+        std::memcmp(bytes.data() + 8, "WAVEfmt ", 8) != 0) {
+        return false;
+    }
+    uint32_t data_bytes;
+    std::memcpy(&out.channels, bytes.data() + 22, 2);
+    std::memcpy(&out.rate, bytes.data() + 24, 4);
+    std::memcpy(&data_bytes, bytes.data() + 40, 4);
+    if (bytes.size() != 44 + data_bytes) return false;
+    out.samples.resize(data_bytes / 2);
+    std::memcpy(out.samples.data(), bytes.data() + 44, data_bytes);
+    return true;
+}
+
+/// Remove `dir` and everything in it
+void remove_tree(const std::string& dir) {
+    if (DIR* d = ::opendir(dir.c_str())) {
+        while (dirent* entry = ::readdir(d)) {
+            std::string name = entry->d_name;
+            if (name == "." || name == "..") continue;
+            std::string path = dir + "/" + name;
+            if (::unlink(path.c_str()) != 0) remove_tree(path);
+        }
+        ::closedir(d);
+    }
+    ::rmdir(dir.c_str());
+}
+
+void send_frame(Room& room, const std::string& id, int16_t value, uint32_t seq) {
+    AudioPacket pkt{};
+    pkt.sequence = seq;
+    pkt.timestamp = seq * kSamplesPerFrame;
+    for (auto& s : pkt.samples) s = value;
+    uint8_t buf[kAudioPacketSize];
+    pkt.serialize(buf);
+    room.on_audio_received(room.slot_of(id), buf, sizeof(buf));
+}
+
+class SessionRecorderTest : public ::testing::Test {
+protected:
+    void TearDown() override { remove_tree(dir_); }
+
+    std::shared_ptr<SilentSession> join(const std::string& id) {
+        auto session = std::make_shared<SilentSession>(id);
+        EXPECT_TRUE(room_.add_participant(id, id, session));
+        return session;
+    }
+
+    std::string dir_ = "/tmp/tutti-" + std::to_string(::getpid()) + "-recording";
+    Room room_{"Cantabile", 4};
+};
+
+TEST_F(SessionRecorderTest, TracksAreSampleAlignedFromTheStart) {
+    auto alice = join("alice");
+    join("bob");
+    ASSERT_TRUE(room_.start_recording(dir_, true));
+    EXPECT_TRUE(room_.recording());
+    EXPECT_FALSE(room_.start_recording(dir_, true));  // already recording
+    ASSERT_FALSE(alice->messages.empty());
+    EXPECT_NE(alice->messages.back().find(R"("recording":true)"), std::string::npos);
+
+    for (uint32_t seq = 0; seq < 10; ++seq) {
+        if (seq == 4) join("carol");
+        send_frame(room_, "alice", static_cast<int16_t>(100 + seq), seq);
+        send_frame(room_, "bob", 20, seq);
+        if (seq >= 4) send_frame(room_, "carol", 3, seq - 4);
+        room_.process_cycle();
+    }
+    room_.stop_recording();
+    EXPECT_FALSE(room_.recording());
+    EXPECT_NE(alice->messages.back().find(R"("recording":false)"), std::string::npos);
+
+    Wav a, b, c;
+    ASSERT_TRUE(read_wav(dir_ + "/alice.wav", a));
+    ASSERT_TRUE(read_wav(dir_ + "/bob.wav", b));
+    ASSERT_TRUE(read_wav(dir_ + "/carol.wav", c));
+    EXPECT_EQ(a.channels, 1u);
+    EXPECT_EQ(a.rate, static_cast<uint32_t>(kSampleRate));
+    ASSERT_EQ(a.samples.size(), 10 * kSamplesPerFrame);
+    EXPECT_EQ(b.samples.size(), a.samples.size());
+    EXPECT_EQ(c.samples.size(), a.samples.size());
+
+    for (size_t cycle = 0; cycle < 10; ++cycle) {
+        const size_t at = cycle * kSamplesPerFrame;
+        EXPECT_EQ(a.samples[at], static_cast<int16_t>(100 + cycle));
+        EXPECT_EQ(b.samples[at], 20);
+        EXPECT_EQ(c.samples[at], cycle < 4 ? 0 : 3) << cycle;  // silence before the join
+    }
+
+    // Mixes line up with the inputs: alice hears bob, and carol once there.
+    // Recording mixes, she was mixed for even while bob was her only source.
+    Wav mix;
+    ASSERT_TRUE(read_wav(dir_ + "/mix-alice.wav", mix));
+    ASSERT_EQ(mix.samples.size(), a.samples.size());
+    EXPECT_EQ(mix.samples[0], 20);
+    EXPECT_EQ(mix.samples[9 * kSamplesPerFrame], 23);
+}
+
+TEST_F(SessionRecorderTest, RecordingMixesARoomThatWouldForward) {
+    join("alice");
+    join("bob");
+    EXPECT_FALSE(room_.needs_mixing());  // two parties forward directly
+
+    ASSERT_TRUE(room_.start_recording(dir_, false));
+    EXPECT_TRUE(room_.needs_mixing());
+    for (uint32_t seq = 0; seq < 3; ++seq) {
+        send_frame(room_, "alice", 500, seq);
+        room_.process_cycle();
+    }
+    room_.stop_recording();
+    EXPECT_FALSE(room_.needs_mixing());
+
+    Wav a;
+    ASSERT_TRUE(read_wav(dir_ + "/alice.wav", a));
+    EXPECT_EQ(a.samples.size(), 3 * kSamplesPerFrame);
+    EXPECT_EQ(a.samples.back(), 500);
+    EXPECT_NE(::access((dir_ + "/mix-bob.wav").c_str(), F_OK), 0);  // mixes not asked for
+}
+
+TEST(RoomManagerRecordingTest, OnlyParticipantsRecordAndOnlyWhenEnabled) {
+    RoomManager manager(4);
+    manager.initialize_default_rooms();
+    std::string id;
+    ASSERT_EQ(manager.join_room("Allegro", "alice", "", nullptr, id),
+              RoomManager::JoinResult::Success);
+
+    using Result = RoomManager::RecordingResult;
+    EXPECT_EQ(manager.set_recording("Allegro", id, true), Result::Disabled);
+    EXPECT_EQ(manager.set_recording("Nowhere", id, true), Result::RoomNotFound);
+    EXPECT_EQ(manager.set_recording("Allegro", "stranger", true), Result::NotParticipant);
+
+    const std::string dir = "/tmp/tutti-" + std::to_string(::getpid()) + "-recordings";
+    ASSERT_EQ(::mkdir(dir.c_str(), 0755), 0);
+    manager.set_recording_dir(dir);
+    EXPECT_EQ(manager.set_recording("Allegro", id, true), Result::Ok);
+    EXPECT_TRUE(manager.get_room("Allegro")->recording());
+
+    // The last one out stops it
+    manager.leave_room("Allegro", id);
+    EXPECT_FALSE(manager.get_room("Allegro")->recording());
+    manager.stop_mixers();
+    remove_tree(dir);
+}
+
+} // namespace
+} // namespace tutti
@@ -0,0 +1,40 @@
+#include <gtest/gtest.h>
+
+#include "audio/silence_gate.h"
+
+namespace tutti {
+namespace {
+
+constexpr uint64_t kLoud = SilenceGate::kQuietEnergy * 100;
+constexpr uint64_t kQuiet = SilenceGate::kQuietEnergy / 10;
+
+TEST(SilenceGateTest, QuietClosesAfterHangover) {
+    SilenceGate gate;
+    EXPECT_FALSE(gate.update(kLoud));
+    for (uint32_t i = 1; i < SilenceGate::kHangoverFrames; ++i) {
+        EXPECT_FALSE(gate.update(kQuiet)) << "frame " << i;
+    }
+    EXPECT_TRUE(gate.update(kQuiet));
+    EXPECT_TRUE(gate.update(kQuiet));
+}
+
+TEST(SilenceGateTest, LoudFrameReopensImmediately) {
+    SilenceGate gate;
+    for (uint32_t i = 0; i < SilenceGate::kHangoverFrames; ++i) gate.update(kQuiet);
+    EXPECT_TRUE(gate.update(kQuiet));
+    EXPECT_FALSE(gate.update(kLoud));
+    EXPECT_FALSE(gate.update(kQuiet));  // hangover starts over
+}
+
+TEST(SilenceGateTest, DigitalSilenceClosesAtOnce) {
+    SilenceGate gate;
+    EXPECT_FALSE(gate.update(kLoud));
+    EXPECT_TRUE(gate.update(0));
+    EXPECT_TRUE(gate.update(kQuiet));  // already past the hangover
+
+    gate.reset();
+    EXPECT_FALSE(gate.update(kQuiet));
+}
+
+} // namespace
+} // namespace tutti
@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+
+#include "audio/soft_limiter.h"
+#include "transport/transport_interface.h"
+
+#include <array>
+#include <cmath>
+
+namespace tutti {
+namespace {
+
+using Bus = std::array<float, kSamplesPerFrame>;
+
+Bus make_bus(float value) {
+    Bus bus;
+    bus.fill(value);
+    return bus;
+}
+
+TEST(SoftLimiterTest, UnderTheKneeIsBitExact) {
+    SoftLimiter limiter;
+    Bus bus = make_bus(0.0f);
+    for (size_t i = 0; i < kSamplesPerFrame; ++i) {
+        bus[i] = static_cast<float>(i * 200) - 12800.5f;
+    }
+    std::array<int16_t, kSamplesPerFrame> out{};
+    limiter.process(mix_kernels(), out.data(), bus.data(), kSamplesPerFrame);
+    for (size_t i = 0; i < kSamplesPerFrame; ++i) {
+        EXPECT_EQ(out[i], std::lrintf(bus[i])) << "sample " << i;
+    }
+    EXPECT_EQ(limiter.gain(), 1.0f);
+}
+
+TEST(SoftLimiterTest, HoldsLoudBusAtTheKneeThenReleases) {
+    SoftLimiter limiter;
+    const MixKernels& k = mix_kernels();
+    std::array<int16_t, kSamplesPerFrame> out{};
+
+    Bus loud = make_bus(-120000.0f);
+    for (int cycle = 0; cycle < 3; ++cycle) {
+        limiter.process(k, out.data(), loud.data(), kSamplesPerFrame);
+        for (int16_t s : out) ASSERT_GT(s, -kSoftClipCeiling) << "cycle " << cycle;
+    }
+    EXPECT_NEAR(out[0], -kSoftClipKnee, 1);
+    EXPECT_NEAR(out[kSamplesPerFrame - 1], -kSoftClipKnee, 1);
+
+    // Gain recovers gradually: never a step back to unity
+    Bus quiet = make_bus(1000.0f);
+    float previous = limiter.gain();
+    limiter.process(k, out.data(), quiet.data(), kSamplesPerFrame);
+    EXPECT_GT(limiter.gain(), previous);
+    EXPECT_LT(out[kSamplesPerFrame - 1], 1000);
+
+    // ~80ms time constant: back to unity, and the fast path, within a second
+    for (int cycle = 0; cycle < 375 && limiter.gain() < 1.0f; ++cycle) {
+        limiter.process(k, out.data(), quiet.data(), kSamplesPerFrame);
+    }
+    EXPECT_EQ(limiter.gain(), 1.0f);
+    limiter.process(k, out.data(), quiet.data(), kSamplesPerFrame);
+    EXPECT_EQ(out[0], 1000);
+    EXPECT_EQ(out[kSamplesPerFrame - 1], 1000);
+}
+
+TEST(SoftLimiterTest, ResetReturnsToUnity) {
+    SoftLimiter limiter;
+    std::array<int16_t, kSamplesPerFrame> out{};
+    Bus loud = make_bus(90000.0f);
+    limiter.process(mix_kernels(), out.data(), loud.data(), kSamplesPerFrame);
+    EXPECT_LT(limiter.gain(), 1.0f);
+    limiter.reset();
+    EXPECT_EQ(limiter.gain(), 1.0f);
+}
+
+} // namespace
+} // namespace tutti
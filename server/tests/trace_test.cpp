@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "telemetry/trace.h"
+
+namespace tutti {
+namespace {
+
+using trace::Event;
+using trace::kRingCapacity;
+
+const nlohmann::json* find_event(const nlohmann::json& dump, const std::string& name,
+                                 const std::string& phase) {
+    for (const auto& e : dump["traceEvents"]) {
+        if (e["name"] == name && e["ph"] == phase) return &e;
+    }
+    return nullptr;
+}
+
+TEST(TraceTest, FullRingKeepsTheNewestEvents) {
+    auto ring = std::make_unique<trace::ThreadRing>();
+    for (uint64_t i = 0; i < kRingCapacity + 10; ++i) ring->record("test", i, i + 1, i);
+    EXPECT_EQ(ring->recorded(), kRingCapacity + 10);
+
+    std::vector<Event> events;
+    ring->snapshot(events);
+    ASSERT_EQ(events.size(), kRingCapacity - 1);  // not the cell being overwritten next
+    EXPECT_EQ(events.front().arg, 11u);
+    EXPECT_EQ(events.back().arg, kRingCapacity + 9);
+}
+
+TEST(TraceTest, SnapshotsTakenWhileRecordingAreNeverTorn) {
+    auto ring = std::make_unique<trace::ThreadRing>();
+    std::atomic<bool> done{false};
+    std::thread writer([&] {
+        for (uint64_t i = 0; i < 8 * kRingCapacity; ++i) ring->record("test", i, i + 1, i);
+        done = true;
+    });
+
+    std::vector<Event> events;
+    size_t snapshots = 0;
+    while (!done || snapshots == 0) {
+        events.clear();
+        ring->snapshot(events);
+        ++snapshots;
+        for (size_t i = 0; i < events.size(); ++i) {
+            ASSERT_EQ(events[i].end, events[i].start + 1);
+            ASSERT_EQ(events[i].arg, events[i].start);
+            if (i > 0) {
+                ASSERT_EQ(events[i].arg, events[i - 1].arg + 1);  // oldest first, no gaps
+            }
+        }
+    }
+    writer.join();
+}
+
+TEST(TraceTest, DumpIsChromeTraceJsonWithNamedThreads) {
+    std::thread worker([] {
+        trace::set_thread_name("trace-test-worker");
+        {
+            trace::Scope outer("test.outer", 7);
+            trace::Scope inner("test.inner");
+            trace::instant("test.instant", 3);
+        }
+    });
+    worker.join();
+
+    const nlohmann::json dump = nlohmann::json::parse(trace::dump_chrome_json());
+    ASSERT_TRUE(dump["traceEvents"].is_array());
+
+    const nlohmann::json* outer = find_event(dump, "test.outer", "X");
+    const nlohmann::json* inner = find_event(dump, "test.inner", "X");
+    const nlohmann::json* instant = find_event(dump, "test.instant", "i");
+    ASSERT_TRUE(outer && inner && instant);
+    EXPECT_EQ((*outer)["args"]["arg"], 7);
+    EXPECT_EQ((*instant)["args"]["arg"], 3);
+    EXPECT_EQ((*outer)["tid"], (*inner)["tid"]);
+
+    // Inner nests in outer (to the microsecond rounding of the dump)
+    const double outer_ts = (*outer)["ts"], outer_dur = (*outer)["dur"];
+    const double inner_ts = (*inner)["ts"], inner_dur = (*inner)["dur"];
+    EXPECT_GE(inner_ts + 0.002, outer_ts);
+    EXPECT_LE(inner_ts + inner_dur, outer_ts + outer_dur + 0.002);
+
+    bool named = false;
+    for (const auto& e : dump["traceEvents"]) {
+        named = named || (e["ph"] == "M" && e["tid"] == (*outer)["tid"] &&
+                          e["args"]["name"] == "trace-test-worker");
+    }
+    EXPECT_TRUE(named);
+}
+
+TEST(TraceTest, MacrosRecordOnlyInTracingBuilds) {
+    uint64_t recorded = 0;
+    std::thread worker([&] {
+        const uint64_t before = trace::thread_ring().recorded();
+        {
+            TUTTI_TRACE("test.macro");
+            TUTTI_TRACE_ARG("test.macro_arg", 1);
+        }
+        TUTTI_TRACE_INSTANT("test.macro_instant", 2);
+        recorded = trace::thread_ring().recorded() - before;
+    });
+    worker.join();
+    EXPECT_EQ(recorded, trace::kEnabled ? 3u : 0u);
+}
+
+} // namespace
+} // namespace tutti